@@ -11,6 +11,23 @@ android {
         minSdk = 24
         targetSdk = 34
         testInstrumentationRunner = "androidx.test.runner.AndroidJUnitRunner"
+        externalNativeBuild {
+            cmake {
+                // Same STL as libjsi from react-android
+                arguments += "-DANDROID_STL=c++_shared"
+            }
+        }
+    }
+
+    buildFeatures {
+        prefab = true
+    }
+
+    // JSI bindings for the "rgba" frame transport (src/main/cpp)
+    externalNativeBuild {
+        cmake {
+            path = file("src/main/cpp/CMakeLists.txt")
+        }
     }
 
     compileOptions {
@@ -41,6 +58,13 @@ dependencies {
     implementation("com.flir:androidsdk:1.0.0")
     // minimal compile deps to satisfy source references
     implementation("androidx.annotation:annotation:1.5.0")
+    // jsi headers and library (prefab) for the frame transport bindings; the app provides React Native
+    compileOnly("com.facebook.react:react-android:${findProperty("reactNativeVersion") ?: "0.74.5"}")
+
+    // Instrumented tests (src/androidTest), run on a device: ./gradlew connectedAndroidTest
+    androidTestImplementation("junit:junit:4.13.2")
+    androidTestImplementation("androidx.test:runner:1.5.2")
+    androidTestImplementation("androidx.test.ext:junit:1.1.5")
 
     // Prevent duplicate SLF4J classes when a consumer also brings `org.slf4j:slf4j-api`
     // The vendor AAR may embed slf4j classes; exclude the API from being pulled transitively
@@ -0,0 +1,152 @@
+package flir.android;
+
+import static org.junit.Assert.assertEquals;
+import static org.junit.Assert.assertFalse;
+import static org.junit.Assert.assertNotNull;
+import static org.junit.Assert.assertNull;
+import static org.junit.Assert.assertTrue;
+
+import android.graphics.Bitmap;
+
+import androidx.test.ext.junit.runners.AndroidJUnit4;
+import androidx.test.platform.app.InstrumentationRegistry;
+
+import org.junit.After;
+import org.junit.Before;
+import org.junit.Test;
+import org.junit.runner.RunWith;
+
+import java.io.File;
+import java.nio.FloatBuffer;
+import java.util.concurrent.CountDownLatch;
+import java.util.concurrent.TimeUnit;
+import java.util.concurrent.atomic.AtomicInteger;
+
+/** Recording while a dump is replayed, the way FlirManager records the live stream. */
+@RunWith(AndroidJUnit4.class)
+public class ReplayRecordingTest {
+
+    private static final int FRAMES = 12;
+    private static final int WIDTH = 16;
+    private static final int HEIGHT = 12;
+    private static final String METADATA = "{\"camera\":{\"displayName\":\"FLIR ONE Edge\",\"width\":16,\"height\":12},"
+            + "\"thermalParameters\":{\"emissivity\":0.95}}";
+
+    private File dir;
+    private CameraHandler handler;
+
+    @Before
+    public void setUp() {
+        dir = new File(InstrumentationRegistry.getInstrumentation().getTargetContext().getCacheDir(), "replay-test");
+        dir.mkdirs();
+        handler = new CameraHandler();
+    }
+
+    @After
+    public void tearDown() {
+        handler.stopReplay();
+        File[] files = dir.listFiles();
+        if (files != null) for (File file : files) file.delete();
+        dir.delete();
+    }
+
+    @Test
+    public void recordsEveryFrameOfAReplayWithTheDumpMetadata() throws Exception {
+        File dump = writeDump(METADATA);
+        File recording = new File(dir, "replay.flirrec");
+        assertEquals(FRAMES, recordReplay(dump, recording));
+        try (RadiometricRecording read = RadiometricRecording.open(recording)) {
+            assertEquals(FRAMES, read.getFrameCount());
+            assertEquals(METADATA, read.getMetadata());
+        }
+    }
+
+    @Test
+    public void recordsAVersion1DumpWithReplayMetadata() throws Exception {
+        File dump = writeDump(null);
+        File recording = new File(dir, "replay-v1.flirrec");
+        assertEquals(FRAMES, recordReplay(dump, recording));
+        try (RadiometricRecording read = RadiometricRecording.open(recording)) {
+            assertNotNull(read.getMetadata());
+        }
+    }
+
+    @Test
+    public void stopPublishesNoFrameAfterReturning() throws Exception {
+        File dump = writeDump(METADATA);
+        handler.startReplay(dump, 1f, true, listener(frame -> {}), null);
+        Thread.sleep(100);
+        FrameReplay replay = handler.getReplay();
+        handler.stopReplay();
+        long published = replay.getFramesReplayed();
+        Thread.sleep(200);
+        assertFalse(replay.isRunning());
+        assertEquals(published, replay.getFramesReplayed());
+        assertNull(handler.getReplay());
+    }
+
+    // Same guard as FlirManager.record: frames are recorded once the stream metadata is known
+    private int recordReplay(File dump, File file) throws Exception {
+        RadiometricRecorder recorder = new RadiometricRecorder(file, 4);
+        AtomicInteger dropped = new AtomicInteger();
+        CountDownLatch finished = new CountDownLatch(1);
+        handler.startReplay(dump, FrameReplay.FAST, false, listener(frame -> {
+            String metadata = handler.getStreamMetadata();
+            if (metadata == null) {
+                dropped.incrementAndGet();
+                return;
+            }
+            try {
+                recorder.append(frame.radiometric, metadata);
+            } catch (Exception e) {
+                throw new RuntimeException(e);
+            }
+        }), (replay, error) -> finished.countDown());
+        handler.requestStreamMetadata();
+        assertTrue(finished.await(10, TimeUnit.SECONDS));
+        // The worker may still hold the last frame when the replay thread finishes
+        Thread.sleep(200);
+        recorder.close();
+        assertEquals(0, dropped.get());
+        return recorder.getFrameCount();
+    }
+
+    private File writeDump(String metadata) throws Exception {
+        File file = new File(dir, metadata != null ? "frames.flirdump" : "frames-v1.flirdump");
+        FrameDump dump = new FrameDump();
+        dump.setMetadata(metadata);
+        dump.start(file);
+        FrameRing.Slot slot = new FrameRing.Slot(0);
+        slot.thermal.ensureCapacity(WIDTH * HEIGHT * 4);
+        slot.thermal.width = WIDTH;
+        slot.thermal.height = HEIGHT;
+        slot.visual.clear();
+        float[] celsius = new float[WIDTH * HEIGHT];
+        for (int i = 0; i < FRAMES; i++) {
+            for (int p = 0; p < celsius.length; p++) celsius[p] = 20f + i + p * 0.01f;
+            slot.radiometric.fill(FloatBuffer.wrap(celsius), WIDTH, HEIGHT, i, i * 33_000_000L);
+            slot.hasRadiometric = true;
+            slot.timestampNanos = i * 33_000_000L;
+            dump.append(slot);
+        }
+        dump.stop();
+        return file;
+    }
+
+    private interface FrameCallback {
+        void frame(FrameDataHolder frame);
+    }
+
+    private static CameraHandler.StreamDataListener listener(FrameCallback callback) {
+        return new CameraHandler.StreamDataListener() {
+            @Override
+            public void images(FrameDataHolder dataHolder) {
+                callback.frame(dataHolder);
+            }
+
+            @Override
+            public void images(Bitmap msxBitmap, Bitmap dcBitmap) {
+            }
+        };
+    }
+}
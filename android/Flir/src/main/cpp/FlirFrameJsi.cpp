@@ -0,0 +1,86 @@
+#include <jni.h>
+#include <jsi/jsi.h>
+
+#include <memory>
+
+using namespace facebook;
+
+namespace {
+
+JavaVM *gVm = nullptr;
+jclass gBridgeClass = nullptr;
+jmethodID gSlotBuffer = nullptr;
+jmethodID gSlotSequence = nullptr;
+
+JNIEnv *env() {
+  JNIEnv *env = nullptr;
+  if (gVm->GetEnv(reinterpret_cast<void **>(&env), JNI_VERSION_1_6) != JNI_OK) {
+    gVm->AttachCurrentThread(&env, nullptr);
+  }
+  return env;
+}
+
+// Keeps the direct ByteBuffer reachable for as long as JS holds the ArrayBuffer, so a ring
+// reallocated on a size change never frees memory JS can still see
+class SlotBuffer : public jsi::MutableBuffer {
+ public:
+  SlotBuffer(JNIEnv *env, jobject buffer)
+      : ref_(env->NewGlobalRef(buffer)),
+        data_(static_cast<uint8_t *>(env->GetDirectBufferAddress(buffer))),
+        size_(static_cast<size_t>(env->GetDirectBufferCapacity(buffer))) {}
+
+  ~SlotBuffer() override { env()->DeleteGlobalRef(ref_); }
+
+  size_t size() const override { return size_; }
+  uint8_t *data() override { return data_; }
+
+ private:
+  jobject ref_;
+  uint8_t *data_;
+  size_t size_;
+};
+
+int slotArgument(jsi::Runtime &rt, const jsi::Value *args, size_t count) {
+  if (count < 1 || !args[0].isNumber()) throw jsi::JSError(rt, "slot must be a number");
+  return static_cast<int>(args[0].asNumber());
+}
+
+void install(jsi::Runtime &rt) {
+  auto frameSlot = jsi::Function::createFromHostFunction(
+      rt, jsi::PropNameID::forAscii(rt, "__flirFrameSlot"), 1,
+      [](jsi::Runtime &rt, const jsi::Value &, const jsi::Value *args, size_t count) -> jsi::Value {
+        int slot = slotArgument(rt, args, count);
+        JNIEnv *e = env();
+        jobject buffer = e->CallStaticObjectMethod(gBridgeClass, gSlotBuffer, slot);
+        if (buffer == nullptr) return jsi::Value::null();
+        auto slotBuffer = std::make_shared<SlotBuffer>(e, buffer);
+        e->DeleteLocalRef(buffer);
+        if (slotBuffer->data() == nullptr) return jsi::Value::null();
+        return jsi::ArrayBuffer(rt, slotBuffer);
+      });
+  auto frameSequence = jsi::Function::createFromHostFunction(
+      rt, jsi::PropNameID::forAscii(rt, "__flirFrameSequence"), 1,
+      [](jsi::Runtime &rt, const jsi::Value &, const jsi::Value *args, size_t count) -> jsi::Value {
+        int slot = slotArgument(rt, args, count);
+        jlong sequence = env()->CallStaticLongMethod(gBridgeClass, gSlotSequence, slot);
+        return jsi::Value(static_cast<double>(sequence));
+      });
+  rt.global().setProperty(rt, "__flirFrameSlot", std::move(frameSlot));
+  rt.global().setProperty(rt, "__flirFrameSequence", std::move(frameSequence));
+}
+
+}  // namespace
+
+extern "C" JNIEXPORT jboolean JNICALL
+Java_flir_android_FlirFrameJsi_nativeInstall(JNIEnv *e, jclass clazz, jlong runtimePointer) {
+  auto *runtime = reinterpret_cast<jsi::Runtime *>(runtimePointer);
+  if (runtime == nullptr) return JNI_FALSE;
+  if (gVm == nullptr) {
+    e->GetJavaVM(&gVm);
+    gBridgeClass = static_cast<jclass>(e->NewGlobalRef(clazz));
+    gSlotBuffer = e->GetStaticMethodID(clazz, "slotBuffer", "(I)Ljava/nio/ByteBuffer;");
+    gSlotSequence = e->GetStaticMethodID(clazz, "slotSequence", "(I)J");
+  }
+  install(*runtime);
+  return JNI_TRUE;
+}
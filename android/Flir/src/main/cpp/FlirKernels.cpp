@@ -0,0 +1,407 @@
+#include <jni.h>
+
+#include <cstdint>
+#include <cstring>
+
+#if defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
+// Pixel kernels of FrameUpscaler and FrameFusion. Pixels are RGBA_8888 bytes; index, weight and
+// sample tables are the ones the Java classes build, and every kernel produces exactly what its
+// Java fallback does. NEON (arm64-v8a, armeabi-v7a) keeps the four channels of a pixel, or a run
+// of row bytes, in vector lanes; other ABIs (x86 emulators) use the plain loops.
+
+namespace {
+
+constexpr int kCubicBits = 12;
+constexpr uint32_t kOpaque = 0xFF000000u;
+
+// Pins an int[] for the duration of a kernel; no JNI calls are made while it is held
+class CriticalInts {
+ public:
+  CriticalInts(JNIEnv *env, jintArray array)
+      : env_(env), array_(array),
+        data_(static_cast<int32_t *>(env->GetPrimitiveArrayCritical(array, nullptr))) {}
+  ~CriticalInts() {
+    if (data_ != nullptr) env_->ReleasePrimitiveArrayCritical(array_, data_, 0);
+  }
+  int32_t *get() const { return data_; }
+
+ private:
+  JNIEnv *env_;
+  jintArray array_;
+  int32_t *data_;
+};
+
+inline uint32_t load(const uint8_t *pixels, int index) {
+  uint32_t p;
+  std::memcpy(&p, pixels + static_cast<size_t>(index) * 4, 4);
+  return p;
+}
+
+inline void store(uint8_t *pixels, int index, uint32_t p) {
+  std::memcpy(pixels + static_cast<size_t>(index) * 4, &p, 4);
+}
+
+inline int clamp255(int v) { return v < 0 ? 0 : (v > 255 ? 255 : v); }
+
+inline uint32_t pack(int r, int g, int b) {
+  return kOpaque | (static_cast<uint32_t>(clamp255(b)) << 16) | (static_cast<uint32_t>(clamp255(g)) << 8) |
+         static_cast<uint32_t>(clamp255(r));
+}
+
+inline uint32_t lerp(uint32_t a, uint32_t b, int w) {
+  int inv = 256 - w;
+  uint32_t r = ((a & 0xFF) * inv + (b & 0xFF) * w + 128) >> 8;
+  uint32_t g = (((a >> 8) & 0xFF) * inv + ((b >> 8) & 0xFF) * w + 128) >> 8;
+  uint32_t bl = (((a >> 16) & 0xFF) * inv + ((b >> 16) & 0xFF) * w + 128) >> 8;
+  return kOpaque | (bl << 16) | (g << 8) | r;
+}
+
+#if defined(__ARM_NEON)
+inline int16x4_t widen(uint32_t p) {
+  return vreinterpret_s16_u16(vget_low_u16(vmovl_u8(vreinterpret_u8_u32(vdup_n_u32(p)))));
+}
+
+// Arithmetic shift, clamp to 0..255 and force alpha, as pack() does
+inline uint32_t narrowCubic(int32x4_t acc) {
+  uint16x4_t clamped = vqmovun_s32(vshrq_n_s32(acc, kCubicBits));
+  uint8x8_t bytes = vqmovn_u16(vcombine_u16(clamped, clamped));
+  return vget_lane_u32(vreinterpret_u32_u8(bytes), 0) | kOpaque;
+}
+#endif
+
+// Rows a and b mixed with weight w of b out of 256, rounded, over n bytes
+void lerpRows(const uint8_t *a, const uint8_t *b, uint8_t *out, int n, int w) {
+  int i = 0;
+#if defined(__ARM_NEON)
+  uint16_t inv = static_cast<uint16_t>(256 - w);
+  uint16_t wb = static_cast<uint16_t>(w);
+  uint16x8_t round = vdupq_n_u16(128);
+  for (; i + 16 <= n; i += 16) {
+    uint8x16_t va = vld1q_u8(a + i);
+    uint8x16_t vb = vld1q_u8(b + i);
+    uint16x8_t lo = vmlaq_n_u16(vmlaq_n_u16(round, vmovl_u8(vget_low_u8(va)), inv), vmovl_u8(vget_low_u8(vb)), wb);
+    uint16x8_t hi = vmlaq_n_u16(vmlaq_n_u16(round, vmovl_u8(vget_high_u8(va)), inv), vmovl_u8(vget_high_u8(vb)), wb);
+    vst1q_u8(out + i, vcombine_u8(vshrn_n_u16(lo, 8), vshrn_n_u16(hi, 8)));
+  }
+#endif
+  for (; i < n; i++) out[i] = static_cast<uint8_t>((a[i] * (256 - w) + b[i] * w + 128) >> 8);
+}
+
+void bilinear(const uint8_t *in, int sw, int sh, uint8_t *out, int dw, int dh, const int32_t *indexX,
+              const int32_t *weightX, const int32_t *indexY, const int32_t *weightY, uint8_t *tmp) {
+  for (int y = 0; y < sh; y++) {
+    const uint8_t *row = in + static_cast<size_t>(y) * sw * 4;
+    int o = y * dw;
+    int x = 0;
+#if defined(__ARM_NEON)
+    // Two output pixels per step, channels in u16 lanes
+    uint32x4_t alpha = vdupq_n_u32(kOpaque);
+    for (; x + 2 <= dw; x += 2) {
+      uint32x2_t a = vdup_n_u32(load(row, indexX[2 * x]));
+      a = vset_lane_u32(load(row, indexX[2 * x + 2]), a, 1);
+      uint32x2_t b = vdup_n_u32(load(row, indexX[2 * x + 1]));
+      b = vset_lane_u32(load(row, indexX[2 * x + 3]), b, 1);
+      uint16x4_t w0 = vdup_n_u16(static_cast<uint16_t>(weightX[2 * x + 1]));
+      uint16x4_t w1 = vdup_n_u16(static_cast<uint16_t>(weightX[2 * x + 3]));
+      uint16x8_t w = vcombine_u16(w0, w1);
+      uint16x8_t inv = vsubq_u16(vdupq_n_u16(256), w);
+      uint16x8_t acc = vmlaq_u16(vmlaq_u16(vdupq_n_u16(128), vmovl_u8(vreinterpret_u8_u32(a)), inv),
+                                 vmovl_u8(vreinterpret_u8_u32(b)), w);
+      uint32x2_t mixed = vreinterpret_u32_u8(vshrn_n_u16(acc, 8));
+      vst1_u8(tmp + static_cast<size_t>(o + x) * 4,
+              vreinterpret_u8_u32(vorr_u32(mixed, vget_low_u32(alpha))));
+    }
+#endif
+    for (; x < dw; x++) {
+      store(tmp, o + x, lerp(load(row, indexX[2 * x]), load(row, indexX[2 * x + 1]), weightX[2 * x + 1]));
+    }
+  }
+  size_t stride = static_cast<size_t>(dw) * 4;
+  for (int y = 0; y < dh; y++) {
+    lerpRows(tmp + indexY[2 * y] * stride, tmp + indexY[2 * y + 1] * stride, out + y * stride,
+             static_cast<int>(stride), weightY[2 * y + 1]);
+  }
+}
+
+void bicubic(const uint8_t *in, int sw, int sh, uint8_t *out, int dw, int dh, const int32_t *indexX,
+             const int32_t *weightX, const int32_t *indexY, const int32_t *weightY, uint8_t *tmp) {
+  const int half = 1 << (kCubicBits - 1);
+  for (int y = 0; y < sh; y++) {
+    const uint8_t *row = in + static_cast<size_t>(y) * sw * 4;
+    int o = y * dw;
+    for (int x = 0; x < dw; x++) {
+      const int32_t *ix = indexX + 4 * x;
+      const int32_t *wx = weightX + 4 * x;
+#if defined(__ARM_NEON)
+      int32x4_t acc = vdupq_n_s32(half);
+      for (int k = 0; k < 4; k++) acc = vmlal_n_s16(acc, widen(load(row, ix[k])), static_cast<int16_t>(wx[k]));
+      store(tmp, o + x, narrowCubic(acc));
+#else
+      int r = half, g = half, b = half;
+      for (int k = 0; k < 4; k++) {
+        uint32_t p = load(row, ix[k]);
+        r += static_cast<int>(p & 0xFF) * wx[k];
+        g += static_cast<int>((p >> 8) & 0xFF) * wx[k];
+        b += static_cast<int>((p >> 16) & 0xFF) * wx[k];
+      }
+      store(tmp, o + x, pack(r >> kCubicBits, g >> kCubicBits, b >> kCubicBits));
+#endif
+    }
+  }
+  for (int y = 0; y < dh; y++) {
+    const uint8_t *rows[4];
+    for (int k = 0; k < 4; k++) rows[k] = tmp + static_cast<size_t>(indexY[4 * y + k]) * dw * 4;
+    const int32_t *wy = weightY + 4 * y;
+    int o = y * dw;
+    for (int x = 0; x < dw; x++) {
+#if defined(__ARM_NEON)
+      int32x4_t acc = vdupq_n_s32(half);
+      for (int k = 0; k < 4; k++) acc = vmlal_n_s16(acc, widen(load(rows[k], x)), static_cast<int16_t>(wy[k]));
+      store(out, o + x, narrowCubic(acc));
+#else
+      int r = half, g = half, b = half;
+      for (int k = 0; k < 4; k++) {
+        uint32_t p = load(rows[k], x);
+        r += static_cast<int>(p & 0xFF) * wy[k];
+        g += static_cast<int>((p >> 8) & 0xFF) * wy[k];
+        b += static_cast<int>((p >> 16) & 0xFF) * wy[k];
+      }
+      store(out, o + x, pack(r >> kCubicBits, g >> kCubicBits, b >> kCubicBits));
+#endif
+    }
+  }
+}
+
+void jointBilateral(const uint8_t *in, int sw, uint8_t *out, int dw, int dh, const int32_t *indexX,
+                    const int32_t *weightX, const int32_t *indexY, const int32_t *weightY,
+                    const int32_t *guideHigh, const int32_t *guideLow, const int32_t *rangeWeights) {
+  for (int y = 0; y < dh; y++) {
+    int r0 = indexY[2 * y] * sw;
+    int r1 = indexY[2 * y + 1] * sw;
+    int wy1 = weightY[2 * y + 1];
+    int wy0 = 256 - wy1;
+    int o = y * dw;
+    for (int x = 0; x < dw; x++) {
+      int c0 = indexX[2 * x];
+      int c1 = indexX[2 * x + 1];
+      int wx1 = weightX[2 * x + 1];
+      int wx0 = 256 - wx1;
+      int g = guideHigh[o + x];
+      int i00 = r0 + c0, i01 = r0 + c1, i10 = r1 + c0, i11 = r1 + c1;
+      auto range = [&](int i) { int d = g - guideLow[i]; return rangeWeights[d < 0 ? -d : d]; };
+      uint32_t w00 = static_cast<uint32_t>((wx0 * wy0 >> 8) * range(i00));
+      uint32_t w01 = static_cast<uint32_t>((wx1 * wy0 >> 8) * range(i01));
+      uint32_t w10 = static_cast<uint32_t>((wx0 * wy1 >> 8) * range(i10));
+      uint32_t w11 = static_cast<uint32_t>((wx1 * wy1 >> 8) * range(i11));
+      uint32_t total = w00 + w01 + w10 + w11;
+      if (total == 0) {
+        store(out, o + x, load(in, wy1 < 128 ? (wx1 < 128 ? i00 : i01) : (wx1 < 128 ? i10 : i11)));
+        continue;
+      }
+      // At most 255 * 65536 * 4 per channel, so 32-bit lanes do not overflow
+      uint32_t sums[4];
+#if defined(__ARM_NEON)
+      auto lanes = [&](int i) { return vmovl_u16(vget_low_u16(vmovl_u8(vreinterpret_u8_u32(vdup_n_u32(load(in, i)))))); };
+      uint32x4_t acc = vmulq_n_u32(lanes(i00), w00);
+      acc = vmlaq_n_u32(acc, lanes(i01), w01);
+      acc = vmlaq_n_u32(acc, lanes(i10), w10);
+      acc = vmlaq_n_u32(acc, lanes(i11), w11);
+      vst1q_u32(sums, acc);
+#else
+      uint32_t p00 = load(in, i00), p01 = load(in, i01), p10 = load(in, i10), p11 = load(in, i11);
+      for (int c = 0; c < 3; c++) {
+        int shift = 8 * c;
+        sums[c] = ((p00 >> shift) & 0xFF) * w00 + ((p01 >> shift) & 0xFF) * w01 + ((p10 >> shift) & 0xFF) * w10 +
+                  ((p11 >> shift) & 0xFF) * w11;
+      }
+#endif
+      store(out, o + x, pack(static_cast<int>(sums[0] / total), static_cast<int>(sums[1] / total),
+                             static_cast<int>(sums[2] / total)));
+    }
+  }
+}
+
+// 2x2 average of the photo per thermal pixel (sample tables from FrameFusion), plus its luma
+void fusionDownsample(const uint8_t *photo, int tw, int th, const int32_t *sampleX0, const int32_t *sampleX1,
+                      const int32_t *sampleY0, const int32_t *sampleY1, uint8_t *small, int32_t *luma) {
+  for (int y = 0; y < th; y++) {
+    int r0 = sampleY0[y];
+    int r1 = sampleY1[y];
+    int o = y * tw;
+    for (int x = 0; x < tw; x++) {
+      uint32_t a = load(photo, r0 + sampleX0[x]), b = load(photo, r0 + sampleX1[x]);
+      uint32_t c = load(photo, r1 + sampleX0[x]), d = load(photo, r1 + sampleX1[x]);
+#if defined(__ARM_NEON)
+      uint16x8_t ab = vmovl_u8(vreinterpret_u8_u32(vset_lane_u32(b, vdup_n_u32(a), 1)));
+      uint16x8_t cd = vmovl_u8(vreinterpret_u8_u32(vset_lane_u32(d, vdup_n_u32(c), 1)));
+      uint16x8_t sum = vaddq_u16(ab, cd);
+      uint16x4_t mean = vshr_n_u16(vadd_u16(vadd_u16(vget_low_u16(sum), vget_high_u16(sum)), vdup_n_u16(2)), 2);
+      uint32_t p = vget_lane_u32(vreinterpret_u32_u8(vmovn_u16(vcombine_u16(mean, mean))), 0) | kOpaque;
+      int r = p & 0xFF, g = (p >> 8) & 0xFF, bl = (p >> 16) & 0xFF;
+#else
+      int r = ((a & 0xFF) + (b & 0xFF) + (c & 0xFF) + (d & 0xFF) + 2) >> 2;
+      int g = (((a >> 8) & 0xFF) + ((b >> 8) & 0xFF) + ((c >> 8) & 0xFF) + ((d >> 8) & 0xFF) + 2) >> 2;
+      int bl = (((a >> 16) & 0xFF) + ((b >> 16) & 0xFF) + ((c >> 16) & 0xFF) + ((d >> 16) & 0xFF) + 2) >> 2;
+      uint32_t p = kOpaque | (static_cast<uint32_t>(bl) << 16) | (static_cast<uint32_t>(g) << 8) | r;
+#endif
+      store(small, o + x, p);
+      luma[o + x] = (77 * r + 150 * g + 29 * bl) >> 8;
+    }
+  }
+}
+
+// thermal = thermal * (256 - alpha) + photo * alpha, truncated; thermal alpha is kept
+void fusionBlend(uint8_t *thermal, const uint8_t *photo, int count, int alpha256) {
+  int inv = 256 - alpha256;
+  int i = 0;
+#if defined(__ARM_NEON)
+  uint8x16_t alphaMask = vreinterpretq_u8_u32(vdupq_n_u32(kOpaque));
+  for (; i + 4 <= count; i += 4) {
+    uint8x16_t p = vld1q_u8(thermal + static_cast<size_t>(i) * 4);
+    uint8x16_t q = vld1q_u8(photo + static_cast<size_t>(i) * 4);
+    uint16x8_t lo = vmlaq_n_u16(vmulq_n_u16(vmovl_u8(vget_low_u8(p)), static_cast<uint16_t>(inv)),
+                                vmovl_u8(vget_low_u8(q)), static_cast<uint16_t>(alpha256));
+    uint16x8_t hi = vmlaq_n_u16(vmulq_n_u16(vmovl_u8(vget_high_u8(p)), static_cast<uint16_t>(inv)),
+                                vmovl_u8(vget_high_u8(q)), static_cast<uint16_t>(alpha256));
+    uint8x16_t mixed = vcombine_u8(vshrn_n_u16(lo, 8), vshrn_n_u16(hi, 8));
+    vst1q_u8(thermal + static_cast<size_t>(i) * 4, vbslq_u8(alphaMask, p, mixed));
+  }
+#endif
+  for (; i < count; i++) {
+    uint32_t p = load(thermal, i), q = load(photo, i);
+    uint32_t r = ((p & 0xFF) * inv + (q & 0xFF) * alpha256) >> 8;
+    uint32_t g = (((p >> 8) & 0xFF) * inv + ((q >> 8) & 0xFF) * alpha256) >> 8;
+    uint32_t b = (((p >> 16) & 0xFF) * inv + ((q >> 16) & 0xFF) * alpha256) >> 8;
+    store(thermal, i, (p & kOpaque) | (b << 16) | (g << 8) | r);
+  }
+}
+
+// Unsharp high-pass of the luma (separable 3x3 box, edges clamped) added to each thermal channel
+void fusionDetail(uint8_t *thermal, const int32_t *luma, int32_t *rowSums, int tw, int th, int alpha256) {
+  int gain = alpha256 * 2;
+  for (int y = 0; y < th; y++) {
+    const int32_t *l = luma + y * tw;
+    int32_t *sums = rowSums + y * tw;
+    int x = 0;
+    sums[0] = l[0] + l[0] + l[tw > 1 ? 1 : 0];
+    x = 1;
+#if defined(__ARM_NEON)
+    for (; x + 4 <= tw - 1; x += 4) {
+      vst1q_s32(sums + x, vaddq_s32(vaddq_s32(vld1q_s32(l + x - 1), vld1q_s32(l + x)), vld1q_s32(l + x + 1)));
+    }
+#endif
+    for (; x < tw; x++) sums[x] = l[x - 1] + l[x] + l[x + 1 < tw ? x + 1 : tw - 1];
+  }
+  for (int y = 0; y < th; y++) {
+    const int32_t *up = rowSums + (y > 0 ? y - 1 : 0) * tw;
+    const int32_t *mid = rowSums + y * tw;
+    const int32_t *down = rowSums + (y + 1 < th ? y + 1 : th - 1) * tw;
+    const int32_t *l = luma + y * tw;
+    uint8_t *row = thermal + static_cast<size_t>(y) * tw * 4;
+    int x = 0;
+#if defined(__ARM_NEON)
+    // x / 9 == (x * 7282) >> 16 for the sums of nine lumas (0..2295)
+    int16x4_t keepAlpha = vreinterpret_s16_u16(vcreate_u16(0x0000FFFFFFFFFFFFull));
+    for (; x + 4 <= tw; x += 4) {
+      int32x4_t sum = vaddq_s32(vaddq_s32(vld1q_s32(up + x), vld1q_s32(mid + x)), vld1q_s32(down + x));
+      int32x4_t blur = vshrq_n_s32(vmulq_n_s32(sum, 7282), 16);
+      int32x4_t delta = vshrq_n_s32(vmulq_n_s32(vsubq_s32(vld1q_s32(l + x), blur), gain), 8);
+      int32_t d[4];
+      vst1q_s32(d, delta);
+      uint8x16_t p = vld1q_u8(row + x * 4);
+      int16x8_t lo = vreinterpretq_s16_u16(vmovl_u8(vget_low_u8(p)));
+      int16x8_t hi = vreinterpretq_s16_u16(vmovl_u8(vget_high_u8(p)));
+      int16x8_t dlo = vcombine_s16(vand_s16(vdup_n_s16(static_cast<int16_t>(d[0])), keepAlpha),
+                                   vand_s16(vdup_n_s16(static_cast<int16_t>(d[1])), keepAlpha));
+      int16x8_t dhi = vcombine_s16(vand_s16(vdup_n_s16(static_cast<int16_t>(d[2])), keepAlpha),
+                                   vand_s16(vdup_n_s16(static_cast<int16_t>(d[3])), keepAlpha));
+      vst1q_u8(row + x * 4, vcombine_u8(vqmovun_s16(vaddq_s16(lo, dlo)), vqmovun_s16(vaddq_s16(hi, dhi))));
+    }
+#endif
+    for (; x < tw; x++) {
+      int blur = (up[x] + mid[x] + down[x]) / 9;
+      int delta = ((l[x] - blur) * gain) >> 8;
+      uint32_t p = load(row, x);
+      int r = clamp255(static_cast<int>(p & 0xFF) + delta);
+      int g = clamp255(static_cast<int>((p >> 8) & 0xFF) + delta);
+      int b = clamp255(static_cast<int>((p >> 16) & 0xFF) + delta);
+      store(row, x, (p & kOpaque) | (static_cast<uint32_t>(b) << 16) | (static_cast<uint32_t>(g) << 8) | r);
+    }
+  }
+}
+
+uint8_t *address(JNIEnv *env, jobject buffer) {
+  return static_cast<uint8_t *>(env->GetDirectBufferAddress(buffer));
+}
+
+}  // namespace
+
+extern "C" JNIEXPORT void JNICALL
+Java_flir_android_FlirNative_upscaleBilinear(JNIEnv *env, jclass, jobject in, jint sw, jint sh, jobject out, jint dw,
+                                             jint dh, jintArray indexX, jintArray weightX, jintArray indexY,
+                                             jintArray weightY, jobject tmp) {
+  uint8_t *src = address(env, in);
+  uint8_t *dst = address(env, out);
+  uint8_t *scratch = address(env, tmp);
+  if (src == nullptr || dst == nullptr || scratch == nullptr) return;
+  CriticalInts ix(env, indexX), wx(env, weightX), iy(env, indexY), wy(env, weightY);
+  bilinear(src, sw, sh, dst, dw, dh, ix.get(), wx.get(), iy.get(), wy.get(), scratch);
+}
+
+extern "C" JNIEXPORT void JNICALL
+Java_flir_android_FlirNative_upscaleBicubic(JNIEnv *env, jclass, jobject in, jint sw, jint sh, jobject out, jint dw,
+                                            jint dh, jintArray indexX, jintArray weightX, jintArray indexY,
+                                            jintArray weightY, jobject tmp) {
+  uint8_t *src = address(env, in);
+  uint8_t *dst = address(env, out);
+  uint8_t *scratch = address(env, tmp);
+  if (src == nullptr || dst == nullptr || scratch == nullptr) return;
+  CriticalInts ix(env, indexX), wx(env, weightX), iy(env, indexY), wy(env, weightY);
+  bicubic(src, sw, sh, dst, dw, dh, ix.get(), wx.get(), iy.get(), wy.get(), scratch);
+}
+
+extern "C" JNIEXPORT void JNICALL
+Java_flir_android_FlirNative_upscaleJointBilateral(JNIEnv *env, jclass, jobject in, jint sw, jobject out, jint dw,
+                                                   jint dh, jintArray indexX, jintArray weightX, jintArray indexY,
+                                                   jintArray weightY, jintArray guideHigh, jintArray guideLow,
+                                                   jintArray rangeWeights) {
+  uint8_t *src = address(env, in);
+  uint8_t *dst = address(env, out);
+  if (src == nullptr || dst == nullptr) return;
+  CriticalInts ix(env, indexX), wx(env, weightX), iy(env, indexY), wy(env, weightY);
+  CriticalInts high(env, guideHigh), low(env, guideLow), range(env, rangeWeights);
+  jointBilateral(src, sw, dst, dw, dh, ix.get(), wx.get(), iy.get(), wy.get(), high.get(), low.get(), range.get());
+}
+
+extern "C" JNIEXPORT void JNICALL
+Java_flir_android_FlirNative_fusionDownsample(JNIEnv *env, jclass, jobject photo, jint tw, jint th,
+                                              jintArray sampleX0, jintArray sampleX1, jintArray sampleY0,
+                                              jintArray sampleY1, jintArray photoSmall, jintArray luma) {
+  uint8_t *src = address(env, photo);
+  if (src == nullptr) return;
+  CriticalInts x0(env, sampleX0), x1(env, sampleX1), y0(env, sampleY0), y1(env, sampleY1);
+  CriticalInts small(env, photoSmall), l(env, luma);
+  fusionDownsample(src, tw, th, x0.get(), x1.get(), y0.get(), y1.get(), reinterpret_cast<uint8_t *>(small.get()),
+                   l.get());
+}
+
+extern "C" JNIEXPORT void JNICALL
+Java_flir_android_FlirNative_fusionBlend(JNIEnv *env, jclass, jobject thermal, jintArray photoSmall, jint count,
+                                         jint alpha256) {
+  uint8_t *dst = address(env, thermal);
+  if (dst == nullptr) return;
+  CriticalInts small(env, photoSmall);
+  fusionBlend(dst, reinterpret_cast<const uint8_t *>(small.get()), count, alpha256);
+}
+
+extern "C" JNIEXPORT void JNICALL
+Java_flir_android_FlirNative_fusionDetail(JNIEnv *env, jclass, jobject thermal, jintArray luma, jintArray rowSums,
+                                          jint tw, jint th, jint alpha256) {
+  uint8_t *dst = address(env, thermal);
+  if (dst == nullptr) return;
+  CriticalInts l(env, luma), sums(env, rowSums);
+  fusionDetail(dst, l.get(), sums.get(), tw, th, alpha256);
+}
@@ -0,0 +1,110 @@
+package flir.android;
+
+import android.graphics.Bitmap;
+
+import java.nio.ByteBuffer;
+import java.util.IdentityHashMap;
+import java.util.LinkedHashMap;
+import java.util.Map;
+import java.util.concurrent.atomic.AtomicLong;
+
+/**
+ * Fixed-size rotation of reusable ARGB_8888 bitmaps per frame size (thermal irSize, visual
+ * visualSize). A bitmap handed out by {@link #fill} stays untouched for the next
+ * {@code depth - 1} frames of the same size, after which it is overwritten unless it is held.
+ * Code that keeps a bitmap beyond that (the latest frame, benchmarks) calls {@link #hold} and
+ * {@link #release}; a held bitmap is skipped and, when the whole rotation is held, replaced by a
+ * fresh one so it leaves the pool. Only the sizes of the current frames are kept: when zoom or
+ * upscaling change an output size, the rotation of the least recently used size is dropped (not
+ * recycled, it may still be on screen).
+ */
+public final class BitmapPool {
+
+    private static final class Rotation {
+        final Bitmap[] bitmaps;
+        int next;
+
+        Rotation(int depth) {
+            bitmaps = new Bitmap[depth];
+        }
+    }
+
+    // A frame yields at most two bitmaps: the thermal output and the visual photo
+    private static final int MAX_SIZES = 2;
+
+    private final int depth;
+    private final Map<Long, Rotation> rotations = new LinkedHashMap<Long, Rotation>(4, 0.75f, true) {
+        @Override
+        protected boolean removeEldestEntry(Map.Entry<Long, Rotation> eldest) {
+            return size() > MAX_SIZES;
+        }
+    };
+    private final Map<Bitmap, Integer> holds = new IdentityHashMap<>();
+    private final AtomicLong allocations = new AtomicLong();
+    private final AtomicLong reuses = new AtomicLong();
+
+    public BitmapPool(int depth) {
+        this.depth = Math.max(2, depth);
+    }
+
+    /** Copies RGBA_8888 pixels into the next pooled bitmap of the given size. */
+    public synchronized Bitmap fill(ByteBuffer pixels, int width, int height) {
+        long key = ((long) width << 32) | (height & 0xffffffffL);
+        Rotation rotation = rotations.get(key);
+        if (rotation == null) {
+            rotation = new Rotation(depth);
+            rotations.put(key, rotation);
+        }
+        // Skip held bitmaps; when every one is held, the slot gets a fresh bitmap below
+        int index = rotation.next;
+        for (int i = 0; i < depth; i++) {
+            int candidate = (rotation.next + i) % depth;
+            if (!holds.containsKey(rotation.bitmaps[candidate])) {
+                index = candidate;
+                break;
+            }
+        }
+        rotation.next = (index + 1) % depth;
+        Bitmap bitmap = rotation.bitmaps[index];
+        if (bitmap == null || bitmap.isRecycled() || holds.containsKey(bitmap)) {
+            bitmap = Bitmap.createBitmap(width, height, Bitmap.Config.ARGB_8888);
+            rotation.bitmaps[index] = bitmap;
+            allocations.incrementAndGet();
+        } else {
+            reuses.incrementAndGet();
+        }
+        pixels.rewind();
+        bitmap.copyPixelsFromBuffer(pixels);
+        pixels.rewind();
+        return bitmap;
+    }
+
+    /** Keeps a bitmap from being overwritten until the matching {@link #release}. */
+    public synchronized void hold(Bitmap bitmap) {
+        Integer count = holds.get(bitmap);
+        holds.put(bitmap, count == null ? 1 : count + 1);
+    }
+
+    public synchronized void release(Bitmap bitmap) {
+        Integer count = holds.get(bitmap);
+        if (count == null) return;
+        if (count <= 1) {
+            holds.remove(bitmap);
+        } else {
+            holds.put(bitmap, count - 1);
+        }
+    }
+
+    /** Drops all pooled bitmaps, e.g. when the stream stops or changes resolution. */
+    public synchronized void clear() {
+        rotations.clear();
+    }
+
+    public long getAllocations() {
+        return allocations.get();
+    }
+
+    public long getReuses() {
+        return reuses.get();
+    }
+}
@@ -3,8 +3,11 @@ package flir.android;
 import android.graphics.Bitmap;
 import android.util.Log;
 
-import com.flir.thermalsdk.androidsdk.image.BitmapAndroid;
+import com.flir.thermalsdk.image.Palette;
+import com.flir.thermalsdk.image.PaletteManager;
 import com.flir.thermalsdk.image.ThermalImage;
+import com.flir.thermalsdk.image.ThermalParameters;
+import com.flir.thermalsdk.image.ThermalValue;
 import com.flir.thermalsdk.live.Camera;
 import com.flir.thermalsdk.live.CommunicationInterface;
 import com.flir.thermalsdk.live.ConnectParameters;
@@ -15,9 +18,16 @@ import com.flir.thermalsdk.live.discovery.DiscoveryFactory;
 import com.flir.thermalsdk.live.streaming.Stream;
 import com.flir.thermalsdk.live.streaming.ThermalStreamer;
 
+import org.json.JSONObject;
+
+import java.io.File;
 import java.io.IOException;
+import java.util.ArrayList;
 import java.util.LinkedList;
+import java.util.List;
 import java.util.Objects;
+import java.util.concurrent.atomic.AtomicReference;
+import java.util.function.Function;
 
 public class CameraHandler {
     
@@ -34,10 +44,34 @@ public class CameraHandler {
 
     private Camera camera;
 
-    private Stream connectedStream;
-    private ThermalStreamer streamer;
-    // Cache the latest ThermalImage delivered by the streamer
-    private ThermalImage latestThermalImage;
+    // Read by snapshots without the monitor
+    private volatile Stream connectedStream;
+    private volatile ThermalStreamer streamer;
+    // Celsius plane copied once per streamed frame; queries read it without locking
+    private final RadiometricBuffer radiometricBuffer = new RadiometricBuffer(3);
+    private final FrameRing frameRing = new FrameRing(3);
+    // Listener bitmaps are recycled after three frames of their size unless held through the pool
+    private final BitmapPool bitmapPool = new BitmapPool(4);
+    private final FrameFusion fusion = new FrameFusion();
+    private final FrameUpscaler upscaler = new FrameUpscaler();
+    private final FrameZoom zoom = new FrameZoom();
+    private final ScaleBar scaleBar = new ScaleBar();
+    private final ColorTemperatureIndex.Tracker colorIndex = new ColorTemperatureIndex.Tracker();
+    // Palette selected from JS; the streaming callback applies it and the streamer renders it from
+    // the next frame on
+    private final AtomicReference<Palette> requestedPalette = new AtomicReference<>();
+    // Streaming callback only: the streamer renders the scale image while this is set
+    private boolean scaleRendering;
+    private FrameWorker frameWorker;
+    // Raw slot dump for replay; a replay feeds the ring in place of the streaming callback
+    private final FrameDump dump = new FrameDump();
+    private FrameReplay replay;
+    private final ThermalSnapshot snapshot = new ThermalSnapshot();
+    // Recording and dump metadata, rebuilt on the first frame of a stream and after a request;
+    // a replay sets it from the dump
+    private volatile boolean metadataRequested;
+    private volatile String streamMetadata;
+    private String cameraName = "N/A";
 
     public CameraHandler() {
         Log.d(TAG, "CameraHandler constr");
@@ -61,6 +95,7 @@ public class CameraHandler {
 
     public synchronized void disconnect() {
         Log.d(TAG, "disconnect");
+        stopReplay();
         if (camera == null) {
             return;
         }
@@ -71,8 +106,16 @@ public class CameraHandler {
         if (connectedStream.isStreaming()) {
             connectedStream.stop();
         }
+        if (frameWorker != null) {
+            frameWorker.stop();
+            frameWorker = null;
+        }
+        bitmapPool.clear();
         camera.disconnect();
         camera = null;
+        radiometricBuffer.clear();
+        scaleBar.clear();
+        colorIndex.clear();
     }
 
     public synchronized void startStream(StreamDataListener listener) {
@@ -81,71 +124,325 @@ public class CameraHandler {
             Log.e(TAG, "startStream, failed, camera was null or not connected");
             return;
         }
-        connectedStream = camera.getStreams().get(0);
-        if (connectedStream.isThermal()) {
+        cameraName = getDeviceInfo();
+        connectedStream = null;
+        for (Stream stream : camera.getStreams()) {
+            if (stream.isThermal()) {
+                connectedStream = stream;
+                break;
+            }
+        }
+        if (connectedStream != null) {
             streamer = new ThermalStreamer(connectedStream);
+            // The scale image is only rendered for the frame after a palette or span change
+            streamer.setRenderScale(false);
+            scaleRendering = false;
         } else {
             Log.e(TAG, "startStream, failed, no thermal stream available for the camera");
             return;
         }
+        // The streaming callback only copies the frame into a pre-allocated ring slot;
+        // everything downstream runs on the frame worker thread
+        stopReplay();
+        requestStreamMetadata();
+        if (frameWorker != null) frameWorker.stop();
+        frameWorker = new FrameWorker(frameRing, bitmapPool, dump, fusion, upscaler, zoom, scaleBar, colorIndex,
+                streamDataListener);
+        frameWorker.start();
         connectedStream.start(
                 unused -> {
-                    streamer.update();
-                    final Bitmap[] dcBitmap = new Bitmap[1];
-                    streamer.withThermalImage(thermalImage -> {
-                        try {
-                            // Cache the latest ThermalImage for sampling
-                            latestThermalImage = thermalImage;
-                            if (thermalImage.getFusion() != null && thermalImage.getFusion().getPhoto() != null) {
-                                dcBitmap[0] = BitmapAndroid.createBitmap(thermalImage.getFusion().getPhoto()).getBitMap();
+                    long arrivalNanos = System.nanoTime();
+                    // A snapshot saving the streamer image drops frames here rather than making them wait
+                    synchronized (snapshot.imageLock()) {
+                        if (snapshot.skipFrame()) return;
+                        streamer.update();
+                        streamer.withThermalImage(thermalImage -> {
+                            Palette palette = requestedPalette.getAndSet(null);
+                            if (palette != null) thermalImage.setPalette(palette);
+                            FrameRing.Slot slot = frameRing.beginWrite();
+                            if (slot == null) return;
+                            try {
+                                RadiometricFrame radiometric = null;
+                                try {
+                                    radiometric = radiometricBuffer.capture(thermalImage);
+                                } catch (Exception e) {
+                                    Log.e(TAG, "radiometric capture error", e);
+                                }
+                                slot.hasRadiometric = radiometric != null;
+                                if (radiometric != null) slot.radiometric.copyFrom(radiometric);
+
+                                if (thermalImage.getFusion() != null && thermalImage.getFusion().getPhoto() != null) {
+                                    slot.visual.copyFrom(thermalImage.getFusion().getPhoto());
+                                } else {
+                                    slot.visual.clear();
+                                }
+                                // streamer.getImage() holds the colorized RGBA pixels for this frame
+                                slot.thermal.copyFrom(streamer.getImage());
+                                slot.timestampNanos = arrivalNanos;
+                                if (metadataRequested) {
+                                    streamMetadata = describeStream(thermalImage);
+                                    metadataRequested = false;
+                                    dump.setMetadata(streamMetadata);
+                                }
+                                frameRing.endWrite(slot);
+                                updateScaleBar(thermalImage);
+                            } catch (Exception e) {
+                                frameRing.abortWrite(slot);
+                                Log.e(TAG, "thermal frame copy error", e);
                             }
-                            // The streamer.getImage() returns the ImageBuffer expected by BitmapAndroid
-                            final Bitmap thermalPixels = BitmapAndroid.createBitmap(streamer.getImage()).getBitMap();
-                            if (streamDataListener != null) streamDataListener.images(thermalPixels, dcBitmap[0]);
-                        } catch (Exception e) {
-                            Log.e(TAG, "thermal bitmap creation error", e);
-                        }
-                    });
+                        });
+                    }
                 },
                 error -> Log.e(TAG, "Streaming error: " + error));
     }
 
-    public synchronized Double getTemperatureAt(int x, int y) {
+    /**
+     * Plays a frame dump through the pipeline as a virtual camera. {@code speed} scales the
+     * recorded frame spacing; {@link FrameReplay#FAST} runs as fast as the worker keeps up.
+     * Throws IllegalStateException while the live stream is running.
+     */
+    public synchronized void startReplay(File file, float speed, boolean loop, StreamDataListener listener,
+                                         FrameReplay.Listener replayListener) {
+        if (connectedStream != null && connectedStream.isStreaming()) {
+            throw new IllegalStateException("Camera is streaming");
+        }
+        stopReplay();
+        this.streamDataListener = listener;
+        if (frameWorker != null) frameWorker.stop();
+        frameWorker = new FrameWorker(frameRing, bitmapPool, dump, fusion, upscaler, zoom, scaleBar, colorIndex,
+                streamDataListener);
+        frameWorker.start();
+        streamMetadata = null;
+        metadataRequested = false;
+        replay = new FrameReplay(file, speed, loop, frameRing, radiometricBuffer, new FrameReplay.Listener() {
+            @Override
+            public void finished(FrameReplay replay, Exception error) {
+                if (replayListener != null) replayListener.finished(replay, error);
+            }
+
+            @Override
+            public void metadata(String metadataJson) {
+                // Recordings and history captures of a replay carry the metadata of the dumped stream
+                streamMetadata = metadataJson != null ? metadataJson : describeReplay(file);
+                dump.setMetadata(streamMetadata);
+            }
+        });
+        replay.start();
+    }
+
+    public synchronized void stopReplay() {
+        if (replay == null) return;
+        replay.stop();
+        replay = null;
+        if (frameWorker != null) {
+            frameWorker.stop();
+            frameWorker = null;
+        }
+        radiometricBuffer.clear();
+    }
+
+    /** The running or last finished replay, or null. */
+    public synchronized FrameReplay getReplay() {
+        return replay;
+    }
+
+    /**
+     * Pins the current ThermalImage and saves it with {@code saveAs} on the snapshot thread.
+     * Not synchronized: the monitor is never held while a snapshot is requested or saved.
+     * Throws IllegalStateException when not streaming or while a snapshot is in progress.
+     */
+    public void captureSnapshot(File file, boolean visual, boolean overlay, ThermalSnapshot.Listener listener) {
+        ThermalStreamer current = streamer;
+        Stream stream = connectedStream;
+        if (current == null || stream == null || !stream.isStreaming()) {
+            throw new IllegalStateException("Not streaming");
+        }
+        snapshot.capture(current, file, visual, overlay, listener);
+    }
+
+    public ThermalSnapshot getSnapshot() {
+        return snapshot;
+    }
+
+    public FrameDump getDump() {
+        return dump;
+    }
+
+    /** Names of the SDK's built-in palettes. */
+    public static List<String> getAvailablePalettes() {
+        List<String> names = new ArrayList<>();
+        for (Palette palette : PaletteManager.getDefaultPalettes()) names.add(palette.name);
+        return names;
+    }
+
+    /** Selects a built-in palette by name, ignoring case; false when there is none. */
+    public boolean setPalette(String name) {
+        for (Palette palette : PaletteManager.getDefaultPalettes()) {
+            if (palette.name.equalsIgnoreCase(name)) {
+                requestedPalette.set(palette);
+                return true;
+            }
+        }
+        return false;
+    }
+
+    private void setScaleRendering(boolean render) {
+        streamer.setRenderScale(render);
+        scaleRendering = render;
+    }
+
+    // Scale range is compared every frame; the scale image is copied only when the legend changes
+    private void updateScaleBar(ThermalImage thermalImage) {
         try {
-            if (streamer == null) return null;
-            ThermalImage img = latestThermalImage;
-            if (img == null) return null;
-
-            java.lang.reflect.Method[] methods = img.getClass().getMethods();
-            for (java.lang.reflect.Method m : methods) {
-                String name = m.getName().toLowerCase();
-                Class<?>[] params = m.getParameterTypes();
-
-                if ((name.contains("get") || name.contains("value") || name.contains("temperature")) && params.length == 2
-                        && (params[0] == int.class || params[0] == Integer.class || params[0] == double.class || params[0] == float.class)
-                        && (params[1] == int.class || params[1] == Integer.class || params[1] == double.class || params[1] == float.class)) {
-                    try {
-                        Object res = null;
-                        if (params[0] == int.class && params[1] == int.class) {
-                            res = m.invoke(img, x, y);
-                        } else if (params[0] == double.class && params[1] == double.class) {
-                            res = m.invoke(img, (double) x, (double) y);
-                        } else if (params[0] == float.class && params[1] == float.class) {
-                            res = m.invoke(img, (float) x, (float) y);
-                        } else {
-                            res = m.invoke(img, Integer.valueOf(x), Integer.valueOf(y));
-                        }
-                        if (res instanceof Number) {
-                            return ((Number) res).doubleValue();
-                        }
-                    } catch (Exception e) {
-                    }
-                }
+            var range = streamer.getScaleRange();
+            ThermalValue low = range.min;
+            ThermalValue high = range.max;
+            String palette = thermalImage.getPalette() != null ? thermalImage.getPalette().name : "";
+            float min = (float) low.asCelsius().value;
+            float max = (float) high.asCelsius().value;
+            if (!scaleBar.isStale(palette, min, max)) {
+                if (scaleRendering) setScaleRendering(false);
+            } else if (scaleRendering) {
+                // Rendered by this frame's update(), so it matches min/max
+                scaleBar.update(palette, min, max, streamer.getScaleImage());
+                setScaleRendering(false);
+            } else {
+                // Takes effect from the next update()
+                setScaleRendering(true);
             }
         } catch (Exception e) {
-            Log.e(TAG, "getTemperatureAt error", e);
+            Log.e(TAG, "scale bar error", e);
         }
-        return null;
+    }
+
+    /**
+     * Drops the cached metadata; {@link #getStreamMetadata} is null until the next frame. A
+     * replay keeps the metadata of its dump, which no frame would rebuild.
+     */
+    public synchronized void requestStreamMetadata() {
+        if (replay != null && replay.isRunning()) return;
+        streamMetadata = null;
+        metadataRequested = true;
+    }
+
+    /** JSON with the camera information and thermal parameters, or null while a request is pending. */
+    public String getStreamMetadata() {
+        return streamMetadata;
+    }
+
+    private String describeStream(ThermalImage thermalImage) {
+        JSONObject json = new JSONObject();
+        try {
+            JSONObject camera = new JSONObject();
+            camera.put("displayName", cameraName);
+            camera.put("width", thermalImage.getWidth());
+            camera.put("height", thermalImage.getHeight());
+            json.put("camera", camera);
+
+            JSONObject thermal = new JSONObject();
+            ThermalParameters params = thermalImage.getImageParameters();
+            if (params != null) {
+                thermal.put("emissivity", params.getEmissivity());
+                thermal.put("objectDistance", params.getObjectDistance());
+                thermal.put("reflectedTemperature", params.getReflectedTemperature().asCelsius().value);
+                thermal.put("atmosphericTemperature", params.getAtmosphericTemperature().asCelsius().value);
+                thermal.put("relativeHumidity", params.getRelativeHumidity());
+                thermal.put("transmission", params.getTransmission());
+            }
+            json.put("thermalParameters", thermal);
+        } catch (Exception e) {
+            Log.e(TAG, "stream metadata error", e);
+        }
+        return json.toString();
+    }
+
+    // Dumps without metadata (version 1) only tell where the frames came from
+    private static String describeReplay(File file) {
+        JSONObject json = new JSONObject();
+        try {
+            JSONObject camera = new JSONObject();
+            camera.put("displayName", "Replay " + file.getName());
+            json.put("camera", camera);
+            json.put("thermalParameters", new JSONObject());
+        } catch (Exception e) {
+            Log.e(TAG, "replay metadata error", e);
+        }
+        return json.toString();
+    }
+
+    /** Queue depth and frame counters of the acquisition-to-worker handoff. */
+    public int getQueueDepth() {
+        return frameRing.depth();
+    }
+
+    public long getFramesAcquired() {
+        return frameRing.getPublished();
+    }
+
+    public long getFramesOverwritten() {
+        return frameRing.getOverwritten();
+    }
+
+    /** Per-frame allocation counters; both stop increasing once streaming is in steady state. */
+    public long getBitmapAllocations() {
+        return bitmapPool.getAllocations();
+    }
+
+    /** Pool the listener bitmaps come from; hold a bitmap there to keep it past the callback. */
+    public BitmapPool getBitmapPool() {
+        return bitmapPool;
+    }
+
+    public long getBufferAllocations() {
+        return FrameRing.getBufferAllocations();
+    }
+
+    /** Thermal/photo fusion stage run by the frame worker; configuration persists across streams. */
+    public FrameFusion getFusion() {
+        return fusion;
+    }
+
+    public FrameUpscaler getUpscaler() {
+        return upscaler;
+    }
+
+    public FrameZoom getZoom() {
+        return zoom;
+    }
+
+    public ScaleBar getScaleBar() {
+        return scaleBar;
+    }
+
+    /** Inverse palette lookup, rebuilt by the frame worker when the palette or span changes. */
+    public ColorTemperatureIndex.Tracker getColorIndex() {
+        return colorIndex;
+    }
+
+    public Double getTemperatureAt(int x, int y) {
+        return radiometricBuffer.read(frame -> frame.contains(x, y) ? (double) frame.valueAt(x, y) : null);
+    }
+
+    /** Temperatures at interleaved {@code [x0, y0, x1, y1, ...]} points, NaN outside the frame. */
+    public float[] getTemperaturesAt(int[] points) {
+        return radiometricBuffer.read(frame -> frame.valuesAt(points));
+    }
+
+    /** Row-major temperatures of a rectangle clipped to the frame. */
+    public float[] getTemperaturesIn(int x, int y, int width, int height) {
+        return radiometricBuffer.read(frame -> frame.valuesIn(x, y, width, height));
+    }
+
+    public float[] getLineProfile(float x0, float y0, float x1, float y1, int samples) {
+        return radiometricBuffer.read(frame -> frame.lineProfile(x0, y0, x1, y1, samples));
+    }
+
+    /**
+     * Runs {@code reader} on the latest radiometric frame, which is not refilled until it
+     * returns; null before the first frame. Do not keep the frame past the call.
+     */
+    public <T> T readRadiometricFrame(Function<RadiometricFrame, T> reader) {
+        return radiometricBuffer.read(reader);
     }
 
     public void add(Identity identity) {
@@ -0,0 +1,152 @@
+package flir.android;
+
+import java.nio.ByteBuffer;
+import java.util.Arrays;
+
+/**
+ * Inverse color-to-temperature lookup for colorized frames.
+ *
+ * Built from a colorized RGBA frame and the radiometric plane it was rendered from, so it
+ * reflects whatever palette and scale the SDK actually applied. The frame must be the plain
+ * colorized thermal image: fused, zoomed or upscaled pixels mix in colors the palette never
+ * produces. Colors are quantized to a
+ * 32x32x32 grid; each cell holds the mean temperature of the pixels that fell into it. Empty
+ * cells next to populated ones are filled by a few dilation passes, cells further away stay
+ * NaN (the color does not occur in the palette). Lookups are a single array read.
+ */
+public final class ColorTemperatureIndex {
+
+    private static final int BITS = 5;
+    private static final int SIZE = 1 << BITS;
+    private static final int SHIFT = 8 - BITS;
+    private static final int FILL_PASSES = 3;
+
+    /**
+     * Keeps the index of the current palette and span. Updated on the frame worker, with the
+     * slot's thermal plane before fusion; read from any thread.
+     */
+    public static final class Tracker {
+        private volatile ColorTemperatureIndex index;
+        // Frame worker only
+        private long builtVersion = -1;
+        private int builtWidth;
+        private int builtHeight;
+
+        /** Rebuilds the index when {@code scaleVersion} (the legend version) or the frame size changed. */
+        void update(FrameRing.Plane thermal, RadiometricFrame radiometric, long scaleVersion, long sequence) {
+            if (radiometric == null || thermal.getWidth() <= 0) return;
+            if (index != null && scaleVersion == builtVersion
+                    && thermal.getWidth() == builtWidth && thermal.getHeight() == builtHeight) return;
+            index = build(thermal.getPixels(), thermal.getWidth(), thermal.getHeight(),
+                    radiometric.celsius, radiometric.width, radiometric.height, sequence);
+            builtVersion = scaleVersion;
+            builtWidth = thermal.getWidth();
+            builtHeight = thermal.getHeight();
+        }
+
+        /** Index for the palette and span of the latest frames, or null before the first frame. */
+        public ColorTemperatureIndex get() {
+            return index;
+        }
+
+        /** Drops the index; the frame worker must be stopped. */
+        void clear() {
+            index = null;
+            builtVersion = -1;
+        }
+    }
+
+    private final float[] cells = new float[SIZE * SIZE * SIZE];
+    private final long sequence;
+
+    private ColorTemperatureIndex(long sequence) {
+        this.sequence = sequence;
+    }
+
+    public long getSequence() {
+        return sequence;
+    }
+
+    /**
+     * @param rgba     RGBA_8888 pixels, {@code width * height * 4} bytes from position 0
+     * @param celsius  radiometric plane; may have a different resolution than the image
+     */
+    public static ColorTemperatureIndex build(ByteBuffer rgba, int width, int height,
+                                              float[] celsius, int radWidth, int radHeight, long sequence) {
+        ColorTemperatureIndex index = new ColorTemperatureIndex(sequence);
+        int n = index.cells.length;
+        double[] sums = new double[n];
+        int[] counts = new int[n];
+
+        for (int y = 0; y < height; y++) {
+            int row = (int) ((long) y * radHeight / height) * radWidth;
+            int src = y * width * 4;
+            for (int x = 0; x < width; x++, src += 4) {
+                float t = celsius[row + (int) ((long) x * radWidth / width)];
+                if (t != t) continue;
+                int cell = cell(rgba.get(src) & 0xFF, rgba.get(src + 1) & 0xFF, rgba.get(src + 2) & 0xFF);
+                sums[cell] += t;
+                counts[cell]++;
+            }
+        }
+
+        float[] cells = index.cells;
+        for (int i = 0; i < n; i++) {
+            cells[i] = counts[i] > 0 ? (float) (sums[i] / counts[i]) : Float.NaN;
+        }
+        for (int pass = 0; pass < FILL_PASSES; pass++) {
+            if (!index.dilate()) break;
+        }
+        return index;
+    }
+
+    /** Temperature for an ARGB color int, NaN when the color is not part of the palette. */
+    public float temperatureOf(int argb) {
+        return cells[cell((argb >> 16) & 0xFF, (argb >> 8) & 0xFF, argb & 0xFF)];
+    }
+
+    /** Converts ARGB pixels (as returned by {@code Bitmap.getPixels}) in one pass. */
+    public float[] temperaturesOf(int[] argb) {
+        float[] out = new float[argb.length];
+        for (int i = 0; i < argb.length; i++) {
+            int c = argb[i];
+            out[i] = cells[cell((c >> 16) & 0xFF, (c >> 8) & 0xFF, c & 0xFF)];
+        }
+        return out;
+    }
+
+    private static int cell(int r, int g, int b) {
+        return ((r >> SHIFT) << (2 * BITS)) | ((g >> SHIFT) << BITS) | (b >> SHIFT);
+    }
+
+    // Fills empty cells with the mean of their populated 6-neighbours; returns false when nothing changed
+    private boolean dilate() {
+        float[] source = Arrays.copyOf(cells, cells.length);
+        boolean changed = false;
+        for (int r = 0; r < SIZE; r++) {
+            for (int g = 0; g < SIZE; g++) {
+                for (int b = 0; b < SIZE; b++) {
+                    int i = (r << (2 * BITS)) | (g << BITS) | b;
+                    if (source[i] == source[i]) continue;
+                    float sum = 0;
+                    int count = 0;
+                    for (int d = 0; d < 6; d++) {
+                        int nr = r + (d == 0 ? 1 : d == 1 ? -1 : 0);
+                        int ng = g + (d == 2 ? 1 : d == 3 ? -1 : 0);
+                        int nb = b + (d == 4 ? 1 : d == 5 ? -1 : 0);
+                        if (nr < 0 || nr >= SIZE || ng < 0 || ng >= SIZE || nb < 0 || nb >= SIZE) continue;
+                        float v = source[(nr << (2 * BITS)) | (ng << BITS) | nb];
+                        if (v != v) continue;
+                        sum += v;
+                        count++;
+                    }
+                    if (count > 0) {
+                        cells[i] = sum / count;
+                        changed = true;
+                    }
+                }
+            }
+        }
+        return changed;
+    }
+}
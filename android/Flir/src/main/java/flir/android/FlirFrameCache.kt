@@ -1,6 +1,175 @@
 package flir.android
 
+import android.graphics.Bitmap
+import android.os.Build
+import java.io.File
+import java.io.FileOutputStream
+import java.io.RandomAccessFile
+import java.nio.ByteBuffer
+import java.nio.ByteOrder
+import java.nio.MappedByteBuffer
+import java.lang.invoke.VarHandle
+import java.nio.channels.FileChannel
+
+/**
+ * Latest frame kept in a memory-mapped file with a fixed little-endian layout:
+ *
+ *   0  magic "FLRF"        4  version
+ *   8  sequence (seqlock, odd while a write is in progress)
+ *   16 timestamp ns        24 width   28 height   32 format (1 = RGBA_8888)
+ *   36 radiometric width   40 radiometric height
+ *   44 RGBA offset         48 Celsius float32 plane offset (0 if absent)
+ *   64 pixel data...
+ *
+ * In-process readers go through [read], which takes the writer's monitor. Readers mapping
+ * [cachePath] from native code or another process follow the seqlock: read the sequence with
+ * acquire semantics, copy the planes, fence and re-read it; a changed or odd value means the
+ * frame was torn and the read is retried. The writer fences the sequence stores on API 33+
+ * (VarHandle); older devices only guarantee torn-free frames to [read]. A PNG is only produced
+ * on request through [exportPng].
+ */
 object FlirFrameCache {
+    const val FILE_NAME = "flir_latest_frame.bin"
+    const val HEADER_SIZE = 64
+    const val FORMAT_RGBA_8888 = 1
+
+    private const val MAGIC = 0x46524C46 // "FLRF" little-endian
+    private const val VERSION = 1
+    private const val OFF_SEQUENCE = 8
+    private const val OFF_TIMESTAMP = 16
+    private const val OFF_WIDTH = 24
+    private const val OFF_HEIGHT = 28
+    private const val OFF_FORMAT = 32
+    private const val OFF_RAD_WIDTH = 36
+    private const val OFF_RAD_HEIGHT = 40
+    private const val OFF_RGBA = 44
+    private const val OFF_RADIOMETRIC = 48
+
     @JvmStatic
-    var latestFramePath: String? = null
+    var cachePath: String? = null
+        private set
+
+    private var file: RandomAccessFile? = null
+    private var mapped: MappedByteBuffer? = null
+    private var sequence = 0L
+
+    class Snapshot(
+        val sequence: Long,
+        val timestampNanos: Long,
+        val width: Int,
+        val height: Int,
+        val rgba: ByteBuffer,
+        val radiometricWidth: Int,
+        val radiometricHeight: Int,
+        val celsius: FloatArray?
+    )
+
+    @Synchronized
+    fun write(dir: File, bmp: Bitmap, radiometric: RadiometricFrame?, timestampNanos: Long) {
+        val rgbaBytes = bmp.width * bmp.height * 4
+        val radWidth = radiometric?.width ?: 0
+        val radHeight = radiometric?.height ?: 0
+        val radOffset = if (radiometric != null) HEADER_SIZE + rgbaBytes else 0
+        val total = HEADER_SIZE + rgbaBytes + radWidth * radHeight * 4
+        val buffer = ensureMapped(dir, total)
+
+        sequence++
+        buffer.putLong(OFF_SEQUENCE, sequence * 2 + 1)
+        // The odd marker must be visible before any payload store
+        if (Build.VERSION.SDK_INT >= Build.VERSION_CODES.TIRAMISU) VarHandle.storeStoreFence()
+
+        buffer.putLong(OFF_TIMESTAMP, timestampNanos)
+        buffer.putInt(OFF_WIDTH, bmp.width)
+        buffer.putInt(OFF_HEIGHT, bmp.height)
+        buffer.putInt(OFF_FORMAT, FORMAT_RGBA_8888)
+        buffer.putInt(OFF_RAD_WIDTH, radWidth)
+        buffer.putInt(OFF_RAD_HEIGHT, radHeight)
+        buffer.putInt(OFF_RGBA, HEADER_SIZE)
+        buffer.putInt(OFF_RADIOMETRIC, radOffset)
+        buffer.position(HEADER_SIZE)
+        bmp.copyPixelsToBuffer(buffer)
+        if (radiometric != null) {
+            buffer.position(radOffset)
+            buffer.asFloatBuffer().put(radiometric.plane, 0, radWidth * radHeight)
+        }
+        buffer.position(0)
+
+        // ...and every payload store before the even marker
+        if (Build.VERSION.SDK_INT >= Build.VERSION_CODES.TIRAMISU) VarHandle.releaseFence()
+        buffer.putLong(OFF_SEQUENCE, sequence * 2)
+    }
+
+    /** Sequence of the cached frame, 0 before the first one; cheap enough to poll. */
+    @Synchronized
+    fun sequence(): Long = sequence
+
+    /**
+     * Copy of the latest frame, or null if nothing has been cached yet. Serialized with [write],
+     * so the copy is never torn.
+     */
+    @Synchronized
+    fun read(): Snapshot? {
+        val buffer = mapped?.duplicate()?.order(ByteOrder.LITTLE_ENDIAN) ?: return null
+        val marker = buffer.getLong(OFF_SEQUENCE)
+        if (marker == 0L) return null
+        val width = buffer.getInt(OFF_WIDTH)
+        val height = buffer.getInt(OFF_HEIGHT)
+        val radWidth = buffer.getInt(OFF_RAD_WIDTH)
+        val radHeight = buffer.getInt(OFF_RAD_HEIGHT)
+        val radOffset = buffer.getInt(OFF_RADIOMETRIC)
+        val timestamp = buffer.getLong(OFF_TIMESTAMP)
+        val rgbaBytes = width * height * 4
+        if (HEADER_SIZE + rgbaBytes > buffer.capacity()) return null
+
+        val rgba = ByteBuffer.allocateDirect(rgbaBytes)
+        val src = buffer.duplicate()
+        src.position(HEADER_SIZE).limit(HEADER_SIZE + rgbaBytes)
+        rgba.put(src).flip()
+        var celsius: FloatArray? = null
+        if (radOffset != 0 && radOffset + radWidth * radHeight * 4 <= buffer.capacity()) {
+            celsius = FloatArray(radWidth * radHeight)
+            val planeSrc = buffer.duplicate().order(ByteOrder.LITTLE_ENDIAN)
+            planeSrc.position(radOffset)
+            planeSrc.asFloatBuffer().get(celsius)
+        }
+        return Snapshot(marker / 2, timestamp, width, height, rgba, radWidth, radHeight, celsius)
+    }
+
+    /** Encodes the cached frame as PNG on demand and returns its path. */
+    fun exportPng(dir: File): String? {
+        val snapshot = read() ?: return null
+        val bmp = Bitmap.createBitmap(snapshot.width, snapshot.height, Bitmap.Config.ARGB_8888)
+        bmp.copyPixelsFromBuffer(snapshot.rgba)
+        val outFile = File(dir, "flir_latest_frame.png")
+        FileOutputStream(outFile).use { bmp.compress(Bitmap.CompressFormat.PNG, 90, it) }
+        bmp.recycle()
+        return outFile.absolutePath
+    }
+
+    @Synchronized
+    fun close() {
+        try {
+            file?.close()
+        } catch (ignored: Exception) {}
+        file = null
+        mapped = null
+    }
+
+    private fun ensureMapped(dir: File, size: Int): MappedByteBuffer {
+        val current = mapped
+        if (current != null && current.capacity() >= size) return current
+        close()
+        val target = File(dir, FILE_NAME)
+        val raf = RandomAccessFile(target, "rw")
+        raf.setLength(size.toLong())
+        val buffer = raf.channel.map(FileChannel.MapMode.READ_WRITE, 0, size.toLong())
+        buffer.order(ByteOrder.LITTLE_ENDIAN)
+        buffer.putInt(0, MAGIC)
+        buffer.putInt(4, VERSION)
+        buffer.putLong(OFF_SEQUENCE, sequence * 2)
+        file = raf
+        mapped = buffer
+        cachePath = target.absolutePath
+        return buffer
+    }
 }
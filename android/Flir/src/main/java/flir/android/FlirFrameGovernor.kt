@@ -0,0 +1,152 @@
+package flir.android
+
+/**
+ * Decides which incoming frames are delivered to JS.
+ *
+ * The delivered rate starts at [maxFps] and backs off towards [minFps] when the per-frame
+ * encode/dispatch cost exceeds the frame budget or JS falls behind acknowledging frames,
+ * then climbs back while the pipeline keeps up. JS acknowledgement is optional: until the
+ * first [acknowledge] call only the native cost is taken into account. When acks stop
+ * arriving (reload, a throwing listener, backgrounding) the in-flight frames expire and
+ * pacing falls back to the interval alone until JS acknowledges again.
+ */
+object FlirFrameGovernor {
+    private const val MAX_IN_FLIGHT = 2
+    private const val EWMA_WEIGHT = 0.2
+    private const val BACKOFF = 1.25
+    private const val RECOVER = 0.95
+    // In-flight frames expire after this many average ack latencies, but never sooner than the floor
+    private const val ACK_TIMEOUT_FACTOR = 4.0
+    private const val ACK_TIMEOUT_MIN_MS = 500.0
+
+    var minFps = 1.0
+        private set
+    var maxFps = 3.0
+        private set
+    var frameBudgetMs = 0.0
+        private set
+
+    private var intervalNanos = fpsToNanos(maxFps)
+    private var lastDeliveredNanos = 0L
+    private var nextFrameId = 0L
+    private var lastAckedId = 0L
+    private var ackSeen = false
+    private val emitNanos = LongArray(8)
+
+    private var received = 0L
+    private var delivered = 0L
+    private var dropped = 0L
+    private var ackTimeouts = 0L
+    private var avgCostMs = 0.0
+    private var avgAckMs = 0.0
+
+    @Synchronized
+    fun setTargetFps(min: Double, max: Double) {
+        require(min > 0 && max >= min) { "Invalid fps range $min..$max" }
+        minFps = min
+        maxFps = max
+        intervalNanos = intervalNanos.coerceIn(fpsToNanos(maxFps), fpsToNanos(minFps))
+    }
+
+    /** Per-frame encode + dispatch budget in milliseconds; 0 derives it from the current rate. */
+    @Synchronized
+    fun setFrameBudget(ms: Double) {
+        require(ms >= 0) { "Invalid frame budget $ms" }
+        frameBudgetMs = ms
+    }
+
+    /**
+     * Called for every frame the camera delivers. Returns the id to attach to the emitted
+     * frame, or -1 when the frame should be dropped.
+     */
+    @Synchronized
+    fun admit(nowNanos: Long): Long {
+        received++
+        if (ackSeen && nextFrameId - lastAckedId >= MAX_IN_FLIGHT && ackExpired(nowNanos)) {
+            ackSeen = false
+            lastAckedId = nextFrameId
+            ackTimeouts++
+        }
+        val inFlight = if (ackSeen) nextFrameId - lastAckedId else 0L
+        if (nowNanos - lastDeliveredNanos < intervalNanos || inFlight >= MAX_IN_FLIGHT) {
+            dropped++
+            return -1
+        }
+        lastDeliveredNanos = nowNanos
+        nextFrameId++
+        emitNanos[(nextFrameId % emitNanos.size).toInt()] = nowNanos
+        return nextFrameId
+    }
+
+    // The oldest unacknowledged frame has waited longer than acks normally take
+    private fun ackExpired(nowNanos: Long): Boolean {
+        val oldest = lastAckedId + 1
+        if (nextFrameId - oldest >= emitNanos.size) return true
+        val waitedMs = (nowNanos - emitNanos[(oldest % emitNanos.size).toInt()]) / 1_000_000.0
+        return waitedMs > maxOf(ACK_TIMEOUT_MIN_MS, avgAckMs * ACK_TIMEOUT_FACTOR)
+    }
+
+    /** Reports how long encoding and dispatching an admitted frame took. */
+    @Synchronized
+    fun delivered(costNanos: Long) {
+        delivered++
+        avgCostMs = ewma(avgCostMs, costNanos / 1_000_000.0)
+        adapt()
+    }
+
+    /** JS consumer acknowledgement for a frame id received in a FlirFrame event. */
+    @Synchronized
+    fun acknowledge(frameId: Long, nowNanos: Long) {
+        if (frameId <= lastAckedId || frameId > nextFrameId) return
+        lastAckedId = frameId
+        ackSeen = true
+        if (nextFrameId - frameId < emitNanos.size) {
+            val sentAt = emitNanos[(frameId % emitNanos.size).toInt()]
+            avgAckMs = ewma(avgAckMs, (nowNanos - sentAt) / 1_000_000.0)
+        }
+    }
+
+    @Synchronized
+    fun stats(): Map<String, Any> {
+        return mapOf(
+            "framesReceived" to received,
+            "framesDelivered" to delivered,
+            "framesDropped" to dropped,
+            "ackTimeouts" to ackTimeouts,
+            "currentFps" to 1_000_000_000.0 / intervalNanos,
+            "minFps" to minFps,
+            "maxFps" to maxFps,
+            "avgCostMs" to avgCostMs,
+            "avgAckLatencyMs" to avgAckMs
+        )
+    }
+
+    @Synchronized
+    fun reset() {
+        intervalNanos = fpsToNanos(maxFps)
+        lastDeliveredNanos = 0
+        nextFrameId = 0
+        lastAckedId = 0
+        ackSeen = false
+        received = 0
+        delivered = 0
+        dropped = 0
+        ackTimeouts = 0
+        avgCostMs = 0.0
+        avgAckMs = 0.0
+    }
+
+    private fun adapt() {
+        val intervalMs = intervalNanos / 1_000_000.0
+        val budgetMs = if (frameBudgetMs > 0) frameBudgetMs else intervalMs * 0.5
+        val behind = avgCostMs > budgetMs || (ackSeen && avgAckMs > intervalMs)
+        val next = if (behind) intervalNanos * BACKOFF else intervalNanos * RECOVER
+        intervalNanos = next.toLong().coerceIn(fpsToNanos(maxFps), fpsToNanos(minFps))
+    }
+
+    private fun ewma(current: Double, sample: Double): Double {
+        return if (current == 0.0) sample else current + EWMA_WEIGHT * (sample - current)
+    }
+
+    private fun fpsToNanos(fps: Double): Long = (1_000_000_000.0 / fps).toLong()
+}
@@ -0,0 +1,36 @@
+package flir.android;
+
+import androidx.annotation.Keep;
+
+import java.nio.ByteBuffer;
+
+/**
+ * Installs the JSI bindings that expose the "rgba" frame ring to JS without copying:
+ * {@code global.__flirFrameSlot(slot)} returns an ArrayBuffer over the slot's direct buffer and
+ * {@code global.__flirFrameSequence(slot)} the sequence of the frame it holds (-1 while it is
+ * being written). A frame is intact when the sequence matches the FlirFrame event before and
+ * after reading it.
+ */
+public final class FlirFrameJsi {
+
+    private FlirFrameJsi() {}
+
+    /** Must run on the JS thread; the bindings are gone after a reload, so install again. */
+    public static synchronized boolean install(long runtimePointer) {
+        if (runtimePointer == 0 || !FlirNative.load()) return false;
+        return nativeInstall(runtimePointer);
+    }
+
+    private static native boolean nativeInstall(long runtimePointer);
+
+    // Called from native code
+    @Keep
+    static ByteBuffer slotBuffer(int slot) {
+        return FlirFrameTransport.INSTANCE.directSlot(slot);
+    }
+
+    @Keep
+    static long slotSequence(int slot) {
+        return FlirFrameTransport.INSTANCE.slotSequence(slot);
+    }
+}
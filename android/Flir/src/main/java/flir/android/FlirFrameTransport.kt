@@ -0,0 +1,183 @@
+package flir.android
+
+import android.graphics.Bitmap
+import android.util.Base64
+import java.io.ByteArrayOutputStream
+import java.nio.ByteBuffer
+import java.nio.ByteOrder
+
+/**
+ * Moves colorized frames from the native pipeline to JS.
+ *
+ * In "rgba" mode frames are copied into a small ring of direct ByteBuffers and only
+ * metadata (slot, sequence, size) goes over the bridge; JS reads the pixels through the
+ * ArrayBuffers [FlirFrameJsi] maps onto the ring. "png" mode keeps the original base64 data
+ * URI events for existing JS consumers.
+ */
+object FlirFrameTransport {
+    const val MODE_PNG = "png"
+    const val MODE_RGBA = "rgba"
+
+    private const val SLOT_COUNT = 3
+
+    @Volatile
+    var mode: String = MODE_PNG
+        private set
+
+    private val slots = arrayOfNulls<ByteBuffer>(SLOT_COUNT)
+    // Sequence of the frame held by each slot; -1 while it is being overwritten
+    private val slotSequences = LongArray(SLOT_COUNT) { -1L }
+    private var slotWidth = 0
+    private var slotHeight = 0
+    private var nextSlot = 0
+    private var sequence = 0L
+
+    // Per-frame encode cost, so both modes can be compared on the same device
+    private var encodedFrames = 0L
+    private var encodeNanosTotal = 0L
+    private var lastEncodeNanos = 0L
+
+    data class Frame(val slot: Int, val sequence: Long, val width: Int, val height: Int, val stride: Int)
+
+    fun setMode(newMode: String): Boolean {
+        if (newMode != MODE_PNG && newMode != MODE_RGBA) return false
+        if (newMode != mode) {
+            mode = newMode
+            resetStats()
+        }
+        return true
+    }
+
+    /**
+     * Copy the bitmap's RGBA pixels into the next ring slot. Slots are reallocated only when
+     * the frame size changes, so steady-state streaming does not allocate.
+     */
+    @Synchronized
+    fun write(bmp: Bitmap): Frame {
+        val start = System.nanoTime()
+        val width = bmp.width
+        val height = bmp.height
+        if (width != slotWidth || height != slotHeight) {
+            for (i in 0 until SLOT_COUNT) {
+                slots[i] = ByteBuffer.allocateDirect(width * height * 4).order(ByteOrder.nativeOrder())
+            }
+            slotWidth = width
+            slotHeight = height
+        }
+        val slot = nextSlot
+        nextSlot = (nextSlot + 1) % SLOT_COUNT
+        val buffer = slots[slot]!!
+        slotSequences[slot] = -1L
+        buffer.rewind()
+        bmp.copyPixelsToBuffer(buffer)
+        buffer.rewind()
+        sequence++
+        slotSequences[slot] = sequence
+        record(System.nanoTime() - start)
+        return Frame(slot, sequence, width, height, width * 4)
+    }
+
+    /**
+     * PNG-compress the bitmap once; callers reuse the same bytes for the cache file and the
+     * base64 event instead of compressing twice.
+     */
+    fun encodePng(bmp: Bitmap): ByteArray {
+        val start = System.nanoTime()
+        val baos = ByteArrayOutputStream()
+        bmp.compress(Bitmap.CompressFormat.PNG, 90, baos)
+        val bytes = baos.toByteArray()
+        synchronized(this) { record(System.nanoTime() - start) }
+        return bytes
+    }
+
+    /**
+     * Read-only view of a ring slot. The contents are overwritten [SLOT_COUNT] frames later,
+     * so consumers should compare the sequence from the event before and after reading.
+     */
+    @Synchronized
+    fun slotBuffer(slot: Int): ByteBuffer? {
+        if (slot < 0 || slot >= SLOT_COUNT) return null
+        return slots[slot]?.asReadOnlyBuffer()?.order(ByteOrder.nativeOrder())
+    }
+
+    /** The ring slot itself, for [FlirFrameJsi] to map into JS; null before the first frame. */
+    @Synchronized
+    fun directSlot(slot: Int): ByteBuffer? = if (slot < 0 || slot >= SLOT_COUNT) null else slots[slot]
+
+    /** Sequence of the frame in [slot], or -1 while it is being written. */
+    @Synchronized
+    fun slotSequence(slot: Int): Long = if (slot < 0 || slot >= SLOT_COUNT) -1L else slotSequences[slot]
+
+    @Synchronized
+    fun latestSequence(): Long = sequence
+
+    @Synchronized
+    fun stats(): Map<String, Any> {
+        return mapOf(
+            "mode" to mode,
+            "frames" to encodedFrames,
+            "lastEncodeMs" to lastEncodeNanos / 1_000_000.0,
+            "avgEncodeMs" to if (encodedFrames == 0L) 0.0 else encodeNanosTotal / encodedFrames / 1_000_000.0
+        )
+    }
+
+    /**
+     * Per-frame cost of each transport on one frame, measured back to back: "legacy" is the
+     * previous pipeline (PNG at 90 for the cache file, PNG at 70 for the event, base64), "png"
+     * the single-pass encode plus base64, "rgba" the ring copy. Runs on the caller's thread.
+     */
+    fun benchmark(bmp: Bitmap, iterations: Int): Map<String, Any> {
+        val frame = bmp.copy(Bitmap.Config.ARGB_8888, false)
+        val ring = ByteBuffer.allocateDirect(frame.byteCount).order(ByteOrder.nativeOrder())
+        try {
+            val legacy = timePerFrame(iterations) {
+                val cache = ByteArrayOutputStream()
+                frame.compress(Bitmap.CompressFormat.PNG, 90, cache)
+                val event = ByteArrayOutputStream()
+                frame.compress(Bitmap.CompressFormat.PNG, 70, event)
+                Base64.encodeToString(event.toByteArray(), Base64.NO_WRAP).length
+            }
+            val png = timePerFrame(iterations) {
+                val out = ByteArrayOutputStream()
+                frame.compress(Bitmap.CompressFormat.PNG, 90, out)
+                Base64.encodeToString(out.toByteArray(), Base64.NO_WRAP).length
+            }
+            val rgba = timePerFrame(iterations) {
+                ring.rewind()
+                frame.copyPixelsToBuffer(ring)
+                ring.position()
+            }
+            return mapOf(
+                "width" to frame.width,
+                "height" to frame.height,
+                "iterations" to iterations,
+                "legacyMs" to legacy,
+                "pngMs" to png,
+                "rgbaMs" to rgba,
+                "speedup" to if (rgba > 0) legacy / rgba else 0.0
+            )
+        } finally {
+            frame.recycle()
+        }
+    }
+
+    private inline fun timePerFrame(iterations: Int, block: () -> Int): Double {
+        block() // warm-up, not timed
+        val start = System.nanoTime()
+        for (i in 0 until iterations) block()
+        return (System.nanoTime() - start) / 1_000_000.0 / iterations
+    }
+
+    @Synchronized
+    fun resetStats() {
+        encodedFrames = 0
+        encodeNanosTotal = 0
+        lastEncodeNanos = 0
+    }
+
+    private fun record(nanos: Long) {
+        lastEncodeNanos = nanos
+        encodeNanosTotal += nanos
+        encodedFrames++
+    }
+}
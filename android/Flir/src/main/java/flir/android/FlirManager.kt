@@ -6,20 +6,16 @@ import android.graphics.BitmapFactory
 import android.graphics.Color
 import android.util.Base64
 import com.facebook.react.bridge.Arguments
+import com.facebook.react.bridge.ReactContext
 import com.facebook.react.bridge.WritableMap
 import com.facebook.react.modules.core.DeviceEventManagerModule
 import com.facebook.react.uimanager.ThemedReactContext
-import java.io.ByteArrayOutputStream
 import java.io.File
-import java.io.FileOutputStream
-import java.util.concurrent.atomic.AtomicLong
 
 object FlirManager {
     private val cameraHandler: CameraHandler = CameraHandler()
-    private val lastEmitMs = AtomicLong(0)
-    private val minEmitIntervalMs = 333L // ~3 fps
     private var discoveryStarted = false
-    private var reactContext: ThemedReactContext? = null
+    private var reactContext: ReactContext? = null
     
     // Emulator and device state tracking
     private var isEmulatorMode = false
@@ -27,6 +23,7 @@ object FlirManager {
     private var connectedIdentity: com.flir.thermalsdk.live.Identity? = null
     
     // GL texture callback support for native filters
+    // The bitmap is pooled: valid until the callback returns unless held with holdBitmap
     interface TextureUpdateCallback {
         fun onTextureUpdate(bitmap: Bitmap, textureUnit: Int)
     }
@@ -35,9 +32,13 @@ object FlirManager {
         fun onTemperatureData(temperature: Double, x: Int, y: Int)
     }
     
+    val regionStatistics = RegionStatistics()
+
     private var textureCallback: TextureUpdateCallback? = null
     private var temperatureCallback: TemperatureCallback? = null
+    // Held in the bitmap pool while published so the worker does not overwrite it
     private var latestBitmap: Bitmap? = null
+    private val latestLock = Any()
     
     fun setTextureCallback(callback: TextureUpdateCallback?) {
         textureCallback = callback
@@ -47,7 +48,22 @@ object FlirManager {
         temperatureCallback = callback
     }
     
-    fun getLatestBitmap(): Bitmap? = latestBitmap
+    /** Latest frame, held until the caller passes it to releaseBitmap. */
+    fun acquireLatestBitmap(): Bitmap? = synchronized(latestLock) {
+        latestBitmap?.also { cameraHandler.bitmapPool.hold(it) }
+    }
+
+    fun holdBitmap(bitmap: Bitmap) = cameraHandler.bitmapPool.hold(bitmap)
+
+    fun releaseBitmap(bitmap: Bitmap) = cameraHandler.bitmapPool.release(bitmap)
+
+    private fun publishLatestBitmap(bitmap: Bitmap?) {
+        synchronized(latestLock) {
+            bitmap?.let { cameraHandler.bitmapPool.hold(it) }
+            latestBitmap?.let { cameraHandler.bitmapPool.release(it) }
+            latestBitmap = bitmap
+        }
+    }
     
     fun getTemperatureAtPoint(x: Int, y: Int): Double? {
         return try {
@@ -123,11 +139,11 @@ object FlirManager {
                             
                             cameraHandler.startStream(object : CameraHandler.StreamDataListener {
                                 override fun images(dataHolder: FrameDataHolder) {
-                                    handleIncomingFrames(dataHolder.msxBitmap, dataHolder.dcBitmap, context)
+                                    handleIncomingFrames(dataHolder, context)
                                 }
 
                                 override fun images(msxBitmap: Bitmap?, dcBitmap: Bitmap?) {
-                                    handleIncomingFrames(msxBitmap, dcBitmap, context)
+                                    handleIncomingFrames(FrameDataHolder(msxBitmap, dcBitmap), context)
                                 }
                             })
                         } catch (e: Exception) {
@@ -155,12 +171,31 @@ object FlirManager {
         } catch (ignored: Throwable) {}
         FlirStatus.flirConnected = false
         FlirStatus.flirStreaming = false
+        FlirFrameGovernor.reset()
+        FlirPreviewRenderer.resetStats()
+        cameraHandler.fusion.resetStats()
+        cameraHandler.upscaler.resetStats()
+        cameraHandler.zoom.reset()
+        stopRecording()
+        closePlayback()
+        try {
+            cameraHandler.dump.stop()
+        } catch (ignored: Exception) {}
+        history.flush()
+        history.clear()
+        FlirFrameCache.close()
+        publishLatestBitmap(null)
+        emittedScaleVersion = 0L
         discoveryStarted = false
         reactContext = null
     }
 
+    /** Encodes the cached latest frame to PNG on demand; frames are not written as PNG otherwise. */
     fun getLatestFramePath(): String? {
-        return FlirStatus.latestFramePath
+        val dir = reactContext?.cacheDir ?: return FlirStatus.latestFramePath
+        val path = FlirFrameCache.exportPng(dir) ?: return FlirStatus.latestFramePath
+        FlirStatus.latestFramePath = path
+        return path
     }
 
     fun getTemperatureAt(x: Int, y: Int): Double? {
@@ -171,57 +206,483 @@ object FlirManager {
         }
     }
 
-    private fun handleIncomingFrames(msxBitmap: Bitmap?, dcBitmap: Bitmap?, ctx: ThemedReactContext) {
+    fun getTemperaturesAt(points: IntArray): FloatArray? {
+        return cameraHandler.getTemperaturesAt(points)
+    }
+
+    fun getTemperaturesIn(x: Int, y: Int, width: Int, height: Int): FloatArray? {
+        return cameraHandler.getTemperaturesIn(x, y, width, height)
+    }
+
+    fun getLineProfile(x0: Float, y0: Float, x1: Float, y1: Float, samples: Int): FloatArray? {
+        return cameraHandler.getLineProfile(x0, y0, x1, y1, samples)
+    }
+
+    /** Runs [reader] on the latest radiometric frame, which is held (not refilled) until it returns. */
+    fun <T> readRadiometricFrame(reader: (RadiometricFrame) -> T): T? =
+        cameraHandler.readRadiometricFrame { reader(it) }
+
+    /** Inverse palette lookup for the current palette and span; null before the first frame. */
+    fun getColorTemperatureIndex(): ColorTemperatureIndex? = cameraHandler.colorIndex.get()
+
+    fun getAvailablePalettes(): List<String> = CameraHandler.getAvailablePalettes()
+
+    /** False for an unknown name; applies from the next frame, and the scale bar follows it. */
+    fun setPalette(name: String): Boolean = cameraHandler.setPalette(name)
+
+    /** Throws IllegalArgumentException for an unknown mode; applies from the next frame. */
+    fun setFusion(mode: String, alpha: Float, pipX: Float, pipY: Float, pipWidth: Float, pipHeight: Float) {
+        cameraHandler.fusion.configure(mode, alpha, pipX, pipY, pipWidth, pipHeight)
+    }
+
+    /** Throws IllegalArgumentException for an unknown kernel; [scale] 0 fits the preview view. */
+    fun setUpscaler(kernel: String, scale: Float) {
+        cameraHandler.upscaler.configure(kernel, scale)
+    }
+
+    /** Zoom factor 1..8 and pan offset of the visible center in sensor pixels; applies from the next frame. */
+    fun setZoom(zoom: Float, panX: Int, panY: Int) {
+        cameraHandler.zoom.configure(zoom, panX, panY)
+    }
+
+    fun getZoomTransform(): FrameZoom.Transform? = cameraHandler.zoom.transform
+
+    fun getScaleBar(): ScaleBar.Snapshot? = cameraHandler.scaleBar.snapshot()
+
+    /** Cached PNG of the current legend; encoded once per orientation and legend change. */
+    fun getScaleBarPath(orientation: String): String? {
+        val dir = reactContext?.cacheDir ?: return null
+        return cameraHandler.scaleBar.exportPng(dir, orientation)
+    }
+
+    /** Temperature at a pixel of the delivered (zoomed and upscaled) frame, interpolated on the sensor plane. */
+    fun getTemperatureAtFramePoint(x: Float, y: Float): Double? {
+        val transform = cameraHandler.zoom.transform
+        val sx = transform?.toSensorX(x) ?: x
+        val sy = transform?.toSensorY(y) ?: y
+        val value = readRadiometricFrame { it.sample(sx, sy) } ?: return null
+        return if (value.isNaN()) null else value.toDouble()
+    }
+
+    @Volatile
+    private var recorder: RadiometricRecorder? = null
+    private var playback: RadiometricRecording? = null
+    private var playbackPath: String? = null
+
+    /**
+     * Starts appending every processed radiometric frame to [path] (a new file in the app's files
+     * directory when null). Returns the file path; throws IllegalStateException while recording.
+     */
+    @Synchronized
+    fun startRecording(path: String?, keyframeInterval: Int): String {
+        if (recorder != null) throw IllegalStateException("Already recording")
+        val file = if (path.isNullOrEmpty()) {
+            val dir = reactContext?.filesDir ?: throw IllegalStateException("Not streaming")
+            File(dir, "flir_${System.currentTimeMillis()}.flirrec")
+        } else {
+            File(path)
+        }
+        cameraHandler.requestStreamMetadata()
+        recorder = RadiometricRecorder(file, keyframeInterval)
+        return file.absolutePath
+    }
+
+    /** Closes the recording and returns its final stats, or null when not recording. */
+    @Synchronized
+    fun stopRecording(): Map<String, Any>? {
+        val current = recorder ?: return null
+        recorder = null
+        current.close()
+        return recordingStats(current)
+    }
+
+    fun getRecordingStats(): Map<String, Any>? = recorder?.let { recordingStats(it) }
+
+    private fun recordingStats(recorder: RadiometricRecorder): Map<String, Any> = mapOf(
+        "path" to recorder.file.absolutePath,
+        "frames" to recorder.frameCount,
+        "rawBytes" to recorder.rawBytes,
+        "bytesWritten" to recorder.bytesWritten,
+        "compressionRatio" to recorder.compressionRatio,
+        "throughputMBps" to recorder.throughputMBps,
+        "avgAppendMs" to recorder.avgAppendMs,
+        "clippedPixels" to recorder.clippedPixels,
+        "clippedFrames" to recorder.clippedFrames
+    )
+
+    /** Memory-mapped reader for [path]; the last opened recording stays mapped until another is opened. */
+    @Synchronized
+    fun openRecording(path: String): RadiometricRecording {
+        val current = playback
+        if (current != null && path == playbackPath) return current
+        closePlayback()
+        return RadiometricRecording.open(File(path)).also {
+            playback = it
+            playbackPath = path
+        }
+    }
+
+    @Synchronized
+    private fun closePlayback() {
+        try {
+            playback?.close()
+        } catch (ignored: Exception) {}
+        playback = null
+        playbackPath = null
+    }
+
+    // Runs on the frame worker; a failed write ends the recording rather than every later frame
+    private fun record(radiometric: RadiometricFrame) {
+        val current = recorder ?: return
+        val metadata = cameraHandler.streamMetadata ?: return
+        try {
+            current.append(radiometric, metadata)
+        } catch (e: Exception) {
+            synchronized(this) {
+                if (recorder === current) recorder = null
+            }
+            try {
+                current.close()
+            } catch (ignored: Exception) {}
+        }
+    }
+
+    /**
+     * Saves the current frame as a radiometric JPEG (a new file in the app's files directory when
+     * [path] is null), optionally with the fusion photo and the colorized frame as JPEGs next to
+     * it. [onSaved] is called from the snapshot thread; the stream skips frames while the image
+     * is being saved instead of waiting.
+     */
+    fun captureSnapshot(path: String?, visual: Boolean, overlay: Boolean, onSaved: (Map<String, Any>?, Exception?) -> Unit) {
+        val file = if (path.isNullOrEmpty()) {
+            val dir = reactContext?.filesDir ?: throw IllegalStateException("Not streaming")
+            File(dir, "flir_snapshot_${System.currentTimeMillis()}.jpg")
+        } else {
+            File(path)
+        }
+        cameraHandler.captureSnapshot(file, visual, overlay) { result, error ->
+            onSaved(if (error == null) snapshotStats(result) else null, error)
+        }
+    }
+
+    private fun snapshotStats(result: ThermalSnapshot.Result): Map<String, Any> {
+        val stats = mutableMapOf<String, Any>(
+            "path" to result.file.absolutePath,
+            "bytes" to result.file.length(),
+            "latencyMs" to result.latencyMs,
+            "pinnedMs" to result.pinnedMs
+        )
+        result.visualFile?.let { stats["visualPath"] = it.absolutePath }
+        result.overlayFile?.let { stats["overlayPath"] = it.absolutePath }
+        return stats
+    }
+
+    fun getSnapshotStats(): Map<String, Any> {
+        val snapshot = cameraHandler.snapshot
+        return mapOf(
+            "snapshots" to snapshot.snapshots,
+            "busy" to snapshot.isBusy,
+            "framesSkipped" to snapshot.framesSkipped,
+            "lastLatencyMs" to snapshot.lastLatencyMs,
+            "avgLatencyMs" to snapshot.avgLatencyMs
+        )
+    }
+
+    private val history = FrameHistory()
+
+    /**
+     * Keeps the last [seconds] of radiometric frames, compressed, in at most [maxBytes] so
+     * [captureWindow] can include the time before a trigger. 0 seconds turns the history off.
+     */
+    fun setFrameHistory(seconds: Float, maxBytes: Int, keyframeInterval: Int) {
+        if (seconds > 0) cameraHandler.requestStreamMetadata()
+        history.configure(seconds, maxBytes, keyframeInterval)
+    }
+
+    /**
+     * Writes [preSeconds] before now to [postSeconds] after now from the history to a .flirrec
+     * file (a new file in the app's files directory when [path] is null). [onWritten] is called
+     * from the writer thread with the capture stats or the error; the stream never waits.
+     */
+    fun captureWindow(preSeconds: Float, postSeconds: Float, path: String?, onWritten: (Map<String, Any>?, Exception?) -> Unit) {
+        val file = if (path.isNullOrEmpty()) {
+            val dir = reactContext?.filesDir ?: throw IllegalStateException("Not streaming")
+            File(dir, "flir_window_${System.currentTimeMillis()}.flirrec")
+        } else {
+            File(path)
+        }
+        history.captureWindow(preSeconds, postSeconds, file) { capture, error ->
+            onWritten(if (error == null) captureStats(capture) else null, error)
+        }
+    }
+
+    fun getFrameHistoryStats(): Map<String, Any> = mapOf(
+        "enabled" to history.isEnabled,
+        "frames" to history.frameCount,
+        "seconds" to history.seconds,
+        "bytesUsed" to history.bytesUsed,
+        "capacityBytes" to history.capacityBytes,
+        "avgEncodeMs" to history.avgEncodeMs,
+        "capturesPending" to history.capturesPending,
+        "capturesWritten" to history.capturesWritten
+    )
+
+    private fun captureStats(capture: FrameHistory.Capture): Map<String, Any> = mapOf(
+        "path" to capture.file.absolutePath,
+        "frames" to capture.frameCount,
+        "preSeconds" to capture.preSeconds,
+        "postSeconds" to capture.postSeconds,
+        "bytesWritten" to capture.bytesWritten,
+        "writeMs" to capture.writeMs
+    )
+
+    /**
+     * Dumps every acquired frame, before fusion, zoom and upscaling, to [path] (a new file in the
+     * app's files directory when null) so the session can be replayed. Returns the file path.
+     */
+    fun startDump(path: String?): String {
+        val file = if (path.isNullOrEmpty()) {
+            val dir = reactContext?.filesDir ?: throw IllegalStateException("Not streaming")
+            File(dir, "flir_${System.currentTimeMillis()}.flirdump")
+        } else {
+            File(path)
+        }
+        cameraHandler.dump.start(file)
+        return file.absolutePath
+    }
+
+    /** Closes the dump and returns its stats, or null when none was running. */
+    fun stopDump(): Map<String, Any>? {
+        val dump = cameraHandler.dump
+        val file = dump.stop() ?: return null
+        return mapOf(
+            "path" to file.absolutePath,
+            "frames" to dump.framesDumped,
+            "bytesWritten" to dump.bytesDumped
+        )
+    }
+
+    /**
+     * Plays a dump through the frame pipeline in place of the camera: frames are emitted, cached,
+     * recorded and queryable exactly as when streaming. [speed] 0 replays as fast as the pipeline
+     * keeps up. Emits FlirReplayFinished with the replay stats when the dump ends or fails.
+     */
+    fun startReplay(ctx: ReactContext, path: String, speed: Float, loop: Boolean) {
+        if (reactContext == null) reactContext = ctx
+        val file = File(path)
+        if (!file.isFile) throw IllegalArgumentException("No dump at $path")
+        cameraHandler.startReplay(file, speed, loop, object : CameraHandler.StreamDataListener {
+            override fun images(dataHolder: FrameDataHolder) {
+                handleIncomingFrames(dataHolder, ctx)
+            }
+
+            override fun images(msxBitmap: Bitmap?, dcBitmap: Bitmap?) {
+                handleIncomingFrames(FrameDataHolder(msxBitmap, dcBitmap), ctx)
+            }
+        }) { replay, error ->
+            val params = Arguments.createMap().apply {
+                replayStats(replay).forEach { (key, value) ->
+                    when (value) {
+                        is String -> putString(key, value)
+                        is Boolean -> putBoolean(key, value)
+                        is Number -> putDouble(key, value.toDouble())
+                    }
+                }
+                if (error != null) putString("error", error.message)
+            }
+            try {
+                ctx.getJSModule(DeviceEventManagerModule.RCTDeviceEventEmitter::class.java)
+                    .emit("FlirReplayFinished", params)
+            } catch (ignored: Exception) {}
+        }
+    }
+
+    fun stopReplay(): Map<String, Any>? {
+        val replay = cameraHandler.replay ?: return null
+        cameraHandler.stopReplay()
+        return replayStats(replay)
+    }
+
+    fun getReplayStats(): Map<String, Any>? = cameraHandler.replay?.let { replayStats(it) }
+
+    private fun replayStats(replay: FrameReplay): Map<String, Any> {
+        val frames = replay.framesReplayed
+        val elapsedMs = replay.elapsedMs
+        return mapOf(
+            "path" to replay.file.absolutePath,
+            "speed" to replay.speed.toDouble(),
+            "running" to replay.isRunning,
+            "framesReplayed" to frames,
+            "elapsedMs" to elapsedMs,
+            "fps" to if (elapsedMs > 0) frames * 1000.0 / elapsedMs else 0.0,
+            "maxLagMs" to replay.maxLagMs,
+            "framesOverwritten" to cameraHandler.framesOverwritten
+        )
+    }
+
+    /** Governor and preview counters plus the acquisition queue state of the frame worker handoff. */
+    fun getFrameStats(): Map<String, Any> {
+        return FlirFrameGovernor.stats() + FlirPreviewRenderer.stats() + mapOf(
+            "framesAcquired" to cameraHandler.framesAcquired,
+            "framesOverwritten" to cameraHandler.framesOverwritten,
+            "queueDepth" to cameraHandler.queueDepth,
+            "bitmapAllocations" to cameraHandler.bitmapAllocations,
+            "bufferAllocations" to cameraHandler.bufferAllocations,
+            "fusionMode" to cameraHandler.fusion.mode,
+            "fusionNative" to cameraHandler.fusion.isNative,
+            "framesFused" to cameraHandler.fusion.framesFused,
+            "lastFusionMs" to cameraHandler.fusion.lastFusionMs,
+            "avgFusionMs" to cameraHandler.fusion.avgFusionMs,
+            "upscaleKernel" to cameraHandler.upscaler.kernel,
+            "upscaleNative" to cameraHandler.upscaler.isNative,
+            "upscaledWidth" to cameraHandler.upscaler.outputWidth,
+            "upscaledHeight" to cameraHandler.upscaler.outputHeight,
+            "lastUpscaleMs" to cameraHandler.upscaler.lastUpscaleMs,
+            "avgUpscaleMs" to cameraHandler.upscaler.avgUpscaleMs
+        )
+    }
+
+    private var emittedScaleVersion = 0L
+
+    private fun handleIncomingFrames(frame: FrameDataHolder, ctx: ReactContext) {
+        val bmp = frame.msxBitmap ?: frame.dcBitmap ?: return
+        emitScaleChange(ctx)
+        frame.radiometric?.let {
+            record(it)
+            history.append(it, cameraHandler.streamMetadata)
+        }
+
+        // The mapped cache tracks every processed frame; it is a plain copy, no encoding
+        try {
+            FlirFrameCache.write(ctx.cacheDir, bmp, frame.viewRadiometric, frame.timestampNanos)
+        } catch (ignored: Exception) {}
+
+        // On-screen preview runs at the sensor rate, ahead of the JS governor
+        try {
+            FlirPreviewRenderer.render(bmp, frame.timestampNanos)
+        } catch (ignored: Exception) {}
+
+        val startNanos = System.nanoTime()
+        val frameId = FlirFrameGovernor.admit(startNanos)
+        if (frameId < 0) return
         val now = System.currentTimeMillis()
-        if (now - lastEmitMs.get() < minEmitIntervalMs) return
-        lastEmitMs.set(now)
 
-        val bmp = msxBitmap ?: dcBitmap ?: return
-        latestBitmap = bmp
+        publishLatestBitmap(bmp)
         
         // Invoke texture callback for native GL/Metal filters (texture unit 7)
         textureCallback?.onTextureUpdate(bmp, 7)
         
-        // Get and emit temperature data
-        try {
-            val temp = cameraHandler.getTemperatureAt(80, 60) // center point
-            if (temp != null) {
-                temperatureCallback?.onTemperatureData(temp, 80, 60)
-            }
-        } catch (ignored: Throwable) {}
+        // Center of the visible area, in sensor coordinates of whatever resolution the sensor delivers
+        val radiometric = frame.radiometric
+        if (radiometric != null) {
+            val transform = cameraHandler.zoom.transform
+            val cx = transform?.let { it.cropX + it.cropWidth / 2 } ?: (radiometric.width / 2)
+            val cy = transform?.let { it.cropY + it.cropHeight / 2 } ?: (radiometric.height / 2)
+            val temp = radiometric.valueAt(cx, cy)
+            if (!temp.isNaN()) temperatureCallback?.onTemperatureData(temp.toDouble(), cx, cy)
+            emitRegionStatistics(radiometric, ctx)
+        }
 
         try {
-            val cacheDir = ctx.cacheDir
-            val outFile = File(cacheDir, "flir_latest_frame.png")
-            val fos = FileOutputStream(outFile)
-            bmp.compress(Bitmap.CompressFormat.PNG, 90, fos)
-            fos.flush()
-            fos.close()
-            FlirStatus.latestFramePath = outFile.absolutePath
-            FlirFrameCache.latestFramePath = outFile.absolutePath
-            FlirStatus.flirStreaming = true
-
-            val baos = ByteArrayOutputStream()
-            bmp.compress(Bitmap.CompressFormat.PNG, 70, baos)
-            val pngBytes = baos.toByteArray()
-            val base64 = Base64.encodeToString(pngBytes, Base64.NO_WRAP)
-
             val params: WritableMap = Arguments.createMap().apply {
                 putString("type", "frame")
-                putString("path", outFile.absolutePath)
-                putString("base64", "data:image/png;base64," + base64)
+                putDouble("frameId", frameId.toDouble())
                 putDouble("timestamp", (now / 1000.0))
             }
+
+            if (FlirFrameTransport.mode == FlirFrameTransport.MODE_RGBA) {
+                // Raw pixels stay in the native ring; only the slot metadata crosses the bridge
+                val slot = FlirFrameTransport.write(bmp)
+                params.putString("format", FlirFrameTransport.MODE_RGBA)
+                params.putInt("slot", slot.slot)
+                params.putDouble("sequence", slot.sequence.toDouble())
+                params.putInt("width", slot.width)
+                params.putInt("height", slot.height)
+                params.putInt("stride", slot.stride)
+            } else {
+                val pngBytes = FlirFrameTransport.encodePng(bmp)
+                params.putString("format", FlirFrameTransport.MODE_PNG)
+                params.putString("base64", "data:image/png;base64," + Base64.encodeToString(pngBytes, Base64.NO_WRAP))
+            }
+            FlirFrameCache.cachePath?.let { params.putString("cachePath", it) }
+            FlirStatus.flirStreaming = true
+
             try {
                 ctx.getJSModule(DeviceEventManagerModule.RCTDeviceEventEmitter::class.java)
                     .emit("FlirFrame", params)
             } catch (e: Exception) {}
+            FlirFrameGovernor.delivered(System.nanoTime() - startNanos)
 
         } catch (e: Exception) {
             FlirStatus.flirStreaming = false
         }
     }
 
+    // Only when the legend changed: palette switch or a span move beyond the jitter threshold
+    private fun emitScaleChange(ctx: ReactContext) {
+        val scaleBar = cameraHandler.scaleBar
+        if (scaleBar.version == emittedScaleVersion) return
+        val snapshot = scaleBar.snapshot() ?: return
+        emittedScaleVersion = snapshot.version
+        try {
+            val params = Arguments.createMap().apply {
+                putString("palette", snapshot.palette)
+                putDouble("min", snapshot.min.toDouble())
+                putDouble("max", snapshot.max.toDouble())
+                putDouble("version", snapshot.version.toDouble())
+            }
+            ctx.getJSModule(DeviceEventManagerModule.RCTDeviceEventEmitter::class.java)
+                .emit("FlirScaleChanged", params)
+        } catch (ignored: Exception) {}
+    }
+
+    private fun emitRegionStatistics(radiometric: RadiometricFrame, ctx: ReactContext) {
+        try {
+            val percentiles = regionStatistics.percentiles
+            val regions = Arguments.createArray()
+            regions.pushMap(toStatsMap(regionStatistics.computeFrame(radiometric), percentiles))
+            for (result in regionStatistics.compute(radiometric)) {
+                regions.pushMap(toStatsMap(result, percentiles))
+            }
+            val params: WritableMap = Arguments.createMap().apply {
+                putDouble("sequence", radiometric.sequence.toDouble())
+                putDouble("timestamp", radiometric.timestampNanos / 1_000_000_000.0)
+                putInt("width", radiometric.width)
+                putInt("height", radiometric.height)
+                putArray("regions", regions)
+            }
+            ctx.getJSModule(DeviceEventManagerModule.RCTDeviceEventEmitter::class.java)
+                .emit("FlirRegionStats", params)
+        } catch (e: Exception) {}
+    }
+
+    private fun toStatsMap(result: RegionStatistics.Result, percentiles: FloatArray): WritableMap {
+        val map = Arguments.createMap()
+        map.putString("id", result.id)
+        map.putInt("count", result.count)
+        if (result.count == 0) return map
+        map.putDouble("min", result.min.toDouble())
+        map.putDouble("max", result.max.toDouble())
+        map.putDouble("mean", result.mean.toDouble())
+        map.putDouble("stddev", result.stddev.toDouble())
+        map.putMap("hotspot", Arguments.createMap().apply {
+            putInt("x", result.hotX)
+            putInt("y", result.hotY)
+        })
+        map.putMap("coldspot", Arguments.createMap().apply {
+            putInt("x", result.coldX)
+            putInt("y", result.coldY)
+        })
+        val values = Arguments.createMap()
+        for (i in percentiles.indices) {
+            if (i < result.percentileValues.size) {
+                values.putDouble("p" + percentiles[i].toString().removeSuffix(".0"), result.percentileValues[i].toDouble())
+            }
+        }
+        map.putMap("percentiles", values)
+        return map
+    }
+
     private fun emitDeviceState(state: String, connected: Boolean, extras: Map<String, Any> = emptyMap()) {
         FlirStatus.flirConnected = connected
         val ctx = reactContext ?: return
@@ -1,25 +1,55 @@
 package flir.android
 
+import android.graphics.BitmapFactory
+import com.facebook.react.bridge.Arguments
 import com.facebook.react.bridge.Promise
 import com.facebook.react.bridge.ReactApplicationContext
 import com.facebook.react.bridge.ReactContextBaseJavaModule
 import com.facebook.react.bridge.ReactMethod
+import com.facebook.react.bridge.ReadableArray
+import com.facebook.react.bridge.ReadableMap
+import com.facebook.react.bridge.ReadableType
+import com.facebook.react.bridge.WritableArray
+import com.facebook.react.bridge.WritableMap
 
 class FlirModule(private val reactContext: ReactApplicationContext) : ReactContextBaseJavaModule(reactContext) {
     override fun getName(): String = "FlirModule"
 
-    // Simple placeholder conversion: converts an ARGB color to a pseudo-temperature value.
-    // Replace with SDK call when integrating thermalsdk APIs.
+    // Inverse of the palette and scale applied to the latest frame; resolves null for colors the
+    // palette does not produce and before any palette is known, as on iOS
     @ReactMethod
     fun getTemperatureFromColor(color: Int, promise: Promise) {
         try {
-            val r = (color shr 16) and 0xFF
-            val g = (color shr 8) and 0xFF
-            val b = color and 0xFF
-            // Luminance-like value scaled to a plausible temperature range (0°C - 400°C)
-            val lum = 0.2126 * r + 0.7152 * g + 0.0722 * b
-            val temp = 0.0 + (lum / 255.0) * 400.0
-            promise.resolve(temp)
+            val temp = FlirManager.getColorTemperatureIndex()?.temperatureOf(color) ?: Float.NaN
+            promise.resolve(if (temp.isNaN()) null else temp.toDouble())
+        } catch (e: Exception) {
+            promise.reject("ERR_FLIR_CONVERT", e)
+        }
+    }
+
+    // Converts a colorized image (file path or file:// URI) back to approximate temperatures;
+    // resolves { width, height, values } with values row-major
+    @ReactMethod
+    fun getTemperaturesFromImage(path: String, promise: Promise) {
+        try {
+            val index = FlirManager.getColorTemperatureIndex()
+            if (index == null) {
+                promise.reject("ERR_NO_DATA", "No colorized frame available")
+                return
+            }
+            val bmp = BitmapFactory.decodeFile(path.removePrefix("file://"))
+            if (bmp == null) {
+                promise.reject("ERR_FLIR_CONVERT", "Could not decode $path")
+                return
+            }
+            val pixels = IntArray(bmp.width * bmp.height)
+            bmp.getPixels(pixels, 0, bmp.width, 0, 0, bmp.width, bmp.height)
+            val map = Arguments.createMap()
+            map.putInt("width", bmp.width)
+            map.putInt("height", bmp.height)
+            map.putArray("values", toWritableArray(index.temperaturesOf(pixels)))
+            bmp.recycle()
+            promise.resolve(map)
         } catch (e: Exception) {
             promise.reject("ERR_FLIR_CONVERT", e)
         }
@@ -28,13 +58,18 @@ class FlirModule(private val reactContext: ReactApplicationContext) : ReactConte
     @ReactMethod
     fun getLatestFramePath(promise: Promise) {
         try {
-            val path = FlirFrameCache.latestFramePath
-            if (path != null) promise.resolve(path) else promise.resolve(null)
+            promise.resolve(FlirManager.getLatestFramePath())
         } catch (e: Exception) {
             promise.reject("ERR_FLIR_PATH", e)
         }
     }
 
+    // Path of the memory-mapped latest-frame file (layout documented in FlirFrameCache)
+    @ReactMethod
+    fun getFrameCachePath(promise: Promise) {
+        promise.resolve(FlirFrameCache.cachePath)
+    }
+
     @ReactMethod
     fun getTemperatureAt(x: Int, y: Int, promise: Promise) {
         try {
@@ -45,6 +80,95 @@ class FlirModule(private val reactContext: ReactApplicationContext) : ReactConte
         }
     }
     
+    // points: [{ x, y }, ...] or a flat [x0, y0, x1, y1, ...]; NaN/outside samples resolve as null
+    @ReactMethod
+    fun getTemperaturesAt(points: ReadableArray, promise: Promise) {
+        try {
+            val values = FlirManager.getTemperaturesAt(toPointArray(points))
+            if (values != null) promise.resolve(toWritableArray(values)) else promise.reject("ERR_NO_DATA", "No temperature data available")
+        } catch (e: Exception) {
+            promise.reject("ERR_FLIR_SAMPLE", e)
+        }
+    }
+
+    // Resolves { x, y, width, height, values } with the rectangle clipped to the frame
+    @ReactMethod
+    fun getTemperaturesInRect(x: Int, y: Int, width: Int, height: Int, promise: Promise) {
+        try {
+            // Clip and values from the same frame
+            val map = FlirManager.readRadiometricFrame { frame ->
+                val x0 = x.coerceIn(0, frame.width)
+                val y0 = y.coerceIn(0, frame.height)
+                Arguments.createMap().apply {
+                    putInt("x", x0)
+                    putInt("y", y0)
+                    putInt("width", (x + width).coerceIn(x0, frame.width) - x0)
+                    putInt("height", (y + height).coerceIn(y0, frame.height) - y0)
+                    putArray("values", toWritableArray(frame.valuesIn(x, y, width, height)))
+                }
+            }
+            if (map == null) {
+                promise.reject("ERR_NO_DATA", "No temperature data available")
+                return
+            }
+            promise.resolve(map)
+        } catch (e: Exception) {
+            promise.reject("ERR_FLIR_SAMPLE", e)
+        }
+    }
+
+    @ReactMethod
+    fun getLineProfile(x0: Double, y0: Double, x1: Double, y1: Double, samples: Int, promise: Promise) {
+        try {
+            val values = FlirManager.getLineProfile(x0.toFloat(), y0.toFloat(), x1.toFloat(), y1.toFloat(), samples)
+            if (values != null) promise.resolve(toWritableArray(values)) else promise.reject("ERR_NO_DATA", "No temperature data available")
+        } catch (e: Exception) {
+            promise.reject("ERR_FLIR_SAMPLE", e)
+        }
+    }
+
+    // Regions: [{ id, type: 'rect'|'ellipse'|'polygon'|'line', ... }]; stats arrive as FlirRegionStats events
+    @ReactMethod
+    fun setRegions(regions: ReadableArray, promise: Promise) {
+        try {
+            val parsed = ArrayList<RegionStatistics.Region>()
+            for (i in 0 until regions.size()) {
+                val region = regions.getMap(i) ?: continue
+                val id = if (region.hasKey("id")) region.getString("id") ?: "$i" else "$i"
+                val type = region.getString("type") ?: RegionStatistics.RECT
+                val coords = when (type) {
+                    RegionStatistics.RECT -> floatArrayOf(region.getDouble("x").toFloat(), region.getDouble("y").toFloat(),
+                        region.getDouble("width").toFloat(), region.getDouble("height").toFloat())
+                    RegionStatistics.ELLIPSE -> floatArrayOf(region.getDouble("cx").toFloat(), region.getDouble("cy").toFloat(),
+                        region.getDouble("rx").toFloat(), region.getDouble("ry").toFloat())
+                    RegionStatistics.LINE -> floatArrayOf(region.getDouble("x0").toFloat(), region.getDouble("y0").toFloat(),
+                        region.getDouble("x1").toFloat(), region.getDouble("y1").toFloat())
+                    RegionStatistics.POLYGON -> toPointArray(region.getArray("points") ?: Arguments.createArray())
+                        .map { it.toFloat() }.toFloatArray()
+                    else -> {
+                        promise.reject("ERR_FLIR_REGION", "Unknown region type: $type")
+                        return
+                    }
+                }
+                parsed.add(RegionStatistics.Region(id, type, coords))
+            }
+            FlirManager.regionStatistics.setRegions(parsed)
+            promise.resolve(parsed.size)
+        } catch (e: Exception) {
+            promise.reject("ERR_FLIR_REGION", e)
+        }
+    }
+
+    @ReactMethod
+    fun setStatisticsPercentiles(percentiles: ReadableArray, promise: Promise) {
+        try {
+            FlirManager.regionStatistics.setPercentiles(FloatArray(percentiles.size()) { percentiles.getDouble(it).toFloat() })
+            promise.resolve(null)
+        } catch (e: Exception) {
+            promise.reject("ERR_FLIR_REGION", e)
+        }
+    }
+
     @ReactMethod
     fun isEmulator(promise: Promise) {
         try {
@@ -71,4 +195,486 @@ class FlirModule(private val reactContext: ReactApplicationContext) : ReactConte
             promise.reject("ERR_FLIR_DEVICE_INFO", e)
         }
     }
+
+    // Selects how frames reach JS: "png" (base64 data URI events) or "rgba" (native buffer ring)
+    @ReactMethod
+    fun setFrameTransport(mode: String, promise: Promise) {
+        try {
+            if (FlirFrameTransport.setMode(mode)) promise.resolve(mode)
+            else promise.reject("ERR_FLIR_TRANSPORT", "Unknown frame transport: $mode")
+        } catch (e: Exception) {
+            promise.reject("ERR_FLIR_TRANSPORT", e)
+        }
+    }
+
+    @ReactMethod
+    fun getFrameTransportStats(promise: Promise) {
+        try {
+            promise.resolve(toWritableMap(FlirFrameTransport.stats()))
+        } catch (e: Exception) {
+            promise.reject("ERR_FLIR_TRANSPORT", e)
+        }
+    }
+
+    // Installs global.__flirFrameSlot / __flirFrameSequence so JS reads "rgba" frames without a
+    // copy; synchronous because it has to run on the JS thread
+    @ReactMethod(isBlockingSynchronousMethod = true)
+    fun installFrameTransport(): Boolean {
+        return try {
+            val runtime = reactContext.javaScriptContextHolder?.get() ?: 0L
+            FlirFrameJsi.install(runtime)
+        } catch (e: Exception) {
+            false
+        }
+    }
+
+    // Times the previous PNG pipeline, the single PNG encode and the RGBA copy on the latest frame
+    @ReactMethod
+    fun benchmarkFrameTransport(iterations: Int, promise: Promise) {
+        val bmp = FlirManager.acquireLatestBitmap()
+        if (bmp == null || bmp.isRecycled) {
+            bmp?.let { FlirManager.releaseBitmap(it) }
+            promise.reject("ERR_NO_DATA", "No frame available")
+            return
+        }
+        try {
+            promise.resolve(toWritableMap(FlirFrameTransport.benchmark(bmp, iterations.coerceIn(1, 500))))
+        } catch (e: Exception) {
+            promise.reject("ERR_FLIR_TRANSPORT", e)
+        } finally {
+            FlirManager.releaseBitmap(bmp)
+        }
+    }
+
+    @ReactMethod
+    fun getAvailablePalettes(promise: Promise) {
+        try {
+            promise.resolve(Arguments.fromList(FlirManager.getAvailablePalettes()))
+        } catch (e: Exception) {
+            promise.reject("ERR_FLIR_PALETTE", e)
+        }
+    }
+
+    @ReactMethod
+    fun setPalette(name: String, promise: Promise) {
+        setPaletteInverted(name, false, promise)
+    }
+
+    // The SDK streamer has no inverted palettes on Android; only iOS colorizes natively
+    @ReactMethod
+    fun setPaletteInverted(name: String, inverted: Boolean, promise: Promise) {
+        if (inverted) {
+            promise.reject("ERR_FLIR_PALETTE", "Inverted palettes are only supported on iOS")
+            return
+        }
+        try {
+            if (FlirManager.setPalette(name)) promise.resolve(name)
+            else promise.reject("ERR_FLIR_PALETTE", "Unknown palette: $name")
+        } catch (e: Exception) {
+            promise.reject("ERR_FLIR_PALETTE", e)
+        }
+    }
+
+    // Combines the thermal image with the visual photo: "off", "msx", "blend" or "pip"
+    @ReactMethod
+    fun setFusionMode(mode: String, options: ReadableMap?, promise: Promise) {
+        if (!FrameFusion.isMode(mode)) {
+            promise.reject("ERR_FLIR_FUSION", "Unknown fusion mode: $mode")
+            return
+        }
+        try {
+            fun option(key: String, fallback: Double): Float =
+                (if (options != null && options.hasKey(key)) options.getDouble(key) else fallback).toFloat()
+            FlirManager.setFusion(mode, option("alpha", 0.5), option("x", 0.6), option("y", 0.6),
+                option("width", 0.35), option("height", 0.35))
+            promise.resolve(mode)
+        } catch (e: Exception) {
+            promise.reject("ERR_FLIR_FUSION", e)
+        }
+    }
+
+    // Upscales the presented frame: "off", "nearest", "bilinear", "bicubic" or "jointBilateral"
+    // (guided by the visual photo); scale 0 fits the largest FLIRCameraView
+    @ReactMethod
+    fun setUpscaler(kernel: String, scale: Double, promise: Promise) {
+        if (!FrameUpscaler.isKernel(kernel)) {
+            promise.reject("ERR_FLIR_UPSCALE", "Unknown upscale kernel: $kernel")
+            return
+        }
+        try {
+            FlirManager.setUpscaler(kernel, scale.toFloat())
+            promise.resolve(kernel)
+        } catch (e: Exception) {
+            promise.reject("ERR_FLIR_UPSCALE", e)
+        }
+    }
+
+    // Resolves [{ kernel, width, height, scale, avgMs, withinBudget }] for each kernel on
+    // synthetic 80x60 and 160x120 frames; runs off the bridge thread
+    @ReactMethod
+    fun benchmarkUpscaler(scale: Double, budgetMs: Double, promise: Promise) {
+        Thread {
+            try {
+                val results = Arguments.createArray()
+                val kernels = listOf(FrameUpscaler.NEAREST, FrameUpscaler.BILINEAR,
+                    FrameUpscaler.BICUBIC, FrameUpscaler.JOINT_BILATERAL)
+                for ((width, height) in listOf(80 to 60, 160 to 120)) {
+                    for (kernel in kernels) {
+                        val avgMs = FrameUpscaler.benchmark(kernel, width, height, scale.toFloat(), 30)
+                        results.pushMap(Arguments.createMap().apply {
+                            putString("kernel", kernel)
+                            putInt("width", width)
+                            putInt("height", height)
+                            putDouble("scale", scale)
+                            putDouble("avgMs", avgMs)
+                            putBoolean("withinBudget", avgMs <= budgetMs)
+                        })
+                    }
+                }
+                promise.resolve(results)
+            } catch (e: Exception) {
+                promise.reject("ERR_FLIR_UPSCALE", e)
+            }
+        }.start()
+    }
+
+    // Digital zoom like the SDK's DisplaySettings: zoom >= 1, pan in sensor pixels from the center.
+    // Frames are cropped natively, so zoomed frames carry fewer pixels.
+    @ReactMethod
+    fun setZoom(zoom: Double, panX: Int, panY: Int, promise: Promise) {
+        try {
+            FlirManager.setZoom(zoom.toFloat(), panX, panY)
+            promise.resolve(null)
+        } catch (e: Exception) {
+            promise.reject("ERR_FLIR_ZOOM", e)
+        }
+    }
+
+    // Maps delivered frame pixels to sensor pixels: sensorX = cropX + (x + 0.5) * scaleX - 0.5
+    @ReactMethod
+    fun getZoomTransform(promise: Promise) {
+        try {
+            val transform = FlirManager.getZoomTransform()
+            if (transform == null) {
+                promise.reject("ERR_NO_DATA", "No frame processed yet")
+                return
+            }
+            promise.resolve(toWritableMap(mapOf(
+                "zoom" to transform.zoom,
+                "panX" to transform.panX,
+                "panY" to transform.panY,
+                "sensorWidth" to transform.sensorWidth,
+                "sensorHeight" to transform.sensorHeight,
+                "cropX" to transform.cropX,
+                "cropY" to transform.cropY,
+                "cropWidth" to transform.cropWidth,
+                "cropHeight" to transform.cropHeight,
+                "frameWidth" to transform.frameWidth,
+                "frameHeight" to transform.frameHeight,
+                "scaleX" to transform.scaleX,
+                "scaleY" to transform.scaleY
+            )))
+        } catch (e: Exception) {
+            promise.reject("ERR_FLIR_ZOOM", e)
+        }
+    }
+
+    // Temperature at a pixel of the delivered frame, whatever zoom and upscaling are active
+    @ReactMethod
+    fun getTemperatureAtFramePoint(x: Double, y: Double, promise: Promise) {
+        try {
+            val temp = FlirManager.getTemperatureAtFramePoint(x.toFloat(), y.toFloat())
+            if (temp != null) promise.resolve(temp)
+            else promise.reject("ERR_NO_DATA", "No temperature data available")
+        } catch (e: Exception) {
+            promise.reject("ERR_FLIR_SAMPLE", e)
+        }
+    }
+
+    // { palette, min, max, version, orientation, path }; path is null when the SDK rendered no scale image
+    @ReactMethod
+    fun getScaleBar(orientation: String, promise: Promise) {
+        try {
+            val snapshot = FlirManager.getScaleBar()
+            if (snapshot == null) {
+                promise.reject("ERR_NO_DATA", "No scale known yet")
+                return
+            }
+            val map = Arguments.createMap()
+            map.putString("palette", snapshot.palette)
+            map.putDouble("min", snapshot.min.toDouble())
+            map.putDouble("max", snapshot.max.toDouble())
+            map.putDouble("version", snapshot.version.toDouble())
+            map.putString("orientation", if (orientation == ScaleBar.HORIZONTAL) ScaleBar.HORIZONTAL else ScaleBar.VERTICAL)
+            val path = FlirManager.getScaleBarPath(orientation)
+            if (path != null) map.putString("path", path) else map.putNull("path")
+            promise.resolve(map)
+        } catch (e: Exception) {
+            promise.reject("ERR_FLIR_SCALE", e)
+        }
+    }
+
+    // Appends every frame's Celsius plane to a compact .flirrec file (16-bit, delta + deflate);
+    // options: path (defaults to the app's files directory), keyframeInterval (frames, default 30)
+    @ReactMethod
+    fun startRecording(options: ReadableMap?, promise: Promise) {
+        try {
+            val path = if (options != null && options.hasKey("path")) options.getString("path") else null
+            val interval = if (options != null && options.hasKey("keyframeInterval")) options.getInt("keyframeInterval") else 30
+            promise.resolve(FlirManager.startRecording(path, interval))
+        } catch (e: Exception) {
+            promise.reject("ERR_FLIR_RECORD", e)
+        }
+    }
+
+    @ReactMethod
+    fun stopRecording(promise: Promise) {
+        try {
+            val stats = FlirManager.stopRecording()
+            if (stats == null) {
+                promise.reject("ERR_NO_DATA", "Not recording")
+                return
+            }
+            promise.resolve(toWritableMap(stats))
+        } catch (e: Exception) {
+            promise.reject("ERR_FLIR_RECORD", e)
+        }
+    }
+
+    // Frames, bytes written, compression ratio against float planes and MB/s of the running recording
+    @ReactMethod
+    fun getRecordingStats(promise: Promise) {
+        val stats = FlirManager.getRecordingStats()
+        if (stats == null) {
+            promise.reject("ERR_NO_DATA", "Not recording")
+            return
+        }
+        promise.resolve(toWritableMap(stats))
+    }
+
+    @ReactMethod
+    fun getRecordingInfo(path: String, promise: Promise) {
+        try {
+            val recording = FlirManager.openRecording(path)
+            val map = toWritableMap(mapOf(
+                "path" to path,
+                "width" to recording.width,
+                "height" to recording.height,
+                "frames" to recording.frameCount,
+                "keyframeInterval" to recording.keyframeInterval,
+                "durationMs" to recording.durationNanos / 1_000_000.0,
+                "createdAt" to recording.createdMillis / 1000.0,
+                "clipMin" to recording.clipMin,
+                "clipMax" to recording.clipMax,
+                "metadata" to recording.metadata
+            ))
+            promise.resolve(map)
+        } catch (e: Exception) {
+            promise.reject("ERR_FLIR_PLAYBACK", e)
+        }
+    }
+
+    // Decodes one recorded frame; values are returned only when includeValues is set
+    @ReactMethod
+    fun getRecordingFrame(path: String, index: Int, includeValues: Boolean, promise: Promise) {
+        try {
+            val recording = FlirManager.openRecording(path)
+            val frame = RadiometricFrame()
+            recording.readFrame(index, frame)
+            val map = toWritableMap(mapOf(
+                "index" to index,
+                "timestamp" to frame.timestampNanos / 1_000_000_000.0,
+                "width" to frame.width,
+                "height" to frame.height,
+                "min" to frame.min,
+                "max" to frame.max
+            ))
+            if (includeValues) map.putArray("values", toWritableArray(frame.plane))
+            promise.resolve(map)
+        } catch (e: Exception) {
+            promise.reject("ERR_FLIR_PLAYBACK", e)
+        }
+    }
+
+    // Radiometric JPEG of the current frame, saved off the stream; options: path, visual, overlay
+    @ReactMethod
+    fun captureSnapshot(options: ReadableMap?, promise: Promise) {
+        try {
+            val path = if (options != null && options.hasKey("path")) options.getString("path") else null
+            val visual = options != null && options.hasKey("visual") && options.getBoolean("visual")
+            val overlay = options != null && options.hasKey("overlay") && options.getBoolean("overlay")
+            FlirManager.captureSnapshot(path, visual, overlay) { stats, error ->
+                if (stats != null) promise.resolve(toWritableMap(stats)) else promise.reject("ERR_FLIR_SNAPSHOT", error)
+            }
+        } catch (e: Exception) {
+            promise.reject("ERR_FLIR_SNAPSHOT", e)
+        }
+    }
+
+    @ReactMethod
+    fun getSnapshotStats(promise: Promise) {
+        promise.resolve(toWritableMap(FlirManager.getSnapshotStats()))
+    }
+
+    // Pre-trigger history; options: seconds (0 disables), maxMB (default 32), keyframeInterval (default 10)
+    @ReactMethod
+    fun setFrameHistory(options: ReadableMap, promise: Promise) {
+        try {
+            val seconds = if (options.hasKey("seconds")) options.getDouble("seconds").toFloat() else 10f
+            val maxMB = if (options.hasKey("maxMB")) options.getDouble("maxMB") else 32.0
+            val interval = if (options.hasKey("keyframeInterval")) options.getInt("keyframeInterval") else 10
+            FlirManager.setFrameHistory(seconds, (maxMB * 1024 * 1024).toInt(), interval)
+            promise.resolve(null)
+        } catch (e: Exception) {
+            promise.reject("ERR_FLIR_HISTORY", e)
+        }
+    }
+
+    @ReactMethod
+    fun getFrameHistoryStats(promise: Promise) {
+        promise.resolve(toWritableMap(FlirManager.getFrameHistoryStats()))
+    }
+
+    // Resolves once the window is written, i.e. postSeconds after the call; options: path
+    @ReactMethod
+    fun captureWindow(preSeconds: Double, postSeconds: Double, options: ReadableMap?, promise: Promise) {
+        try {
+            val path = if (options != null && options.hasKey("path")) options.getString("path") else null
+            FlirManager.captureWindow(preSeconds.toFloat(), postSeconds.toFloat(), path) { stats, error ->
+                if (stats != null) promise.resolve(toWritableMap(stats)) else promise.reject("ERR_FLIR_HISTORY", error)
+            }
+        } catch (e: Exception) {
+            promise.reject("ERR_FLIR_HISTORY", e)
+        }
+    }
+
+    // Raw dump of every acquired frame for startReplay; options: path (defaults to the app's files directory)
+    @ReactMethod
+    fun startFrameDump(options: ReadableMap?, promise: Promise) {
+        try {
+            val path = if (options != null && options.hasKey("path")) options.getString("path") else null
+            promise.resolve(FlirManager.startDump(path))
+        } catch (e: Exception) {
+            promise.reject("ERR_FLIR_REPLAY", e)
+        }
+    }
+
+    @ReactMethod
+    fun stopFrameDump(promise: Promise) {
+        try {
+            val stats = FlirManager.stopDump()
+            if (stats == null) {
+                promise.reject("ERR_NO_DATA", "Not dumping")
+                return
+            }
+            promise.resolve(toWritableMap(stats))
+        } catch (e: Exception) {
+            promise.reject("ERR_FLIR_REPLAY", e)
+        }
+    }
+
+    // Plays a dump as a virtual camera; options: speed (1 = original timing, 0 = as fast as possible), loop
+    @ReactMethod
+    fun startReplay(path: String, options: ReadableMap?, promise: Promise) {
+        try {
+            val speed = if (options != null && options.hasKey("speed")) options.getDouble("speed").toFloat() else 1f
+            val loop = options != null && options.hasKey("loop") && options.getBoolean("loop")
+            FlirManager.startReplay(reactContext, path, speed, loop)
+            promise.resolve(null)
+        } catch (e: Exception) {
+            promise.reject("ERR_FLIR_REPLAY", e)
+        }
+    }
+
+    @ReactMethod
+    fun stopReplay(promise: Promise) {
+        val stats = FlirManager.stopReplay()
+        if (stats == null) {
+            promise.reject("ERR_NO_DATA", "Not replaying")
+            return
+        }
+        promise.resolve(toWritableMap(stats))
+    }
+
+    @ReactMethod
+    fun getReplayStats(promise: Promise) {
+        val stats = FlirManager.getReplayStats()
+        if (stats == null) {
+            promise.reject("ERR_NO_DATA", "Not replaying")
+            return
+        }
+        promise.resolve(toWritableMap(stats))
+    }
+
+    // Delivered frame rate adapts between minFps and maxFps depending on pipeline cost
+    @ReactMethod
+    fun setTargetFps(minFps: Double, maxFps: Double, promise: Promise) {
+        try {
+            FlirFrameGovernor.setTargetFps(minFps, maxFps)
+            promise.resolve(null)
+        } catch (e: Exception) {
+            promise.reject("ERR_FLIR_GOVERNOR", e)
+        }
+    }
+
+    @ReactMethod
+    fun setFrameBudget(budgetMs: Double, promise: Promise) {
+        try {
+            FlirFrameGovernor.setFrameBudget(budgetMs)
+            promise.resolve(null)
+        } catch (e: Exception) {
+            promise.reject("ERR_FLIR_GOVERNOR", e)
+        }
+    }
+
+    // Optional: JS reports the frameId of each FlirFrame event it finished handling
+    @ReactMethod
+    fun acknowledgeFrame(frameId: Double) {
+        FlirFrameGovernor.acknowledge(frameId.toLong(), System.nanoTime())
+    }
+
+    @ReactMethod
+    fun getFrameStats(promise: Promise) {
+        try {
+            promise.resolve(toWritableMap(FlirManager.getFrameStats()))
+        } catch (e: Exception) {
+            promise.reject("ERR_FLIR_GOVERNOR", e)
+        }
+    }
+
+    private fun toPointArray(points: ReadableArray): IntArray {
+        if (points.size() > 0 && points.getType(0) == ReadableType.Map) {
+            val out = IntArray(points.size() * 2)
+            for (i in 0 until points.size()) {
+                val point = points.getMap(i)
+                out[2 * i] = point?.getDouble("x")?.toInt() ?: -1
+                out[2 * i + 1] = point?.getDouble("y")?.toInt() ?: -1
+            }
+            return out
+        }
+        return IntArray(points.size()) { points.getDouble(it).toInt() }
+    }
+
+    private fun toWritableArray(values: FloatArray): WritableArray {
+        val array = Arguments.createArray()
+        for (value in values) {
+            if (value.isNaN()) array.pushNull() else array.pushDouble(value.toDouble())
+        }
+        return array
+    }
+
+    private fun toWritableMap(values: Map<String, Any>): WritableMap {
+        val map = Arguments.createMap()
+        values.forEach { (key, value) ->
+            when (value) {
+                is String -> map.putString(key, value)
+                is Boolean -> map.putBoolean(key, value)
+                is Int -> map.putInt(key, value)
+                is Long -> map.putDouble(key, value.toDouble())
+                is Double -> map.putDouble(key, value)
+                is Float -> map.putDouble(key, value.toDouble())
+            }
+        }
+        return map
+    }
 }
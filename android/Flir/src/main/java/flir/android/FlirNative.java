@@ -0,0 +1,53 @@
+package flir.android;
+
+import android.util.Log;
+
+import java.nio.ByteBuffer;
+
+/**
+ * libflirjsi: the JSI frame transport and the NEON pixel kernels of the frame worker
+ * (src/main/cpp). Callers keep a Java path for when the library cannot be loaded.
+ *
+ * Kernel buffers are direct RGBA_8888 buffers read from address 0; tables are the ones the
+ * calling class builds, and each kernel produces exactly what its Java fallback does.
+ */
+final class FlirNative {
+
+    private static final String TAG = "FlirNative";
+    private static Boolean loaded;
+
+    private FlirNative() {}
+
+    static synchronized boolean load() {
+        if (loaded == null) {
+            try {
+                System.loadLibrary("flirjsi");
+                loaded = true;
+            } catch (UnsatisfiedLinkError e) {
+                Log.e(TAG, "flirjsi not available", e);
+                loaded = false;
+            }
+        }
+        return loaded;
+    }
+
+    /** {@code tmp} holds {@code sh * dw} pixels. */
+    static native void upscaleBilinear(ByteBuffer in, int sw, int sh, ByteBuffer out, int dw, int dh,
+                                       int[] indexX, int[] weightX, int[] indexY, int[] weightY, ByteBuffer tmp);
+
+    static native void upscaleBicubic(ByteBuffer in, int sw, int sh, ByteBuffer out, int dw, int dh,
+                                      int[] indexX, int[] weightX, int[] indexY, int[] weightY, ByteBuffer tmp);
+
+    static native void upscaleJointBilateral(ByteBuffer in, int sw, ByteBuffer out, int dw, int dh,
+                                             int[] indexX, int[] weightX, int[] indexY, int[] weightY,
+                                             int[] guideHigh, int[] guideLow, int[] rangeWeights);
+
+    /** Fills {@code photoSmall} and {@code luma} (thermal resolution) from the photo. */
+    static native void fusionDownsample(ByteBuffer photo, int tw, int th, int[] sampleX0, int[] sampleX1,
+                                        int[] sampleY0, int[] sampleY1, int[] photoSmall, int[] luma);
+
+    static native void fusionBlend(ByteBuffer thermal, int[] photoSmall, int count, int alpha256);
+
+    /** {@code rowSums} is scratch of thermal size. */
+    static native void fusionDetail(ByteBuffer thermal, int[] luma, int[] rowSums, int tw, int th, int alpha256);
+}
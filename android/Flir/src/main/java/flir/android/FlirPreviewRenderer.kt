@@ -0,0 +1,117 @@
+package flir.android
+
+import android.graphics.Bitmap
+import android.graphics.Color
+import android.graphics.Matrix
+import android.graphics.Paint
+import android.view.Surface
+import java.util.concurrent.CopyOnWriteArrayList
+
+/**
+ * Draws processed frames straight into the SurfaceTextures of attached [FlirView]s.
+ *
+ * [render] runs on the frame worker thread for every frame, independent of the JS frame
+ * governor: the pooled bitmap is blitted into the locked surface buffer and posted, so the
+ * on-screen preview follows the sensor rate. Display latency is measured from the frame's
+ * arrival in the streaming callback to the buffer being posted.
+ */
+object FlirPreviewRenderer {
+    private const val EWMA_WEIGHT = 0.1
+
+    class Target(val surface: Surface, @Volatile var width: Int, @Volatile var height: Int) {
+        internal val matrix = Matrix()
+        internal var matrixKey = 0L
+    }
+
+    private val targets = CopyOnWriteArrayList<Target>()
+    private val paint = Paint(Paint.FILTER_BITMAP_FLAG)
+
+    @Volatile private var framesRendered = 0L
+    @Volatile private var lastLatencyMs = 0.0
+    @Volatile private var avgLatencyMs = 0.0
+
+    fun attach(surface: Surface, width: Int, height: Int): Target {
+        val target = Target(surface, width, height)
+        targets.add(target)
+        return target
+    }
+
+    /** Removes the target and releases its surface once no frame is being drawn into it. */
+    fun detach(target: Target) {
+        targets.remove(target)
+        synchronized(target) {
+            target.surface.release()
+        }
+    }
+
+    val hasTargets: Boolean
+        get() = targets.isNotEmpty()
+
+    /** Largest aspect-fit scale of a [width] x [height] frame over attached views, 0 when none. */
+    @JvmStatic
+    fun fitScale(width: Int, height: Int): Float {
+        var scale = 0f
+        for (target in targets) {
+            scale = maxOf(scale, minOf(target.width.toFloat() / width, target.height.toFloat() / height))
+        }
+        return scale
+    }
+
+    /** Called from the frame worker thread only. */
+    fun render(bmp: Bitmap, timestampNanos: Long) {
+        if (targets.isEmpty()) return
+        var posted = false
+        for (target in targets) {
+            synchronized(target) {
+                if (drawInto(target, bmp)) posted = true
+            }
+        }
+        if (posted && timestampNanos > 0) {
+            val latencyMs = (System.nanoTime() - timestampNanos) / 1_000_000.0
+            lastLatencyMs = latencyMs
+            avgLatencyMs = if (framesRendered == 0L) latencyMs else avgLatencyMs + EWMA_WEIGHT * (latencyMs - avgLatencyMs)
+            framesRendered++
+        }
+    }
+
+    private fun drawInto(target: Target, bmp: Bitmap): Boolean {
+        if (!target.surface.isValid || target.width <= 0 || target.height <= 0) return false
+        val canvas = try {
+            target.surface.lockHardwareCanvas()
+        } catch (e: Exception) {
+            return false
+        }
+        try {
+            canvas.drawColor(Color.BLACK)
+            canvas.drawBitmap(bmp, fitMatrix(target, bmp.width, bmp.height), paint)
+        } finally {
+            target.surface.unlockCanvasAndPost(canvas)
+        }
+        return true
+    }
+
+    fun stats(): Map<String, Any> = mapOf(
+        "framesRendered" to framesRendered,
+        "lastDisplayLatencyMs" to lastLatencyMs,
+        "avgDisplayLatencyMs" to avgLatencyMs
+    )
+
+    fun resetStats() {
+        framesRendered = 0
+        lastLatencyMs = 0.0
+        avgLatencyMs = 0.0
+    }
+
+    // Aspect-fit, centered; rebuilt only when the frame or surface size changes
+    private fun fitMatrix(target: Target, srcWidth: Int, srcHeight: Int): Matrix {
+        val key = (srcWidth.toLong() shl 48) or (srcHeight.toLong() shl 32) or
+            (target.width.toLong() shl 16) or target.height.toLong()
+        if (key != target.matrixKey) {
+            val scale = minOf(target.width.toFloat() / srcWidth, target.height.toFloat() / srcHeight)
+            target.matrix.setScale(scale, scale)
+            target.matrix.postTranslate((target.width - srcWidth * scale) / 2f, (target.height - srcHeight * scale) / 2f)
+            target.matrixKey = key
+        }
+        return target.matrix
+    }
+}
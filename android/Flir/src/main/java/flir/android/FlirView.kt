@@ -1,31 +1,46 @@
 package flir.android
 
-import android.content.Context
-import android.graphics.Color
+import android.graphics.SurfaceTexture
+import android.view.Surface
 import android.view.TextureView
 import android.widget.FrameLayout
-import android.widget.TextView
 import com.facebook.react.uimanager.ThemedReactContext
 
-class FlirView(context: ThemedReactContext) : FrameLayout(context) {
+class FlirView(context: ThemedReactContext) : FrameLayout(context), TextureView.SurfaceTextureListener {
     private val textureView: TextureView
+    private var renderTarget: FlirPreviewRenderer.Target? = null
 
     init {
         textureView = TextureView(context)
+        textureView.isOpaque = true
+        textureView.surfaceTextureListener = this
         layoutParams = LayoutParams(LayoutParams.MATCH_PARENT, LayoutParams.MATCH_PARENT)
         addView(textureView)
 
-        // Simple placeholder overlay to indicate native FLIR view
-        val overlay = TextView(context)
-        overlay.text = "FLIR Preview"
-        overlay.setTextColor(Color.WHITE)
-        overlay.setPadding(12, 12, 12, 12)
-        addView(overlay)
-
         // Ensure SDK is initialized
         FlirManager.init(context)
     }
 
+    // Frames are drawn into the SurfaceTexture by FlirPreviewRenderer on the frame worker thread
+    override fun onSurfaceTextureAvailable(surface: SurfaceTexture, width: Int, height: Int) {
+        renderTarget = FlirPreviewRenderer.attach(Surface(surface), width, height)
+    }
+
+    override fun onSurfaceTextureSizeChanged(surface: SurfaceTexture, width: Int, height: Int) {
+        renderTarget?.let {
+            it.width = width
+            it.height = height
+        }
+    }
+
+    override fun onSurfaceTextureDestroyed(surface: SurfaceTexture): Boolean {
+        renderTarget?.let { FlirPreviewRenderer.detach(it) }
+        renderTarget = null
+        return true
+    }
+
+    override fun onSurfaceTextureUpdated(surface: SurfaceTexture) {}
+
     override fun onAttachedToWindow() {
         super.onAttachedToWindow()
         // Let the centralized manager handle discovery and streaming and emit events
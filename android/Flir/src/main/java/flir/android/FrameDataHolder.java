@@ -6,9 +6,24 @@ public class FrameDataHolder {
     
     public final Bitmap msxBitmap;
     public final Bitmap dcBitmap;
+    // Celsius plane for this frame; null when radiometric capture failed
+    public final RadiometricFrame radiometric;
+    // Celsius plane cropped like the bitmaps when zoomed, otherwise the same as radiometric
+    public final RadiometricFrame viewRadiometric;
+    public final long sequence;
+    public final long timestampNanos;
 
     public FrameDataHolder(Bitmap msxBitmap, Bitmap dcBitmap) {
+        this(msxBitmap, dcBitmap, null, null, 0, System.nanoTime());
+    }
+
+    public FrameDataHolder(Bitmap msxBitmap, Bitmap dcBitmap, RadiometricFrame radiometric,
+                           RadiometricFrame viewRadiometric, long sequence, long timestampNanos) {
         this.msxBitmap = msxBitmap;
         this.dcBitmap = dcBitmap;
+        this.radiometric = radiometric;
+        this.viewRadiometric = viewRadiometric;
+        this.sequence = sequence;
+        this.timestampNanos = timestampNanos;
     }
 }
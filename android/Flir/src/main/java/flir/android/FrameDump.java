@@ -0,0 +1,272 @@
+package flir.android;
+
+import java.io.EOFException;
+import java.io.File;
+import java.io.FileInputStream;
+import java.io.FileOutputStream;
+import java.io.IOException;
+import java.nio.ByteBuffer;
+import java.nio.ByteOrder;
+import java.nio.channels.FileChannel;
+import java.nio.charset.StandardCharsets;
+import java.util.Arrays;
+
+/**
+ * Raw session dump: every ring slot exactly as the streaming callback filled it, before fusion,
+ * zoom or upscaling, so {@link FrameReplay} can feed it back through the whole pipeline.
+ *
+ * <pre>
+ * header   16 bytes   magic "FLIRDMP1", u32 version, reserved
+ * metadata u32 "DMTA", u32 length, u64 reserved, then UTF-8 JSON (camera information, thermal
+ *          parameters); written before the first frame and again whenever it changes
+ * frame    u32 "DFRM", u32 reserved, u64 timestamp (ns), then three planes:
+ *          colorized thermal (u32 width, u32 height, RGBA bytes), visual photo (same, 0x0
+ *          when absent) and Celsius (u32 width, u32 height, f32 values, 0x0 when absent)
+ * </pre>
+ *
+ * Version 1 dumps have no metadata records and are still replayed.
+ *
+ * Little-endian and uncompressed: dumps are meant for reproducing bugs and benchmarking, where
+ * replay cost must not depend on a decoder. Appends run on the frame worker.
+ */
+public final class FrameDump {
+
+    static final byte[] MAGIC = "FLIRDMP1".getBytes(StandardCharsets.US_ASCII);
+    static final int VERSION = 2;
+    static final int HEADER_SIZE = 16;
+    static final int FRAME_MAGIC = 0x4D524644; // "DFRM"
+    static final int METADATA_MAGIC = 0x41544D44; // "DMTA"
+    static final int FRAME_HEADER_SIZE = 16;
+
+    private final ByteBuffer header = ByteBuffer.allocate(FRAME_HEADER_SIZE + 8).order(ByteOrder.LITTLE_ENDIAN);
+    private ByteBuffer floats = ByteBuffer.allocate(0);
+    private FileChannel channel;
+    private File file;
+    // Stream metadata set by the streaming callback, and what this dump last wrote of it
+    private volatile String metadata;
+    private String metadataWritten;
+    private volatile long framesDumped;
+    private volatile long bytesDumped;
+
+    /** Starts a new dump; throws IllegalStateException while one is running. */
+    public synchronized void start(File file) throws IOException {
+        if (channel != null) throw new IllegalStateException("Already dumping to " + this.file);
+        FileChannel out = new FileOutputStream(file).getChannel();
+        ByteBuffer head = ByteBuffer.allocate(HEADER_SIZE).order(ByteOrder.LITTLE_ENDIAN);
+        head.put(MAGIC).putInt(VERSION).putInt(0).flip();
+        writeFully(out, head);
+        channel = out;
+        this.file = file;
+        metadataWritten = null;
+        framesDumped = 0;
+        bytesDumped = HEADER_SIZE;
+    }
+
+    /** Metadata of the current stream, written to the dump ahead of the next frame when it changed. */
+    public void setMetadata(String metadataJson) {
+        metadata = metadataJson;
+    }
+
+    /** Closes the dump and returns its file, or null when none was running. */
+    public synchronized File stop() throws IOException {
+        if (channel == null) return null;
+        channel.close();
+        channel = null;
+        return file;
+    }
+
+    public boolean isDumping() {
+        return channel != null;
+    }
+
+    public long getFramesDumped() {
+        return framesDumped;
+    }
+
+    public long getBytesDumped() {
+        return bytesDumped;
+    }
+
+    /** Called from the frame worker before the slot is modified; a write error ends the dump. */
+    public synchronized void append(FrameRing.Slot slot) {
+        if (channel == null) return;
+        try {
+            long start = channel.position();
+            writeMetadata();
+            header.clear();
+            header.putInt(FRAME_MAGIC).putInt(0).putLong(slot.timestampNanos).flip();
+            writeFully(channel, header);
+            writePlane(slot.thermal);
+            writePlane(slot.visual);
+            writeRadiometric(slot.hasRadiometric ? slot.radiometric : null);
+            framesDumped++;
+            bytesDumped += channel.position() - start;
+        } catch (IOException e) {
+            try {
+                stop();
+            } catch (IOException ignored) {
+            }
+        }
+    }
+
+    private void writeMetadata() throws IOException {
+        String json = metadata;
+        if (json == null || json.equals(metadataWritten)) return;
+        byte[] bytes = json.getBytes(StandardCharsets.UTF_8);
+        header.clear();
+        header.putInt(METADATA_MAGIC).putInt(bytes.length).putLong(0).flip();
+        writeFully(channel, header);
+        writeFully(channel, ByteBuffer.wrap(bytes));
+        metadataWritten = json;
+    }
+
+    private void writePlane(FrameRing.Plane plane) throws IOException {
+        boolean present = plane.width > 0 && plane.pixels != null;
+        writeSize(present ? plane.width : 0, present ? plane.height : 0);
+        if (!present) return;
+        ByteBuffer pixels = plane.pixels.duplicate();
+        pixels.clear().limit(plane.width * plane.height * 4);
+        writeFully(channel, pixels);
+    }
+
+    private void writeRadiometric(RadiometricFrame frame) throws IOException {
+        if (frame == null) {
+            writeSize(0, 0);
+            return;
+        }
+        int n = frame.width * frame.height;
+        writeSize(frame.width, frame.height);
+        if (floats.capacity() < n * 4) floats = ByteBuffer.allocate(n * 4).order(ByteOrder.LITTLE_ENDIAN);
+        floats.clear();
+        floats.asFloatBuffer().put(frame.celsius, 0, n);
+        floats.limit(n * 4);
+        writeFully(channel, floats);
+    }
+
+    private void writeSize(int width, int height) throws IOException {
+        header.clear();
+        header.putInt(width).putInt(height).flip();
+        writeFully(channel, header);
+    }
+
+    private static void writeFully(FileChannel out, ByteBuffer buffer) throws IOException {
+        while (buffer.hasRemaining()) out.write(buffer);
+    }
+
+    /** Sequential reader used by {@link FrameReplay}; reads straight into ring slots. */
+    static final class Reader implements AutoCloseable {
+        private final FileChannel channel;
+        private final ByteBuffer header = ByteBuffer.allocate(FRAME_HEADER_SIZE).order(ByteOrder.LITTLE_ENDIAN);
+        private ByteBuffer floats = ByteBuffer.allocate(0);
+        private long timestampNanos;
+        private String metadata;
+
+        Reader(File file) throws IOException {
+            channel = new FileInputStream(file).getChannel();
+            ByteBuffer head = ByteBuffer.allocate(HEADER_SIZE).order(ByteOrder.LITTLE_ENDIAN);
+            try {
+                readFully(head);
+                byte[] magic = new byte[MAGIC.length];
+                head.get(magic);
+                int version = head.getInt();
+                if (!Arrays.equals(magic, MAGIC) || version < 1 || version > VERSION) {
+                    throw new IOException("Not a frame dump: " + file);
+                }
+            } catch (IOException e) {
+                channel.close();
+                throw e;
+            }
+        }
+
+        /**
+         * Reads the next frame header, taking any metadata record before it; false at the end of
+         * the dump (a truncated tail counts as the end).
+         */
+        boolean next() throws IOException {
+            while (true) {
+                header.clear();
+                try {
+                    readFully(header);
+                } catch (EOFException e) {
+                    return false;
+                }
+                int magic = header.getInt();
+                int length = header.getInt();
+                if (magic == METADATA_MAGIC) {
+                    if (length < 0) throw new IOException("Corrupt frame dump at " + channel.position());
+                    ByteBuffer bytes = ByteBuffer.allocate(length);
+                    try {
+                        readFully(bytes);
+                    } catch (EOFException e) {
+                        return false;
+                    }
+                    metadata = new String(bytes.array(), 0, length, StandardCharsets.UTF_8);
+                    continue;
+                }
+                if (magic != FRAME_MAGIC) throw new IOException("Corrupt frame dump at " + channel.position());
+                timestampNanos = header.getLong();
+                return true;
+            }
+        }
+
+        long getTimestampNanos() {
+            return timestampNanos;
+        }
+
+        /** Metadata of the stream the current frame belongs to, or null when the dump has none. */
+        String getMetadata() {
+            return metadata;
+        }
+
+        /** Reads the planes of the current frame into {@code slot}. */
+        void readInto(FrameRing.Slot slot) throws IOException {
+            readPlane(slot.thermal);
+            readPlane(slot.visual);
+            int[] size = readSize();
+            int n = size[0] * size[1];
+            slot.hasRadiometric = n > 0;
+            if (n > 0) {
+                if (floats.capacity() < n * 4) floats = ByteBuffer.allocate(n * 4).order(ByteOrder.LITTLE_ENDIAN);
+                floats.clear().limit(n * 4);
+                readFully(floats);
+                slot.radiometric.fill(floats.asFloatBuffer(), size[0], size[1], 0, 0);
+            }
+        }
+
+        void rewind() throws IOException {
+            channel.position(HEADER_SIZE);
+        }
+
+        @Override
+        public void close() throws IOException {
+            channel.close();
+        }
+
+        private void readPlane(FrameRing.Plane plane) throws IOException {
+            int[] size = readSize();
+            int bytes = size[0] * size[1] * 4;
+            if (bytes == 0) {
+                plane.clear();
+                return;
+            }
+            plane.ensureCapacity(bytes);
+            plane.pixels.clear().limit(bytes);
+            readFully(plane.pixels);
+            plane.width = size[0];
+            plane.height = size[1];
+        }
+
+        private int[] readSize() throws IOException {
+            header.clear().limit(8);
+            readFully(header);
+            return new int[]{header.getInt(), header.getInt()};
+        }
+
+        private void readFully(ByteBuffer buffer) throws IOException {
+            while (buffer.hasRemaining()) {
+                if (channel.read(buffer) < 0) throw new EOFException();
+            }
+            buffer.flip();
+        }
+    }
+}
@@ -0,0 +1,316 @@
+package flir.android;
+
+import java.nio.ByteBuffer;
+import java.nio.IntBuffer;
+
+/**
+ * Combines the colorized thermal plane of a ring slot with its visual photo, in place.
+ *
+ * <ul>
+ *   <li>{@code msx}: the photo is box-downsampled to thermal resolution, its luma is
+ *       high-passed (luma minus 3x3 box blur) and the signed detail is added to every thermal
+ *       channel scaled by {@code alpha}, like MSX on the camera.</li>
+ *   <li>{@code blend}: the downsampled photo is mixed over the thermal image with opacity
+ *       {@code alpha}.</li>
+ *   <li>{@code pip}: the photo is scaled down into an inset rectangle of the thermal image,
+ *       which stays the primary image, so temperature coordinates keep their meaning.</li>
+ * </ul>
+ *
+ * Scratch arrays and sampling tables are sized per (thermal, photo) resolution pair and reused,
+ * so the per-frame cost only depends on the resolution. The msx and blend kernels run as NEON
+ * code in libflirjsi ({@link FlirNative}) straight on the slot buffers; the Java loops below are
+ * the fallback and process pixels as ints: the RGBA_8888 bytes of the little-endian slot
+ * buffers read as {@code 0xAABBGGRR}.
+ */
+public final class FrameFusion {
+
+    public static final String OFF = "off";
+    public static final String MSX = "msx";
+    public static final String BLEND = "blend";
+    public static final String PIP = "pip";
+
+    private static final double EWMA_WEIGHT = 0.1;
+
+    private final boolean nativeKernels = FlirNative.load();
+
+    /** Immutable configuration, swapped atomically from the bridge thread. */
+    private static final class Settings {
+        final String mode;
+        final int alpha256;
+        final float pipX;
+        final float pipY;
+        final float pipWidth;
+        final float pipHeight;
+
+        Settings(String mode, float alpha, float pipX, float pipY, float pipWidth, float pipHeight) {
+            this.mode = mode;
+            this.alpha256 = Math.round(Math.max(0f, Math.min(1f, alpha)) * 256f);
+            this.pipX = pipX;
+            this.pipY = pipY;
+            this.pipWidth = pipWidth;
+            this.pipHeight = pipHeight;
+        }
+    }
+
+    private volatile Settings settings = new Settings(OFF, 0.5f, 0.6f, 0.6f, 0.35f, 0.35f);
+
+    private volatile long framesFused;
+    private volatile double lastFusionMs;
+    private volatile double avgFusionMs;
+
+    // Worker-thread scratch, rebuilt only when a resolution changes
+    private int thermalWidth;
+    private int thermalHeight;
+    private int photoWidth;
+    private int photoHeight;
+    private int[] thermal = new int[0];
+    private int[] photo = new int[0];
+    private int[] photoSmall = new int[0];
+    private int[] luma = new int[0];
+    private int[] rowSums = new int[0];
+    private int[] sampleX0 = new int[0];
+    private int[] sampleX1 = new int[0];
+    private int[] sampleY0 = new int[0];
+    private int[] sampleY1 = new int[0];
+    private int[] pipRow = new int[0];
+
+    // Int views of the slot buffers; slot buffers are only replaced when a frame size grows
+    private ByteBuffer thermalBuffer;
+    private IntBuffer thermalView;
+    private ByteBuffer photoBuffer;
+    private IntBuffer photoView;
+
+    public static boolean isMode(String mode) {
+        return OFF.equals(mode) || MSX.equals(mode) || BLEND.equals(mode) || PIP.equals(mode);
+    }
+
+    /**
+     * @param alpha  msx detail strength or blend opacity, 0..1
+     * @param pipX   inset rectangle in fractions of the photo size (pip only)
+     */
+    public void configure(String mode, float alpha, float pipX, float pipY, float pipWidth, float pipHeight) {
+        if (!isMode(mode)) throw new IllegalArgumentException("Unknown fusion mode: " + mode);
+        settings = new Settings(mode, alpha, clamp01(pipX), clamp01(pipY), clamp01(pipWidth), clamp01(pipHeight));
+    }
+
+    public String getMode() {
+        return settings.mode;
+    }
+
+    /**
+     * Called from the frame worker thread only. Fuses the photo into the thermal plane in place
+     * and returns it, also when fusion is off or the frame has no photo.
+     */
+    public FrameRing.Plane apply(FrameRing.Plane thermalPlane, FrameRing.Plane photoPlane) {
+        Settings s = settings;
+        if (OFF.equals(s.mode) || photoPlane == null || photoPlane.getWidth() <= 0 || thermalPlane.getWidth() <= 0) {
+            return thermalPlane;
+        }
+
+        long start = System.nanoTime();
+        ensureScratch(thermalPlane.getWidth(), thermalPlane.getHeight(), photoPlane.getWidth(), photoPlane.getHeight());
+        if (PIP.equals(s.mode)) {
+            pictureInPicture(s, thermalView(thermalPlane.getPixels()), photoView(photoPlane.getPixels()));
+        } else if (nativeKernels) {
+            ByteBuffer pixels = thermalPlane.getPixels();
+            FlirNative.fusionDownsample(photoPlane.getPixels(), thermalWidth, thermalHeight,
+                    sampleX0, sampleX1, sampleY0, sampleY1, photoSmall, luma);
+            if (MSX.equals(s.mode)) {
+                FlirNative.fusionDetail(pixels, luma, rowSums, thermalWidth, thermalHeight, s.alpha256);
+            } else {
+                FlirNative.fusionBlend(pixels, photoSmall, thermalWidth * thermalHeight, s.alpha256);
+            }
+        } else {
+            IntBuffer tv = thermalView(thermalPlane.getPixels());
+            tv.clear();
+            tv.get(thermal, 0, thermalWidth * thermalHeight);
+            IntBuffer pv = photoView(photoPlane.getPixels());
+            pv.clear();
+            pv.get(photo, 0, photoWidth * photoHeight);
+            downsamplePhoto();
+            if (MSX.equals(s.mode)) {
+                addDetail(s.alpha256);
+            } else {
+                blend(s.alpha256);
+            }
+            tv.clear();
+            tv.put(thermal, 0, thermalWidth * thermalHeight);
+        }
+
+        double ms = (System.nanoTime() - start) / 1_000_000.0;
+        lastFusionMs = ms;
+        avgFusionMs = framesFused == 0 ? ms : avgFusionMs + EWMA_WEIGHT * (ms - avgFusionMs);
+        framesFused++;
+        return thermalPlane;
+    }
+
+    /** True when the msx and blend kernels run natively. */
+    public boolean isNative() {
+        return nativeKernels;
+    }
+
+    public long getFramesFused() {
+        return framesFused;
+    }
+
+    public double getLastFusionMs() {
+        return lastFusionMs;
+    }
+
+    public double getAvgFusionMs() {
+        return avgFusionMs;
+    }
+
+    public void resetStats() {
+        framesFused = 0;
+        lastFusionMs = 0;
+        avgFusionMs = 0;
+    }
+
+    private void ensureScratch(int tw, int th, int pw, int ph) {
+        if (tw == thermalWidth && th == thermalHeight && pw == photoWidth && ph == photoHeight) return;
+        int thermalCount = tw * th;
+        // The Java scratch is only needed without the native kernels
+        thermal = new int[nativeKernels ? 0 : thermalCount];
+        photo = new int[nativeKernels ? 0 : pw * ph];
+        photoSmall = new int[thermalCount];
+        luma = new int[thermalCount];
+        rowSums = new int[thermalCount];
+        pipRow = new int[tw];
+        // Two samples per axis at the quarter points of each thermal pixel's footprint
+        sampleX0 = new int[tw];
+        sampleX1 = new int[tw];
+        for (int x = 0; x < tw; x++) {
+            sampleX0[x] = Math.min(pw - 1, (int) ((x + 0.25) * pw / tw));
+            sampleX1[x] = Math.min(pw - 1, (int) ((x + 0.75) * pw / tw));
+        }
+        sampleY0 = new int[th];
+        sampleY1 = new int[th];
+        for (int y = 0; y < th; y++) {
+            sampleY0[y] = Math.min(ph - 1, (int) ((y + 0.25) * ph / th)) * pw;
+            sampleY1[y] = Math.min(ph - 1, (int) ((y + 0.75) * ph / th)) * pw;
+        }
+        thermalWidth = tw;
+        thermalHeight = th;
+        photoWidth = pw;
+        photoHeight = ph;
+    }
+
+    private IntBuffer thermalView(ByteBuffer pixels) {
+        if (pixels != thermalBuffer) {
+            thermalBuffer = pixels;
+            thermalView = ((ByteBuffer) pixels.duplicate().clear()).order(pixels.order()).asIntBuffer();
+        }
+        return thermalView;
+    }
+
+    private IntBuffer photoView(ByteBuffer pixels) {
+        if (pixels != photoBuffer) {
+            photoBuffer = pixels;
+            photoView = ((ByteBuffer) pixels.duplicate().clear()).order(pixels.order()).asIntBuffer();
+        }
+        return photoView;
+    }
+
+    // 2x2 average of the photo per thermal pixel, plus its luma
+    private void downsamplePhoto() {
+        int tw = thermalWidth;
+        for (int y = 0; y < thermalHeight; y++) {
+            int r0 = sampleY0[y];
+            int r1 = sampleY1[y];
+            int o = y * tw;
+            for (int x = 0; x < tw; x++) {
+                int a = photo[r0 + sampleX0[x]];
+                int b = photo[r0 + sampleX1[x]];
+                int c = photo[r1 + sampleX0[x]];
+                int d = photo[r1 + sampleX1[x]];
+                int r = ((a & 0xFF) + (b & 0xFF) + (c & 0xFF) + (d & 0xFF) + 2) >> 2;
+                int g = (((a >> 8) & 0xFF) + ((b >> 8) & 0xFF) + ((c >> 8) & 0xFF) + ((d >> 8) & 0xFF) + 2) >> 2;
+                int bl = (((a >> 16) & 0xFF) + ((b >> 16) & 0xFF) + ((c >> 16) & 0xFF) + ((d >> 16) & 0xFF) + 2) >> 2;
+                photoSmall[o + x] = 0xFF000000 | (bl << 16) | (g << 8) | r;
+                luma[o + x] = (77 * r + 150 * g + 29 * bl) >> 8;
+            }
+        }
+    }
+
+    // Unsharp high-pass of the luma (separable 3x3 box, edges clamped) added to each channel
+    private void addDetail(int alpha256) {
+        int tw = thermalWidth;
+        int th = thermalHeight;
+        int gain = alpha256 * 2;
+        for (int y = 0; y < th; y++) {
+            int o = y * tw;
+            for (int x = 0; x < tw; x++) {
+                int l = luma[o + Math.max(0, x - 1)];
+                int r = luma[o + Math.min(tw - 1, x + 1)];
+                rowSums[o + x] = l + luma[o + x] + r;
+            }
+        }
+        for (int y = 0; y < th; y++) {
+            int o = y * tw;
+            int up = Math.max(0, y - 1) * tw;
+            int down = Math.min(th - 1, y + 1) * tw;
+            for (int x = 0; x < tw; x++) {
+                int blur = (rowSums[up + x] + rowSums[o + x] + rowSums[down + x]) / 9;
+                int delta = ((luma[o + x] - blur) * gain) >> 8;
+                int p = thermal[o + x];
+                int r = clamp255((p & 0xFF) + delta);
+                int g = clamp255(((p >> 8) & 0xFF) + delta);
+                int b = clamp255(((p >> 16) & 0xFF) + delta);
+                thermal[o + x] = (p & 0xFF000000) | (b << 16) | (g << 8) | r;
+            }
+        }
+    }
+
+    private void blend(int alpha256) {
+        int inv = 256 - alpha256;
+        int count = thermalWidth * thermalHeight;
+        for (int i = 0; i < count; i++) {
+            int p = thermal[i];
+            int q = photoSmall[i];
+            int r = ((p & 0xFF) * inv + (q & 0xFF) * alpha256) >> 8;
+            int g = (((p >> 8) & 0xFF) * inv + ((q >> 8) & 0xFF) * alpha256) >> 8;
+            int b = (((p >> 16) & 0xFF) * inv + ((q >> 16) & 0xFF) * alpha256) >> 8;
+            thermal[i] = (p & 0xFF000000) | (b << 16) | (g << 8) | r;
+        }
+    }
+
+    // Photo scaled into the thermal inset, each inset pixel the mean of four photo samples at the
+    // quarter points of its footprint; only inset rows of the thermal plane are written
+    private void pictureInPicture(Settings s, IntBuffer thermalView, IntBuffer photoView) {
+        int x0 = Math.round(s.pipX * thermalWidth);
+        int y0 = Math.round(s.pipY * thermalHeight);
+        int w = Math.min(thermalWidth - x0, Math.round(s.pipWidth * thermalWidth));
+        int h = Math.min(thermalHeight - y0, Math.round(s.pipHeight * thermalHeight));
+        if (w <= 0 || h <= 0) return;
+        int pw = photoWidth;
+        int ph = photoHeight;
+        for (int y = 0; y < h; y++) {
+            int r0 = Math.min(ph - 1, (int) ((y + 0.25) * ph / h)) * pw;
+            int r1 = Math.min(ph - 1, (int) ((y + 0.75) * ph / h)) * pw;
+            for (int x = 0; x < w; x++) {
+                int c0 = Math.min(pw - 1, (int) ((x + 0.25) * pw / w));
+                int c1 = Math.min(pw - 1, (int) ((x + 0.75) * pw / w));
+                pipRow[x] = average(photoView.get(r0 + c0), photoView.get(r0 + c1),
+                        photoView.get(r1 + c0), photoView.get(r1 + c1));
+            }
+            thermalView.position((y0 + y) * thermalWidth + x0);
+            thermalView.put(pipRow, 0, w);
+        }
+    }
+
+    private static int average(int a, int b, int c, int d) {
+        int r = ((a & 0xFF) + (b & 0xFF) + (c & 0xFF) + (d & 0xFF) + 2) >> 2;
+        int g = (((a >> 8) & 0xFF) + ((b >> 8) & 0xFF) + ((c >> 8) & 0xFF) + ((d >> 8) & 0xFF) + 2) >> 2;
+        int bl = (((a >> 16) & 0xFF) + ((b >> 16) & 0xFF) + ((c >> 16) & 0xFF) + ((d >> 16) & 0xFF) + 2) >> 2;
+        return 0xFF000000 | (bl << 16) | (g << 8) | r;
+    }
+
+    private static int clamp255(int v) {
+        return v < 0 ? 0 : (v > 255 ? 255 : v);
+    }
+
+    private static float clamp01(float v) {
+        return Math.max(0f, Math.min(1f, v));
+    }
+}
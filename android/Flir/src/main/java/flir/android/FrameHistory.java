@@ -0,0 +1,352 @@
+package flir.android;
+
+import android.util.Log;
+
+import java.io.File;
+import java.io.IOException;
+import java.util.ArrayList;
+import java.util.Arrays;
+import java.util.List;
+import java.util.concurrent.ExecutorService;
+import java.util.concurrent.Executors;
+
+/**
+ * Pre-trigger history: the last few seconds of radiometric frames, encoded as in a
+ * {@code .flirrec} recording and kept in one fixed byte arena, so
+ * {@link #captureWindow} can write the seconds before an event.
+ *
+ * Frames are appended from the frame worker. Payloads are stored back to back and wrap at the
+ * end of the arena; the oldest frames are evicted when the arena, the entry table or the time
+ * limit runs out, always up to the next keyframe, so the history starts decodable. A capture
+ * copies the compressed pre-trigger frames, collects the post-trigger ones as they arrive and
+ * writes the recording on a background thread.
+ */
+public final class FrameHistory {
+
+    public interface CaptureListener {
+        /** Called on the writer thread once the window is on disk, or failed to be written. */
+        void written(Capture capture, Exception error);
+    }
+
+    /** One requested window: compressed frames copied out of the history, then written to a file. */
+    public static final class Capture {
+        final File file;
+        final long triggerNanos;
+        final long endNanos;
+        final String metadataJson;
+        final int keyframeInterval;
+        final CaptureListener listener;
+        byte[] data = new byte[64 * 1024];
+        int size;
+        // u64 timestamp, u64 offset, u64 length/flags/width/height per frame
+        long[] frames = new long[4 * 64];
+        int frameCount;
+        volatile long bytesWritten;
+        volatile double writeMs;
+
+        Capture(File file, long triggerNanos, long endNanos, String metadataJson, int keyframeInterval,
+                CaptureListener listener) {
+            this.file = file;
+            this.triggerNanos = triggerNanos;
+            this.endNanos = endNanos;
+            this.metadataJson = metadataJson;
+            this.keyframeInterval = keyframeInterval;
+            this.listener = listener;
+        }
+
+        void add(long timestampNanos, boolean keyframe, int width, int height, byte[] payload, int offset, int length) {
+            if (size + length > data.length) data = Arrays.copyOf(data, Math.max(data.length * 2, size + length));
+            System.arraycopy(payload, offset, data, size, length);
+            if (4 * (frameCount + 1) > frames.length) frames = Arrays.copyOf(frames, frames.length * 2);
+            int i = 4 * frameCount++;
+            frames[i] = timestampNanos;
+            frames[i + 1] = size;
+            frames[i + 2] = ((long) length << 1) | (keyframe ? 1 : 0);
+            frames[i + 3] = ((long) width << 32) | height;
+            size += length;
+        }
+
+        public File getFile() {
+            return file;
+        }
+
+        public int getFrameCount() {
+            return frameCount;
+        }
+
+        /** Seconds covered before the trigger; less than requested when the history was shorter. */
+        public double getPreSeconds() {
+            return frameCount > 0 ? Math.max(0, triggerNanos - frames[0]) / 1e9 : 0;
+        }
+
+        public double getPostSeconds() {
+            return frameCount > 0 ? Math.max(0, frames[4 * (frameCount - 1)] - triggerNanos) / 1e9 : 0;
+        }
+
+        public long getBytesWritten() {
+            return bytesWritten;
+        }
+
+        public double getWriteMs() {
+            return writeMs;
+        }
+    }
+
+    private static final String TAG = "FrameHistory";
+    // Entry table bound: up to 60 fps for the configured time
+    private static final int MAX_FPS = 60;
+
+    private final RadiometricEncoder encoder = new RadiometricEncoder();
+    private final List<Capture> pending = new ArrayList<>();
+    private ExecutorService writer;
+
+    private long windowNanos;
+    private int keyframeInterval = 10;
+    private byte[] arena = new byte[0];
+    private int head;
+    // Entry ring, oldest at first
+    private long[] timestamps = new long[0];
+    private int[] offsets = new int[0];
+    private int[] lengths = new int[0];
+    private boolean[] keyframes = new boolean[0];
+    private int first;
+    private int count;
+    private long bytesUsed;
+    private int width;
+    private int height;
+    private int sinceKeyframe;
+    // Stream metadata taken with the latest stored keyframe, written to captures
+    private String metadataJson;
+
+    private long framesEncoded;
+    private long encodeNanos;
+    private long capturesWritten;
+
+    /**
+     * Keeps up to {@code seconds} of history in at most {@code maxBytes}; 0 seconds disables
+     * the history and frees the arena. Drops the frames held so far.
+     */
+    public synchronized void configure(float seconds, int maxBytes, int keyframeInterval) {
+        windowNanos = (long) (Math.max(0f, seconds) * 1e9);
+        this.keyframeInterval = Math.max(1, keyframeInterval);
+        int entries = windowNanos > 0 ? (int) Math.ceil(seconds * MAX_FPS) + 1 : 0;
+        int bytes = windowNanos > 0 ? Math.max(0, maxBytes) : 0;
+        if (arena.length != bytes) arena = new byte[bytes];
+        if (timestamps.length != entries) {
+            timestamps = new long[entries];
+            offsets = new int[entries];
+            lengths = new int[entries];
+            keyframes = new boolean[entries];
+        }
+        clear();
+    }
+
+    public synchronized boolean isEnabled() {
+        return windowNanos > 0 && arena.length > 0;
+    }
+
+    /** Drops the held frames; pending captures are kept and finish with the frames they have. */
+    public synchronized void clear() {
+        head = 0;
+        first = 0;
+        count = 0;
+        bytesUsed = 0;
+        width = 0;
+        height = 0;
+        sinceKeyframe = 0;
+        metadataJson = null;
+    }
+
+    /**
+     * Frame worker only. {@code metadataJson} describes the stream the frame belongs to; it is
+     * kept with each keyframe, so captures carry it even after the stream has ended.
+     */
+    public synchronized void append(RadiometricFrame frame, String metadataJson) {
+        if (!isEnabled()) return;
+        long start = System.nanoTime();
+        if (frame.width != width || frame.height != height) {
+            width = frame.width;
+            height = frame.height;
+            sinceKeyframe = 0;
+        }
+        boolean keyframe = sinceKeyframe == 0;
+        int length = encoder.encode(frame.celsius, width, height, keyframe);
+        sinceKeyframe = (sinceKeyframe + 1) % keyframeInterval;
+        byte[] payload = encoder.output();
+        long timestamp = frame.timestampNanos;
+
+        for (int i = pending.size() - 1; i >= 0; i--) {
+            Capture capture = pending.get(i);
+            if (timestamp <= capture.endNanos) {
+                capture.add(timestamp, keyframe, width, height, payload, 0, length);
+            }
+            if (timestamp >= capture.endNanos) {
+                pending.remove(i);
+                submit(capture);
+            }
+        }
+        if (store(timestamp, keyframe, payload, length)) {
+            if (keyframe && metadataJson != null) this.metadataJson = metadataJson;
+            evictBefore(timestamp - windowNanos);
+        } else {
+            // Too large for the arena, or its keyframe was evicted: restart the delta chain
+            clear();
+        }
+        framesEncoded++;
+        encodeNanos += System.nanoTime() - start;
+    }
+
+    /**
+     * Writes the frames from {@code preSeconds} before now to {@code postSeconds} after now to
+     * {@code file}, starting at the keyframe at or before the window start. Returns immediately;
+     * {@code listener} is called once the file is written. Throws IllegalStateException when the
+     * history is disabled.
+     */
+    public synchronized Capture captureWindow(float preSeconds, float postSeconds, File file,
+                                              CaptureListener listener) {
+        if (!isEnabled()) throw new IllegalStateException("Frame history is disabled");
+        long trigger = System.nanoTime();
+        long windowStart = trigger - (long) (Math.max(0f, preSeconds) * 1e9);
+        Capture capture = new Capture(file, trigger, trigger + (long) (Math.max(0f, postSeconds) * 1e9),
+                metadataJson, keyframeInterval, listener);
+        int from = 0;
+        for (int i = 0; i < count; i++) {
+            int e = entry(i);
+            if (timestamps[e] > windowStart) break;
+            if (keyframes[e]) from = i;
+        }
+        for (int i = from; i < count; i++) {
+            int e = entry(i);
+            capture.add(timestamps[e], keyframes[e], width, height, arena, offsets[e], lengths[e]);
+        }
+        if (postSeconds > 0) {
+            pending.add(capture);
+        } else {
+            submit(capture);
+        }
+        return capture;
+    }
+
+    /** Writes pending captures with the frames collected so far, e.g. when the stream stops. */
+    public synchronized void flush() {
+        for (Capture capture : pending) submit(capture);
+        pending.clear();
+    }
+
+    public synchronized int getFrameCount() {
+        return count;
+    }
+
+    /** Time between the oldest and newest held frame. */
+    public synchronized double getSeconds() {
+        return count > 1 ? (timestamps[entry(count - 1)] - timestamps[first]) / 1e9 : 0;
+    }
+
+    public synchronized long getBytesUsed() {
+        return bytesUsed;
+    }
+
+    public synchronized int getCapacityBytes() {
+        return arena.length;
+    }
+
+    public synchronized double getAvgEncodeMs() {
+        return framesEncoded > 0 ? encodeNanos / 1e6 / framesEncoded : 0;
+    }
+
+    public synchronized int getCapturesPending() {
+        return pending.size();
+    }
+
+    public synchronized long getCapturesWritten() {
+        return capturesWritten;
+    }
+
+    private int entry(int i) {
+        return (first + i) % timestamps.length;
+    }
+
+    private boolean store(long timestamp, boolean keyframe, byte[] payload, int length) {
+        if (length > arena.length) return false;
+        if (head + length > arena.length) {
+            // Wrap: whatever is left past the write position is the oldest part of the history
+            while (count > 0 && offsets[first] >= head) evictOldest();
+            head = 0;
+        }
+        // Entries follow each other through the arena, so only the oldest can overlap the next write
+        while (count > 0 && overlaps(first, head, length)) evictOldest();
+        if (count == timestamps.length) evictOldest();
+        alignToKeyframe();
+        if (count == 0 && !keyframe) return false;
+        int e = entry(count++);
+        timestamps[e] = timestamp;
+        offsets[e] = head;
+        lengths[e] = length;
+        keyframes[e] = keyframe;
+        System.arraycopy(payload, 0, arena, head, length);
+        head += length;
+        bytesUsed += length;
+        return true;
+    }
+
+    private boolean overlaps(int e, int offset, int length) {
+        return offsets[e] < offset + length && offsets[e] + lengths[e] > offset;
+    }
+
+    // Drops whole keyframe groups once the next group alone still covers the cutoff
+    private void evictBefore(long cutoff) {
+        while (count > 1) {
+            int next = 1;
+            while (next < count && !keyframes[entry(next)]) next++;
+            if (next == count || timestamps[entry(next)] > cutoff) return;
+            for (int i = 0; i < next; i++) evictOldest();
+        }
+    }
+
+    private void alignToKeyframe() {
+        while (count > 0 && !keyframes[first]) evictOldest();
+    }
+
+    private void evictOldest() {
+        bytesUsed -= lengths[first];
+        first = (first + 1) % timestamps.length;
+        count--;
+    }
+
+    private void submit(Capture capture) {
+        if (writer == null) writer = Executors.newSingleThreadExecutor(r -> new Thread(r, "FlirHistoryWriter"));
+        writer.execute(() -> write(capture));
+    }
+
+    private void write(Capture capture) {
+        long start = System.nanoTime();
+        Exception error = null;
+        RadiometricRecorder recorder = new RadiometricRecorder(capture.file, capture.keyframeInterval);
+        try {
+            for (int i = 0; i < capture.frameCount; i++) {
+                long[] f = capture.frames;
+                int length = (int) (f[4 * i + 2] >>> 1);
+                boolean keyframe = (f[4 * i + 2] & 1) != 0;
+                recorder.appendEncoded((int) (f[4 * i + 3] >>> 32), (int) f[4 * i + 3], f[4 * i], keyframe,
+                        capture.data, (int) f[4 * i + 1], length, capture.metadataJson);
+            }
+        } catch (IOException e) {
+            Log.e(TAG, "capture write error", e);
+            error = e;
+        } finally {
+            try {
+                recorder.close();
+            } catch (IOException e) {
+                if (error == null) error = e;
+            }
+        }
+        capture.bytesWritten = recorder.getBytesWritten();
+        capture.writeMs = (System.nanoTime() - start) / 1e6;
+        // The copied frames are no longer needed once on disk
+        capture.data = null;
+        synchronized (this) {
+            capturesWritten++;
+        }
+        if (capture.listener != null) capture.listener.written(capture, error);
+    }
+}
@@ -0,0 +1,199 @@
+package flir.android;
+
+import android.util.Log;
+
+import java.io.EOFException;
+import java.io.File;
+import java.io.IOException;
+import java.util.concurrent.locks.LockSupport;
+
+/**
+ * Virtual camera: plays a {@link FrameDump} into the {@link FrameRing} from its own thread,
+ * exactly where the SDK streaming callback would, so fusion, zoom, upscaling, caching and
+ * emission all run as they do live.
+ *
+ * With a positive {@code speed} frames are published at their recorded spacing divided by the
+ * speed (1 = original timing). With {@link #FAST} the next frame is published as soon as the
+ * worker has taken the previous one, so every frame is processed and the run measures the
+ * pipeline itself.
+ */
+public final class FrameReplay implements Runnable {
+
+    public interface Listener {
+        /** Called on the replay thread when the dump ends, fails or the replay is stopped. */
+        void finished(FrameReplay replay, Exception error);
+
+        /**
+         * Called on the replay thread before the first frame of a stream is published, with the
+         * stream metadata recorded in the dump or null when it has none.
+         */
+        default void metadata(String metadataJson) {}
+    }
+
+    public static final float FAST = 0f;
+
+    private static final String TAG = "FrameReplay";
+    private static final long FAST_POLL_NANOS = 100_000;
+    private static final long STOP_TIMEOUT_MS = 1000;
+
+    private final File file;
+    private final float speed;
+    private final boolean loop;
+    private final FrameRing ring;
+    private final RadiometricBuffer radiometricBuffer;
+    private final Listener listener;
+    // Frames read while the ring has no free slot (cannot happen with one consumer, kept as a guard)
+    private final FrameRing.Slot discard = new FrameRing.Slot(-1);
+    private volatile boolean running;
+    private Thread thread;
+
+    private volatile long framesReplayed;
+    private volatile long startNanos;
+    private volatile long endNanos;
+    private volatile long maxLagNanos;
+
+    public FrameReplay(File file, float speed, boolean loop, FrameRing ring, RadiometricBuffer radiometricBuffer,
+                       Listener listener) {
+        this.file = file;
+        this.speed = Math.max(FAST, speed);
+        this.loop = loop;
+        this.ring = ring;
+        this.radiometricBuffer = radiometricBuffer;
+        this.listener = listener;
+    }
+
+    public synchronized void start() {
+        if (running) return;
+        running = true;
+        thread = new Thread(this, "FlirFrameReplay");
+        thread.start();
+    }
+
+    /**
+     * Stops the replay and waits, up to a second, for its thread to end, so no frame of this
+     * replay is published into the ring afterwards. The listener runs before this returns.
+     */
+    public void stop() {
+        Thread current;
+        synchronized (this) {
+            running = false;
+            current = thread;
+            thread = null;
+        }
+        if (current == null) return;
+        current.interrupt();
+        if (current == Thread.currentThread()) return;
+        try {
+            current.join(STOP_TIMEOUT_MS);
+        } catch (InterruptedException e) {
+            Thread.currentThread().interrupt();
+        }
+        if (current.isAlive()) Log.w(TAG, "replay thread did not stop within " + STOP_TIMEOUT_MS + " ms");
+    }
+
+    public boolean isRunning() {
+        return running;
+    }
+
+    public File getFile() {
+        return file;
+    }
+
+    public float getSpeed() {
+        return speed;
+    }
+
+    public long getFramesReplayed() {
+        return framesReplayed;
+    }
+
+    /** Wall time since the first frame, up to the last one once finished. */
+    public double getElapsedMs() {
+        long start = startNanos;
+        if (start == 0) return 0;
+        long end = running ? System.nanoTime() : endNanos;
+        return (end - start) / 1_000_000.0;
+    }
+
+    /** Largest delay of a paced frame behind its schedule; 0 in fast mode. */
+    public double getMaxLagMs() {
+        return maxLagNanos / 1_000_000.0;
+    }
+
+    @Override
+    public void run() {
+        Exception error = null;
+        try (FrameDump.Reader reader = new FrameDump.Reader(file)) {
+            long firstTimestamp = -1;
+            long wallStart = 0;
+            boolean metadataPublished = false;
+            String metadata = null;
+            while (running) {
+                if (!reader.next()) {
+                    if (!loop || framesReplayed == 0) break;
+                    reader.rewind();
+                    firstTimestamp = -1;
+                    continue;
+                }
+                long now = System.nanoTime();
+                if (firstTimestamp < 0) {
+                    firstTimestamp = reader.getTimestampNanos();
+                    wallStart = now;
+                    if (startNanos == 0) startNanos = now;
+                }
+                if (speed > FAST) {
+                    long due = wallStart + (long) ((reader.getTimestampNanos() - firstTimestamp) / speed);
+                    while (running && (now = System.nanoTime()) < due) LockSupport.parkNanos(this, due - now);
+                    maxLagNanos = Math.max(maxLagNanos, now - due);
+                } else {
+                    while (running && ring.depth() > 0) LockSupport.parkNanos(this, FAST_POLL_NANOS);
+                }
+                if (!running) break;
+                if (!metadataPublished || reader.getMetadata() != metadata) {
+                    metadata = reader.getMetadata();
+                    metadataPublished = true;
+                    if (listener != null) listener.metadata(metadata);
+                }
+                publish(reader);
+            }
+        } catch (EOFException e) {
+            // Truncated last frame: the dump was not closed cleanly
+        } catch (IOException e) {
+            Log.e(TAG, "replay error", e);
+            error = e;
+        } finally {
+            endNanos = System.nanoTime();
+            running = false;
+        }
+        if (listener != null) listener.finished(this, error);
+    }
+
+    // Same steps as the streaming callback: fill a slot, publish the Celsius plane for queries.
+    // A stop while the slot is filled abandons it, so a stopped replay never publishes a frame.
+    private void publish(FrameDump.Reader reader) throws IOException {
+        FrameRing.Slot slot = running ? ring.beginWrite() : null;
+        if (slot == null) {
+            reader.readInto(discard);
+            return;
+        }
+        try {
+            reader.readInto(slot);
+        } catch (IOException e) {
+            ring.abortWrite(slot);
+            throw e;
+        }
+        if (!running) {
+            ring.abortWrite(slot);
+            return;
+        }
+        long now = System.nanoTime();
+        if (slot.hasRadiometric) {
+            RadiometricFrame published = radiometricBuffer.publish(slot.radiometric, now);
+            slot.radiometric.sequence = published.sequence;
+            slot.radiometric.timestampNanos = now;
+        }
+        slot.timestampNanos = now;
+        ring.endWrite(slot);
+        framesReplayed++;
+    }
+}
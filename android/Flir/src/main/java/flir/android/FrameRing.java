@@ -0,0 +1,218 @@
+package flir.android;
+
+import com.flir.thermalsdk.image.ImageBuffer;
+
+import java.nio.ByteBuffer;
+import java.nio.ByteOrder;
+import java.util.concurrent.TimeUnit;
+import java.util.concurrent.atomic.AtomicIntegerArray;
+import java.util.concurrent.atomic.AtomicLong;
+import java.util.concurrent.locks.LockSupport;
+
+/**
+ * Single-producer/single-consumer handoff between the SDK streaming callback and the frame
+ * worker. Slots are allocated up front and reused; when the consumer falls behind the
+ * producer overwrites the oldest unconsumed frame instead of waiting.
+ */
+public final class FrameRing {
+
+    private static final int FREE = 0;
+    private static final int WRITING = 1;
+    private static final int READY = 2;
+    private static final int READING = 3;
+
+    /** One pre-allocated frame: colorized thermal pixels, optional visual photo and radiometry. */
+    public static final class Slot {
+        final int index;
+        final Plane thermal = new Plane();
+        final Plane visual = new Plane();
+        final RadiometricFrame radiometric = new RadiometricFrame();
+        boolean hasRadiometric;
+        long sequence;
+        long timestampNanos;
+
+        Slot(int index) {
+            this.index = index;
+        }
+
+        public Plane getThermal() {
+            return thermal;
+        }
+
+        /** Visual photo pixels, or null when the frame has no fusion photo. */
+        public Plane getVisual() {
+            return visual.width > 0 ? visual : null;
+        }
+
+        public RadiometricFrame getRadiometric() {
+            return hasRadiometric ? radiometric : null;
+        }
+
+        public long getSequence() {
+            return sequence;
+        }
+
+        public long getTimestampNanos() {
+            return timestampNanos;
+        }
+    }
+
+    // Pixel buffer allocations across all rings; flat once streaming reaches steady state
+    private static final AtomicLong bufferAllocations = new AtomicLong();
+
+    /** RGBA_8888 pixels in a direct buffer that is only reallocated when the size grows. */
+    public static final class Plane {
+        ByteBuffer pixels;
+        int width;
+        int height;
+
+        public ByteBuffer getPixels() {
+            return pixels;
+        }
+
+        public int getWidth() {
+            return width;
+        }
+
+        public int getHeight() {
+            return height;
+        }
+
+        void copyFrom(ImageBuffer image) {
+            int w = image.getWidth();
+            int h = image.getHeight();
+            ensureCapacity(w * h * 4);
+            pixels.clear();
+            image.with(src -> {
+                src.rewind();
+                pixels.put(src);
+            });
+            pixels.flip();
+            width = w;
+            height = h;
+        }
+
+        void ensureCapacity(int bytes) {
+            if (pixels == null || pixels.capacity() < bytes) {
+                pixels = ByteBuffer.allocateDirect(bytes).order(ByteOrder.nativeOrder());
+                bufferAllocations.incrementAndGet();
+            }
+        }
+
+        void clear() {
+            width = 0;
+            height = 0;
+        }
+    }
+
+    private final Slot[] slots;
+    private final AtomicIntegerArray states;
+    private int writeIndex;
+    private long sequence;
+    private volatile Thread consumer;
+
+    private final AtomicLong published = new AtomicLong();
+    private final AtomicLong overwritten = new AtomicLong();
+    private final AtomicLong consumed = new AtomicLong();
+
+    public FrameRing(int capacity) {
+        int n = Math.max(2, capacity);
+        slots = new Slot[n];
+        states = new AtomicIntegerArray(n);
+        for (int i = 0; i < n; i++) {
+            slots[i] = new Slot(i);
+        }
+    }
+
+    /**
+     * Producer: claims the next slot for writing. A ready but unconsumed slot is taken over
+     * (counted as overwritten); the slot the consumer is reading is skipped.
+     */
+    public Slot beginWrite() {
+        for (int tries = 0; tries < slots.length; tries++) {
+            int i = writeIndex;
+            writeIndex = (writeIndex + 1) % slots.length;
+            if (states.compareAndSet(i, FREE, WRITING)) {
+                return slots[i];
+            }
+            if (states.compareAndSet(i, READY, WRITING)) {
+                overwritten.incrementAndGet();
+                return slots[i];
+            }
+        }
+        return null;
+    }
+
+    public void endWrite(Slot slot) {
+        slot.sequence = ++sequence;
+        states.set(slot.index, READY);
+        published.incrementAndGet();
+        Thread waiting = consumer;
+        if (waiting != null) LockSupport.unpark(waiting);
+    }
+
+    /** Producer: gives a claimed slot back without publishing it (e.g. after a copy error). */
+    public void abortWrite(Slot slot) {
+        states.set(slot.index, FREE);
+    }
+
+    /**
+     * Consumer: takes the oldest ready slot, parking up to {@code timeoutMs} when there is
+     * none. Returns null on timeout or interrupt.
+     */
+    public Slot take(long timeoutMs) {
+        consumer = Thread.currentThread();
+        long deadline = System.nanoTime() + TimeUnit.MILLISECONDS.toNanos(timeoutMs);
+        while (true) {
+            Slot slot = claimOldestReady();
+            if (slot != null) return slot;
+            long remaining = deadline - System.nanoTime();
+            if (remaining <= 0 || Thread.interrupted()) return null;
+            LockSupport.parkNanos(this, remaining);
+        }
+    }
+
+    public void release(Slot slot) {
+        consumed.incrementAndGet();
+        states.set(slot.index, FREE);
+    }
+
+    /** Number of published frames waiting for the consumer. */
+    public int depth() {
+        int depth = 0;
+        for (int i = 0; i < slots.length; i++) {
+            if (states.get(i) == READY) depth++;
+        }
+        return depth;
+    }
+
+    public long getPublished() {
+        return published.get();
+    }
+
+    public long getOverwritten() {
+        return overwritten.get();
+    }
+
+    public long getConsumed() {
+        return consumed.get();
+    }
+
+    public static long getBufferAllocations() {
+        return bufferAllocations.get();
+    }
+
+    private Slot claimOldestReady() {
+        while (true) {
+            Slot oldest = null;
+            for (int i = 0; i < slots.length; i++) {
+                if (states.get(i) == READY && (oldest == null || slots[i].sequence < oldest.sequence)) {
+                    oldest = slots[i];
+                }
+            }
+            if (oldest == null) return null;
+            // The producer may have reclaimed it in the meantime; rescan in that case
+            if (states.compareAndSet(oldest.index, READY, READING)) return oldest;
+        }
+    }
+}
@@ -0,0 +1,505 @@
+package flir.android;
+
+import java.nio.ByteBuffer;
+import java.nio.ByteOrder;
+import java.nio.IntBuffer;
+
+/**
+ * Upscales the presented frame on the frame worker before it is copied into a pooled bitmap,
+ * so low-resolution sensors are not left to whatever filtering the view applies.
+ *
+ * Kernels are separable fixed-point passes over packed {@code 0xAABBGGRR} ints with per-size
+ * index and weight tables: {@code nearest}, {@code bilinear}, {@code bicubic} (Catmull-Rom) and
+ * {@code jointBilateral}, which weights the 2x2 low-resolution neighbourhood of each output
+ * pixel by how closely the visual photo's luma there matches the photo at the output pixel,
+ * keeping thermal edges on object boundaries. Without a photo it falls back to bicubic.
+ * The bilinear, bicubic and joint-bilateral passes run as NEON kernels in libflirjsi
+ * ({@link FlirNative}); the Java loops below are the fallback and the reference.
+ *
+ * Nothing is upscaled when the frame already fills the attached preview view, and the output
+ * never exceeds it.
+ */
+public final class FrameUpscaler {
+
+    public static final String OFF = "off";
+    public static final String NEAREST = "nearest";
+    public static final String BILINEAR = "bilinear";
+    public static final String BICUBIC = "bicubic";
+    public static final String JOINT_BILATERAL = "jointBilateral";
+
+    public static final float MAX_SCALE = 4f;
+    // Scale used in fit-to-view mode while no preview view is attached
+    private static final float DEFAULT_FIT_SCALE = 2f;
+    private static final double EWMA_WEIGHT = 0.1;
+    private static final int CUBIC_BITS = 12;
+    private static final float RANGE_SIGMA = 24f;
+
+    private static final class Settings {
+        final String kernel;
+        final float scale;
+
+        Settings(String kernel, float scale) {
+            this.kernel = kernel;
+            this.scale = scale;
+        }
+    }
+
+    private volatile Settings settings = new Settings(OFF, 0f);
+
+    private volatile long framesUpscaled;
+    private volatile double lastUpscaleMs;
+    private volatile double avgUpscaleMs;
+    private volatile int outputWidth;
+    private volatile int outputHeight;
+
+    // Worker-thread scratch; tables are rebuilt when the kernel or either size changes
+    private String tableKernel;
+    private int srcWidth;
+    private int srcHeight;
+    private int dstWidth;
+    private int dstHeight;
+    private int[] src = new int[0];
+    private int[] tmp = new int[0];
+    private int[] dst = new int[0];
+    private int[] indexX = new int[0];
+    private int[] indexY = new int[0];
+    private int[] weightX = new int[0];
+    private int[] weightY = new int[0];
+    private int[] guideHigh = new int[0];
+    private int[] guideLow = new int[0];
+    private final int[] rangeWeights = new int[256];
+
+    // Native path: pixels stay in direct buffers, tmp holds the horizontal pass
+    private final boolean nativeKernels = FlirNative.load();
+    private ByteBuffer nativeTmp;
+
+    private ByteBuffer inputBuffer;
+    private IntBuffer inputView;
+    private IntBuffer photoView;
+    private ByteBuffer photoBuffer;
+    private final FrameRing.Plane output = new FrameRing.Plane();
+    private IntBuffer outputView;
+
+    public FrameUpscaler() {
+        for (int d = 0; d < 256; d++) {
+            rangeWeights[d] = Math.round(256f * (float) Math.exp(-(d * d) / (2f * RANGE_SIGMA * RANGE_SIGMA)));
+        }
+    }
+
+    public static boolean isKernel(String kernel) {
+        return OFF.equals(kernel) || NEAREST.equals(kernel) || BILINEAR.equals(kernel)
+                || BICUBIC.equals(kernel) || JOINT_BILATERAL.equals(kernel);
+    }
+
+    /**
+     * @param scale  output scale factor up to {@link #MAX_SCALE}; 0 fits the largest attached
+     *               preview view
+     */
+    public void configure(String kernel, float scale) {
+        if (!isKernel(kernel)) throw new IllegalArgumentException("Unknown upscale kernel: " + kernel);
+        settings = new Settings(kernel, Math.max(0f, Math.min(MAX_SCALE, scale)));
+    }
+
+    public String getKernel() {
+        return settings.kernel;
+    }
+
+    /**
+     * Called from the frame worker thread only. Returns the upscaled plane, owned by this
+     * upscaler and overwritten by the next frame, or {@code input} when no scaling applies.
+     */
+    public FrameRing.Plane apply(FrameRing.Plane input, FrameRing.Plane photo) {
+        Settings s = settings;
+        int sw = input.getWidth();
+        int sh = input.getHeight();
+        if (OFF.equals(s.kernel) || sw <= 0 || sh <= 0) return input;
+        // A zoomed-out crop that already covers the view gains nothing from more pixels
+        float view = FlirPreviewRenderer.fitScale(sw, sh);
+        if (view > 0 && view <= 1f) return input;
+        float scale = s.scale > 0 ? (view > 0 ? Math.min(s.scale, view) : s.scale) : fitScale(view);
+        int dw = Math.round(sw * scale);
+        int dh = Math.round(sh * scale);
+        if (dw <= sw && dh <= sh) return input;
+
+        long start = System.nanoTime();
+        upscale(s.kernel, input, photo, dw, dh);
+
+        double ms = (System.nanoTime() - start) / 1_000_000.0;
+        lastUpscaleMs = ms;
+        avgUpscaleMs = framesUpscaled == 0 ? ms : avgUpscaleMs + EWMA_WEIGHT * (ms - avgUpscaleMs);
+        framesUpscaled++;
+        outputWidth = dw;
+        outputHeight = dh;
+        return output;
+    }
+
+    /**
+     * Times {@code kernel} on a synthetic frame of the given size, with a synthetic photo guide
+     * for the joint-bilateral kernel. Returns the mean milliseconds per frame.
+     */
+    public static double benchmark(String kernel, int width, int height, float scale, int iterations) {
+        FrameUpscaler upscaler = new FrameUpscaler();
+        int[] frame = new int[width * height];
+        for (int i = 0; i < frame.length; i++) {
+            int v = (i * 31 + (i / width) * 17) & 0xFF;
+            frame[i] = 0xFF000000 | (v << 16) | ((255 - v) << 8) | v;
+        }
+        int pw = width * 4;
+        int ph = height * 4;
+        int[] photo = new int[pw * ph];
+        for (int i = 0; i < photo.length; i++) {
+            int v = ((i % pw) ^ (i / pw)) & 0xFF;
+            photo[i] = 0xFF000000 | (v << 16) | (v << 8) | v;
+        }
+        FrameRing.Plane input = plane(frame, width, height);
+        FrameRing.Plane guide = plane(photo, pw, ph);
+        int dw = Math.round(width * scale);
+        int dh = Math.round(height * scale);
+        upscaler.upscale(kernel, input, guide, dw, dh);
+        long start = System.nanoTime();
+        for (int i = 0; i < iterations; i++) {
+            upscaler.upscale(kernel, input, guide, dw, dh);
+        }
+        return (System.nanoTime() - start) / 1_000_000.0 / Math.max(1, iterations);
+    }
+
+    public long getFramesUpscaled() {
+        return framesUpscaled;
+    }
+
+    public double getLastUpscaleMs() {
+        return lastUpscaleMs;
+    }
+
+    public double getAvgUpscaleMs() {
+        return avgUpscaleMs;
+    }
+
+    public int getOutputWidth() {
+        return outputWidth;
+    }
+
+    public int getOutputHeight() {
+        return outputHeight;
+    }
+
+    public void resetStats() {
+        framesUpscaled = 0;
+        lastUpscaleMs = 0;
+        avgUpscaleMs = 0;
+        outputWidth = 0;
+        outputHeight = 0;
+    }
+
+    /** True when the bilinear, bicubic and joint-bilateral kernels run natively. */
+    public boolean isNative() {
+        return nativeKernels;
+    }
+
+    private static float fitScale(float view) {
+        return Math.min(MAX_SCALE, view > 0 ? view : DEFAULT_FIT_SCALE);
+    }
+
+    private static FrameRing.Plane plane(int[] pixels, int width, int height) {
+        FrameRing.Plane plane = new FrameRing.Plane();
+        plane.pixels = ByteBuffer.allocateDirect(pixels.length * 4).order(ByteOrder.nativeOrder());
+        plane.pixels.asIntBuffer().put(pixels);
+        plane.width = width;
+        plane.height = height;
+        return plane;
+    }
+
+    private static IntBuffer view(ByteBuffer pixels, ByteBuffer cachedBuffer, IntBuffer cachedView) {
+        if (pixels == cachedBuffer && cachedView != null) return cachedView;
+        return ((ByteBuffer) pixels.duplicate().clear()).order(pixels.order()).asIntBuffer();
+    }
+
+    private int[] photoPixels = new int[0];
+
+    private int[] readGuide(IntBuffer view, int pw, int ph) {
+        if (photoPixels.length < pw * ph) photoPixels = new int[pw * ph];
+        view.clear();
+        view.get(photoPixels, 0, pw * ph);
+        return photoPixels;
+    }
+
+    // Scales input to dw x dh into the output plane; photo guides the joint-bilateral kernel
+    private void upscale(String kernel, FrameRing.Plane input, FrameRing.Plane photo, int dw, int dh) {
+        int sw = input.getWidth();
+        int sh = input.getHeight();
+        int[] guide = null;
+        int pw = 0;
+        int ph = 0;
+        if (JOINT_BILATERAL.equals(kernel) && photo != null && photo != input && photo.getWidth() > 0) {
+            photoView = view(photo.getPixels(), photoBuffer, photoView);
+            photoBuffer = photo.getPixels();
+            pw = photo.getWidth();
+            ph = photo.getHeight();
+            guide = readGuide(photoView, pw, ph);
+        }
+        if (JOINT_BILATERAL.equals(kernel) && guide == null) kernel = BICUBIC;
+        ensureTables(kernel, sw, sh, dw, dh);
+        if (JOINT_BILATERAL.equals(kernel)) ensureGuide(guide, pw, ph);
+
+        int bytes = dw * dh * 4;
+        if (output.pixels == null || output.pixels.capacity() < bytes) {
+            output.pixels = ByteBuffer.allocateDirect(bytes).order(ByteOrder.nativeOrder());
+            outputView = output.pixels.asIntBuffer();
+        }
+        if (!NEAREST.equals(kernel) && nativeKernels) {
+            upscaleNative(kernel, input.getPixels(), sw, sh, dw, dh);
+        } else {
+            if (src.length < sw * sh) src = new int[sw * sh];
+            inputView = view(input.getPixels(), inputBuffer, inputView);
+            inputBuffer = input.getPixels();
+            inputView.clear();
+            inputView.get(src, 0, sw * sh);
+            switch (kernel) {
+                case NEAREST:
+                    nearest(src, sw);
+                    break;
+                case BILINEAR:
+                    bilinear(src, sw, sh);
+                    break;
+                case JOINT_BILATERAL:
+                    jointBilateral(src, sw);
+                    break;
+                default:
+                    bicubic(src, sw, sh);
+                    break;
+            }
+            outputView.clear();
+            outputView.put(dst, 0, dw * dh);
+        }
+        output.pixels.clear().limit(bytes);
+        output.width = dw;
+        output.height = dh;
+    }
+
+    private void upscaleNative(String kernel, ByteBuffer in, int sw, int sh, int dw, int dh) {
+        if (JOINT_BILATERAL.equals(kernel)) {
+            FlirNative.upscaleJointBilateral(in, sw, output.pixels, dw, dh, indexX, weightX, indexY, weightY,
+                    guideHigh, guideLow, rangeWeights);
+            return;
+        }
+        int tmpBytes = sh * dw * 4;
+        if (nativeTmp == null || nativeTmp.capacity() < tmpBytes) {
+            nativeTmp = ByteBuffer.allocateDirect(tmpBytes).order(ByteOrder.nativeOrder());
+        }
+        if (BILINEAR.equals(kernel)) {
+            FlirNative.upscaleBilinear(in, sw, sh, output.pixels, dw, dh, indexX, weightX, indexY, weightY, nativeTmp);
+        } else {
+            FlirNative.upscaleBicubic(in, sw, sh, output.pixels, dw, dh, indexX, weightX, indexY, weightY, nativeTmp);
+        }
+    }
+
+    private void ensureTables(String kernel, int sw, int sh, int dw, int dh) {
+        if (kernel.equals(tableKernel) && sw == srcWidth && sh == srcHeight && dw == dstWidth && dh == dstHeight) return;
+        int taps = BICUBIC.equals(kernel) ? 4 : (NEAREST.equals(kernel) ? 1 : 2);
+        indexX = new int[dw * taps];
+        weightX = new int[dw * taps];
+        indexY = new int[dh * taps];
+        weightY = new int[dh * taps];
+        buildAxis(taps, sw, dw, indexX, weightX);
+        buildAxis(taps, sh, dh, indexY, weightY);
+        // The Java scratch is only needed without the native kernels
+        tmp = nativeKernels && !NEAREST.equals(kernel) ? new int[0] : new int[sh * dw];
+        dst = nativeKernels && !NEAREST.equals(kernel) ? new int[0] : new int[dw * dh];
+        tableKernel = kernel;
+        srcWidth = sw;
+        srcHeight = sh;
+        dstWidth = dw;
+        dstHeight = dh;
+    }
+
+    // Edge-clamped source indices and fixed-point weights per output position
+    private static void buildAxis(int taps, int srcSize, int dstSize, int[] index, int[] weight) {
+        float ratio = (float) srcSize / dstSize;
+        for (int d = 0; d < dstSize; d++) {
+            float pos = (d + 0.5f) * ratio - 0.5f;
+            int o = d * taps;
+            if (taps == 1) {
+                index[o] = Math.min(srcSize - 1, (int) ((d + 0.5f) * ratio));
+                weight[o] = 1;
+                continue;
+            }
+            int base = (int) Math.floor(pos);
+            float t = pos - base;
+            if (taps == 2) {
+                index[o] = clamp(base, srcSize);
+                index[o + 1] = clamp(base + 1, srcSize);
+                weight[o + 1] = Math.round(t * 256f);
+                weight[o] = 256 - weight[o + 1];
+                continue;
+            }
+            // Catmull-Rom, weights normalized to 1 << CUBIC_BITS
+            float t2 = t * t;
+            float t3 = t2 * t;
+            float[] w = {
+                    -0.5f * t3 + t2 - 0.5f * t,
+                    1.5f * t3 - 2.5f * t2 + 1f,
+                    -1.5f * t3 + 2f * t2 + 0.5f * t,
+                    0.5f * t3 - 0.5f * t2
+            };
+            int sum = 0;
+            for (int k = 0; k < 4; k++) {
+                index[o + k] = clamp(base - 1 + k, srcSize);
+                weight[o + k] = Math.round(w[k] * (1 << CUBIC_BITS));
+                sum += weight[o + k];
+            }
+            weight[o + 1] += (1 << CUBIC_BITS) - sum;
+        }
+    }
+
+    private void nearest(int[] in, int sw) {
+        for (int y = 0; y < dstHeight; y++) {
+            int row = indexY[y] * sw;
+            int o = y * dstWidth;
+            for (int x = 0; x < dstWidth; x++) {
+                dst[o + x] = in[row + indexX[x]];
+            }
+        }
+    }
+
+    private void bilinear(int[] in, int sw, int sh) {
+        int dw = dstWidth;
+        for (int y = 0; y < sh; y++) {
+            int row = y * sw;
+            int o = y * dw;
+            for (int x = 0; x < dw; x++) {
+                int a = in[row + indexX[2 * x]];
+                int b = in[row + indexX[2 * x + 1]];
+                tmp[o + x] = lerp(a, b, weightX[2 * x + 1]);
+            }
+        }
+        for (int y = 0; y < dstHeight; y++) {
+            int r0 = indexY[2 * y] * dw;
+            int r1 = indexY[2 * y + 1] * dw;
+            int w = weightY[2 * y + 1];
+            int o = y * dw;
+            for (int x = 0; x < dw; x++) {
+                dst[o + x] = lerp(tmp[r0 + x], tmp[r1 + x], w);
+            }
+        }
+    }
+
+    private void bicubic(int[] in, int sw, int sh) {
+        int dw = dstWidth;
+        int half = 1 << (CUBIC_BITS - 1);
+        for (int y = 0; y < sh; y++) {
+            int row = y * sw;
+            int o = y * dw;
+            for (int x = 0; x < dw; x++) {
+                int r = half, g = half, b = half;
+                for (int k = 0; k < 4; k++) {
+                    int p = in[row + indexX[4 * x + k]];
+                    int w = weightX[4 * x + k];
+                    r += (p & 0xFF) * w;
+                    g += ((p >> 8) & 0xFF) * w;
+                    b += ((p >> 16) & 0xFF) * w;
+                }
+                tmp[o + x] = pack(r >> CUBIC_BITS, g >> CUBIC_BITS, b >> CUBIC_BITS);
+            }
+        }
+        for (int y = 0; y < dstHeight; y++) {
+            int o = y * dw;
+            int r0 = indexY[4 * y] * dw;
+            int r1 = indexY[4 * y + 1] * dw;
+            int r2 = indexY[4 * y + 2] * dw;
+            int r3 = indexY[4 * y + 3] * dw;
+            int w0 = weightY[4 * y];
+            int w1 = weightY[4 * y + 1];
+            int w2 = weightY[4 * y + 2];
+            int w3 = weightY[4 * y + 3];
+            for (int x = 0; x < dw; x++) {
+                int p0 = tmp[r0 + x], p1 = tmp[r1 + x], p2 = tmp[r2 + x], p3 = tmp[r3 + x];
+                int r = half + (p0 & 0xFF) * w0 + (p1 & 0xFF) * w1 + (p2 & 0xFF) * w2 + (p3 & 0xFF) * w3;
+                int g = half + ((p0 >> 8) & 0xFF) * w0 + ((p1 >> 8) & 0xFF) * w1
+                        + ((p2 >> 8) & 0xFF) * w2 + ((p3 >> 8) & 0xFF) * w3;
+                int b = half + ((p0 >> 16) & 0xFF) * w0 + ((p1 >> 16) & 0xFF) * w1
+                        + ((p2 >> 16) & 0xFF) * w2 + ((p3 >> 16) & 0xFF) * w3;
+                dst[o + x] = pack(r >> CUBIC_BITS, g >> CUBIC_BITS, b >> CUBIC_BITS);
+            }
+        }
+    }
+
+    // Photo luma sampled at output pixels and at low-resolution pixel centers
+    private void ensureGuide(int[] photo, int pw, int ph) {
+        int sw = srcWidth, sh = srcHeight, dw = dstWidth, dh = dstHeight;
+        if (guideHigh.length != dw * dh) guideHigh = new int[dw * dh];
+        if (guideLow.length != sw * sh) guideLow = new int[sw * sh];
+        for (int y = 0; y < dh; y++) {
+            int row = Math.min(ph - 1, (int) ((y + 0.5f) * ph / dh)) * pw;
+            int o = y * dw;
+            for (int x = 0; x < dw; x++) {
+                guideHigh[o + x] = luma(photo[row + Math.min(pw - 1, (int) ((x + 0.5f) * pw / dw))]);
+            }
+        }
+        for (int y = 0; y < sh; y++) {
+            int row = Math.min(ph - 1, (int) ((y + 0.5f) * ph / sh)) * pw;
+            int o = y * sw;
+            for (int x = 0; x < sw; x++) {
+                guideLow[o + x] = luma(photo[row + Math.min(pw - 1, (int) ((x + 0.5f) * pw / sw))]);
+            }
+        }
+    }
+
+    private void jointBilateral(int[] in, int sw) {
+        int dw = dstWidth;
+        for (int y = 0; y < dstHeight; y++) {
+            int r0 = indexY[2 * y] * sw;
+            int r1 = indexY[2 * y + 1] * sw;
+            int wy1 = weightY[2 * y + 1];
+            int wy0 = 256 - wy1;
+            int o = y * dw;
+            for (int x = 0; x < dw; x++) {
+                int c0 = indexX[2 * x];
+                int c1 = indexX[2 * x + 1];
+                int wx1 = weightX[2 * x + 1];
+                int wx0 = 256 - wx1;
+                int g = guideHigh[o + x];
+                int i00 = r0 + c0, i01 = r0 + c1, i10 = r1 + c0, i11 = r1 + c1;
+                int w00 = (wx0 * wy0 >> 8) * rangeWeights[Math.abs(g - guideLow[i00])];
+                int w01 = (wx1 * wy0 >> 8) * rangeWeights[Math.abs(g - guideLow[i01])];
+                int w10 = (wx0 * wy1 >> 8) * rangeWeights[Math.abs(g - guideLow[i10])];
+                int w11 = (wx1 * wy1 >> 8) * rangeWeights[Math.abs(g - guideLow[i11])];
+                int total = w00 + w01 + w10 + w11;
+                if (total == 0) {
+                    dst[o + x] = in[wy1 < 128 ? (wx1 < 128 ? i00 : i01) : (wx1 < 128 ? i10 : i11)];
+                    continue;
+                }
+                int p00 = in[i00], p01 = in[i01], p10 = in[i10], p11 = in[i11];
+                long r = (long) (p00 & 0xFF) * w00 + (long) (p01 & 0xFF) * w01
+                        + (long) (p10 & 0xFF) * w10 + (long) (p11 & 0xFF) * w11;
+                long gr = (long) ((p00 >> 8) & 0xFF) * w00 + (long) ((p01 >> 8) & 0xFF) * w01
+                        + (long) ((p10 >> 8) & 0xFF) * w10 + (long) ((p11 >> 8) & 0xFF) * w11;
+                long b = (long) ((p00 >> 16) & 0xFF) * w00 + (long) ((p01 >> 16) & 0xFF) * w01
+                        + (long) ((p10 >> 16) & 0xFF) * w10 + (long) ((p11 >> 16) & 0xFF) * w11;
+                dst[o + x] = pack((int) (r / total), (int) (gr / total), (int) (b / total));
+            }
+        }
+    }
+
+    private static int lerp(int a, int b, int w) {
+        int inv = 256 - w;
+        int r = ((a & 0xFF) * inv + (b & 0xFF) * w + 128) >> 8;
+        int g = (((a >> 8) & 0xFF) * inv + ((b >> 8) & 0xFF) * w + 128) >> 8;
+        int bl = (((a >> 16) & 0xFF) * inv + ((b >> 16) & 0xFF) * w + 128) >> 8;
+        return 0xFF000000 | (bl << 16) | (g << 8) | r;
+    }
+
+    private static int pack(int r, int g, int b) {
+        r = r < 0 ? 0 : (r > 255 ? 255 : r);
+        g = g < 0 ? 0 : (g > 255 ? 255 : g);
+        b = b < 0 ? 0 : (b > 255 ? 255 : b);
+        return 0xFF000000 | (b << 16) | (g << 8) | r;
+    }
+
+    private static int luma(int p) {
+        return (77 * (p & 0xFF) + 150 * ((p >> 8) & 0xFF) + 29 * ((p >> 16) & 0xFF)) >> 8;
+    }
+
+    private static int clamp(int i, int size) {
+        return i < 0 ? 0 : (i >= size ? size - 1 : i);
+    }
+}
@@ -0,0 +1,111 @@
+package flir.android;
+
+import android.graphics.Bitmap;
+import android.util.Log;
+
+/**
+ * Drains a {@link FrameRing} on its own thread and hands each frame to the stream listener,
+ * so colorization, caching and emission never run on the SDK streaming callback.
+ */
+public final class FrameWorker implements Runnable {
+
+    private static final String TAG = "FrameWorker";
+    private static final long POLL_MS = 100;
+    private static final long STOP_TIMEOUT_MS = 1000;
+
+    private final FrameRing ring;
+    private final CameraHandler.StreamDataListener listener;
+    private final BitmapPool bitmapPool;
+    private final FrameDump dump;
+    private final FrameFusion fusion;
+    private final FrameUpscaler upscaler;
+    private final FrameZoom zoom;
+    private final ScaleBar scaleBar;
+    private final ColorTemperatureIndex.Tracker colorIndex;
+    private volatile boolean running;
+    private Thread thread;
+
+    public FrameWorker(FrameRing ring, BitmapPool bitmapPool, FrameDump dump, FrameFusion fusion,
+                       FrameUpscaler upscaler, FrameZoom zoom, ScaleBar scaleBar,
+                       ColorTemperatureIndex.Tracker colorIndex, CameraHandler.StreamDataListener listener) {
+        this.ring = ring;
+        this.bitmapPool = bitmapPool;
+        this.dump = dump;
+        this.fusion = fusion;
+        this.upscaler = upscaler;
+        this.zoom = zoom;
+        this.scaleBar = scaleBar;
+        this.colorIndex = colorIndex;
+        this.listener = listener;
+    }
+
+    public synchronized void start() {
+        if (running) return;
+        running = true;
+        thread = new Thread(this, "FlirFrameWorker");
+        thread.start();
+    }
+
+    /**
+     * Stops the worker and waits, up to a second, for the frame in progress to be handed over,
+     * so a worker started next never runs alongside this one.
+     */
+    public void stop() {
+        Thread current;
+        synchronized (this) {
+            running = false;
+            current = thread;
+            thread = null;
+        }
+        if (current == null) return;
+        current.interrupt();
+        if (current == Thread.currentThread()) return;
+        try {
+            current.join(STOP_TIMEOUT_MS);
+        } catch (InterruptedException e) {
+            Thread.currentThread().interrupt();
+        }
+        if (current.isAlive()) Log.w(TAG, "worker thread did not stop within " + STOP_TIMEOUT_MS + " ms");
+    }
+
+    @Override
+    public void run() {
+        while (running) {
+            FrameRing.Slot slot = ring.take(POLL_MS);
+            if (slot == null) continue;
+            try {
+                process(slot);
+            } catch (Exception e) {
+                Log.e(TAG, "frame processing error", e);
+            } finally {
+                ring.release(slot);
+            }
+        }
+    }
+
+    private void process(FrameRing.Slot slot) {
+        if (listener == null) return;
+        // Dumped as acquired, so a replay runs the same fusion, zoom and upscaling again
+        dump.append(slot);
+        FrameRing.Plane thermalPlane = slot.getThermal();
+        FrameRing.Plane visualPlane = slot.getVisual();
+        RadiometricFrame radiometric = slot.getRadiometric();
+        // Learns the palette from the plain colorized plane, before fusion rewrites it
+        colorIndex.update(thermalPlane, radiometric, scaleBar.getVersion(), slot.getSequence());
+        zoom.begin(radiometric != null ? radiometric.getWidth() : thermalPlane.getWidth(),
+                radiometric != null ? radiometric.getHeight() : thermalPlane.getHeight());
+        // Fusion works on the slot buffers in place, before anything is copied into a bitmap
+        FrameRing.Plane primary = fusion.apply(thermalPlane, visualPlane);
+        FrameRing.Plane photo = visualPlane != null && visualPlane != primary ? zoom.applyPhoto(visualPlane) : null;
+        primary = upscaler.apply(zoom.apply(primary), photo);
+        zoom.publish(primary.getWidth(), primary.getHeight());
+        Bitmap thermal = toBitmap(primary);
+        Bitmap visual = photo != null ? toBitmap(photo) : null;
+        listener.images(new FrameDataHolder(thermal, visual, radiometric, zoom.apply(radiometric),
+                slot.getSequence(), slot.getTimestampNanos()));
+    }
+
+    private Bitmap toBitmap(FrameRing.Plane plane) {
+        return bitmapPool.fill(plane.getPixels(), plane.getWidth(), plane.getHeight());
+    }
+}
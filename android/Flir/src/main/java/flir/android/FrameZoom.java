@@ -0,0 +1,211 @@
+package flir.android;
+
+import java.nio.ByteBuffer;
+import java.nio.ByteOrder;
+import java.nio.IntBuffer;
+
+/**
+ * Digital zoom and pan applied on the frame worker, with the semantics of the SDK's
+ * {@code DisplaySettings}: a zoom factor of 1 shows the whole frame, pan is the offset of the
+ * visible center from the frame center in sensor pixels (0 = centered) and is clamped so the
+ * crop stays inside the frame.
+ *
+ * The colorized plane and the Celsius plane are cropped to the same normalized rectangle before
+ * transport and caching, so zoomed frames carry only the visible pixels. {@link #getTransform}
+ * maps delivered frame pixels back to sensor coordinates for temperature queries.
+ */
+public final class FrameZoom {
+
+    public static final float MAX_ZOOM = 8f;
+
+    /** Crop of the last processed frame and the mapping from delivered pixels to sensor pixels. */
+    public static final class Transform {
+        public final float zoom;
+        public final int panX;
+        public final int panY;
+        public final int sensorWidth;
+        public final int sensorHeight;
+        public final int cropX;
+        public final int cropY;
+        public final int cropWidth;
+        public final int cropHeight;
+        public final int frameWidth;
+        public final int frameHeight;
+
+        Transform(float zoom, int panX, int panY, int sensorWidth, int sensorHeight,
+                  int cropX, int cropY, int cropWidth, int cropHeight, int frameWidth, int frameHeight) {
+            this.zoom = zoom;
+            this.panX = panX;
+            this.panY = panY;
+            this.sensorWidth = sensorWidth;
+            this.sensorHeight = sensorHeight;
+            this.cropX = cropX;
+            this.cropY = cropY;
+            this.cropWidth = cropWidth;
+            this.cropHeight = cropHeight;
+            this.frameWidth = frameWidth;
+            this.frameHeight = frameHeight;
+        }
+
+        /** Sensor pixels per delivered frame pixel. */
+        public float getScaleX() {
+            return frameWidth > 0 ? (float) cropWidth / frameWidth : 1f;
+        }
+
+        public float getScaleY() {
+            return frameHeight > 0 ? (float) cropHeight / frameHeight : 1f;
+        }
+
+        /** Sensor x of the center of delivered frame pixel {@code x}. */
+        public float toSensorX(float x) {
+            return cropX + (x + 0.5f) * getScaleX() - 0.5f;
+        }
+
+        public float toSensorY(float y) {
+            return cropY + (y + 0.5f) * getScaleY() - 0.5f;
+        }
+
+        boolean matches(float zoom, int panX, int panY, int sensorWidth, int sensorHeight, int frameWidth, int frameHeight) {
+            return this.zoom == zoom && this.panX == panX && this.panY == panY
+                    && this.sensorWidth == sensorWidth && this.sensorHeight == sensorHeight
+                    && this.frameWidth == frameWidth && this.frameHeight == frameHeight;
+        }
+    }
+
+    private static final class Settings {
+        final float zoom;
+        final int panX;
+        final int panY;
+
+        Settings(float zoom, int panX, int panY) {
+            this.zoom = zoom;
+            this.panX = panX;
+            this.panY = panY;
+        }
+    }
+
+    private volatile Settings settings = new Settings(1f, 0, 0);
+    private volatile Transform transform;
+
+    // Worker-thread state: crop of the current frame and the buffers it is cropped into
+    private Settings frameSettings = settings;
+    private int cropX;
+    private int cropY;
+    private int cropWidth;
+    private int cropHeight;
+    private int sensorWidth;
+    private int sensorHeight;
+    private final Cropper primary = new Cropper();
+    private final Cropper photo = new Cropper();
+    private final RadiometricFrame radiometric = new RadiometricFrame();
+
+    public void configure(float zoom, int panX, int panY) {
+        settings = new Settings(Math.max(1f, Math.min(MAX_ZOOM, zoom)), panX, panY);
+    }
+
+    public boolean isZoomed() {
+        return settings.zoom > 1f;
+    }
+
+    /** Transform of the last delivered frame, null before the first frame. */
+    public Transform getTransform() {
+        return transform;
+    }
+
+    /**
+     * Called from the frame worker thread only, once per frame before {@link #apply}. Computes
+     * the crop in sensor pixels of the radiometric plane (or of the colorized plane when the
+     * frame has no radiometry).
+     */
+    public void begin(int width, int height) {
+        Settings s = settings;
+        frameSettings = s;
+        float cw = width / s.zoom;
+        float ch = height / s.zoom;
+        float cx = Math.max(cw / 2f, Math.min(width - cw / 2f, width / 2f + s.panX));
+        float cy = Math.max(ch / 2f, Math.min(height - ch / 2f, height / 2f + s.panY));
+        cropWidth = Math.max(1, Math.round(cw));
+        cropHeight = Math.max(1, Math.round(ch));
+        cropX = Math.max(0, Math.min(width - cropWidth, Math.round(cx - cw / 2f)));
+        cropY = Math.max(0, Math.min(height - cropHeight, Math.round(cy - ch / 2f)));
+        sensorWidth = width;
+        sensorHeight = height;
+    }
+
+    /** Crops the presented plane to the current crop scaled to its own resolution. */
+    public FrameRing.Plane apply(FrameRing.Plane input) {
+        return primary.crop(input);
+    }
+
+    /** Same crop for the visual photo, so it stays aligned with the presented plane. */
+    public FrameRing.Plane applyPhoto(FrameRing.Plane input) {
+        return photo.crop(input);
+    }
+
+    /** Crops the Celsius plane into a worker-owned frame, valid until the next call. */
+    public RadiometricFrame apply(RadiometricFrame input) {
+        if (input == null || !isCropped() || input.width != sensorWidth || input.height != sensorHeight) return input;
+        radiometric.cropFrom(input, cropX, cropY, cropWidth, cropHeight);
+        return radiometric;
+    }
+
+    /** Publishes the transform for the delivered frame size once all stages have run. */
+    public void publish(int frameWidth, int frameHeight) {
+        Settings s = frameSettings;
+        Transform current = transform;
+        if (current != null && current.matches(s.zoom, s.panX, s.panY, sensorWidth, sensorHeight, frameWidth, frameHeight)) {
+            return;
+        }
+        transform = new Transform(s.zoom, s.panX, s.panY, sensorWidth, sensorHeight,
+                cropX, cropY, cropWidth, cropHeight, frameWidth, frameHeight);
+    }
+
+    public void reset() {
+        transform = null;
+    }
+
+    private boolean isCropped() {
+        return sensorWidth > 0 && (cropWidth < sensorWidth || cropHeight < sensorHeight);
+    }
+
+    // Row-wise copy of the crop into a reused direct buffer
+    private final class Cropper {
+        private final FrameRing.Plane output = new FrameRing.Plane();
+        private IntBuffer outputView;
+        private ByteBuffer inputBuffer;
+        private IntBuffer inputView;
+        private int[] row = new int[0];
+
+        FrameRing.Plane crop(FrameRing.Plane input) {
+            if (!isCropped() || input.getWidth() <= 0) return input;
+            int iw = input.getWidth();
+            int ih = input.getHeight();
+            int x0 = cropX * iw / sensorWidth;
+            int y0 = cropY * ih / sensorHeight;
+            int w = Math.max(1, Math.min(iw - x0, cropWidth * iw / sensorWidth));
+            int h = Math.max(1, Math.min(ih - y0, cropHeight * ih / sensorHeight));
+
+            int bytes = w * h * 4;
+            if (output.pixels == null || output.pixels.capacity() < bytes) {
+                output.pixels = ByteBuffer.allocateDirect(bytes).order(ByteOrder.nativeOrder());
+                outputView = output.pixels.asIntBuffer();
+            }
+            if (input.getPixels() != inputBuffer) {
+                inputBuffer = input.getPixels();
+                inputView = ((ByteBuffer) inputBuffer.duplicate().clear()).order(inputBuffer.order()).asIntBuffer();
+            }
+            if (row.length < w) row = new int[w];
+            inputView.clear();
+            outputView.clear();
+            for (int y = 0; y < h; y++) {
+                inputView.position((y0 + y) * iw + x0);
+                inputView.get(row, 0, w);
+                outputView.put(row, 0, w);
+            }
+            output.pixels.clear().limit(bytes);
+            output.width = w;
+            output.height = h;
+            return output;
+        }
+    }
+}
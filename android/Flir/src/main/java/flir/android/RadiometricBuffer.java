@@ -0,0 +1,108 @@
+package flir.android;
+
+import com.flir.thermalsdk.image.Rectangle;
+import com.flir.thermalsdk.image.TemperatureUnit;
+import com.flir.thermalsdk.image.ThermalImage;
+
+import java.util.ArrayList;
+import java.util.List;
+import java.util.function.Function;
+
+/**
+ * Copies each streamed ThermalImage once into a recycled float plane and publishes it
+ * without locking. The streaming callback is the only writer; any thread may read the latest
+ * frame through {@link #acquire()} / {@link #release} or {@link #read}. A frame is only refilled
+ * once no reader holds it, so readers never see a plane being overwritten.
+ */
+public final class RadiometricBuffer {
+
+    // Writer thread only; grows past the initial capacity only while readers hold every frame
+    private final List<RadiometricFrame> frames = new ArrayList<>();
+    private int writeIndex;
+    private long sequence;
+    private volatile RadiometricFrame latest;
+
+    public RadiometricBuffer(int capacity) {
+        for (int i = 0; i < Math.max(2, capacity); i++) {
+            frames.add(new RadiometricFrame());
+        }
+    }
+
+    /** Must be called from inside {@code withThermalImage}, while the image is valid. */
+    public RadiometricFrame capture(ThermalImage image) {
+        int w = image.getWidth();
+        int h = image.getHeight();
+        if (image.getTemperatureUnit() != TemperatureUnit.CELSIUS) {
+            image.setTemperatureUnit(TemperatureUnit.CELSIUS);
+        }
+        double[] values = image.getValues(new Rectangle(0, 0, w, h));
+        if (values == null || values.length < w * h) return null;
+
+        RadiometricFrame frame = claim();
+        frame.fill(values, w, h, ++sequence, System.nanoTime());
+        publish(frame);
+        return frame;
+    }
+
+    /** Publishes a copy of an already decoded frame (session replay); same single-writer rule. */
+    public RadiometricFrame publish(RadiometricFrame source, long timestampNanos) {
+        RadiometricFrame frame = claim();
+        frame.copyFrom(source);
+        frame.sequence = ++sequence;
+        frame.timestampNanos = timestampNanos;
+        publish(frame);
+        return frame;
+    }
+
+    // Next frame that is neither the latest nor held by a reader, marked as being written
+    private RadiometricFrame claim() {
+        RadiometricFrame current = latest;
+        for (int i = 0; i < frames.size(); i++) {
+            RadiometricFrame frame = frames.get(writeIndex);
+            writeIndex = (writeIndex + 1) % frames.size();
+            if (frame != current && frame.holds.compareAndSet(0, RadiometricFrame.WRITING)) return frame;
+        }
+        RadiometricFrame frame = new RadiometricFrame();
+        frame.holds.set(RadiometricFrame.WRITING);
+        frames.add(frame);
+        return frame;
+    }
+
+    private void publish(RadiometricFrame frame) {
+        frame.holds.set(0);
+        latest = frame;
+    }
+
+    /**
+     * The latest frame, held until {@link #release} so it is not refilled meanwhile; null
+     * before the first frame. Hold it briefly: a writer that finds every frame held allocates.
+     */
+    public RadiometricFrame acquire() {
+        while (true) {
+            RadiometricFrame frame = latest;
+            if (frame == null) return null;
+            int holds = frame.holds.get();
+            // A frame being refilled is no longer the latest; reload it
+            if (holds >= 0 && frame.holds.compareAndSet(holds, holds + 1)) return frame;
+        }
+    }
+
+    public void release(RadiometricFrame frame) {
+        if (frame != null) frame.holds.decrementAndGet();
+    }
+
+    /** Applies {@code reader} to the held latest frame; null before the first frame. */
+    public <T> T read(Function<RadiometricFrame, T> reader) {
+        RadiometricFrame frame = acquire();
+        if (frame == null) return null;
+        try {
+            return reader.apply(frame);
+        } finally {
+            release(frame);
+        }
+    }
+
+    public void clear() {
+        latest = null;
+    }
+}
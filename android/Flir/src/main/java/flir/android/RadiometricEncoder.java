@@ -0,0 +1,89 @@
+package flir.android;
+
+import java.util.Arrays;
+import java.util.zip.Deflater;
+
+/**
+ * Frame payload codec of the {@code .flirrec} format, shared by {@link RadiometricRecorder} and
+ * {@link FrameHistory}: u16 quantization, optional delta to the previous frame, low/high byte
+ * planes and raw deflate. Scratch buffers are sized once per frame size. Not thread-safe.
+ */
+final class RadiometricEncoder {
+
+    private int width;
+    private int height;
+    private char[] previous = new char[0];
+    private char[] current = new char[0];
+    private byte[] raw = new byte[0];
+    private byte[] compressed = new byte[0];
+    private final Deflater deflater = new Deflater(Deflater.BEST_SPEED, true);
+    private int clipped;
+
+    /**
+     * Encodes {@code plane} and returns the payload length; the payload is in {@link #output()}
+     * until the next call. A size change resets the delta chain, so the frame must be a keyframe.
+     */
+    int encode(float[] plane, int w, int h, boolean keyframe) {
+        if (w != width || h != height) resize(w, h);
+        int n = w * h;
+        float inverseStep = 1f / RadiometricRecorder.STEP;
+        int outside = 0;
+        for (int i = 0; i < n; i++) {
+            float t = plane[i];
+            int q;
+            if (t != t) {
+                q = RadiometricRecorder.NAN_CODE;
+            } else {
+                q = Math.round((t - RadiometricRecorder.OFFSET) * inverseStep);
+                if (q < 0 || q > RadiometricRecorder.NAN_CODE - 1) {
+                    outside++;
+                    q = Math.max(0, Math.min(RadiometricRecorder.NAN_CODE - 1, q));
+                }
+            }
+            current[i] = (char) q;
+        }
+        clipped = outside;
+        // Byte planes: low bytes first, then high bytes
+        for (int i = 0; i < n; i++) {
+            int v = keyframe ? current[i] : (current[i] - previous[i]) & 0xFFFF;
+            raw[i] = (byte) v;
+            raw[n + i] = (byte) (v >> 8);
+        }
+        char[] swap = previous;
+        previous = current;
+        current = swap;
+
+        deflater.reset();
+        deflater.setInput(raw, 0, 2 * n);
+        deflater.finish();
+        int length = 0;
+        while (!deflater.finished()) {
+            if (length == compressed.length) compressed = Arrays.copyOf(compressed, compressed.length * 2);
+            length += deflater.deflate(compressed, length, compressed.length - length);
+        }
+        return length;
+    }
+
+    byte[] output() {
+        return compressed;
+    }
+
+    /** Pixels of the last frame outside the quantization range, stored at its nearest end. */
+    int clippedPixels() {
+        return clipped;
+    }
+
+    void end() {
+        deflater.end();
+    }
+
+    private void resize(int w, int h) {
+        width = w;
+        height = h;
+        int n = w * h;
+        previous = new char[n];
+        current = new char[n];
+        raw = new byte[2 * n];
+        compressed = new byte[Math.max(1024, n)];
+    }
+}
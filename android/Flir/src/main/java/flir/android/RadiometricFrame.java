@@ -0,0 +1,196 @@
+package flir.android;
+
+import java.nio.FloatBuffer;
+import java.util.concurrent.atomic.AtomicInteger;
+
+/**
+ * One streamed frame of radiometric data as a flat, row-major plane of Celsius values.
+ * Instances are recycled by {@link RadiometricBuffer}; readers should take a frame, query it
+ * and drop the reference rather than holding on to it across frames.
+ */
+public final class RadiometricFrame {
+
+    static final int WRITING = -1;
+
+    // Readers holding the frame through RadiometricBuffer, or WRITING while it is refilled
+    final AtomicInteger holds = new AtomicInteger();
+
+    int width;
+    int height;
+    float[] celsius = new float[0];
+    long sequence;
+    long timestampNanos;
+    // Whole-frame range, tracked while the plane is filled
+    float min = Float.NaN;
+    float max = Float.NaN;
+
+    public int getWidth() {
+        return width;
+    }
+
+    public int getHeight() {
+        return height;
+    }
+
+    public long getSequence() {
+        return sequence;
+    }
+
+    public long getTimestampNanos() {
+        return timestampNanos;
+    }
+
+    public float getMin() {
+        return min;
+    }
+
+    public float getMax() {
+        return max;
+    }
+
+    /** Backing plane, {@code width * height} values; index with {@code y * width + x}. */
+    public float[] getPlane() {
+        return celsius;
+    }
+
+    public boolean contains(int x, int y) {
+        return x >= 0 && y >= 0 && x < width && y < height;
+    }
+
+    /** Temperature at a pixel, or NaN when outside the frame. */
+    public float valueAt(int x, int y) {
+        if (!contains(x, y)) return Float.NaN;
+        return celsius[y * width + x];
+    }
+
+    /**
+     * Temperatures at interleaved {@code [x0, y0, x1, y1, ...]} points; points outside the
+     * frame yield NaN.
+     */
+    public float[] valuesAt(int[] points) {
+        float[] out = new float[points.length / 2];
+        for (int i = 0; i < out.length; i++) {
+            out[i] = valueAt(points[2 * i], points[2 * i + 1]);
+        }
+        return out;
+    }
+
+    /**
+     * Row-major copy of a rectangle clipped to the frame. Returns an empty array when the
+     * rectangle does not intersect the frame.
+     */
+    public float[] valuesIn(int x, int y, int w, int h) {
+        int x0 = Math.max(0, x);
+        int y0 = Math.max(0, y);
+        int x1 = Math.min(width, x + w);
+        int y1 = Math.min(height, y + h);
+        if (x1 <= x0 || y1 <= y0) return new float[0];
+        int cw = x1 - x0;
+        float[] out = new float[cw * (y1 - y0)];
+        for (int row = y0; row < y1; row++) {
+            System.arraycopy(celsius, row * width + x0, out, (row - y0) * cw, cw);
+        }
+        return out;
+    }
+
+    /**
+     * {@code samples} evenly spaced, bilinearly interpolated temperatures from (x0, y0) to
+     * (x1, y1) inclusive; samples outside the frame yield NaN.
+     */
+    public float[] lineProfile(float x0, float y0, float x1, float y1, int samples) {
+        float[] out = new float[Math.max(0, samples)];
+        for (int i = 0; i < out.length; i++) {
+            float t = out.length == 1 ? 0f : (float) i / (out.length - 1);
+            out[i] = sample(x0 + (x1 - x0) * t, y0 + (y1 - y0) * t);
+        }
+        return out;
+    }
+
+    /** Bilinear sample at a sub-pixel position, NaN outside the frame. */
+    public float sample(float x, float y) {
+        if (x < 0 || y < 0 || x > width - 1 || y > height - 1) return Float.NaN;
+        int ix = Math.min((int) x, Math.max(0, width - 2));
+        int iy = Math.min((int) y, Math.max(0, height - 2));
+        float fx = x - ix;
+        float fy = y - iy;
+        int i = iy * width + ix;
+        int right = ix + 1 < width ? 1 : 0;
+        int down = iy + 1 < height ? width : 0;
+        float top = celsius[i] + (celsius[i + right] - celsius[i]) * fx;
+        float bottom = celsius[i + down] + (celsius[i + down + right] - celsius[i + down]) * fx;
+        return top + (bottom - top) * fy;
+    }
+
+    void fill(double[] values, int w, int h, long seq, long timestamp) {
+        int n = w * h;
+        if (celsius.length != n) celsius = new float[n];
+        float lo = Float.POSITIVE_INFINITY;
+        float hi = Float.NEGATIVE_INFINITY;
+        for (int i = 0; i < n; i++) {
+            float v = (float) values[i];
+            celsius[i] = v;
+            if (v < lo) lo = v;
+            if (v > hi) hi = v;
+        }
+        min = lo <= hi ? lo : Float.NaN;
+        max = lo <= hi ? hi : Float.NaN;
+        width = w;
+        height = h;
+        sequence = seq;
+        timestampNanos = timestamp;
+    }
+
+    void fill(FloatBuffer values, int w, int h, long seq, long timestamp) {
+        int n = w * h;
+        if (celsius.length != n) celsius = new float[n];
+        values.get(celsius, 0, n);
+        float lo = Float.POSITIVE_INFINITY;
+        float hi = Float.NEGATIVE_INFINITY;
+        for (int i = 0; i < n; i++) {
+            float v = celsius[i];
+            if (v < lo) lo = v;
+            if (v > hi) hi = v;
+        }
+        min = lo <= hi ? lo : Float.NaN;
+        max = lo <= hi ? hi : Float.NaN;
+        width = w;
+        height = h;
+        sequence = seq;
+        timestampNanos = timestamp;
+    }
+
+    void copyFrom(RadiometricFrame other) {
+        int n = other.width * other.height;
+        if (celsius.length != n) celsius = new float[n];
+        System.arraycopy(other.celsius, 0, celsius, 0, n);
+        min = other.min;
+        max = other.max;
+        width = other.width;
+        height = other.height;
+        sequence = other.sequence;
+        timestampNanos = other.timestampNanos;
+    }
+
+    void cropFrom(RadiometricFrame other, int x, int y, int w, int h) {
+        int n = w * h;
+        if (celsius.length != n) celsius = new float[n];
+        float lo = Float.POSITIVE_INFINITY;
+        float hi = Float.NEGATIVE_INFINITY;
+        for (int row = 0; row < h; row++) {
+            int src = (y + row) * other.width + x;
+            int dst = row * w;
+            System.arraycopy(other.celsius, src, celsius, dst, w);
+            for (int i = dst; i < dst + w; i++) {
+                float v = celsius[i];
+                if (v < lo) lo = v;
+                if (v > hi) hi = v;
+            }
+        }
+        min = lo <= hi ? lo : Float.NaN;
+        max = lo <= hi ? hi : Float.NaN;
+        width = w;
+        height = h;
+        sequence = other.sequence;
+        timestampNanos = other.timestampNanos;
+    }
+}
@@ -0,0 +1,248 @@
+package flir.android;
+
+import java.io.BufferedOutputStream;
+import java.io.File;
+import java.io.FileOutputStream;
+import java.io.IOException;
+import java.io.OutputStream;
+import java.nio.ByteBuffer;
+import java.nio.ByteOrder;
+import java.nio.charset.StandardCharsets;
+import java.util.Arrays;
+
+/**
+ * Appends radiometric frames to a {@code .flirrec} file.
+ *
+ * <pre>
+ * header    64 bytes   magic "FLIRREC1", u16 version, u16 codec, u32 width, u32 height,
+ *                      f32 offset, f32 step, u32 keyframe interval, u64 created (ms),
+ *                      u32 metadata length, f32 clip min, f32 clip max, reserved
+ *           metadata   UTF-8 JSON (camera information, thermal parameters)
+ * frame     24 bytes   u32 "FRME", u32 flags (1 = keyframe), u64 timestamp (ns),
+ *                      u32 payload length, u32 raw length
+ *           payload    raw-deflated plane
+ * index     24 bytes   per frame: u64 offset, u64 timestamp, u32 flags, reserved
+ * trailer   24 bytes   u64 index offset, u32 frame count, reserved, "FLIRIDX1"
+ * </pre>
+ *
+ * All values are little-endian. Temperatures are stored as u16 {@code (t - offset) / step}
+ * with 0xFFFF for NaN, so the range is {@link #CLIP_MIN} to {@link #CLIP_MAX}; values outside it are
+ * stored at the nearest end, and the header repeats the range so readers can treat a pixel at
+ * either end as saturated. Keyframes hold the values, other frames the difference to the previous
+ * frame modulo 2^16; before compression the low bytes of the plane are grouped ahead of the high
+ * bytes, which turns small deltas into long runs. Scratch buffers are sized once per frame size,
+ * so memory stays flat however long the recording runs (the index grows by 24 bytes per frame).
+ */
+public final class RadiometricRecorder {
+
+    static final byte[] MAGIC = "FLIRREC1".getBytes(StandardCharsets.US_ASCII);
+    static final byte[] INDEX_MAGIC = "FLIRIDX1".getBytes(StandardCharsets.US_ASCII);
+    static final int FRAME_MAGIC = 0x454D5246; // "FRME"
+    static final int VERSION = 1;
+    static final int CODEC_DEFLATE = 1;
+    static final int HEADER_SIZE = 64;
+    static final int FRAME_HEADER_SIZE = 24;
+    static final int INDEX_ENTRY_SIZE = 24;
+    static final int TRAILER_SIZE = 24;
+    static final int FLAG_KEYFRAME = 1;
+    static final int NAN_CODE = 0xFFFF;
+    static final float OFFSET = -100f;
+    static final float STEP = 0.01f;
+    static final float CLIP_MIN = OFFSET;
+    static final float CLIP_MAX = OFFSET + (NAN_CODE - 1) * STEP;
+
+    private final File file;
+    private final int keyframeInterval;
+    private OutputStream out;
+    private long position;
+    private int width;
+    private int height;
+
+    private final RadiometricEncoder encoder = new RadiometricEncoder();
+    private final ByteBuffer scratch = ByteBuffer.allocate(HEADER_SIZE).order(ByteOrder.LITTLE_ENDIAN);
+    private long[] index = new long[3 * 256];
+    private int frameCount;
+
+    private volatile long rawBytes;
+    private volatile long bytesWritten;
+    private volatile long encodeNanos;
+    private volatile long clippedPixels;
+    private volatile int clippedFrames;
+    private volatile boolean closed;
+
+    public RadiometricRecorder(File file, int keyframeInterval) {
+        this.file = file;
+        this.keyframeInterval = Math.max(1, keyframeInterval);
+    }
+
+    public File getFile() {
+        return file;
+    }
+
+    /**
+     * Called from the frame worker thread only. The header is written with the first frame;
+     * frames of a different size than the first are skipped and reported as false.
+     */
+    public synchronized boolean append(RadiometricFrame frame, String metadataJson) throws IOException {
+        if (closed) return false;
+        long start = System.nanoTime();
+        if (out == null) {
+            open(frame.width, frame.height, metadataJson);
+        } else if (frame.width != width || frame.height != height) {
+            return false;
+        }
+
+        int n = width * height;
+        boolean keyframe = frameCount % keyframeInterval == 0;
+        int length = encoder.encode(frame.celsius, width, height, keyframe);
+        writeFrame(frame.timestampNanos, keyframe, encoder.output(), 0, length, 2 * n);
+        int clipped = encoder.clippedPixels();
+        if (clipped > 0) {
+            clippedPixels += clipped;
+            clippedFrames++;
+        }
+        rawBytes += (long) n * 4;
+        bytesWritten = position;
+        encodeNanos += System.nanoTime() - start;
+        return true;
+    }
+
+    /**
+     * Appends a payload that is already encoded, e.g. from {@link FrameHistory}. The first
+     * payload must be a keyframe; frames of a different size than the first are skipped.
+     */
+    synchronized boolean appendEncoded(int w, int h, long timestampNanos, boolean keyframe, byte[] payload,
+                                       int offset, int length, String metadataJson) throws IOException {
+        if (closed) return false;
+        long start = System.nanoTime();
+        if (out == null) {
+            if (!keyframe) return false;
+            open(w, h, metadataJson);
+        } else if (w != width || h != height) {
+            return false;
+        }
+        writeFrame(timestampNanos, keyframe, payload, offset, length, 2 * w * h);
+        rawBytes += (long) w * h * 4;
+        bytesWritten = position;
+        encodeNanos += System.nanoTime() - start;
+        return true;
+    }
+
+    private void writeFrame(long timestampNanos, boolean keyframe, byte[] payload, int payloadOffset,
+                            int length, int rawLength) throws IOException {
+        long offset = position;
+        scratch.clear();
+        scratch.putInt(FRAME_MAGIC);
+        scratch.putInt(keyframe ? FLAG_KEYFRAME : 0);
+        scratch.putLong(timestampNanos);
+        scratch.putInt(length);
+        scratch.putInt(rawLength);
+        write(scratch.array(), 0, FRAME_HEADER_SIZE);
+        write(payload, payloadOffset, length);
+        addIndex(offset, timestampNanos, keyframe ? FLAG_KEYFRAME : 0);
+    }
+
+    /** Writes the index and trailer and closes the file; safe to call more than once. */
+    public synchronized void close() throws IOException {
+        if (closed) return;
+        closed = true;
+        encoder.end();
+        if (out == null) return;
+        long indexOffset = position;
+        ByteBuffer entry = ByteBuffer.allocate(INDEX_ENTRY_SIZE).order(ByteOrder.LITTLE_ENDIAN);
+        for (int i = 0; i < frameCount; i++) {
+            entry.clear();
+            entry.putLong(index[3 * i]);
+            entry.putLong(index[3 * i + 1]);
+            entry.putInt((int) index[3 * i + 2]);
+            entry.putInt(0);
+            write(entry.array(), 0, INDEX_ENTRY_SIZE);
+        }
+        entry.clear();
+        entry.putLong(indexOffset);
+        entry.putInt(frameCount);
+        entry.putInt(0);
+        entry.put(INDEX_MAGIC);
+        write(entry.array(), 0, TRAILER_SIZE);
+        out.close();
+        bytesWritten = position;
+    }
+
+    public int getFrameCount() {
+        return frameCount;
+    }
+
+    /** Size of the frames as float Celsius planes, the form they are held in memory. */
+    public long getRawBytes() {
+        return rawBytes;
+    }
+
+    public long getBytesWritten() {
+        return bytesWritten;
+    }
+
+    public double getCompressionRatio() {
+        long written = bytesWritten;
+        return written > 0 ? (double) rawBytes / written : 0;
+    }
+
+    /** Raw megabytes per second through quantize, delta, compress and write. */
+    public double getThroughputMBps() {
+        long nanos = encodeNanos;
+        return nanos > 0 ? rawBytes / 1e6 / (nanos / 1e9) : 0;
+    }
+
+    /**
+     * Pixels stored at the clip range ends because they were outside it, and the frames holding
+     * any; frames appended already encoded are not counted.
+     */
+    public long getClippedPixels() {
+        return clippedPixels;
+    }
+
+    public int getClippedFrames() {
+        return clippedFrames;
+    }
+
+    public double getAvgAppendMs() {
+        int frames = frameCount;
+        return frames > 0 ? encodeNanos / 1e6 / frames : 0;
+    }
+
+    private void open(int w, int h, String metadataJson) throws IOException {
+        width = w;
+        height = h;
+        out = new BufferedOutputStream(new FileOutputStream(file), 1 << 16);
+
+        byte[] metadata = (metadataJson != null ? metadataJson : "{}").getBytes(StandardCharsets.UTF_8);
+        scratch.clear();
+        scratch.put(MAGIC);
+        scratch.putShort((short) VERSION);
+        scratch.putShort((short) CODEC_DEFLATE);
+        scratch.putInt(w);
+        scratch.putInt(h);
+        scratch.putFloat(OFFSET);
+        scratch.putFloat(STEP);
+        scratch.putInt(keyframeInterval);
+        scratch.putLong(System.currentTimeMillis());
+        scratch.putInt(metadata.length);
+        scratch.putFloat(CLIP_MIN);
+        scratch.putFloat(CLIP_MAX);
+        while (scratch.position() < HEADER_SIZE) scratch.put((byte) 0);
+        write(scratch.array(), 0, HEADER_SIZE);
+        write(metadata, 0, metadata.length);
+    }
+
+    private void addIndex(long offset, long timestampNanos, int flags) {
+        if (3 * (frameCount + 1) > index.length) index = Arrays.copyOf(index, index.length * 2);
+        index[3 * frameCount] = offset;
+        index[3 * frameCount + 1] = timestampNanos;
+        index[3 * frameCount + 2] = flags;
+        frameCount++;
+    }
+
+    private void write(byte[] bytes, int offset, int length) throws IOException {
+        out.write(bytes, offset, length);
+        position += length;
+    }
+}
@@ -0,0 +1,318 @@
+package flir.android;
+
+import java.io.Closeable;
+import java.io.File;
+import java.io.IOException;
+import java.io.RandomAccessFile;
+import java.nio.ByteBuffer;
+import java.nio.ByteOrder;
+import java.nio.MappedByteBuffer;
+import java.nio.channels.FileChannel;
+import java.nio.charset.StandardCharsets;
+import java.util.Arrays;
+import java.util.zip.DataFormatException;
+import java.util.zip.Inflater;
+
+/**
+ * Read-only, memory-mapped view of a {@code .flirrec} file written by {@link RadiometricRecorder}.
+ * The frame index is taken from the footer, or rebuilt by walking the frame headers when the
+ * recording was not closed cleanly. A frame is decoded from the nearest keyframe at or before it;
+ * sequential reads continue from the last decoded frame. The file is mapped in chunks of
+ * {@link #CHUNK_SIZE}, since one mapping cannot address more than 2 GB; reads that straddle two
+ * chunks are stitched from both.
+ */
+public final class RadiometricRecording implements Closeable {
+
+    static final int CHUNK_SIZE = 1 << 30;
+
+    private final RandomAccessFile file;
+    private final MappedByteBuffer[] chunks;
+    private final long size;
+    // Primitives that straddle a chunk boundary are assembled here
+    private final ByteBuffer straddle = ByteBuffer.allocate(8).order(ByteOrder.LITTLE_ENDIAN);
+    private final int width;
+    private final int height;
+    private final float offset;
+    private final float step;
+    private final float clipMin;
+    private final float clipMax;
+    private final int keyframeInterval;
+    private final long createdMillis;
+    private final String metadata;
+    private long[] offsets;
+    private long[] timestamps;
+    private int[] flags;
+    private int frameCount;
+
+    // Decoder state: quantized plane of decodedIndex
+    private final Inflater inflater = new Inflater(true);
+    private final char[] plane;
+    private final byte[] raw;
+    private byte[] payload = new byte[0];
+    private int decodedIndex = -1;
+
+    public static RadiometricRecording open(File path) throws IOException {
+        return new RadiometricRecording(path);
+    }
+
+    private RadiometricRecording(File path) throws IOException {
+        file = new RandomAccessFile(path, "r");
+        try {
+            size = file.length();
+            if (size < RadiometricRecorder.HEADER_SIZE) throw new IOException("Not a recording: " + path);
+            FileChannel channel = file.getChannel();
+            chunks = new MappedByteBuffer[(int) ((size + CHUNK_SIZE - 1) / CHUNK_SIZE)];
+            for (int i = 0; i < chunks.length; i++) {
+                long start = (long) i * CHUNK_SIZE;
+                chunks[i] = channel.map(FileChannel.MapMode.READ_ONLY, start, Math.min(CHUNK_SIZE, size - start));
+                chunks[i].order(ByteOrder.LITTLE_ENDIAN);
+            }
+
+            // The header always lies in the first chunk
+            MappedByteBuffer map = chunks[0];
+            byte[] magic = new byte[RadiometricRecorder.MAGIC.length];
+            map.get(magic);
+            if (!Arrays.equals(magic, RadiometricRecorder.MAGIC)) throw new IOException("Not a recording: " + path);
+            int version = map.getShort(8);
+            int codec = map.getShort(10);
+            if (version != RadiometricRecorder.VERSION || codec != RadiometricRecorder.CODEC_DEFLATE) {
+                throw new IOException("Unsupported recording version " + version + ", codec " + codec);
+            }
+            width = map.getInt(12);
+            height = map.getInt(16);
+            offset = map.getFloat(20);
+            step = map.getFloat(24);
+            keyframeInterval = map.getInt(28);
+            createdMillis = map.getLong(32);
+            int metadataLength = map.getInt(40);
+            // Recordings from before the clip range was stored leave it zero; it follows from offset and step
+            float storedMin = map.getFloat(44);
+            float storedMax = map.getFloat(48);
+            boolean stored = storedMin != 0 || storedMax != 0;
+            clipMin = stored ? storedMin : offset;
+            clipMax = stored ? storedMax : offset + (RadiometricRecorder.NAN_CODE - 1) * step;
+            if (metadataLength < 0 || RadiometricRecorder.HEADER_SIZE + (long) metadataLength > size) {
+                throw new IOException("Truncated recording header: " + path);
+            }
+            byte[] metadataBytes = new byte[metadataLength];
+            read(RadiometricRecorder.HEADER_SIZE, metadataBytes, 0, metadataLength);
+            metadata = new String(metadataBytes, StandardCharsets.UTF_8);
+
+            int n = width * height;
+            plane = new char[n];
+            raw = new byte[2 * n];
+            if (!readIndex()) scanFrames(RadiometricRecorder.HEADER_SIZE + metadataLength);
+        } catch (IOException | RuntimeException e) {
+            file.close();
+            throw e;
+        }
+    }
+
+    public int getWidth() {
+        return width;
+    }
+
+    public int getHeight() {
+        return height;
+    }
+
+    public int getFrameCount() {
+        return frameCount;
+    }
+
+    public int getKeyframeInterval() {
+        return keyframeInterval;
+    }
+
+    public long getCreatedMillis() {
+        return createdMillis;
+    }
+
+    /**
+     * Range the temperatures were quantized to; pixels decoded at either end were at or beyond
+     * it when recorded.
+     */
+    public float getClipMin() {
+        return clipMin;
+    }
+
+    public float getClipMax() {
+        return clipMax;
+    }
+
+    /** UTF-8 JSON stored in the header. */
+    public String getMetadata() {
+        return metadata;
+    }
+
+    public long getTimestampNanos(int index) {
+        return timestamps[index];
+    }
+
+    /** Recording length from the first to the last frame timestamp. */
+    public long getDurationNanos() {
+        return frameCount > 1 ? timestamps[frameCount - 1] - timestamps[0] : 0;
+    }
+
+    /** Index of the last frame at or before {@code timestampNanos}, clamped to the recording. */
+    public int indexAt(long timestampNanos) {
+        int i = Arrays.binarySearch(timestamps, 0, frameCount, timestampNanos);
+        if (i < 0) i = -i - 2;
+        return Math.max(0, Math.min(frameCount - 1, i));
+    }
+
+    /** Decodes frame {@code index} into {@code out}, which is resized as needed; NaN for dropouts. */
+    public synchronized void readFrame(int index, RadiometricFrame out) throws IOException {
+        if (index < 0 || index >= frameCount) throw new IndexOutOfBoundsException("Frame " + index + " of " + frameCount);
+        int start = index;
+        if (decodedIndex >= 0 && decodedIndex <= index && !isKeyframeBetween(decodedIndex + 1, index)) {
+            start = decodedIndex + 1;
+        } else {
+            while (start > 0 && (flags[start] & RadiometricRecorder.FLAG_KEYFRAME) == 0) start--;
+        }
+        for (int i = start; i <= index; i++) decode(i);
+
+        int n = width * height;
+        if (out.celsius.length != n) out.celsius = new float[n];
+        float lo = Float.POSITIVE_INFINITY;
+        float hi = Float.NEGATIVE_INFINITY;
+        for (int i = 0; i < n; i++) {
+            int q = plane[i];
+            float v = q == RadiometricRecorder.NAN_CODE ? Float.NaN : offset + q * step;
+            out.celsius[i] = v;
+            if (v < lo) lo = v;
+            if (v > hi) hi = v;
+        }
+        out.min = lo <= hi ? lo : Float.NaN;
+        out.max = lo <= hi ? hi : Float.NaN;
+        out.width = width;
+        out.height = height;
+        out.sequence = index;
+        out.timestampNanos = timestamps[index];
+    }
+
+    @Override
+    public synchronized void close() throws IOException {
+        inflater.end();
+        file.close();
+    }
+
+    private boolean isKeyframeBetween(int from, int to) {
+        for (int i = from; i <= to; i++) {
+            if ((flags[i] & RadiometricRecorder.FLAG_KEYFRAME) != 0) return true;
+        }
+        return false;
+    }
+
+    private void decode(int index) throws IOException {
+        long position = offsets[index];
+        int length = getInt(position + 16);
+        int rawLength = getInt(position + 20);
+        int n = width * height;
+        if (rawLength != 2 * n) throw new IOException("Frame " + index + " has unexpected size " + rawLength);
+        if (payload.length < length) payload = new byte[length];
+        read(position + RadiometricRecorder.FRAME_HEADER_SIZE, payload, 0, length);
+
+        inflater.reset();
+        inflater.setInput(payload, 0, length);
+        try {
+            int read = 0;
+            while (read < rawLength && !inflater.finished()) {
+                int count = inflater.inflate(raw, read, rawLength - read);
+                if (count == 0 && (inflater.needsInput() || inflater.needsDictionary())) break;
+                read += count;
+            }
+            if (read != rawLength) throw new IOException("Frame " + index + " is truncated");
+        } catch (DataFormatException e) {
+            throw new IOException("Frame " + index + " is corrupt", e);
+        }
+
+        boolean keyframe = (flags[index] & RadiometricRecorder.FLAG_KEYFRAME) != 0;
+        for (int i = 0; i < n; i++) {
+            int v = (raw[i] & 0xFF) | ((raw[n + i] & 0xFF) << 8);
+            plane[i] = (char) (keyframe ? v : plane[i] + v);
+        }
+        decodedIndex = index;
+    }
+
+    private boolean readIndex() {
+        if (size < RadiometricRecorder.TRAILER_SIZE) return false;
+        long trailer = size - RadiometricRecorder.TRAILER_SIZE;
+        byte[] magic = new byte[RadiometricRecorder.INDEX_MAGIC.length];
+        read(trailer + 16, magic, 0, magic.length);
+        if (!Arrays.equals(magic, RadiometricRecorder.INDEX_MAGIC)) return false;
+        long indexOffset = getLong(trailer);
+        int count = getInt(trailer + 8);
+        if (count < 0 || indexOffset + (long) count * RadiometricRecorder.INDEX_ENTRY_SIZE != trailer) return false;
+
+        allocateIndex(count);
+        for (int i = 0; i < count; i++) {
+            long entry = indexOffset + (long) i * RadiometricRecorder.INDEX_ENTRY_SIZE;
+            offsets[i] = getLong(entry);
+            timestamps[i] = getLong(entry + 8);
+            flags[i] = getInt(entry + 16);
+        }
+        frameCount = count;
+        return true;
+    }
+
+    // Footer missing: walk the frame headers and stop at the first incomplete frame
+    private void scanFrames(long position) {
+        allocateIndex(64);
+        int count = 0;
+        while (position + RadiometricRecorder.FRAME_HEADER_SIZE <= size
+                && getInt(position) == RadiometricRecorder.FRAME_MAGIC) {
+            int length = getInt(position + 16);
+            long end = position + RadiometricRecorder.FRAME_HEADER_SIZE + length;
+            if (length < 0 || end > size) break;
+            if (count == offsets.length) {
+                offsets = Arrays.copyOf(offsets, count * 2);
+                timestamps = Arrays.copyOf(timestamps, count * 2);
+                flags = Arrays.copyOf(flags, count * 2);
+            }
+            offsets[count] = position;
+            timestamps[count] = getLong(position + 8);
+            flags[count] = getInt(position + 4);
+            count++;
+            position = end;
+        }
+        frameCount = count;
+    }
+
+    // Absolute reads across the chunks; callers hold the monitor or run in the constructor, since
+    // bulk reads move the chunk positions
+    private void read(long position, byte[] dst, int offset, int length) {
+        while (length > 0) {
+            MappedByteBuffer chunk = chunks[(int) (position / CHUNK_SIZE)];
+            int at = (int) (position % CHUNK_SIZE);
+            int count = Math.min(length, chunk.capacity() - at);
+            chunk.position(at);
+            chunk.get(dst, offset, count);
+            position += count;
+            offset += count;
+            length -= count;
+        }
+    }
+
+    private int getInt(long position) {
+        MappedByteBuffer chunk = chunks[(int) (position / CHUNK_SIZE)];
+        int at = (int) (position % CHUNK_SIZE);
+        if (at + 4 <= chunk.capacity()) return chunk.getInt(at);
+        read(position, straddle.array(), 0, 4);
+        return straddle.getInt(0);
+    }
+
+    private long getLong(long position) {
+        MappedByteBuffer chunk = chunks[(int) (position / CHUNK_SIZE)];
+        int at = (int) (position % CHUNK_SIZE);
+        if (at + 8 <= chunk.capacity()) return chunk.getLong(at);
+        read(position, straddle.array(), 0, 8);
+        return straddle.getLong(0);
+    }
+
+    private void allocateIndex(int count) {
+        offsets = new long[Math.max(1, count)];
+        timestamps = new long[Math.max(1, count)];
+        flags = new int[Math.max(1, count)];
+    }
+}
@@ -0,0 +1,285 @@
+package flir.android;
+
+import java.util.ArrayList;
+import java.util.Arrays;
+import java.util.Collections;
+import java.util.List;
+
+/**
+ * Per-frame statistics over registered regions of interest.
+ *
+ * Each region is rasterized once per frame size into row spans {@code (row, x0, x1)}; a frame
+ * is then reduced with a single linear pass per region over those spans, accumulating
+ * min/max/sum/sum-of-squares, hot/cold spot and a histogram for percentiles. The histogram
+ * range is the whole-frame range tracked while the plane was copied.
+ */
+public final class RegionStatistics {
+
+    public static final String RECT = "rect";
+    public static final String ELLIPSE = "ellipse";
+    public static final String POLYGON = "polygon";
+    public static final String LINE = "line";
+
+    private static final int HISTOGRAM_BINS = 1024;
+
+    public static final class Region {
+        final String id;
+        final String type;
+        final float[] coords;
+        int[] spans = new int[0];
+        int spanWidth = -1;
+        int spanHeight = -1;
+
+        /**
+         * {@code coords} by type: rect {x, y, w, h}; ellipse {cx, cy, rx, ry};
+         * polygon {x0, y0, x1, y1, ...}; line {x0, y0, x1, y1}.
+         */
+        public Region(String id, String type, float[] coords) {
+            this.id = id;
+            this.type = type;
+            this.coords = coords;
+        }
+    }
+
+    public static final class Result {
+        public String id;
+        public int count;
+        public float min;
+        public float max;
+        public float mean;
+        public float stddev;
+        public int hotX;
+        public int hotY;
+        public int coldX;
+        public int coldY;
+        public float[] percentileValues;
+    }
+
+    private volatile List<Region> regions = Collections.emptyList();
+    private volatile float[] percentiles = {5f, 50f, 95f};
+    private final int[] histogram = new int[HISTOGRAM_BINS];
+    private Region wholeFrame;
+
+    public void setRegions(List<Region> newRegions) {
+        regions = Collections.unmodifiableList(new ArrayList<>(newRegions));
+    }
+
+    public boolean hasRegions() {
+        return !regions.isEmpty();
+    }
+
+    public void setPercentiles(float[] values) {
+        percentiles = values.clone();
+    }
+
+    public float[] getPercentiles() {
+        return percentiles;
+    }
+
+    /** Whole-frame statistics, reported as region id "frame". */
+    public Result computeFrame(RadiometricFrame frame) {
+        Region whole = wholeFrame;
+        if (whole == null || whole.spanWidth != frame.width || whole.spanHeight != frame.height) {
+            whole = new Region("frame", RECT, new float[]{0, 0, frame.width, frame.height});
+            wholeFrame = whole;
+        }
+        return compute(frame, whole);
+    }
+
+    /** Called from the frame worker thread only; the histogram scratch buffer is shared. */
+    public List<Result> compute(RadiometricFrame frame) {
+        List<Region> current = regions;
+        List<Result> results = new ArrayList<>(current.size());
+        for (Region region : current) {
+            results.add(compute(frame, region));
+        }
+        return results;
+    }
+
+    private Result compute(RadiometricFrame frame, Region region) {
+        ensureSpans(region, frame.width, frame.height);
+        float[] plane = frame.celsius;
+        int width = frame.width;
+        int[] spans = region.spans;
+
+        float lo = frame.min;
+        float range = frame.max - frame.min;
+        float scale = range > 0 ? (HISTOGRAM_BINS - 1) / range : 0f;
+        Arrays.fill(histogram, 0);
+
+        int count = 0;
+        double sum = 0;
+        double sumSq = 0;
+        float min = Float.POSITIVE_INFINITY;
+        float max = Float.NEGATIVE_INFINITY;
+        int minIndex = -1;
+        int maxIndex = -1;
+        for (int s = 0; s < spans.length; s += 3) {
+            int base = spans[s] * width;
+            int end = base + spans[s + 2];
+            for (int i = base + spans[s + 1]; i < end; i++) {
+                float v = plane[i];
+                if (v != v) continue;
+                count++;
+                sum += v;
+                sumSq += (double) v * v;
+                if (v < min) {
+                    min = v;
+                    minIndex = i;
+                }
+                if (v > max) {
+                    max = v;
+                    maxIndex = i;
+                }
+                histogram[(int) ((v - lo) * scale)]++;
+            }
+        }
+
+        Result result = new Result();
+        result.id = region.id;
+        result.count = count;
+        float[] ps = percentiles;
+        result.percentileValues = new float[ps.length];
+        if (count == 0) {
+            result.min = result.max = result.mean = result.stddev = Float.NaN;
+            result.hotX = result.hotY = result.coldX = result.coldY = -1;
+            Arrays.fill(result.percentileValues, Float.NaN);
+            return result;
+        }
+        double mean = sum / count;
+        result.min = min;
+        result.max = max;
+        result.mean = (float) mean;
+        result.stddev = (float) Math.sqrt(Math.max(0, sumSq / count - mean * mean));
+        result.hotX = maxIndex % width;
+        result.hotY = maxIndex / width;
+        result.coldX = minIndex % width;
+        result.coldY = minIndex / width;
+        for (int p = 0; p < ps.length; p++) {
+            result.percentileValues[p] = percentile(ps[p], count, lo, scale, min, max);
+        }
+        return result;
+    }
+
+    private float percentile(float p, int count, float lo, float scale, float min, float max) {
+        if (scale == 0f) return min;
+        long target = (long) Math.ceil(Math.max(0f, Math.min(100f, p)) / 100.0 * count);
+        long cumulative = 0;
+        for (int bin = 0; bin < HISTOGRAM_BINS; bin++) {
+            cumulative += histogram[bin];
+            if (cumulative >= target && cumulative > 0) {
+                float value = lo + (bin + 0.5f) / scale;
+                return Math.max(min, Math.min(max, value));
+            }
+        }
+        return max;
+    }
+
+    private static void ensureSpans(Region region, int width, int height) {
+        if (region.spanWidth == width && region.spanHeight == height) return;
+        SpanBuilder spans = new SpanBuilder(width, height);
+        float[] c = region.coords;
+        switch (region.type) {
+            case RECT:
+                for (int y = (int) c[1]; y < (int) (c[1] + c[3]); y++) {
+                    spans.add(y, (int) c[0], (int) (c[0] + c[2]));
+                }
+                break;
+            case ELLIPSE:
+                for (int y = (int) Math.floor(c[1] - c[3]); y <= (int) Math.ceil(c[1] + c[3]); y++) {
+                    float dy = (y + 0.5f - c[1]) / c[3];
+                    if (dy * dy > 1f) continue;
+                    float half = c[2] * (float) Math.sqrt(1f - dy * dy);
+                    spans.add(y, Math.round(c[0] - half), Math.round(c[0] + half));
+                }
+                break;
+            case POLYGON:
+                rasterizePolygon(c, spans, height);
+                break;
+            case LINE:
+                rasterizeLine(c, spans);
+                break;
+            default:
+                break;
+        }
+        region.spans = spans.toArray();
+        region.spanWidth = width;
+        region.spanHeight = height;
+    }
+
+    // Even-odd scanline fill sampled at pixel centers
+    private static void rasterizePolygon(float[] c, SpanBuilder spans, int height) {
+        int n = c.length / 2;
+        if (n < 3) return;
+        float[] crossings = new float[n];
+        for (int y = 0; y < height; y++) {
+            float sy = y + 0.5f;
+            int found = 0;
+            for (int i = 0, j = n - 1; i < n; j = i++) {
+                float yi = c[2 * i + 1];
+                float yj = c[2 * j + 1];
+                if ((yi > sy) != (yj > sy)) {
+                    float xi = c[2 * i];
+                    float xj = c[2 * j];
+                    crossings[found++] = xi + (sy - yi) / (yj - yi) * (xj - xi);
+                }
+            }
+            Arrays.sort(crossings, 0, found);
+            for (int k = 0; k + 1 < found; k += 2) {
+                spans.add(y, (int) Math.ceil(crossings[k] - 0.5f), (int) Math.ceil(crossings[k + 1] - 0.5f));
+            }
+        }
+    }
+
+    private static void rasterizeLine(float[] c, SpanBuilder spans) {
+        int x0 = Math.round(c[0]);
+        int y0 = Math.round(c[1]);
+        int x1 = Math.round(c[2]);
+        int y1 = Math.round(c[3]);
+        int dx = Math.abs(x1 - x0);
+        int dy = -Math.abs(y1 - y0);
+        int sx = x0 < x1 ? 1 : -1;
+        int sy = y0 < y1 ? 1 : -1;
+        int err = dx + dy;
+        while (true) {
+            spans.add(y0, x0, x0 + 1);
+            if (x0 == x1 && y0 == y1) break;
+            int e2 = 2 * err;
+            if (e2 >= dy) {
+                err += dy;
+                x0 += sx;
+            }
+            if (e2 <= dx) {
+                err += dx;
+                y0 += sy;
+            }
+        }
+    }
+
+    private static final class SpanBuilder {
+        private final int width;
+        private final int height;
+        private int[] data = new int[48];
+        private int size;
+
+        SpanBuilder(int width, int height) {
+            this.width = width;
+            this.height = height;
+        }
+
+        void add(int row, int x0, int x1) {
+            if (row < 0 || row >= height) return;
+            x0 = Math.max(0, x0);
+            x1 = Math.min(width, x1);
+            if (x1 <= x0) return;
+            if (size + 3 > data.length) data = Arrays.copyOf(data, data.length * 2);
+            data[size++] = row;
+            data[size++] = x0;
+            data[size++] = x1;
+        }
+
+        int[] toArray() {
+            return Arrays.copyOf(data, size);
+        }
+    }
+}
@@ -0,0 +1,122 @@
+package flir.android;
+
+import android.graphics.Bitmap;
+import android.graphics.Matrix;
+
+import com.flir.thermalsdk.image.ImageBuffer;
+
+import java.io.File;
+import java.io.FileOutputStream;
+import java.nio.ByteBuffer;
+import java.util.HashMap;
+import java.util.Map;
+
+/**
+ * Scale legend of the SDK's colorizer: palette name, span and the scale image, fetched from the
+ * streamer only when the palette changes or the span moves by more than
+ * {@link #CHANGE_THRESHOLD}. PNGs are encoded on request, once per orientation and change.
+ */
+public final class ScaleBar {
+
+    public static final String VERTICAL = "vertical";
+    public static final String HORIZONTAL = "horizontal";
+
+    // Span changes below this (Celsius) are auto-scale jitter and keep the cached legend
+    private static final float CHANGE_THRESHOLD = 0.1f;
+
+    public static final class Snapshot {
+        public final String palette;
+        public final float min;
+        public final float max;
+        public final long version;
+
+        Snapshot(String palette, float min, float max, long version) {
+            this.palette = palette;
+            this.min = min;
+            this.max = max;
+            this.version = version;
+        }
+    }
+
+    // Scale image as delivered by the SDK (vertical, hot end on top)
+    private final FrameRing.Plane image = new FrameRing.Plane();
+    private String palette = "";
+    private float min = Float.NaN;
+    private float max = Float.NaN;
+    private volatile long version;
+    private final Map<String, String> paths = new HashMap<>();
+
+    /** True when {@code palette} or the span differ enough from the cached legend to refetch it. */
+    public synchronized boolean isStale(String palette, float min, float max) {
+        return !palette.equals(this.palette) || this.min != this.min
+                || Math.abs(min - this.min) >= CHANGE_THRESHOLD || Math.abs(max - this.max) >= CHANGE_THRESHOLD;
+    }
+
+    /** Called from the SDK streaming callback only; {@code scaleImage} may be null. */
+    public synchronized void update(String palette, float min, float max, ImageBuffer scaleImage) {
+        if (scaleImage != null) {
+            image.copyFrom(scaleImage);
+        } else {
+            image.clear();
+        }
+        this.palette = palette;
+        this.min = min;
+        this.max = max;
+        removeImages();
+        version++;
+    }
+
+    /** Incremented on every legend change; 0 before the first frame. */
+    public long getVersion() {
+        return version;
+    }
+
+    public synchronized Snapshot snapshot() {
+        return min != min ? null : new Snapshot(palette, min, max, version);
+    }
+
+    /** PNG of the legend for the current version, hot end at the top or on the right; null without an image. */
+    public synchronized String exportPng(File dir, String orientation) throws Exception {
+        if (image.getWidth() <= 0) return null;
+        String key = HORIZONTAL.equals(orientation) ? HORIZONTAL : VERTICAL;
+        String cached = paths.get(key);
+        if (cached != null) return cached;
+
+        Bitmap bmp = Bitmap.createBitmap(image.getWidth(), image.getHeight(), Bitmap.Config.ARGB_8888);
+        ByteBuffer pixels = image.getPixels();
+        pixels.rewind();
+        bmp.copyPixelsFromBuffer(pixels);
+        pixels.rewind();
+        if (HORIZONTAL.equals(key)) {
+            Matrix rotate = new Matrix();
+            rotate.postRotate(90f);
+            Bitmap rotated = Bitmap.createBitmap(bmp, 0, 0, bmp.getWidth(), bmp.getHeight(), rotate, true);
+            bmp.recycle();
+            bmp = rotated;
+        }
+        File file = new File(dir, "flir_scale_" + key + "_" + version + ".png");
+        try (FileOutputStream out = new FileOutputStream(file)) {
+            bmp.compress(Bitmap.CompressFormat.PNG, 100, out);
+        } finally {
+            bmp.recycle();
+        }
+        paths.put(key, file.getAbsolutePath());
+        return file.getAbsolutePath();
+    }
+
+    public synchronized void clear() {
+        image.clear();
+        palette = "";
+        min = Float.NaN;
+        max = Float.NaN;
+        removeImages();
+    }
+
+    private void removeImages() {
+        for (String path : paths.values()) {
+            //noinspection ResultOfMethodCallIgnored
+            new File(path).delete();
+        }
+        paths.clear();
+    }
+}
@@ -0,0 +1,208 @@
+package flir.android;
+
+import android.graphics.Bitmap;
+import android.util.Log;
+
+import com.flir.thermalsdk.androidsdk.image.BitmapAndroid;
+import com.flir.thermalsdk.image.ImageBuffer;
+import com.flir.thermalsdk.live.streaming.ThermalStreamer;
+
+import java.io.File;
+import java.io.FileOutputStream;
+import java.io.IOException;
+import java.io.OutputStream;
+import java.util.concurrent.ExecutorService;
+import java.util.concurrent.Executors;
+import java.util.concurrent.atomic.AtomicBoolean;
+
+/**
+ * Saves the streamer's current ThermalImage as a radiometric JPEG ({@code saveAs}) on a
+ * background thread.
+ *
+ * The streamer refreshes one image in place on every frame, so the image is pinned while it is
+ * saved: the streaming callback skips frames until the save is done instead of waiting for it.
+ * One snapshot runs at a time.
+ */
+public final class ThermalSnapshot {
+
+    public interface Listener {
+        /** Called on the snapshot thread once the files are written, or with the error. */
+        void saved(Result result, Exception error);
+    }
+
+    public static final class Result {
+        final File file;
+        File visualFile;
+        File overlayFile;
+        double latencyMs;
+        double pinnedMs;
+
+        Result(File file) {
+            this.file = file;
+        }
+
+        public File getFile() {
+            return file;
+        }
+
+        /** Fusion photo as a JPEG next to the snapshot, or null when not requested or absent. */
+        public File getVisualFile() {
+            return visualFile;
+        }
+
+        /** Colorized frame as shown, as a JPEG next to the snapshot, or null when not requested. */
+        public File getOverlayFile() {
+            return overlayFile;
+        }
+
+        /** Request to all files closed. */
+        public double getLatencyMs() {
+            return latencyMs;
+        }
+
+        /** Time the stream skipped frames for this snapshot. */
+        public double getPinnedMs() {
+            return pinnedMs;
+        }
+    }
+
+    private static final String TAG = "ThermalSnapshot";
+    private static final double EWMA_WEIGHT = 0.2;
+
+    private final ExecutorService executor = Executors.newSingleThreadExecutor(r -> new Thread(r, "FlirSnapshot"));
+    private final Object imageLock = new Object();
+    private final AtomicBoolean pinned = new AtomicBoolean();
+
+    private volatile long snapshots;
+    private volatile long framesSkipped;
+    private volatile double lastLatencyMs;
+    private volatile double avgLatencyMs;
+
+    /**
+     * Streaming callback: hold this lock around {@code update()} and the image access, and drop
+     * the frame when {@link #skipFrame()} says so. It is only contended for the moment a snapshot
+     * takes the image over.
+     */
+    Object imageLock() {
+        return imageLock;
+    }
+
+    /** Streaming callback, inside {@link #imageLock()}: true while a snapshot holds the image. */
+    boolean skipFrame() {
+        if (!pinned.get()) return false;
+        framesSkipped++;
+        return true;
+    }
+
+    /** Throws IllegalStateException while another snapshot is being saved. */
+    public void capture(ThermalStreamer streamer, File file, boolean visual, boolean overlay, Listener listener) {
+        if (!pinned.compareAndSet(false, true)) throw new IllegalStateException("Snapshot in progress");
+        long requested = System.nanoTime();
+        executor.execute(() -> save(streamer, file, visual, overlay, requested, listener));
+    }
+
+    private void save(ThermalStreamer streamer, File file, boolean visual, boolean overlay, long requested,
+                      Listener listener) {
+        Result result = new Result(file);
+        Exception[] error = new Exception[1];
+        long pinnedAt = System.nanoTime();
+        Bitmap photo = null;
+        Bitmap colorized = null;
+        try {
+            // Waits out a frame that is being copied right now; later frames see the pin and skip
+            synchronized (imageLock) {
+                pinnedAt = System.nanoTime();
+            }
+            streamer.withThermalImage(image -> {
+                try {
+                    image.saveAs(file.getAbsolutePath());
+                } catch (Exception e) {
+                    error[0] = e;
+                }
+            });
+            if (error[0] == null && visual) photo = fusionPhoto(streamer);
+            if (error[0] == null && overlay) colorized = toBitmap(streamer.getImage());
+        } catch (Exception e) {
+            error[0] = e;
+        } finally {
+            pinned.set(false);
+        }
+        result.pinnedMs = (System.nanoTime() - pinnedAt) / 1e6;
+
+        // Sidecar images are encoded after the stream is released
+        try {
+            if (error[0] == null && photo != null) result.visualFile = writeJpeg(photo, sidecar(file, "_visual"));
+            if (error[0] == null && colorized != null) result.overlayFile = writeJpeg(colorized, sidecar(file, "_overlay"));
+        } catch (IOException e) {
+            error[0] = e;
+        } finally {
+            if (photo != null) photo.recycle();
+            if (colorized != null) colorized.recycle();
+        }
+        if (error[0] != null) {
+            Log.e(TAG, "snapshot error", error[0]);
+        } else {
+            double ms = (System.nanoTime() - requested) / 1e6;
+            result.latencyMs = ms;
+            lastLatencyMs = ms;
+            avgLatencyMs = snapshots == 0 ? ms : avgLatencyMs + EWMA_WEIGHT * (ms - avgLatencyMs);
+            snapshots++;
+        }
+        if (listener != null) listener.saved(result, error[0]);
+    }
+
+    private static Bitmap fusionPhoto(ThermalStreamer streamer) {
+        Bitmap[] photo = new Bitmap[1];
+        streamer.withThermalImage(image -> {
+            if (image.getFusion() != null && image.getFusion().getPhoto() != null) {
+                photo[0] = toBitmap(image.getFusion().getPhoto());
+            }
+        });
+        return photo[0];
+    }
+
+    // Copies the pixels, so the bitmap stays valid after the image is released
+    private static Bitmap toBitmap(ImageBuffer buffer) {
+        Bitmap bitmap = BitmapAndroid.createBitmap(buffer).getBitMap();
+        try {
+            return bitmap.copy(Bitmap.Config.ARGB_8888, false);
+        } finally {
+            bitmap.recycle();
+        }
+    }
+
+    private static File sidecar(File file, String suffix) {
+        String name = file.getName();
+        int dot = name.lastIndexOf('.');
+        String base = dot > 0 ? name.substring(0, dot) : name;
+        return new File(file.getParentFile(), base + suffix + ".jpg");
+    }
+
+    private static File writeJpeg(Bitmap bitmap, File file) throws IOException {
+        try (OutputStream out = new FileOutputStream(file)) {
+            if (!bitmap.compress(Bitmap.CompressFormat.JPEG, 90, out)) throw new IOException("JPEG encoding failed");
+        }
+        return file;
+    }
+
+    public boolean isBusy() {
+        return pinned.get();
+    }
+
+    public long getSnapshots() {
+        return snapshots;
+    }
+
+    /** Frames dropped by the stream while snapshots held the image. */
+    public long getFramesSkipped() {
+        return framesSkipped;
+    }
+
+    public double getLastLatencyMs() {
+        return lastLatencyMs;
+    }
+
+    public double getAvgLatencyMs() {
+        return avgLatencyMs;
+    }
+}
@@ -0,0 +1,95 @@
+#import <Foundation/Foundation.h>
+#import <UIKit/UIKit.h>
+
+@class FLIRPalette;
+@class FLIRRange;
+
+NS_ASSUME_NONNULL_BEGIN
+
+#define FLIR_COLORIZER_LUT_SIZE 1024
+#define FLIR_COLORIZER_MAX_ISOTHERMS 8
+
+typedef NS_ENUM(NSInteger, FlirColorDistribution) {
+  // Span mapped linearly onto the palette
+  FlirColorDistributionLinear = 0,
+  // Histogram equalization over the span
+  FlirColorDistributionHistogram,
+  // Histogram equalization with per-bin counts clipped at the plateau
+  FlirColorDistributionPlateau,
+};
+
+// Maps the Celsius plane to 32BGRA through a LUT built from a ThermalSDK palette.
+// The LUT holds FLIR_COLORIZER_LUT_SIZE palette entries plus the below- and above-span colors;
+// palette and span changes only rebuild or rescale it, so the last frame can be re-colorized at once.
+@interface FlirColorizer : NSObject
+
+// NO until a palette has been selected; frames keep the SDK rendering until then
+@property (nonatomic, readonly) BOOL enabled;
+@property (nonatomic, readonly, copy) NSString *paletteName;
+@property (nonatomic, readonly) BOOL autoSpan;
+@property (nonatomic, readonly) float spanMin;
+@property (nonatomic, readonly) float spanMax;
+@property (nonatomic, readonly) FlirColorDistribution distribution;
+// Plateau: bin counts are clipped at this multiple of the mean bin count
+@property (nonatomic, readonly) float plateau;
+// 0...1 share of the linear mapping blended into the equalized one
+@property (nonatomic, readonly) float linearPercent;
+// 0...1 temporal smoothing of the transfer function and auto span; 0 follows each frame
+@property (nonatomic, readonly) float smoothing;
+// [{ id, count, fraction }] per isotherm for the most recent frame, nil without isotherms
+@property (atomic, readonly, copy, nullable) NSArray<NSDictionary *> *lastIsothermCounts;
+// Duration of the most recent colorize pass
+@property (nonatomic, readonly) double lastColorizeMs;
+
++ (instancetype)shared;
++ (NSArray<NSString *> *)availablePalettes;
+
+- (BOOL)setPaletteNamed:(NSString *)name inverted:(BOOL)inverted;
+// While no native palette is selected, mirrors the SDK's palette and scale so the inverse
+// lookup matches what the SDK rendered. Call from the stream queue.
+- (void)trackPalette:(FLIRPalette *_Nullable)palette range:(FLIRRange *_Nullable)range;
+- (void)setSpanMin:(float)min max:(float)max;
+- (void)setAutoSpan;
+// Isotherms are applied in the colorize pass, in order, the first matching rule winning:
+//   { id, type: @"above" | @"below", threshold }   { id, type: @"interval", min, max }
+//   { id, type: @"humidity", airTemperature, relativeHumidity, limit }
+//   { id, type: @"insulation", indoorTemperature, outdoorTemperature, factor }
+// plus color (ARGB) and blend (0...1). An empty array removes them.
+- (BOOL)setIsotherms:(NSArray<NSDictionary *> *)rules error:(NSString *_Nullable *_Nullable)error;
+- (void)setDistribution:(FlirColorDistribution)distribution
+                plateau:(float)plateau
+          linearPercent:(float)linearPercent
+              smoothing:(float)smoothing;
+
+// Writes width x height 32BGRA pixels; with auto span the range is taken from the plane.
+// Non-linear distributions build this frame's histogram in the same pass while mapping
+// through the previous frame's (smoothed) transfer function.
+- (void)colorizePlane:(const float *)plane
+                width:(int)width
+               height:(int)height
+               pixels:(uint8_t *)pixels
+          bytesPerRow:(size_t)bytesPerRow;
+
+// Colorizes synthetic planes of each size once per distribution (linear, histogram, plateau)
+// on private instances, with the current palette or a default one and the current plateau,
+// linear share and smoothing; returns [{ width, height, distribution, avgMs }].
+- (NSArray<NSDictionary *> *)benchmarkSizes:(NSArray<NSValue *> *)sizes iterations:(int)iterations;
+
+// Current LUT (FLIR_COLORIZER_LUT_SIZE + 2 BGRA entries, see above) and span; the returned
+// object is replaced, never mutated, when the palette changes. nil when no palette is known yet.
+- (nullable NSData *)currentLutWithMin:(float *)min max:(float *)max;
+
+// LUT index (1...FLIR_COLORIZER_LUT_SIZE) for each of FLIR_COLORIZER_LUT_SIZE equal steps
+// across the span, as the current equalization maps them; nil while the distribution is linear
+// and before the first equalized frame. Stream queue only.
+- (nullable NSData *)currentTransfer;
+
+// Inverse of the active LUT and span via a 32x32x32 nearest-color grid built once per LUT.
+// NaN for colors outside the span or not produced by the palette.
+- (float)temperatureForColor:(uint32_t)argb;
+// Row-major float temperatures for a colorized image; nil when no palette is known yet.
+- (nullable NSData *)temperaturesForImage:(UIImage *)image width:(int *)width height:(int *)height;
+
+@end
+
+NS_ASSUME_NONNULL_END
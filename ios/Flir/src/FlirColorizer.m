@@ -0,0 +1,711 @@
+#import "FlirColorizer.h"
+#import <ThermalSDK/ThermalSDK.h>
+#import <Accelerate/Accelerate.h>
+#import <QuartzCore/QuartzCore.h>
+#import <os/lock.h>
+
+// LUT layout: [0] below span, [1 ... SIZE] palette, [SIZE + 1] above span
+#define FLIR_LUT_ENTRIES (FLIR_COLORIZER_LUT_SIZE + 2)
+
+// Inverse lookup grid: 5 bits per channel
+#define FLIR_INVERSE_BITS 5
+#define FLIR_INVERSE_CELLS (1 << (3 * FLIR_INVERSE_BITS))
+// Colors further than this (squared, per-channel units) from every palette entry are not palette colors
+#define FLIR_INVERSE_MAX_DISTANCE (3 * 24 * 24)
+
+// Isotherm rule reduced to a Celsius interval; blend is 0...256
+typedef struct {
+  float lo;
+  float hi;
+  uint32_t color;
+  uint32_t blend;
+} FlirIsothermRule;
+
+// Saturation vapour pressure over water (Magnus), hPa
+static inline double FlirVapourPressure(double celsius)
+{
+  return 6.112 * exp(17.62 * celsius / (243.12 + celsius));
+}
+
+static inline double FlirVapourPressureToCelsius(double hPa)
+{
+  double l = log(hPa / 6.112);
+  return 243.12 * l / (17.62 - l);
+}
+
+static inline uint32_t FlirBlendBGRA(uint32_t base, uint32_t over, uint32_t blend)
+{
+  uint32_t inverse = 256 - blend;
+  uint32_t rb = (((base & 0xFF00FF) * inverse + (over & 0xFF00FF) * blend) >> 8) & 0xFF00FF;
+  uint32_t g = (((base & 0x00FF00) * inverse + (over & 0x00FF00) * blend) >> 8) & 0x00FF00;
+  return 0xFF000000u | rb | g;
+}
+
+// Range of the plane's samples; NO when it holds no numbers. vDSP_minv/maxv give NaN as soon as a
+// NaN pixel (dropout, masked area) is hit, so that case falls back to a scan that skips them.
+static BOOL FlirPlaneRange(const float *plane, vDSP_Length count, float *min, float *max)
+{
+  float lo = NAN, hi = NAN;
+  vDSP_minv(plane, 1, &lo, count);
+  vDSP_maxv(plane, 1, &hi, count);
+  if (isnan(lo) || isnan(hi)) {
+    lo = INFINITY;
+    hi = -INFINITY;
+    for (vDSP_Length i = 0; i < count; i++) {
+      float v = plane[i];
+      if (v < lo) lo = v;
+      if (v > hi) hi = v;
+    }
+    if (lo > hi) return NO;
+  }
+  *min = lo;
+  *max = hi;
+  return YES;
+}
+
+static inline uint32_t FlirPackBGRA(UIColor *color)
+{
+  CGFloat r = 0, g = 0, b = 0, a = 1;
+  [color getRed:&r green:&g blue:&b alpha:&a];
+  uint32_t R = (uint32_t)lround(MAX(0.0, MIN(1.0, r)) * 255.0);
+  uint32_t G = (uint32_t)lround(MAX(0.0, MIN(1.0, g)) * 255.0);
+  uint32_t B = (uint32_t)lround(MAX(0.0, MIN(1.0, b)) * 255.0);
+  return B | (G << 8) | (R << 16) | (0xFFu << 24);
+}
+
+@interface FlirColorizer ()
+// Set through the atomic setter so a reader on another queue never sees a released array
+@property (atomic, readwrite, copy, nullable) NSArray<NSDictionary *> *lastIsothermCounts;
+@end
+
+@implementation FlirColorizer {
+    NSData *_lut;
+    os_unfair_lock _lock;
+    // Palette last taken from the SDK while no native palette is selected; stream queue only
+    NSString *_trackedKey;
+    // Nearest LUT entry per quantized color, rebuilt lazily for _inverseSource
+    uint16_t *_inverse;
+    NSData *_inverseSource;
+    os_unfair_lock _inverseLock;
+    // Per-row scratch, stream queue only
+    NSMutableData *_scaled;
+    NSMutableData *_indices;
+    // Color distribution state, stream queue only; index 0 and SIZE + 1 are the out-of-span entries
+    uint32_t _histogram[FLIR_LUT_ENTRIES];
+    uint16_t _transferIndex[FLIR_LUT_ENTRIES];
+    float _transfer[FLIR_COLORIZER_LUT_SIZE];
+    BOOL _transferValid;
+    BOOL _distributionChanged;
+    float _smoothedMin;
+    float _smoothedMax;
+    BOOL _hasSmoothedSpan;
+    // LUT position -> fractional span bin, the inverse of the transfer; guarded by _lock
+    float _binForIndex[FLIR_COLORIZER_LUT_SIZE];
+    // Isotherm rules, guarded by _lock; band counts of the last frame
+    FlirIsothermRule _isotherms[FLIR_COLORIZER_MAX_ISOTHERMS];
+    NSArray<NSString *> *_isothermIds;
+    int _isothermCount;
+}
+
++ (instancetype)shared
+{
+  static FlirColorizer *shared = nil;
+  static dispatch_once_t onceToken;
+  dispatch_once(&onceToken, ^{
+    shared = [FlirColorizer new];
+  });
+  return shared;
+}
+
++ (NSArray<NSString *> *)availablePalettes
+{
+  NSMutableArray<NSString *> *names = [NSMutableArray array];
+  for (FLIRPalette *palette in [[FLIRPaletteManager default] getDefaultPalettes]) {
+    [names addObject:palette.name];
+  }
+  return names;
+}
+
+- (instancetype)init
+{
+  if (self = [super init]) {
+    _lock = OS_UNFAIR_LOCK_INIT;
+    _inverseLock = OS_UNFAIR_LOCK_INIT;
+    _inverse = malloc(FLIR_INVERSE_CELLS * sizeof(uint16_t));
+    _paletteName = @"";
+    _autoSpan = YES;
+    _scaled = [NSMutableData data];
+    _indices = [NSMutableData data];
+    _distribution = FlirColorDistributionLinear;
+    _plateau = 3.f;
+    _linearPercent = 0.f;
+    _smoothing = 0.8f;
+    for (int i = 0; i < FLIR_COLORIZER_LUT_SIZE; i++) {
+      _binForIndex[i] = i;
+    }
+    [self resetTransfer];
+  }
+  return self;
+}
+
+- (void)resetTransfer
+{
+  for (int i = 0; i < FLIR_LUT_ENTRIES; i++) {
+    _transferIndex[i] = (uint16_t)i;
+  }
+  memset(_histogram, 0, sizeof(_histogram));
+  _transferValid = NO;
+  _hasSmoothedSpan = NO;
+}
+
+static FLIRPalette *FlirFindPalette(NSString *name)
+{
+  for (FLIRPalette *candidate in [[FLIRPaletteManager default] getDefaultPalettes]) {
+    if ([candidate.name caseInsensitiveCompare:name] == NSOrderedSame) return candidate;
+  }
+  return nil;
+}
+
+// Resamples the palette stops to a fixed-size table so lookups never depend on the palette length
+static NSData *FlirBuildLut(FLIRPalette *palette, BOOL invert)
+{
+  NSArray<UIColor *> *colors = palette.paletteColors;
+  NSUInteger count = colors.count;
+  if (count == 0) return nil;
+
+  NSMutableData *lut = [NSMutableData dataWithLength:FLIR_LUT_ENTRIES * sizeof(uint32_t)];
+  uint32_t *entries = (uint32_t *)lut.mutableBytes;
+  uint32_t *stops = malloc(count * sizeof(uint32_t));
+  for (NSUInteger i = 0; i < count; i++) {
+    stops[i] = FlirPackBGRA(colors[i]);
+  }
+  for (int i = 0; i < FLIR_COLORIZER_LUT_SIZE; i++) {
+    float t = (float)i / (FLIR_COLORIZER_LUT_SIZE - 1);
+    if (invert) t = 1.f - t;
+    float pos = t * (count - 1);
+    NSUInteger lo = (NSUInteger)pos;
+    NSUInteger hi = MIN(lo + 1, count - 1);
+    float f = pos - lo;
+    uint32_t a = stops[lo], b = stops[hi];
+    uint32_t packed = 0xFFu << 24;
+    for (int shift = 0; shift < 24; shift += 8) {
+      float ca = (a >> shift) & 0xFF, cb = (b >> shift) & 0xFF;
+      packed |= (uint32_t)lroundf(ca + (cb - ca) * f) << shift;
+    }
+    entries[i + 1] = packed;
+  }
+  free(stops);
+  entries[0] = FlirPackBGRA(invert ? palette.aboveSpanColor : palette.belowSpanColor);
+  entries[FLIR_COLORIZER_LUT_SIZE + 1] = FlirPackBGRA(invert ? palette.belowSpanColor : palette.aboveSpanColor);
+  return lut;
+}
+
+- (BOOL)setPaletteNamed:(NSString *)name inverted:(BOOL)inverted
+{
+  FLIRPalette *palette = FlirFindPalette(name);
+  NSData *lut = palette != nil ? FlirBuildLut(palette, inverted != palette.isInverted) : nil;
+  if (lut == nil) return NO;
+
+  os_unfair_lock_lock(&_lock);
+  _lut = lut;
+  _paletteName = [palette.name copy];
+  _enabled = YES;
+  os_unfair_lock_unlock(&_lock);
+  return YES;
+}
+
+- (void)trackPalette:(FLIRPalette *)palette range:(FLIRRange *)range
+{
+  if (self.enabled || palette == nil) return;
+  NSString *key = [NSString stringWithFormat:@"%@/%d", palette.name, palette.isInverted];
+  NSData *lut = nil;
+  if (![key isEqualToString:_trackedKey]) {
+    lut = FlirBuildLut(palette, palette.isInverted);
+    _trackedKey = key;
+  }
+  os_unfair_lock_lock(&_lock);
+  if (!_enabled) {
+    if (lut != nil) {
+      _lut = lut;
+      _paletteName = [palette.name copy];
+    }
+    if (range != nil) {
+      _spanMin = (float)[range.min asCelsius].value;
+      _spanMax = (float)[range.max asCelsius].value;
+    }
+  }
+  os_unfair_lock_unlock(&_lock);
+}
+
+- (void)setSpanMin:(float)min max:(float)max
+{
+  os_unfair_lock_lock(&_lock);
+  _spanMin = MIN(min, max);
+  _spanMax = MAX(min, max);
+  _autoSpan = NO;
+  os_unfair_lock_unlock(&_lock);
+}
+
+- (void)setAutoSpan
+{
+  os_unfair_lock_lock(&_lock);
+  _autoSpan = YES;
+  os_unfair_lock_unlock(&_lock);
+}
+
+- (BOOL)setIsotherms:(NSArray<NSDictionary *> *)rules error:(NSString **)error
+{
+  if (rules.count > FLIR_COLORIZER_MAX_ISOTHERMS) {
+    if (error) *error = [NSString stringWithFormat:@"At most %d isotherms are supported", FLIR_COLORIZER_MAX_ISOTHERMS];
+    return NO;
+  }
+  FlirIsothermRule parsed[FLIR_COLORIZER_MAX_ISOTHERMS];
+  NSMutableArray<NSString *> *ids = [NSMutableArray arrayWithCapacity:rules.count];
+  int count = 0;
+  for (NSDictionary *rule in rules) {
+    NSString *type = rule[@"type"];
+    FlirIsothermRule r = { -INFINITY, INFINITY, 0, 256 };
+    if ([type isEqualToString:@"above"]) {
+      r.lo = [rule[@"threshold"] floatValue];
+    } else if ([type isEqualToString:@"below"]) {
+      r.hi = [rule[@"threshold"] floatValue];
+    } else if ([type isEqualToString:@"interval"]) {
+      r.lo = [rule[@"min"] floatValue];
+      r.hi = [rule[@"max"] floatValue];
+    } else if ([type isEqualToString:@"humidity"]) {
+      // Surfaces whose relative humidity would reach the limit: colder than the temperature at
+      // which the air's vapour pressure is `limit` of saturation
+      double air = [rule[@"airTemperature"] doubleValue];
+      double humidity = [rule[@"relativeHumidity"] doubleValue];
+      double limit = rule[@"limit"] ? [rule[@"limit"] doubleValue] : 1.0;
+      if (humidity > 1) humidity /= 100.0;
+      if (limit > 1) limit /= 100.0;
+      if (humidity <= 0 || limit <= 0) {
+        if (error) *error = @"Humidity isotherm needs relativeHumidity and limit above 0";
+        return NO;
+      }
+      r.hi = (float)FlirVapourPressureToCelsius(humidity * FlirVapourPressure(air) / limit);
+    } else if ([type isEqualToString:@"insulation"]) {
+      // Surfaces colder than the insulation factor allows between outdoor and indoor temperature
+      float indoor = [rule[@"indoorTemperature"] floatValue];
+      float outdoor = [rule[@"outdoorTemperature"] floatValue];
+      float factor = [rule[@"factor"] floatValue];
+      r.hi = outdoor + factor * (indoor - outdoor);
+    } else {
+      if (error) *error = [NSString stringWithFormat:@"Unknown isotherm type: %@", type];
+      return NO;
+    }
+    uint32_t argb = rule[@"color"] ? (uint32_t)[rule[@"color"] longLongValue] : 0xFF00FF00u;
+    // ARGB from JS; 32BGRA in memory is the same word on little-endian
+    r.color = argb | 0xFF000000u;
+    float blend = rule[@"blend"] ? [rule[@"blend"] floatValue] : 1.f;
+    r.blend = (uint32_t)lroundf(MAX(0.f, MIN(1.f, blend)) * 256.f);
+    parsed[count++] = r;
+    [ids addObject:[rule[@"id"] description] ?: [NSString stringWithFormat:@"%d", count - 1]];
+  }
+
+  os_unfair_lock_lock(&_lock);
+  memcpy(_isotherms, parsed, sizeof(FlirIsothermRule) * count);
+  _isothermCount = count;
+  _isothermIds = ids;
+  os_unfair_lock_unlock(&_lock);
+  return YES;
+}
+
+- (void)setDistribution:(FlirColorDistribution)distribution plateau:(float)plateau linearPercent:(float)linearPercent smoothing:(float)smoothing
+{
+  os_unfair_lock_lock(&_lock);
+  _distribution = distribution;
+  _plateau = MAX(1.f, plateau);
+  _linearPercent = MAX(0.f, MIN(1.f, linearPercent));
+  _smoothing = MAX(0.f, MIN(0.99f, smoothing));
+  // The transfer function is reset on the stream queue at the next frame
+  _distributionChanged = YES;
+  os_unfair_lock_unlock(&_lock);
+}
+
+// The distribution settings are written from the JS thread under _lock, so they are read under it too
+- (FlirColorDistribution)distribution
+{
+  os_unfair_lock_lock(&_lock);
+  FlirColorDistribution distribution = _distribution;
+  os_unfair_lock_unlock(&_lock);
+  return distribution;
+}
+
+- (float)plateau
+{
+  os_unfair_lock_lock(&_lock);
+  float plateau = _plateau;
+  os_unfair_lock_unlock(&_lock);
+  return plateau;
+}
+
+- (float)linearPercent
+{
+  os_unfair_lock_lock(&_lock);
+  float linearPercent = _linearPercent;
+  os_unfair_lock_unlock(&_lock);
+  return linearPercent;
+}
+
+- (float)smoothing
+{
+  os_unfair_lock_lock(&_lock);
+  float smoothing = _smoothing;
+  os_unfair_lock_unlock(&_lock);
+  return smoothing;
+}
+
+- (void)colorizePlane:(const float *)plane width:(int)width height:(int)height pixels:(uint8_t *)pixels bytesPerRow:(size_t)bytesPerRow
+{
+  os_unfair_lock_lock(&_lock);
+  NSData *lutData = _lut;
+  BOOL autoSpan = _autoSpan;
+  float min = _spanMin, max = _spanMax;
+  FlirColorDistribution distribution = _distribution;
+  float plateau = _plateau, linearPercent = _linearPercent, smoothing = _smoothing;
+  FlirIsothermRule isotherms[FLIR_COLORIZER_MAX_ISOTHERMS];
+  int isothermCount = _isothermCount;
+  memcpy(isotherms, _isotherms, sizeof(FlirIsothermRule) * isothermCount);
+  NSArray<NSString *> *isothermIds = _isothermIds;
+  BOOL reset = _distributionChanged;
+  _distributionChanged = NO;
+  os_unfair_lock_unlock(&_lock);
+  if (lutData == nil || width <= 0 || height <= 0) return;
+  if (reset) {
+    [self resetTransfer];
+    os_unfair_lock_lock(&_lock);
+    for (int i = 0; i < FLIR_COLORIZER_LUT_SIZE; i++) {
+      _binForIndex[i] = i;
+    }
+    os_unfair_lock_unlock(&_lock);
+  }
+
+  CFTimeInterval start = CACurrentMediaTime();
+  BOOL equalize = distribution != FlirColorDistributionLinear;
+  vDSP_Length n = (vDSP_Length)width;
+  // A plane without numbers keeps the last span
+  if (autoSpan && FlirPlaneRange(plane, (vDSP_Length)width * height, &min, &max)) {
+    // Auto span pumps with every hot or cold object entering the frame; smooth it with the transfer
+    if (equalize && _hasSmoothedSpan) {
+      min = _smoothedMin + (1.f - smoothing) * (min - _smoothedMin);
+      max = _smoothedMax + (1.f - smoothing) * (max - _smoothedMax);
+    }
+    _smoothedMin = min;
+    _smoothedMax = max;
+    _hasSmoothedSpan = YES;
+  }
+
+  // index = (v - min) * scale + 1, so min maps to the first palette entry and max to the last;
+  // clipping sends anything outside the span to the below/above entries
+  float scale = max > min ? (FLIR_COLORIZER_LUT_SIZE - 1) / (max - min) : 0.f;
+  float offset = 1.f - min * scale;
+  float lowest = 0.f, highest = FLIR_COLORIZER_LUT_SIZE + 1;
+  if (_scaled.length < n * sizeof(float)) _scaled.length = n * sizeof(float);
+  if (_indices.length < n * sizeof(int)) _indices.length = n * sizeof(int);
+  float *scaled = (float *)_scaled.mutableBytes;
+  int *indices = (int *)_indices.mutableBytes;
+  const uint32_t *lut = (const uint32_t *)lutData.bytes;
+  const uint16_t *transfer = _transferIndex;
+  uint32_t *histogram = _histogram;
+  NSUInteger bandCounts[FLIR_COLORIZER_MAX_ISOTHERMS] = { 0 };
+
+  for (int y = 0; y < height; y++) {
+    const float *row = plane + (NSInteger)y * width;
+    uint32_t *dst = (uint32_t *)(pixels + y * bytesPerRow);
+    vDSP_vsmsa(row, 1, &scale, &offset, scaled, 1, n);
+    vDSP_vclip(scaled, 1, &lowest, &highest, scaled, 1, n);
+    vDSP_vfix32(scaled, 1, indices, 1, n);
+    if (equalize) {
+      for (int x = 0; x < width; x++) {
+        unsigned idx = (unsigned)indices[x];
+        idx = idx < FLIR_LUT_ENTRIES ? idx : 0;
+        histogram[idx]++;
+        dst[x] = lut[transfer[idx]];
+      }
+    } else {
+      for (int x = 0; x < width; x++) {
+        // NaN converts to an out-of-range index; show it as below span
+        unsigned idx = (unsigned)indices[x];
+        dst[x] = lut[idx < FLIR_LUT_ENTRIES ? idx : 0];
+      }
+    }
+    // Isotherms on the row just written, while it is still in cache; the first matching rule wins
+    if (isothermCount > 0) {
+      for (int x = 0; x < width; x++) {
+        float v = row[x];
+        for (int r = 0; r < isothermCount; r++) {
+          if (v >= isotherms[r].lo && v <= isotherms[r].hi) {
+            dst[x] = FlirBlendBGRA(dst[x], isotherms[r].color, isotherms[r].blend);
+            bandCounts[r]++;
+            break;
+          }
+        }
+      }
+    }
+  }
+
+  if (equalize) {
+    [self updateTransferPlateau:distribution == FlirColorDistributionPlateau ? plateau : 0.f
+                  linearPercent:linearPercent
+                      smoothing:smoothing];
+  }
+  if (autoSpan) {
+    os_unfair_lock_lock(&_lock);
+    _spanMin = min;
+    _spanMax = max;
+    os_unfair_lock_unlock(&_lock);
+  }
+  if (isothermCount > 0) {
+    NSUInteger total = (NSUInteger)width * height;
+    NSMutableArray<NSDictionary *> *counts = [NSMutableArray arrayWithCapacity:isothermCount];
+    for (int r = 0; r < isothermCount; r++) {
+      [counts addObject:@{ @"id": isothermIds[r], @"count": @(bandCounts[r]), @"fraction": @((double)bandCounts[r] / total) }];
+    }
+    self.lastIsothermCounts = counts;
+  } else {
+    self.lastIsothermCounts = nil;
+  }
+  _lastColorizeMs = (CACurrentMediaTime() - start) * 1000.0;
+}
+
+// Builds the next frame's transfer function from this frame's histogram and clears it
+- (void)updateTransferPlateau:(float)plateau linearPercent:(float)linearPercent smoothing:(float)smoothing
+{
+  const int bins = FLIR_COLORIZER_LUT_SIZE;
+  uint32_t *counts = _histogram + 1;
+  double total = 0;
+  for (int i = 0; i < bins; i++) total += counts[i];
+  if (total == 0) {
+    memset(_histogram, 0, sizeof(_histogram));
+    return;
+  }
+
+  double clip = plateau > 0 ? MAX(1.0, plateau * total / bins) : INFINITY;
+  double clippedTotal = 0;
+  for (int i = 0; i < bins; i++) clippedTotal += MIN((double)counts[i], clip);
+
+  float alpha = _transferValid ? 1.f - smoothing : 1.f;
+  double cumulative = 0;
+  for (int i = 0; i < bins; i++) {
+    double c = MIN((double)counts[i], clip);
+    float equalized = (float)((cumulative + c * 0.5) / clippedTotal);
+    cumulative += c;
+    float linear = (float)i / (bins - 1);
+    float target = linearPercent * linear + (1.f - linearPercent) * equalized;
+    _transfer[i] += alpha * (target - _transfer[i]);
+    _transferIndex[i + 1] = (uint16_t)(1 + lroundf(MAX(0.f, MIN(1.f, _transfer[i])) * (bins - 1)));
+  }
+  _transferValid = YES;
+  memset(_histogram, 0, sizeof(_histogram));
+
+  // Invert the monotonic transfer for color-to-temperature lookups
+  float inverse[FLIR_COLORIZER_LUT_SIZE];
+  int bin = 0;
+  for (int p = 0; p < bins; p++) {
+    float position = (float)p / (bins - 1);
+    while (bin < bins - 1 && _transfer[bin + 1] < position) bin++;
+    float lo = _transfer[bin];
+    float hi = bin < bins - 1 ? _transfer[bin + 1] : lo;
+    inverse[p] = bin + (hi > lo ? MAX(0.f, MIN(1.f, (position - lo) / (hi - lo))) : 0.f);
+  }
+  os_unfair_lock_lock(&_lock);
+  memcpy(_binForIndex, inverse, sizeof(inverse));
+  os_unfair_lock_unlock(&_lock);
+}
+
+- (NSData *)currentTransfer
+{
+  os_unfair_lock_lock(&_lock);
+  BOOL equalized = _distribution != FlirColorDistributionLinear && !_distributionChanged;
+  os_unfair_lock_unlock(&_lock);
+  if (!equalized || !_transferValid) return nil;
+  return [NSData dataWithBytes:_transferIndex + 1 length:FLIR_COLORIZER_LUT_SIZE * sizeof(uint16_t)];
+}
+
+// Gray ramp for benchmarks when the SDK offers no palette
+static NSData *FlirGrayLut(void)
+{
+  NSMutableData *lut = [NSMutableData dataWithLength:FLIR_LUT_ENTRIES * sizeof(uint32_t)];
+  uint32_t *entries = (uint32_t *)lut.mutableBytes;
+  for (int i = 0; i < FLIR_LUT_ENTRIES; i++) {
+    uint32_t v = (uint32_t)(MAX(0, MIN(FLIR_COLORIZER_LUT_SIZE - 1, i - 1)) * 255 / (FLIR_COLORIZER_LUT_SIZE - 1));
+    entries[i] = 0xFF000000u | (v << 16) | (v << 8) | v;
+  }
+  return lut;
+}
+
+- (NSArray<NSDictionary *> *)benchmarkSizes:(NSArray<NSValue *> *)sizes iterations:(int)iterations
+{
+  os_unfair_lock_lock(&_lock);
+  NSData *lut = _lut;
+  float plateau = _plateau, linearPercent = _linearPercent, smoothing = _smoothing;
+  os_unfair_lock_unlock(&_lock);
+  // Always measured with a LUT, whether or not a palette has been selected
+  if (lut == nil) {
+    FLIRPalette *palette = FlirFindPalette(@"iron") ?: [[FLIRPaletteManager default] getDefaultPalettes].firstObject;
+    lut = (palette != nil ? FlirBuildLut(palette, NO) : nil) ?: FlirGrayLut();
+  }
+  NSArray *modes = @[
+    @[@"linear", @(FlirColorDistributionLinear)],
+    @[@"histogram", @(FlirColorDistributionHistogram)],
+    @[@"plateau", @(FlirColorDistributionPlateau)],
+  ];
+
+  NSMutableArray<NSDictionary *> *results = [NSMutableArray arrayWithCapacity:sizes.count * modes.count];
+  for (NSValue *value in sizes) {
+    CGSize size = value.CGSizeValue;
+    int width = (int)size.width, height = (int)size.height;
+    if (width <= 0 || height <= 0) continue;
+    // Gradient with a warm blob, roughly the spread of an indoor scene
+    NSMutableData *plane = [NSMutableData dataWithLength:(NSUInteger)width * height * sizeof(float)];
+    float *values = (float *)plane.mutableBytes;
+    for (int y = 0; y < height; y++) {
+      for (int x = 0; x < width; x++) {
+        float dx = (x - width * 0.6f) / width, dy = (y - height * 0.4f) / height;
+        values[(NSInteger)y * width + x] = 18.f + 6.f * x / width + 20.f * expf(-(dx * dx + dy * dy) * 40.f);
+      }
+    }
+    size_t bytesPerRow = (size_t)width * 4;
+    NSMutableData *pixels = [NSMutableData dataWithLength:bytesPerRow * height];
+    for (NSArray *mode in modes) {
+      FlirColorizer *bench = [FlirColorizer new];
+      bench->_lut = lut;
+      [bench setDistribution:(FlirColorDistribution)[mode[1] integerValue] plateau:plateau linearPercent:linearPercent smoothing:smoothing];
+      // Warm-up frame; the equalized modes also build their first transfer function here
+      [bench colorizePlane:values width:width height:height pixels:pixels.mutableBytes bytesPerRow:bytesPerRow];
+
+      CFTimeInterval start = CACurrentMediaTime();
+      for (int i = 0; i < MAX(1, iterations); i++) {
+        [bench colorizePlane:values width:width height:height pixels:pixels.mutableBytes bytesPerRow:bytesPerRow];
+      }
+      double avgMs = (CACurrentMediaTime() - start) * 1000.0 / MAX(1, iterations);
+      [results addObject:@{ @"width": @(width), @"height": @(height), @"distribution": mode[0], @"avgMs": @(avgMs) }];
+    }
+  }
+  return results;
+}
+
+#pragma mark - Inverse lookup
+
+static inline int FlirInverseCell(int r, int g, int b)
+{
+  const int shift = 8 - FLIR_INVERSE_BITS;
+  return ((r >> shift) << (2 * FLIR_INVERSE_BITS)) | ((g >> shift) << FLIR_INVERSE_BITS) | (b >> shift);
+}
+
+static inline int FlirColorDistance(uint32_t bgra, int r, int g, int b)
+{
+  int dr = (int)((bgra >> 16) & 0xFF) - r;
+  int dg = (int)((bgra >> 8) & 0xFF) - g;
+  int db = (int)(bgra & 0xFF) - b;
+  return dr * dr + dg * dg + db * db;
+}
+
+// One-off brute force over the LUT for every cell center; lookups afterwards are a single read
+static void FlirBuildInverse(uint16_t *inverse, const uint32_t *lut)
+{
+  const int size = 1 << FLIR_INVERSE_BITS;
+  const int half = 1 << (7 - FLIR_INVERSE_BITS);
+  for (int cr = 0; cr < size; cr++) {
+    for (int cg = 0; cg < size; cg++) {
+      for (int cb = 0; cb < size; cb++) {
+        int r = (cr << (8 - FLIR_INVERSE_BITS)) + half;
+        int g = (cg << (8 - FLIR_INVERSE_BITS)) + half;
+        int b = (cb << (8 - FLIR_INVERSE_BITS)) + half;
+        int best = 0, bestDistance = INT_MAX;
+        for (int i = 0; i < FLIR_LUT_ENTRIES; i++) {
+          int d = FlirColorDistance(lut[i], r, g, b);
+          if (d < bestDistance) {
+            bestDistance = d;
+            best = i;
+          }
+        }
+        inverse[(cr << (2 * FLIR_INVERSE_BITS)) | (cg << FLIR_INVERSE_BITS) | cb] = (uint16_t)best;
+      }
+    }
+  }
+}
+
+- (NSData *)currentLutWithMin:(float *)min max:(float *)max
+{
+  os_unfair_lock_lock(&_lock);
+  NSData *lut = _lut;
+  *min = _spanMin;
+  *max = _spanMax;
+  os_unfair_lock_unlock(&_lock);
+  return lut;
+}
+
+// Calls the block with the inverse grid for the current LUT and span, building it if needed
+- (BOOL)withInverse:(void (NS_NOESCAPE ^)(const uint16_t *inverse, const uint32_t *lut, const float *bins, float min, float max))block
+{
+  float bins[FLIR_COLORIZER_LUT_SIZE];
+  os_unfair_lock_lock(&_lock);
+  NSData *lutData = _lut;
+  float min = _spanMin, max = _spanMax;
+  memcpy(bins, _binForIndex, sizeof(bins));
+  os_unfair_lock_unlock(&_lock);
+  if (lutData == nil) return NO;
+
+  os_unfair_lock_lock(&_inverseLock);
+  if (_inverseSource != lutData) {
+    FlirBuildInverse(_inverse, (const uint32_t *)lutData.bytes);
+    _inverseSource = lutData;
+  }
+  block(_inverse, (const uint32_t *)lutData.bytes, bins, min, max);
+  os_unfair_lock_unlock(&_inverseLock);
+  return YES;
+}
+
+// bins maps a palette position back through the color distribution transfer to a span bin
+static inline float FlirInverseTemperature(const uint16_t *inverse, const uint32_t *lut, const float *bins, float min, float max, int r, int g, int b)
+{
+  int idx = inverse[FlirInverseCell(r, g, b)];
+  if (idx == 0 || idx == FLIR_COLORIZER_LUT_SIZE + 1) return NAN;
+  if (FlirColorDistance(lut[idx], r, g, b) > FLIR_INVERSE_MAX_DISTANCE) return NAN;
+  return min + bins[idx - 1] * (max - min) / (FLIR_COLORIZER_LUT_SIZE - 1);
+}
+
+- (float)temperatureForColor:(uint32_t)argb
+{
+  __block float result = NAN;
+  [self withInverse:^(const uint16_t *inverse, const uint32_t *lut, const float *bins, float min, float max) {
+    result = FlirInverseTemperature(inverse, lut, bins, min, max, (argb >> 16) & 0xFF, (argb >> 8) & 0xFF, argb & 0xFF);
+  }];
+  return result;
+}
+
+- (NSData *)temperaturesForImage:(UIImage *)image width:(int *)outWidth height:(int *)outHeight
+{
+  CGImageRef cgImage = image.CGImage;
+  if (cgImage == NULL) return nil;
+  int width = (int)CGImageGetWidth(cgImage);
+  int height = (int)CGImageGetHeight(cgImage);
+  NSMutableData *pixels = [NSMutableData dataWithLength:(NSUInteger)width * height * 4];
+  CGColorSpaceRef colorSpace = CGColorSpaceCreateDeviceRGB();
+  CGContextRef context = CGBitmapContextCreate(pixels.mutableBytes, width, height, 8, (size_t)width * 4, colorSpace,
+                                               kCGImageAlphaPremultipliedFirst | kCGBitmapByteOrder32Little);
+  CGColorSpaceRelease(colorSpace);
+  if (context == NULL) return nil;
+  CGContextDrawImage(context, CGRectMake(0, 0, width, height), cgImage);
+  CGContextRelease(context);
+
+  NSMutableData *values = [NSMutableData dataWithLength:(NSUInteger)width * height * sizeof(float)];
+  BOOL ok = [self withInverse:^(const uint16_t *inverse, const uint32_t *lut, const float *bins, float min, float max) {
+    const uint32_t *src = (const uint32_t *)pixels.bytes;
+    float *dst = (float *)values.mutableBytes;
+    NSUInteger count = (NSUInteger)width * height;
+    for (NSUInteger i = 0; i < count; i++) {
+      uint32_t c = src[i];
+      dst[i] = FlirInverseTemperature(inverse, lut, bins, min, max, (c >> 16) & 0xFF, (c >> 8) & 0xFF, c & 0xFF);
+    }
+  }];
+  if (!ok) return nil;
+  if (outWidth) *outWidth = width;
+  if (outHeight) *outHeight = height;
+  return values;
+}
+
+@end
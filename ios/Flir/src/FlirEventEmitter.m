@@ -21,7 +21,7 @@ RCT_EXPORT_MODULE();
 
 - (NSArray<NSString *> *)supportedEvents
 {
-  return @[@"FlirDeviceConnected", @"FlirDeviceDisconnected", @"FlirFrame"];
+  return @[@"FlirDeviceConnected", @"FlirDeviceDisconnected", @"FlirFrame", @"FlirRegionStats", @"FlirIsothermStats", @"FlirScaleChanged", @"FlirError"];
 }
 
 - (void)sendDeviceEvent:(NSString *)name body:(id)body
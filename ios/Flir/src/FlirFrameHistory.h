@@ -0,0 +1,39 @@
+#import <Foundation/Foundation.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+// Pre-trigger history: the last seconds of Celsius planes, encoded like a .flirrec recording and
+// kept in one fixed byte arena. The oldest frames are evicted up to the next keyframe when the
+// arena, the entry table or the time limit runs out, so the history always starts decodable.
+// Everything except the completion blocks runs on the stream queue.
+@interface FlirFrameHistory : NSObject
+
+@property (nonatomic, readonly) BOOL enabled;
+
+// Keeps up to seconds of history in at most maxBytes; 0 seconds disables it and frees the arena.
+// Drops the frames held so far.
+- (void)configureSeconds:(double)seconds maxBytes:(NSUInteger)maxBytes keyframeInterval:(int)keyframeInterval;
+
+- (void)appendPlane:(const float *)plane width:(int)width height:(int)height timestampNanos:(uint64_t)timestampNanos;
+
+// Copies the compressed frames from the keyframe at or before preSeconds ago, collects frames
+// for postSeconds more and writes them to path on a background queue. completion gets
+// { path, frames, preSeconds, postSeconds, bytesWritten, writeMs } or the write error.
+- (void)captureWindowPreSeconds:(double)preSeconds
+                    postSeconds:(double)postSeconds
+                           path:(NSString *)path
+                       metadata:(nullable NSDictionary *)metadata
+                     completion:(void (^)(NSDictionary *_Nullable stats, NSError *_Nullable error))completion;
+
+// Writes pending captures with the frames collected so far, e.g. when the stream stops.
+- (void)flush;
+
+// Drops the held frames; pending captures keep theirs.
+- (void)clear;
+
+// { enabled, frames, seconds, bytesUsed, capacityBytes, avgEncodeMs, capturesPending, capturesWritten }
+- (NSDictionary *)stats;
+
+@end
+
+NS_ASSUME_NONNULL_END
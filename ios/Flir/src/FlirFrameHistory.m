@@ -0,0 +1,294 @@
+#import "FlirFrameHistory.h"
+#import "FlirRecorder.h"
+#import <stdatomic.h>
+
+// Entry table bound: up to 60 fps for the configured time
+#define FLIR_HISTORY_MAX_FPS 60
+
+typedef struct {
+  uint64_t timestamp;
+  size_t offset;
+  size_t length;
+  BOOL keyframe;
+} FlirHistoryEntry;
+
+// Frames copied out of the history for one requested window
+@interface FlirHistoryCapture : NSObject
+@property (nonatomic, copy) NSString *path;
+@property (nonatomic, copy) NSDictionary *metadata;
+@property (nonatomic, copy) void (^completion)(NSDictionary *_Nullable, NSError *_Nullable);
+@property (nonatomic, assign) uint64_t triggerNanos;
+@property (nonatomic, assign) uint64_t endNanos;
+@property (nonatomic, assign) int keyframeInterval;
+@property (nonatomic, strong) NSMutableData *data;
+// FlirHistoryEntry per frame, offsets into data; frames of another size than the first are skipped
+@property (nonatomic, strong) NSMutableData *entries;
+@property (nonatomic, assign) int width;
+@property (nonatomic, assign) int height;
+@end
+
+@implementation FlirHistoryCapture
+
+- (void)addPayload:(const uint8_t *)payload length:(size_t)length keyframe:(BOOL)keyframe timestamp:(uint64_t)timestamp
+{
+  FlirHistoryEntry entry = {timestamp, self.data.length, length, keyframe};
+  [self.data appendBytes:payload length:length];
+  [self.entries appendBytes:&entry length:sizeof(entry)];
+}
+
+@end
+
+@implementation FlirFrameHistory {
+    FlirPlaneEncoder *_encoder;
+    dispatch_queue_t _writeQueue;
+    NSMutableArray<FlirHistoryCapture *> *_pending;
+    uint64_t _windowNanos;
+    int _keyframeInterval;
+    NSMutableData *_arena;
+    size_t _head;
+    // Entry ring, oldest at _first
+    NSMutableData *_entries;
+    NSInteger _capacity;
+    NSInteger _first;
+    NSInteger _count;
+    size_t _bytesUsed;
+    int _width;
+    int _height;
+    int _sinceKeyframe;
+    uint64_t _framesEncoded;
+    uint64_t _encodeNanos;
+    _Atomic uint64_t _capturesWritten;
+}
+
+- (instancetype)init
+{
+  if (self = [super init]) {
+    _encoder = [[FlirPlaneEncoder alloc] init];
+    _writeQueue = dispatch_queue_create("flir.history", DISPATCH_QUEUE_SERIAL);
+    _pending = [NSMutableArray array];
+    _keyframeInterval = 10;
+    _arena = [NSMutableData data];
+    _entries = [NSMutableData data];
+    atomic_init(&_capturesWritten, 0);
+  }
+  return self;
+}
+
+- (BOOL)enabled
+{
+  return _windowNanos > 0 && _arena.length > 0;
+}
+
+- (void)configureSeconds:(double)seconds maxBytes:(NSUInteger)maxBytes keyframeInterval:(int)keyframeInterval
+{
+  _windowNanos = (uint64_t)(MAX(0, seconds) * 1e9);
+  _keyframeInterval = MAX(1, keyframeInterval);
+  _capacity = _windowNanos > 0 ? (NSInteger)ceil(seconds * FLIR_HISTORY_MAX_FPS) + 1 : 0;
+  _arena = [NSMutableData dataWithLength:_windowNanos > 0 ? maxBytes : 0];
+  _entries = [NSMutableData dataWithLength:(NSUInteger)_capacity * sizeof(FlirHistoryEntry)];
+  [self clear];
+}
+
+- (void)clear
+{
+  _head = 0;
+  _first = 0;
+  _count = 0;
+  _bytesUsed = 0;
+  _width = 0;
+  _height = 0;
+  _sinceKeyframe = 0;
+}
+
+- (FlirHistoryEntry *)entryAt:(NSInteger)i
+{
+  return (FlirHistoryEntry *)_entries.mutableBytes + (_first + i) % _capacity;
+}
+
+- (void)appendPlane:(const float *)plane width:(int)width height:(int)height timestampNanos:(uint64_t)timestampNanos
+{
+  if (!self.enabled) return;
+  uint64_t start = clock_gettime_nsec_np(CLOCK_UPTIME_RAW);
+  if (width != _width || height != _height) {
+    _width = width;
+    _height = height;
+    _sinceKeyframe = 0;
+  }
+  BOOL keyframe = _sinceKeyframe == 0;
+  size_t length = [_encoder encodePlane:plane width:width height:height keyframe:keyframe];
+  if (length == 0) {
+    [self clear];
+    return;
+  }
+  _sinceKeyframe = (_sinceKeyframe + 1) % _keyframeInterval;
+
+  for (NSInteger i = (NSInteger)_pending.count - 1; i >= 0; i--) {
+    FlirHistoryCapture *capture = _pending[(NSUInteger)i];
+    if (timestampNanos <= capture.endNanos) {
+      if (capture.width == 0) {
+        capture.width = width;
+        capture.height = height;
+      }
+      if (width == capture.width && height == capture.height) {
+        [capture addPayload:_encoder.bytes length:length keyframe:keyframe timestamp:timestampNanos];
+      }
+    }
+    if (timestampNanos >= capture.endNanos) {
+      [_pending removeObjectAtIndex:(NSUInteger)i];
+      [self submit:capture];
+    }
+  }
+  if ([self storePayload:_encoder.bytes length:length keyframe:keyframe timestamp:timestampNanos]) {
+    [self evictBefore:timestampNanos > _windowNanos ? timestampNanos - _windowNanos : 0];
+  } else {
+    // Too large for the arena, or its keyframe was evicted: restart the delta chain
+    [self clear];
+  }
+  _framesEncoded++;
+  _encodeNanos += clock_gettime_nsec_np(CLOCK_UPTIME_RAW) - start;
+}
+
+- (BOOL)storePayload:(const uint8_t *)payload length:(size_t)length keyframe:(BOOL)keyframe timestamp:(uint64_t)timestamp
+{
+  if (length > _arena.length) return NO;
+  if (_head + length > _arena.length) {
+    // Wrap: whatever is left past the write position is the oldest part of the history
+    while (_count > 0 && [self entryAt:0]->offset >= _head) [self evictOldest];
+    _head = 0;
+  }
+  // Entries follow each other through the arena, so only the oldest can overlap the next write
+  while (_count > 0) {
+    FlirHistoryEntry *oldest = [self entryAt:0];
+    if (!(oldest->offset < _head + length && oldest->offset + oldest->length > _head)) break;
+    [self evictOldest];
+  }
+  if (_count == _capacity) [self evictOldest];
+  while (_count > 0 && ![self entryAt:0]->keyframe) [self evictOldest];
+  if (_count == 0 && !keyframe) return NO;
+
+  FlirHistoryEntry *entry = [self entryAt:_count++];
+  *entry = (FlirHistoryEntry){timestamp, _head, length, keyframe};
+  memcpy((uint8_t *)_arena.mutableBytes + _head, payload, length);
+  _head += length;
+  _bytesUsed += length;
+  return YES;
+}
+
+// Drops whole keyframe groups once the next group alone still covers the cutoff
+- (void)evictBefore:(uint64_t)cutoff
+{
+  while (_count > 1) {
+    NSInteger next = 1;
+    while (next < _count && ![self entryAt:next]->keyframe) next++;
+    if (next == _count || [self entryAt:next]->timestamp > cutoff) return;
+    for (NSInteger i = 0; i < next; i++) [self evictOldest];
+  }
+}
+
+- (void)evictOldest
+{
+  _bytesUsed -= [self entryAt:0]->length;
+  _first = (_first + 1) % _capacity;
+  _count--;
+}
+
+- (void)captureWindowPreSeconds:(double)preSeconds
+                    postSeconds:(double)postSeconds
+                           path:(NSString *)path
+                       metadata:(NSDictionary *)metadata
+                     completion:(void (^)(NSDictionary *, NSError *))completion
+{
+  uint64_t trigger = clock_gettime_nsec_np(CLOCK_UPTIME_RAW);
+  uint64_t preNanos = (uint64_t)(MAX(0, preSeconds) * 1e9);
+  uint64_t windowStart = trigger > preNanos ? trigger - preNanos : 0;
+  FlirHistoryCapture *capture = [[FlirHistoryCapture alloc] init];
+  capture.path = path;
+  capture.metadata = metadata ?: @{};
+  capture.completion = completion;
+  capture.triggerNanos = trigger;
+  capture.endNanos = trigger + (uint64_t)(MAX(0, postSeconds) * 1e9);
+  capture.keyframeInterval = _keyframeInterval;
+  capture.data = [NSMutableData dataWithCapacity:_bytesUsed];
+  capture.entries = [NSMutableData data];
+  capture.width = _width;
+  capture.height = _height;
+
+  NSInteger from = 0;
+  for (NSInteger i = 0; i < _count; i++) {
+    FlirHistoryEntry *entry = [self entryAt:i];
+    if (entry->timestamp > windowStart) break;
+    if (entry->keyframe) from = i;
+  }
+  const uint8_t *arena = (const uint8_t *)_arena.bytes;
+  for (NSInteger i = from; i < _count; i++) {
+    FlirHistoryEntry *entry = [self entryAt:i];
+    [capture addPayload:arena + entry->offset length:entry->length keyframe:entry->keyframe timestamp:entry->timestamp];
+  }
+  if (postSeconds > 0) {
+    [_pending addObject:capture];
+  } else {
+    [self submit:capture];
+  }
+}
+
+- (void)flush
+{
+  for (FlirHistoryCapture *capture in _pending) [self submit:capture];
+  [_pending removeAllObjects];
+}
+
+- (void)submit:(FlirHistoryCapture *)capture
+{
+  dispatch_async(_writeQueue, ^{
+    [self write:capture];
+  });
+}
+
+- (void)write:(FlirHistoryCapture *)capture
+{
+  uint64_t start = clock_gettime_nsec_np(CLOCK_UPTIME_RAW);
+  FlirRecorder *recorder = [[FlirRecorder alloc] initWithPath:capture.path keyframeInterval:capture.keyframeInterval];
+  NSError *error = nil;
+  const uint8_t *data = (const uint8_t *)capture.data.bytes;
+  const FlirHistoryEntry *entries = (const FlirHistoryEntry *)capture.entries.bytes;
+  NSInteger frames = (NSInteger)(capture.entries.length / sizeof(FlirHistoryEntry));
+  for (NSInteger i = 0; i < frames && error == nil; i++) {
+    [recorder appendPayload:data + entries[i].offset length:entries[i].length keyframe:entries[i].keyframe
+                      width:capture.width height:capture.height timestampNanos:entries[i].timestamp
+                   metadata:capture.metadata error:&error];
+  }
+  [recorder close];
+  atomic_fetch_add(&_capturesWritten, 1);
+  if (error != nil) {
+    capture.completion(nil, error);
+    return;
+  }
+  NSDictionary *recorded = [recorder stats];
+  uint64_t first = frames > 0 ? entries[0].timestamp : capture.triggerNanos;
+  uint64_t last = frames > 0 ? entries[frames - 1].timestamp : capture.triggerNanos;
+  capture.completion(@{
+    @"path": capture.path,
+    @"frames": recorded[@"frames"],
+    @"preSeconds": @(first < capture.triggerNanos ? (capture.triggerNanos - first) / 1e9 : 0),
+    @"postSeconds": @(last > capture.triggerNanos ? (last - capture.triggerNanos) / 1e9 : 0),
+    @"bytesWritten": recorded[@"bytesWritten"],
+    @"writeMs": @((clock_gettime_nsec_np(CLOCK_UPTIME_RAW) - start) / 1e6)
+  }, nil);
+}
+
+- (NSDictionary *)stats
+{
+  double seconds = _count > 1 ? ([self entryAt:_count - 1]->timestamp - [self entryAt:0]->timestamp) / 1e9 : 0;
+  return @{
+    @"enabled": @(self.enabled),
+    @"frames": @(_count),
+    @"seconds": @(seconds),
+    @"bytesUsed": @(_bytesUsed),
+    @"capacityBytes": @(_arena.length),
+    @"avgEncodeMs": @(_framesEncoded > 0 ? _encodeNanos / 1e6 / _framesEncoded : 0),
+    @"capturesPending": @(_pending.count),
+    @"capturesWritten": @(atomic_load(&_capturesWritten))
+  };
+}
+
+@end
@@ -1,73 +1,649 @@
 #import "FlirModule.h"
 #import "FlirEventEmitter.h"
 #import "FlirState.h"
+#import "FlirRegionStatistics.h"
+#import "FlirPreviewView.h"
+#import "FlirColorizer.h"
+#import "FlirScaleBar.h"
+#import "FlirRecorder.h"
+#import "FlirVideoRecorder.h"
+#import "FlirFrameHistory.h"
 #import <ThermalSDK/ThermalSDK.h>
 #import <React/RCTLog.h>
+#import <stdatomic.h>
+
+#define FLIR_MAX_ZOOM 8.f
 
 #ifndef F1_gen3
 #define F1_gen3 FLIRCameraType_flirOne
 #endif
 
 
-@interface FlirModule() <FLIRDiscoveryEventDelegate>
+@interface FlirModule() <FLIRDiscoveryEventDelegate, FLIRDataReceivedDelegate, FLIRStreamDelegate>
 @property (nonatomic, strong) FLIRDiscovery *discovery;
 @property (nonatomic, strong) FLIRCamera *camera;
+@property (nonatomic, strong) FLIRStream *stream;
+@property (nonatomic, strong) FLIRThermalStreamer *streamer;
+// Serial queue owning the camera, stream start/stop and streamer updates
+@property (nonatomic, strong) dispatch_queue_t streamQueue;
 @property (nonatomic, strong) FLIRIdentity *connectedIdentity;
 @property (nonatomic, assign) BOOL isEmulatorMode;
 @property (nonatomic, assign) BOOL isPhysicalDeviceConnected;
+// Delivered-frame to sensor mapping of the last processed frame
+@property (atomic, copy) NSDictionary *zoomTransform;
 @end
 
-@implementation FlirModule
+@implementation FlirModule {
+    // Set while a frame is queued on streamQueue; further frames are dropped until it is processed
+    atomic_bool _framePending;
+    // Arrival time of the newest streamed image, and of the one being processed (streamQueue)
+    _Atomic uint64_t _frameArrivalNanos;
+    uint64_t _frameTimestampNanos;
+    // Zoom state, streamQueue only
+    float _zoomFactor;
+    int _zoomPanX;
+    int _zoomPanY;
+    CGRect _zoomCrop;
+    int _sensorWidth;
+    int _sensorHeight;
+    NSMutableData *_zoomPlane;
+    // Recording, streamQueue only; metadata is captured from the first recorded frame
+    FlirRecorder *_recorder;
+    NSDictionary *_recordingMetadata;
+    // Playback reads are serialized on their own queue so decoding never stalls the stream
+    dispatch_queue_t _playbackQueue;
+    FlirRecording *_playback;
+    NSString *_playbackPath;
+    // MP4 of the colorized preview, streamQueue only; fed from the preview's frame tap
+    FlirVideoRecorder *_videoRecorder;
+    // Pre-trigger history, streamQueue only; metadata is captured from the first frame it holds
+    FlirFrameHistory *_history;
+    NSDictionary *_historyMetadata;
+    // Set while a snapshot saves the streamer's image; processFrame skips frames meanwhile
+    atomic_bool _snapshotPinned;
+    _Atomic uint64_t _snapshotFramesSkipped;
+    // Snapshot stats, _snapshotQueue only
+    dispatch_queue_t _snapshotQueue;
+    uint64_t _snapshots;
+    double _lastSnapshotMs;
+    double _avgSnapshotMs;
+}
 
 RCT_EXPORT_MODULE(FlirIOS);
 
+- (instancetype)init
+{
+  if (self = [super init]) {
+    _streamQueue = dispatch_queue_create("flir.stream", DISPATCH_QUEUE_SERIAL);
+    atomic_init(&_framePending, false);
+    atomic_init(&_frameArrivalNanos, 0);
+    _zoomFactor = 1.f;
+    _zoomCrop = CGRectNull;
+    _zoomPlane = [NSMutableData data];
+    _playbackQueue = dispatch_queue_create("flir.playback", DISPATCH_QUEUE_SERIAL);
+    _history = [[FlirFrameHistory alloc] init];
+    atomic_init(&_snapshotPinned, false);
+    atomic_init(&_snapshotFramesSkipped, 0);
+    _snapshotQueue = dispatch_queue_create("flir.snapshot", DISPATCH_QUEUE_SERIAL);
+  }
+  return self;
+}
+
 RCT_EXPORT_METHOD(startDiscovery)
 {
-  // Hook into ThermalSDK discovery when ready. For now, emit an event to JS.
   dispatch_async(dispatch_get_main_queue(), ^{
-    [[FlirEventEmitter shared] sendDeviceEvent:@"FlirDeviceConnected" body:@{ @"msg": @"discovery-started" }];
-    RCTLogInfo(@"FLIR discovery started (placeholder)");
+    if (!self.discovery) {
+      self.discovery = [[FLIRDiscovery alloc] init];
+      self.discovery.delegate = self;
+    }
+    [self.discovery start:FLIRCommunicationInterfaceLightning | FLIRCommunicationInterfaceEmulator];
+    RCTLogInfo(@"FLIR discovery started");
   });
 }
 
 RCT_EXPORT_METHOD(stopDiscovery)
 {
   dispatch_async(dispatch_get_main_queue(), ^{
-    [[FlirEventEmitter shared] sendDeviceEvent:@"FlirDeviceDisconnected" body:@{ @"msg": @"discovery-stopped" }];
-    RCTLogInfo(@"FLIR discovery stopped (placeholder)");
+    [self.discovery stop];
+    RCTLogInfo(@"FLIR discovery stopped");
   });
 }
 
 RCT_EXPORT_METHOD(connect:(NSDictionary *)identity resolver:(RCTPromiseResolveBlock)resolve rejecter:(RCTPromiseRejectBlock)reject)
 {
-  // TODO: implement real connect using ThermalSDK and identity info
-  dispatch_async(dispatch_get_main_queue(), ^{
-    RCTLogInfo(@"Flir connect called (placeholder)");
-    [[FlirEventEmitter shared] sendDeviceEvent:@"FlirDeviceConnected" body:@{ @"identity": identity ?: @{} }];
-    resolve(@(YES));
+  FLIRIdentity *target = self.connectedIdentity;
+  NSString *deviceId = identity[@"deviceId"];
+  if (target == nil || (deviceId != nil && ![deviceId isEqualToString:[target deviceId]])) {
+    reject(@"ERR_FLIR_CONNECT", @"Device has not been discovered", nil);
+    return;
+  }
+  dispatch_async(self.streamQueue, ^{
+    NSError *error = nil;
+    if ([self connectAndStream:target error:&error]) {
+      resolve(@(YES));
+    } else {
+      reject(@"ERR_FLIR_CONNECT", error.localizedDescription ?: @"Failed to connect", error);
+    }
   });
 }
 
 RCT_EXPORT_METHOD(disconnect)
 {
-  dispatch_async(dispatch_get_main_queue(), ^{
-    RCTLogInfo(@"Flir disconnect called (placeholder)");
+  dispatch_async(self.streamQueue, ^{
+    [self stopStreaming];
+    [self.camera disconnect];
     [[FlirEventEmitter shared] sendDeviceEvent:@"FlirDeviceDisconnected" body:@{}];
   });
 }
 
 RCT_EXPORT_METHOD(getTemperatureAt:(nonnull NSNumber *)x y:(nonnull NSNumber *)y resolver:(RCTPromiseResolveBlock)resolve rejecter:(RCTPromiseRejectBlock)reject) {
-  // Return the last sampled temperature from the preview/state singleton
-  dispatch_async(dispatch_get_main_queue(), ^{
-    double t = [FlirState shared].lastTemperature;
-    if (isnan(t)) {
-      resolve([NSNull null]);
+  // Indexed load from the radiometric plane kept by FlirState
+  double t = [[FlirState shared] queryTemperatureAtPoint:x.intValue y:y.intValue];
+  if (isnan(t)) {
+    resolve([NSNull null]);
+  } else {
+    resolve(@(t));
+  }
+}
+
+// Temperature at a pixel of the delivered (zoomed) frame, interpolated on the sensor plane
+RCT_EXPORT_METHOD(getTemperatureAtFramePoint:(nonnull NSNumber *)x y:(nonnull NSNumber *)y resolver:(RCTPromiseResolveBlock)resolve rejecter:(RCTPromiseRejectBlock)reject) {
+  NSDictionary *transform = self.zoomTransform;
+  float sx = x.floatValue, sy = y.floatValue;
+  if (transform != nil) {
+    sx = [transform[@"cropX"] floatValue] + (sx + 0.5f) * [transform[@"scaleX"] floatValue] - 0.5f;
+    sy = [transform[@"cropY"] floatValue] + (sy + 0.5f) * [transform[@"scaleY"] floatValue] - 0.5f;
+  }
+  double t = [[FlirState shared] sampleTemperatureAtX:sx y:sy];
+  if (isnan(t)) {
+    reject(@"ERR_NO_DATA", @"No temperature data available", nil);
+  } else {
+    resolve(@(t));
+  }
+}
+
+RCT_EXPORT_METHOD(getTemperaturesAt:(NSArray *)points resolver:(RCTPromiseResolveBlock)resolve rejecter:(RCTPromiseRejectBlock)reject) {
+  NSArray *values = [[FlirState shared] temperaturesAtPoints:points];
+  if (values == nil) {
+    reject(@"ERR_NO_DATA", @"No temperature data available", nil);
+  } else {
+    resolve(values);
+  }
+}
+
+RCT_EXPORT_METHOD(getTemperaturesInRect:(nonnull NSNumber *)x y:(nonnull NSNumber *)y width:(nonnull NSNumber *)width height:(nonnull NSNumber *)height resolver:(RCTPromiseResolveBlock)resolve rejecter:(RCTPromiseRejectBlock)reject) {
+  CGRect rect = CGRectMake(x.doubleValue, y.doubleValue, width.doubleValue, height.doubleValue);
+  NSDictionary *values = [[FlirState shared] temperaturesInRect:rect];
+  if (values == nil) {
+    reject(@"ERR_NO_DATA", @"No temperature data available", nil);
+  } else {
+    resolve(values);
+  }
+}
+
+RCT_EXPORT_METHOD(getLineProfile:(nonnull NSNumber *)x0 y0:(nonnull NSNumber *)y0 x1:(nonnull NSNumber *)x1 y1:(nonnull NSNumber *)y1 samples:(nonnull NSNumber *)samples resolver:(RCTPromiseResolveBlock)resolve rejecter:(RCTPromiseRejectBlock)reject) {
+  NSArray *values = [[FlirState shared] lineProfileFrom:CGPointMake(x0.doubleValue, y0.doubleValue)
+                                                     to:CGPointMake(x1.doubleValue, y1.doubleValue)
+                                                samples:samples.integerValue];
+  if (values == nil) {
+    reject(@"ERR_NO_DATA", @"No temperature data available", nil);
+  } else {
+    resolve(values);
+  }
+}
+
+// Regions: [{ id, type: 'rect'|'ellipse'|'polygon'|'line', ... }]; stats arrive as FlirRegionStats events
+RCT_EXPORT_METHOD(setRegions:(NSArray *)regions resolver:(RCTPromiseResolveBlock)resolve rejecter:(RCTPromiseRejectBlock)reject) {
+  NSSet *types = [NSSet setWithObjects:@"rect", @"ellipse", @"polygon", @"line", nil];
+  for (NSDictionary *region in regions) {
+    NSString *type = region[@"type"] ?: @"rect";
+    if (![types containsObject:type]) {
+      reject(@"ERR_FLIR_REGION", [NSString stringWithFormat:@"Unknown region type: %@", type], nil);
+      return;
+    }
+  }
+  [[FlirRegionStatistics shared] setRegions:regions];
+  resolve(@(regions.count));
+}
+
+RCT_EXPORT_METHOD(setStatisticsPercentiles:(NSArray<NSNumber *> *)percentiles resolver:(RCTPromiseResolveBlock)resolve rejecter:(RCTPromiseRejectBlock)reject) {
+  [FlirRegionStatistics shared].percentiles = percentiles;
+  resolve(nil);
+}
+
+RCT_EXPORT_METHOD(getAvailablePalettes:(RCTPromiseResolveBlock)resolve rejecter:(RCTPromiseRejectBlock)reject) {
+  resolve([FlirColorizer availablePalettes]);
+}
+
+RCT_EXPORT_METHOD(setPalette:(NSString *)name resolver:(RCTPromiseResolveBlock)resolve rejecter:(RCTPromiseRejectBlock)reject) {
+  [self applyPalette:name inverted:NO resolver:resolve rejecter:reject];
+}
+
+RCT_EXPORT_METHOD(setPaletteInverted:(NSString *)name inverted:(BOOL)inverted resolver:(RCTPromiseResolveBlock)resolve rejecter:(RCTPromiseRejectBlock)reject) {
+  [self applyPalette:name inverted:inverted resolver:resolve rejecter:reject];
+}
+
+// Palette and span changes re-colorize the last frame from the cached plane without waiting for the camera
+- (void)applyPalette:(NSString *)name inverted:(BOOL)inverted resolver:(RCTPromiseResolveBlock)resolve rejecter:(RCTPromiseRejectBlock)reject
+{
+  if (![[FlirColorizer shared] setPaletteNamed:name inverted:inverted]) {
+    reject(@"ERR_FLIR_PALETTE", [NSString stringWithFormat:@"Unknown palette: %@", name], nil);
+    return;
+  }
+  dispatch_async(self.streamQueue, ^{
+    [self renderColorizedPreview];
+    resolve([FlirColorizer shared].paletteName);
+  });
+}
+
+RCT_EXPORT_METHOD(setColorSpan:(nonnull NSNumber *)min max:(nonnull NSNumber *)max resolver:(RCTPromiseResolveBlock)resolve rejecter:(RCTPromiseRejectBlock)reject) {
+  [[FlirColorizer shared] setSpanMin:min.floatValue max:max.floatValue];
+  dispatch_async(self.streamQueue, ^{
+    [self renderColorizedPreview];
+    resolve(nil);
+  });
+}
+
+RCT_EXPORT_METHOD(setAutoColorSpan:(RCTPromiseResolveBlock)resolve rejecter:(RCTPromiseRejectBlock)reject) {
+  [[FlirColorizer shared] setAutoSpan];
+  dispatch_async(self.streamQueue, ^{
+    [self renderColorizedPreview];
+    resolve(nil);
+  });
+}
+
+// mode: 'linear' | 'histogram' | 'plateau'; options: { plateau, linearPercent, smoothing }
+RCT_EXPORT_METHOD(setColorDistribution:(NSString *)mode options:(NSDictionary *)options resolver:(RCTPromiseResolveBlock)resolve rejecter:(RCTPromiseRejectBlock)reject) {
+  NSDictionary<NSString *, NSNumber *> *modes = @{
+    @"linear": @(FlirColorDistributionLinear),
+    @"histogram": @(FlirColorDistributionHistogram),
+    @"plateau": @(FlirColorDistributionPlateau),
+  };
+  NSNumber *distribution = modes[mode];
+  if (distribution == nil) {
+    reject(@"ERR_FLIR_PALETTE", [NSString stringWithFormat:@"Unknown color distribution: %@", mode], nil);
+    return;
+  }
+  FlirColorizer *colorizer = [FlirColorizer shared];
+  [colorizer setDistribution:(FlirColorDistribution)distribution.integerValue
+                     plateau:options[@"plateau"] ? [options[@"plateau"] floatValue] : colorizer.plateau
+               linearPercent:options[@"linearPercent"] ? [options[@"linearPercent"] floatValue] : colorizer.linearPercent
+                   smoothing:options[@"smoothing"] ? [options[@"smoothing"] floatValue] : colorizer.smoothing];
+  dispatch_async(self.streamQueue, ^{
+    [self renderColorizedPreview];
+    resolve(nil);
+  });
+}
+
+// Off the stream queue so live preview keeps running while it measures
+RCT_EXPORT_METHOD(benchmarkColorDistribution:(RCTPromiseResolveBlock)resolve rejecter:(RCTPromiseRejectBlock)reject) {
+  dispatch_async(dispatch_get_global_queue(QOS_CLASS_UTILITY, 0), ^{
+    NSArray<NSValue *> *sizes = @[
+      [NSValue valueWithCGSize:CGSizeMake(160, 120)],
+      [NSValue valueWithCGSize:CGSizeMake(320, 240)],
+      [NSValue valueWithCGSize:CGSizeMake(640, 480)],
+    ];
+    resolve([[FlirColorizer shared] benchmarkSizes:sizes iterations:50]);
+  });
+}
+
+// Isotherms are drawn by the native colorizer; band counts arrive as FlirIsothermStats events
+RCT_EXPORT_METHOD(setIsotherms:(NSArray *)rules resolver:(RCTPromiseResolveBlock)resolve rejecter:(RCTPromiseRejectBlock)reject) {
+  NSString *error = nil;
+  if (![[FlirColorizer shared] setIsotherms:rules error:&error]) {
+    reject(@"ERR_FLIR_ISOTHERM", error, nil);
+    return;
+  }
+  dispatch_async(self.streamQueue, ^{
+    [self renderColorizedPreview];
+    resolve(@(rules.count));
+  });
+}
+
+// Digital zoom with FLIRDisplaySettings semantics: zoom >= 1, pan of the visible center from the
+// frame center in sensor pixels. Frames are cropped before they reach the preview.
+RCT_EXPORT_METHOD(setZoom:(nonnull NSNumber *)zoom panX:(nonnull NSNumber *)panX panY:(nonnull NSNumber *)panY resolver:(RCTPromiseResolveBlock)resolve rejecter:(RCTPromiseRejectBlock)reject) {
+  dispatch_async(self.streamQueue, ^{
+    self->_zoomFactor = MAX(1.f, MIN(FLIR_MAX_ZOOM, zoom.floatValue));
+    self->_zoomPanX = panX.intValue;
+    self->_zoomPanY = panY.intValue;
+    resolve(nil);
+  });
+}
+
+// Maps delivered frame pixels to sensor pixels: sensorX = cropX + (x + 0.5) * scaleX - 0.5
+RCT_EXPORT_METHOD(getZoomTransform:(RCTPromiseResolveBlock)resolve rejecter:(RCTPromiseRejectBlock)reject) {
+  NSDictionary *transform = self.zoomTransform;
+  if (transform == nil) {
+    reject(@"ERR_NO_DATA", @"No frame processed yet", nil);
+  } else {
+    resolve(transform);
+  }
+}
+
+// { palette, min, max, version, orientation, path }; the PNG is rendered once per palette/span change
+RCT_EXPORT_METHOD(getScaleBar:(NSString *)orientation resolver:(RCTPromiseResolveBlock)resolve rejecter:(RCTPromiseRejectBlock)reject) {
+  NSDictionary *scale = [[FlirScaleBar shared] scaleBarWithOrientation:orientation];
+  if (scale == nil) {
+    reject(@"ERR_NO_DATA", @"No palette or span known yet", nil);
+  } else {
+    resolve(scale);
+  }
+}
+
+// Appends every frame's Celsius plane to a compact .flirrec file (16-bit, delta + deflate);
+// options: path (defaults to the Documents directory), keyframeInterval (frames, default 30)
+RCT_EXPORT_METHOD(startRecording:(NSDictionary *)options resolver:(RCTPromiseResolveBlock)resolve rejecter:(RCTPromiseRejectBlock)reject) {
+  dispatch_async(self.streamQueue, ^{
+    if (self->_recorder != nil) {
+      reject(@"ERR_FLIR_RECORD", @"Already recording", nil);
+      return;
+    }
+    NSString *path = [options[@"path"] isKindOfClass:[NSString class]] ? options[@"path"] : nil;
+    if (path.length == 0) {
+      NSString *dir = NSSearchPathForDirectoriesInDomains(NSDocumentDirectory, NSUserDomainMask, YES).firstObject;
+      path = [dir stringByAppendingPathComponent:[NSString stringWithFormat:@"flir_%lld.flirrec",
+                                                  (long long)([[NSDate date] timeIntervalSince1970] * 1000)]];
+    }
+    int interval = options[@"keyframeInterval"] != nil ? [options[@"keyframeInterval"] intValue] : 30;
+    self->_recorder = [[FlirRecorder alloc] initWithPath:path keyframeInterval:interval];
+    self->_recordingMetadata = nil;
+    resolve(path);
+  });
+}
+
+RCT_EXPORT_METHOD(stopRecording:(RCTPromiseResolveBlock)resolve rejecter:(RCTPromiseRejectBlock)reject) {
+  dispatch_async(self.streamQueue, ^{
+    NSDictionary *stats = [self finishRecording];
+    if (stats == nil) {
+      reject(@"ERR_NO_DATA", @"Not recording", nil);
+    } else {
+      resolve(stats);
+    }
+  });
+}
+
+// Frames, bytes written, compression ratio against float planes and MB/s of the running recording
+RCT_EXPORT_METHOD(getRecordingStats:(RCTPromiseResolveBlock)resolve rejecter:(RCTPromiseRejectBlock)reject) {
+  dispatch_async(self.streamQueue, ^{
+    if (self->_recorder == nil) {
+      reject(@"ERR_NO_DATA", @"Not recording", nil);
+    } else {
+      resolve([self->_recorder stats]);
+    }
+  });
+}
+
+// zlib (the recording codec) against LZ4 on the latest plane, or a synthetic one before the first frame
+RCT_EXPORT_METHOD(benchmarkRecordingCodecs:(nonnull NSNumber *)frames resolver:(RCTPromiseResolveBlock)resolve rejecter:(RCTPromiseRejectBlock)reject) {
+  dispatch_async(self.streamQueue, ^{
+    __block NSMutableData *plane = nil;
+    __block int width = 0, height = 0;
+    [[FlirState shared] readPublishedTemperaturePlane:^(const float *values, int w, int h) {
+      plane = [NSMutableData dataWithBytes:values length:(NSUInteger)w * h * sizeof(float)];
+      width = w;
+      height = h;
+    }];
+    if (plane == nil) {
+      width = 320;
+      height = 240;
+      plane = [NSMutableData dataWithLength:(NSUInteger)width * height * sizeof(float)];
+      float *values = (float *)plane.mutableBytes;
+      for (int y = 0; y < height; y++) {
+        for (int x = 0; x < width; x++) {
+          values[y * width + x] = 20.f + 15.f * x / width + 5.f * y / height;
+        }
+      }
+    }
+    int count = MAX(1, MIN(500, frames.intValue));
+    // Off the stream queue so live preview keeps running while it measures
+    dispatch_async(dispatch_get_global_queue(QOS_CLASS_UTILITY, 0), ^{
+      resolve([FlirPlaneEncoder benchmarkCodecsWithPlane:(const float *)plane.bytes width:width height:height frames:count]);
+    });
+  });
+}
+
+RCT_EXPORT_METHOD(getRecordingInfo:(NSString *)path resolver:(RCTPromiseResolveBlock)resolve rejecter:(RCTPromiseRejectBlock)reject) {
+  dispatch_async(_playbackQueue, ^{
+    NSError *error = nil;
+    FlirRecording *recording = [self openRecording:path error:&error];
+    if (recording == nil) {
+      reject(@"ERR_FLIR_PLAYBACK", error.localizedDescription ?: @"Cannot open recording", error);
+      return;
+    }
+    resolve(@{
+      @"path": path,
+      @"width": @(recording.width),
+      @"height": @(recording.height),
+      @"frames": @(recording.frameCount),
+      @"keyframeInterval": @(recording.keyframeInterval),
+      @"durationMs": @(recording.durationNanos / 1e6),
+      @"createdAt": @(recording.createdAt),
+      @"clipMin": @(recording.clipMin),
+      @"clipMax": @(recording.clipMax),
+      @"metadata": recording.metadata
+    });
+  });
+}
+
+// Decodes one recorded frame; values are returned only when includeValues is set
+RCT_EXPORT_METHOD(getRecordingFrame:(NSString *)path index:(nonnull NSNumber *)index includeValues:(BOOL)includeValues resolver:(RCTPromiseResolveBlock)resolve rejecter:(RCTPromiseRejectBlock)reject) {
+  dispatch_async(_playbackQueue, ^{
+    NSError *error = nil;
+    FlirRecording *recording = [self openRecording:path error:&error];
+    NSInteger i = index.integerValue;
+    NSMutableData *plane = [NSMutableData dataWithLength:(NSUInteger)recording.width * recording.height * sizeof(float)];
+    float min = NAN, max = NAN;
+    if (recording == nil || ![recording readFrame:i into:(float *)plane.mutableBytes min:&min max:&max error:&error]) {
+      reject(@"ERR_FLIR_PLAYBACK", error.localizedDescription ?: @"Cannot read frame", error);
+      return;
+    }
+    NSMutableDictionary *frame = [@{
+      @"index": @(i),
+      @"timestamp": @([recording timestampNanosAtIndex:i] / 1e9),
+      @"width": @(recording.width),
+      @"height": @(recording.height),
+      @"min": isnan(min) ? (id)[NSNull null] : @(min),
+      @"max": isnan(max) ? (id)[NSNull null] : @(max)
+    } mutableCopy];
+    if (includeValues) {
+      const float *values = (const float *)plane.bytes;
+      NSInteger n = (NSInteger)recording.width * recording.height;
+      NSMutableArray *array = [NSMutableArray arrayWithCapacity:n];
+      for (NSInteger k = 0; k < n; k++) {
+        [array addObject:isnan(values[k]) ? (id)[NSNull null] : @(values[k])];
+      }
+      frame[@"values"] = array;
+    }
+    resolve(frame);
+  });
+}
+
+// Encodes the colorized preview to MP4 with per-frame stream timestamps; options: path (defaults to
+// the Documents directory), codec ("h264" or "hevc"), fps (nominal rate, default 9), bitRate (0 = auto)
+RCT_EXPORT_METHOD(startVideoRecording:(NSDictionary *)options resolver:(RCTPromiseResolveBlock)resolve rejecter:(RCTPromiseRejectBlock)reject) {
+  dispatch_async(self.streamQueue, ^{
+    if (self->_videoRecorder != nil) {
+      reject(@"ERR_FLIR_VIDEO", @"Already recording video", nil);
+      return;
+    }
+    NSString *path = [options[@"path"] isKindOfClass:[NSString class]] ? options[@"path"] : nil;
+    if (path.length == 0) {
+      NSString *dir = NSSearchPathForDirectoriesInDomains(NSDocumentDirectory, NSUserDomainMask, YES).firstObject;
+      path = [dir stringByAppendingPathComponent:[NSString stringWithFormat:@"flir_%lld.mp4",
+                                                  (long long)([[NSDate date] timeIntervalSince1970] * 1000)]];
+    }
+    NSString *codec = [options[@"codec"] isKindOfClass:[NSString class]] ? options[@"codec"] : @"h264";
+    if (![codec isEqualToString:@"h264"] && ![codec isEqualToString:@"hevc"]) {
+      reject(@"ERR_FLIR_VIDEO", [NSString stringWithFormat:@"Unknown codec: %@", codec], nil);
+      return;
+    }
+    FlirVideoRecorder *recorder = [[FlirVideoRecorder alloc] initWithPath:path codec:codec
+                                                                      fps:[options[@"fps"] intValue]
+                                                                  bitRate:[options[@"bitRate"] longLongValue]];
+    self->_videoRecorder = recorder;
+    __weak FlirModule *weakSelf = self;
+    [FlirPreviewView setFrameTap:^(CVPixelBufferRef buffer) {
+      FlirModule *strongSelf = weakSelf;
+      if (strongSelf == nil) return;
+      [recorder appendPixelBuffer:buffer timestampNanos:strongSelf->_frameTimestampNanos];
+    }];
+    resolve(path);
+  });
+}
+
+RCT_EXPORT_METHOD(stopVideoRecording:(RCTPromiseResolveBlock)resolve rejecter:(RCTPromiseRejectBlock)reject) {
+  dispatch_async(self.streamQueue, ^{
+    BOOL recording = [self finishVideoRecording:^(NSDictionary *stats, NSError *error) {
+      if (error != nil) {
+        reject(@"ERR_FLIR_VIDEO", error.localizedDescription, error);
+      } else {
+        resolve(stats);
+      }
+    }];
+    if (!recording) reject(@"ERR_NO_DATA", @"Not recording video", nil);
+  });
+}
+
+// Frames encoded and dropped, encode queue depth and average encode time of the running recording
+RCT_EXPORT_METHOD(getVideoRecordingStats:(RCTPromiseResolveBlock)resolve rejecter:(RCTPromiseRejectBlock)reject) {
+  dispatch_async(self.streamQueue, ^{
+    if (self->_videoRecorder == nil) {
+      reject(@"ERR_NO_DATA", @"Not recording video", nil);
     } else {
-      resolve(@(t));
+      resolve([self->_videoRecorder stats]);
+    }
+  });
+}
+
+// Pre-trigger history; options: seconds (0 disables), maxMB (default 32), keyframeInterval (default 10)
+RCT_EXPORT_METHOD(setFrameHistory:(NSDictionary *)options resolver:(RCTPromiseResolveBlock)resolve rejecter:(RCTPromiseRejectBlock)reject) {
+  double seconds = options[@"seconds"] != nil ? [options[@"seconds"] doubleValue] : 10;
+  double maxMB = options[@"maxMB"] != nil ? [options[@"maxMB"] doubleValue] : 32;
+  int interval = options[@"keyframeInterval"] != nil ? [options[@"keyframeInterval"] intValue] : 10;
+  dispatch_async(self.streamQueue, ^{
+    [self->_history configureSeconds:seconds maxBytes:(NSUInteger)(MAX(0, maxMB) * 1024 * 1024) keyframeInterval:interval];
+    self->_historyMetadata = nil;
+    resolve(nil);
+  });
+}
+
+RCT_EXPORT_METHOD(getFrameHistoryStats:(RCTPromiseResolveBlock)resolve rejecter:(RCTPromiseRejectBlock)reject) {
+  dispatch_async(self.streamQueue, ^{
+    resolve([self->_history stats]);
+  });
+}
+
+// Resolves once the window is written, i.e. postSeconds after the call; options: path
+RCT_EXPORT_METHOD(captureWindow:(nonnull NSNumber *)preSeconds postSeconds:(nonnull NSNumber *)postSeconds options:(NSDictionary *)options resolver:(RCTPromiseResolveBlock)resolve rejecter:(RCTPromiseRejectBlock)reject) {
+  dispatch_async(self.streamQueue, ^{
+    if (!self->_history.enabled) {
+      reject(@"ERR_FLIR_HISTORY", @"Frame history is disabled", nil);
+      return;
+    }
+    NSString *path = [options[@"path"] isKindOfClass:[NSString class]] ? options[@"path"] : nil;
+    if (path.length == 0) {
+      NSString *dir = NSSearchPathForDirectoriesInDomains(NSDocumentDirectory, NSUserDomainMask, YES).firstObject;
+      path = [dir stringByAppendingPathComponent:[NSString stringWithFormat:@"flir_window_%lld.flirrec",
+                                                  (long long)([[NSDate date] timeIntervalSince1970] * 1000)]];
+    }
+    [self->_history captureWindowPreSeconds:preSeconds.doubleValue postSeconds:postSeconds.doubleValue path:path
+                                   metadata:self->_historyMetadata completion:^(NSDictionary *stats, NSError *error) {
+      if (error != nil) {
+        reject(@"ERR_FLIR_HISTORY", error.localizedDescription, error);
+      } else {
+        resolve(stats);
+      }
+    }];
+  });
+}
+
+// Radiometric JPEG of the current frame via saveAs on a background queue; options: path,
+// visual (fusion photo as a JPEG next to it), overlay (embed the colorized frame as shown)
+RCT_EXPORT_METHOD(captureSnapshot:(NSDictionary *)options resolver:(RCTPromiseResolveBlock)resolve rejecter:(RCTPromiseRejectBlock)reject) {
+  uint64_t requested = clock_gettime_nsec_np(CLOCK_UPTIME_RAW);
+  bool expected = false;
+  if (!atomic_compare_exchange_strong(&_snapshotPinned, &expected, true)) {
+    reject(@"ERR_FLIR_SNAPSHOT", @"Snapshot in progress", nil);
+    return;
+  }
+  NSString *path = [options[@"path"] isKindOfClass:[NSString class]] ? options[@"path"] : nil;
+  if (path.length == 0) {
+    NSString *dir = NSSearchPathForDirectoriesInDomains(NSDocumentDirectory, NSUserDomainMask, YES).firstObject;
+    path = [dir stringByAppendingPathComponent:[NSString stringWithFormat:@"flir_snapshot_%lld.jpg",
+                                                (long long)([[NSDate date] timeIntervalSince1970] * 1000)]];
+  }
+  BOOL visual = [options[@"visual"] boolValue];
+  BOOL overlay = [options[@"overlay"] boolValue];
+  // Runs after the frame being processed, if any; later frames see the pin and are skipped
+  dispatch_async(self.streamQueue, ^{
+    FLIRThermalStreamer *streamer = self.streamer;
+    if (streamer == nil) {
+      atomic_store(&self->_snapshotPinned, false);
+      reject(@"ERR_FLIR_SNAPSHOT", @"Not streaming", nil);
+      return;
     }
+    UIImage *overlayImage = overlay ? [streamer getImage] : nil;
+    dispatch_async(self->_snapshotQueue, ^{
+      [self saveSnapshot:streamer path:path visual:visual overlay:overlayImage requested:requested resolver:resolve rejecter:reject];
+    });
   });
 }
 
+// Snapshot count, frames skipped while images were pinned and snapshot-to-disk latency
+RCT_EXPORT_METHOD(getSnapshotStats:(RCTPromiseResolveBlock)resolve rejecter:(RCTPromiseRejectBlock)reject) {
+  dispatch_async(_snapshotQueue, ^{
+    resolve(@{
+      @"snapshots": @(self->_snapshots),
+      @"busy": @(atomic_load(&self->_snapshotPinned)),
+      @"framesSkipped": @(atomic_load(&self->_snapshotFramesSkipped)),
+      @"lastLatencyMs": @(self->_lastSnapshotMs),
+      @"avgLatencyMs": @(self->_avgSnapshotMs)
+    });
+  });
+}
+
+RCT_EXPORT_METHOD(getColorizerStats:(RCTPromiseResolveBlock)resolve rejecter:(RCTPromiseRejectBlock)reject) {
+  FlirColorizer *colorizer = [FlirColorizer shared];
+  resolve(@{
+    @"palette": colorizer.paletteName,
+    @"autoSpan": @(colorizer.autoSpan),
+    @"spanMin": @(colorizer.spanMin),
+    @"spanMax": @(colorizer.spanMax),
+    @"distribution": @[@"linear", @"histogram", @"plateau"][colorizer.distribution],
+    @"lastColorizeMs": @(colorizer.lastColorizeMs)
+  });
+}
+
+// Inverse of the active palette and span; resolves null for colors the palette does not produce
+RCT_EXPORT_METHOD(getTemperatureFromColor:(nonnull NSNumber *)color resolver:(RCTPromiseResolveBlock)resolve rejecter:(RCTPromiseRejectBlock)reject) {
+  float t = [[FlirColorizer shared] temperatureForColor:(uint32_t)color.longLongValue];
+  resolve(isnan(t) ? [NSNull null] : @(t));
+}
+
+// Converts a colorized image (file path or file:// URI) back to approximate temperatures
+RCT_EXPORT_METHOD(getTemperaturesFromImage:(NSString *)path resolver:(RCTPromiseResolveBlock)resolve rejecter:(RCTPromiseRejectBlock)reject) {
+  NSString *filePath = [path hasPrefix:@"file://"] ? [NSURL URLWithString:path].path : path;
+  UIImage *image = [UIImage imageWithContentsOfFile:filePath];
+  if (image == nil) {
+    reject(@"ERR_FLIR_CONVERT", [NSString stringWithFormat:@"Could not decode %@", path], nil);
+    return;
+  }
+  int width = 0, height = 0;
+  NSData *data = [[FlirColorizer shared] temperaturesForImage:image width:&width height:&height];
+  if (data == nil) {
+    reject(@"ERR_NO_DATA", @"No palette available", nil);
+    return;
+  }
+  const float *src = (const float *)data.bytes;
+  NSUInteger count = (NSUInteger)width * height;
+  NSMutableArray *values = [NSMutableArray arrayWithCapacity:count];
+  for (NSUInteger i = 0; i < count; i++) {
+    [values addObject:isnan(src[i]) ? (id)[NSNull null] : @(src[i])];
+  }
+  resolve(@{ @"width": @(width), @"height": @(height), @"values": values });
+}
+
 RCT_EXPORT_METHOD(isEmulator:(RCTPromiseResolveBlock)resolve rejecter:(RCTPromiseRejectBlock)reject) {
   dispatch_async(dispatch_get_main_queue(), ^{
     resolve(@(self.isEmulatorMode));
@@ -151,199 +727,390 @@ RCT_EXPORT_METHOD(startEmulatorMode:(RCTPromiseResolveBlock)resolve rejecter:(RC
 #pragma mark - Helper Methods
 
 - (void)connectToDevice:(FLIRIdentity *)identity {
+  dispatch_async(self.streamQueue, ^{
+    NSError *error = nil;
+    if (![self connectAndStream:identity error:&error]) {
+      RCTLogError(@"Failed to connect to FLIR device: %@", error.localizedDescription);
+    }
+  });
+}
+
+#pragma mark - Streaming (streamQueue only)
+
+- (BOOL)connectAndStream:(FLIRIdentity *)identity error:(NSError **)error
+{
   if (!self.camera) {
     self.camera = [[FLIRCamera alloc] init];
+    self.camera.delegate = self;
   }
-
-  NSError *error;
-  BOOL connected = [self.camera connect:identity error:&error];
-
-  if (connected) {
-    NSString *deviceType = self.isEmulatorMode ? @"emulator" : @"device";
-    [[FlirEventEmitter shared] sendDeviceEvent:@"FlirDeviceConnected" body:@{
-      @"identity": @{
-        @"deviceId": [identity deviceId] ?: @"Unknown",
-        @"isEmulator": @(self.isEmulatorMode)
-      },
-      @"deviceType": deviceType,
-      @"isEmulator": @(self.isEmulatorMode)
-    }];
-  } else {
-    RCTLogError(@"Failed to connect to FLIR device: %@", error.localizedDescription);
+  if (![self.camera isConnected] && ![self.camera connect:identity error:error]) {
+    return NO;
   }
-}
 
-#pragma mark - FLIRDiscoveryEventDelegate
-
-- (void)cameraFound:(FLIRIdentity *)identity
-{
-  self.connectedIdentity = identity;
-  self.isEmulatorMode = ([identity communicationInterface] == FLIRCommunicationInterfaceEmulator);
-  self.isPhysicalDeviceConnected = !self.isEmulatorMode;
+  [self stopStreaming];
+  // Cameras with a visual stream may list it first; only a thermal stream feeds the streamer
+  FLIRStream *stream = nil;
+  for (FLIRStream *candidate in [self.camera getStreams]) {
+    if (candidate.isThermal) {
+      stream = candidate;
+      break;
+    }
+  }
+  if (stream == nil) {
+    if (error) *error = [NSError errorWithDomain:@"FlirModule" code:1 userInfo:@{NSLocalizedDescriptionKey: @"No thermal stream available for the camera"}];
+    return NO;
+  }
+  stream.delegate = self;
+  self.streamer = [[FLIRThermalStreamer alloc] initWithStream:stream];
+  if (![stream start:error]) {
+    self.streamer = nil;
+    return NO;
+  }
+  self.stream = stream;
 
   [[FlirEventEmitter shared] sendDeviceEvent:@"FlirDeviceConnected" body:@{
     @"identity": @{
       @"deviceId": [identity deviceId] ?: @"Unknown",
       @"isEmulator": @(self.isEmulatorMode)
     },
-    @"deviceType": self.isEmulatorMode ? @"emulator" : @"physical",
+    @"deviceType": self.isEmulatorMode ? @"emulator" : @"device",
     @"isEmulator": @(self.isEmulatorMode)
   }];
+  return YES;
 }
 
-- (void)cameraLost:(FLIRIdentity *)identity
+- (void)stopStreaming
 {
-  self.connectedIdentity = nil;
-  self.isEmulatorMode = NO;
-  self.isPhysicalDeviceConnected = NO;
+  [self.stream stop];
+  self.stream.delegate = nil;
+  self.stream = nil;
+  self.streamer = nil;
+  atomic_store(&_framePending, false);
+  [[FlirScaleBar shared] reset];
+  [self finishRecording];
+  [self finishVideoRecording:nil];
+  [_history flush];
+  [_history clear];
+  _historyMetadata = nil;
+}
 
-  [[FlirEventEmitter shared] sendDeviceEvent:@"FlirDeviceDisconnected" body:@{
-    @"identity": @{
-      @"deviceId": [identity deviceId] ?: @"Unknown",
-      @"isEmulator": @([identity communicationInterface] == FLIRCommunicationInterfaceEmulator)
-    },
-    @"wasEmulator": @([identity communicationInterface] == FLIRCommunicationInterfaceEmulator)
+- (void)processFrame
+{
+  atomic_store(&_framePending, false);
+  if (atomic_load(&_snapshotPinned)) {
+    atomic_fetch_add(&_snapshotFramesSkipped, 1);
+    return;
+  }
+  _frameTimestampNanos = atomic_load(&_frameArrivalNanos);
+  FLIRThermalStreamer *streamer = self.streamer;
+  if (streamer == nil) return;
+
+  NSError *error = nil;
+  if (![streamer update:&error]) {
+    RCTLogWarn(@"FLIR streamer update failed: %@", error.localizedDescription);
+    return;
+  }
+  UIImage *image = [streamer getImage];
+  if (image == nil) return;
+
+  // Radiometric plane, region stats and callbacks stay on this queue; the preview only composites
+  [streamer withThermalImage:^(FLIRThermalImage *thermalImage) {
+    [self updateZoomCropWidth:[thermalImage getWidth] height:[thermalImage getHeight]];
+    [[FlirState shared] updateFrame:image withThermalImage:thermalImage];
+    [self recordThermalImage:thermalImage];
+    [self appendHistoryThermalImage:thermalImage];
+    [[FlirColorizer shared] trackPalette:thermalImage.Palette range:[streamer getScaleRange]];
   }];
+  if (![self renderColorizedPreview]) {
+    UIImage *visible = [self croppedImage:image];
+    [self publishZoomTransformFrameWidth:(int)CGImageGetWidth(visible.CGImage) height:(int)CGImageGetHeight(visible.CGImage)];
+    [FlirPreviewView broadcastFrameImage:visible temperature:[FlirState shared].lastTemperature];
+    [[FlirScaleBar shared] updateFromColorizer:[FlirColorizer shared]];
+    return;
+  }
+  [[FlirScaleBar shared] updateFromColorizer:[FlirColorizer shared]];
+  NSArray<NSDictionary *> *isotherms = [FlirColorizer shared].lastIsothermCounts;
+  if (isotherms != nil) {
+    [[FlirEventEmitter shared] sendDeviceEvent:@"FlirIsothermStats" body:@{
+      @"timestamp": @([[NSDate date] timeIntervalSince1970]),
+      @"isotherms": isotherms
+    }];
+  }
 }
 
-- (void)discoveryError:(NSString *)error netServiceError:(int)nsnetserviceserror on:(FLIRCommunicationInterface)iface
+// Colorizes the current plane straight into the preview's pixel buffers once a native palette is set
+- (BOOL)renderColorizedPreview
 {
-  [[FlirEventEmitter shared] sendDeviceEvent:@"FlirError" body:@{
-    @"error": error ?: @"Unknown discovery error",
-    @"type": @"discovery",
-    @"interface": @(iface)
+  FlirColorizer *colorizer = [FlirColorizer shared];
+  if (!colorizer.enabled) return NO;
+  double temperature = [FlirState shared].lastTemperature;
+  __block int frameWidth = 0, frameHeight = 0;
+  // Runs on the stream queue, so the plane is read in place without holding off other readers
+  BOOL rendered = [[FlirState shared] readPublishedTemperaturePlane:^(const float *plane, int width, int height) {
+    // While zoomed only the visible rows are copied out and colorized, so auto span follows the view
+    if (!CGRectIsNull(self->_zoomCrop) && width == self->_sensorWidth && height == self->_sensorHeight) {
+      int x0 = (int)CGRectGetMinX(self->_zoomCrop), y0 = (int)CGRectGetMinY(self->_zoomCrop);
+      int w = (int)CGRectGetWidth(self->_zoomCrop), h = (int)CGRectGetHeight(self->_zoomCrop);
+      self->_zoomPlane.length = (NSUInteger)w * h * sizeof(float);
+      float *crop = (float *)self->_zoomPlane.mutableBytes;
+      for (int row = 0; row < h; row++) {
+        memcpy(crop + (NSInteger)row * w, plane + (NSInteger)(y0 + row) * width + x0, (size_t)w * sizeof(float));
+      }
+      plane = crop;
+      width = w;
+      height = h;
+    }
+    frameWidth = width;
+    frameHeight = height;
+    [FlirPreviewView broadcastFrameWidth:width height:height temperature:temperature render:^(uint8_t *pixels, size_t bytesPerRow) {
+      [colorizer colorizePlane:plane width:width height:height pixels:pixels bytesPerRow:bytesPerRow];
+    }];
   }];
+  if (rendered) [self publishZoomTransformFrameWidth:frameWidth height:frameHeight];
+  return rendered;
 }
 
-@end
-#import "FlirModule.h"
-#import "FlirEventEmitter.h"
-#import "FlirState.h"
-#import <ThermalSDK/ThermalSDK.h>
-#ifndef F1_gen3
-#define F1_gen3 FLIRCameraType_flirOne
-#endif
-#import <React/RCTLog.h>
+#pragma mark - Snapshots (_snapshotQueue only)
 
+- (void)saveSnapshot:(FLIRThermalStreamer *)streamer path:(NSString *)path visual:(BOOL)visual overlay:(nullable UIImage *)overlay requested:(uint64_t)requested resolver:(RCTPromiseResolveBlock)resolve rejecter:(RCTPromiseRejectBlock)reject
+{
+  uint64_t pinnedAt = clock_gettime_nsec_np(CLOCK_UPTIME_RAW);
+  __block NSError *error = nil;
+  __block BOOL saved = NO;
+  __block UIImage *photo = nil;
+  [streamer withThermalImage:^(FLIRThermalImage *thermalImage) {
+    saved = overlay != nil ? [thermalImage saveAs:path imageWithOverlay:overlay error:&error]
+                           : [thermalImage saveAs:path error:&error];
+    if (saved && visual) photo = [thermalImage getPhoto];
+  }];
+  atomic_store(&_snapshotPinned, false);
+  double pinnedMs = (clock_gettime_nsec_np(CLOCK_UPTIME_RAW) - pinnedAt) / 1e6;
+  if (!saved) {
+    reject(@"ERR_FLIR_SNAPSHOT", error.localizedDescription ?: @"Saving the snapshot failed", error);
+    return;
+  }
 
-@interface FlirModule()
-<FLIRDiscoveryEventDelegate>
-@property (nonatomic, strong) FLIRDiscovery *discovery;
-@property (nonatomic, strong) FLIRCamera *camera;
-@property (nonatomic, strong) FLIRIdentity *connectedIdentity;
-@property (nonatomic, assign) BOOL isEmulatorMode;
-@property (nonatomic, assign) BOOL isPhysicalDeviceConnected;
-@end
+  NSMutableDictionary *result = [NSMutableDictionary dictionary];
+  // The photo is encoded after the stream is released
+  if (photo != nil) {
+    NSString *visualPath = [[path stringByDeletingPathExtension] stringByAppendingString:@"_visual.jpg"];
+    if ([UIImageJPEGRepresentation(photo, 0.9) writeToFile:visualPath atomically:NO]) result[@"visualPath"] = visualPath;
+  }
+  double ms = (clock_gettime_nsec_np(CLOCK_UPTIME_RAW) - requested) / 1e6;
+  _avgSnapshotMs = _snapshots == 0 ? ms : _avgSnapshotMs + 0.2 * (ms - _avgSnapshotMs);
+  _lastSnapshotMs = ms;
+  _snapshots++;
+  NSNumber *size = [[NSFileManager defaultManager] attributesOfItemAtPath:path error:nil][NSFileSize];
+  [result addEntriesFromDictionary:@{
+    @"path": path,
+    @"bytes": size ?: @0,
+    @"latencyMs": @(ms),
+    @"pinnedMs": @(pinnedMs)
+  }];
+  resolve(result);
+}
 
-@implementation FlirModule
+#pragma mark - Recording
 
-RCT_EXPORT_MODULE(FlirIOS);
+// Appends the full sensor plane; a failed write ends the recording rather than every later frame
+- (void)recordThermalImage:(FLIRThermalImage *)thermalImage
+{
+  FlirRecorder *recorder = _recorder;
+  if (recorder == nil) return;
+  if (_recordingMetadata == nil) _recordingMetadata = [self describeThermalImage:thermalImage];
+  NSDictionary *metadata = _recordingMetadata;
+  uint64_t timestamp = _frameTimestampNanos;
+  dispatch_queue_t streamQueue = self.streamQueue;
+  __weak FlirModule *weakSelf = self;
+  // Only the copy happens here; compression and I/O run on the recorder's queue
+  [[FlirState shared] readPublishedTemperaturePlane:^(const float *plane, int width, int height) {
+    [recorder enqueuePlane:plane width:width height:height timestampNanos:timestamp metadata:metadata failure:^(NSError *error) {
+      dispatch_async(streamQueue, ^{
+        FlirModule *module = weakSelf;
+        if (module == nil || module->_recorder != recorder) return;
+        RCTLogWarn(@"FLIR recording stopped: %@", error.localizedDescription);
+        [module finishRecording];
+      });
+    }];
+  }];
+}
 
-RCT_EXPORT_METHOD(startDiscovery)
+- (void)appendHistoryThermalImage:(FLIRThermalImage *)thermalImage
 {
-  // Hook into ThermalSDK discovery when ready. For now, emit an event to JS.
-  dispatch_async(dispatch_get_main_queue(), ^{
-    [[FlirEventEmitter shared] sendDeviceEvent:@"FlirDeviceConnected" body:@{ @"msg": @"discovery-started" }];
-    RCTLogInfo(@"FLIR discovery started (placeholder)");
-  });
+  if (!_history.enabled) return;
+  if (_historyMetadata == nil) _historyMetadata = [self describeThermalImage:thermalImage];
+  uint64_t timestamp = _frameTimestampNanos;
+  FlirFrameHistory *history = _history;
+  [[FlirState shared] readPublishedTemperaturePlane:^(const float *plane, int width, int height) {
+    [history appendPlane:plane width:width height:height timestampNanos:timestamp];
+  }];
 }
 
-RCT_EXPORT_METHOD(stopDiscovery)
+- (nullable NSDictionary *)finishRecording
 {
-  dispatch_async(dispatch_get_main_queue(), ^{
-    [[FlirEventEmitter shared] sendDeviceEvent:@"FlirDeviceDisconnected" body:@{ @"msg": @"discovery-stopped" }];
-    RCTLogInfo(@"FLIR discovery stopped (placeholder)");
-  });
+  FlirRecorder *recorder = _recorder;
+  if (recorder == nil) return nil;
+  _recorder = nil;
+  _recordingMetadata = nil;
+  [recorder close];
+  return [recorder stats];
 }
 
-RCT_EXPORT_METHOD(connect:(NSDictionary *)identity resolver:(RCTPromiseResolveBlock)resolve rejecter:(RCTPromiseRejectBlock)reject)
+- (NSDictionary *)describeThermalImage:(FLIRThermalImage *)thermalImage
 {
-  // TODO: implement real connect using ThermalSDK and identity info
-  dispatch_async(dispatch_get_main_queue(), ^{
-    RCTLogInfo(@"Flir connect called (placeholder)");
-    // emit a connected event
-    [[FlirEventEmitter shared] sendDeviceEvent:@"FlirDeviceConnected" body:@{ @"identity": identity ?: @{} }];
-    resolve(@(YES));
-  });
+  NSMutableDictionary *camera = [@{
+    @"deviceId": [self.connectedIdentity deviceId] ?: @"Unknown",
+    @"width": @([thermalImage getWidth]),
+    @"height": @([thermalImage getHeight])
+  } mutableCopy];
+  CameraInfo *info = [thermalImage getCameraInformation];
+  if (info != nil) {
+    if (info.modelName) camera[@"name"] = info.modelName;
+    if (info.serialNumber) camera[@"serialNumber"] = info.serialNumber;
+  }
+  NSMutableDictionary *thermal = [NSMutableDictionary dictionary];
+  FLIRThermalParameters *params = [thermalImage getImageParameters];
+  if (params != nil) {
+    thermal[@"emissivity"] = @(params.objectEmissivity);
+    thermal[@"objectDistance"] = @(params.objectDistance);
+    thermal[@"reflectedTemperature"] = @(params.objectReflectedTemperature.value);
+    thermal[@"atmosphericTemperature"] = @(params.atmosphericTemperature.value);
+    thermal[@"relativeHumidity"] = @(params.relativeHumidity);
+    thermal[@"transmission"] = @(params.atmosphericTransmission);
+  }
+  return @{@"camera": camera, @"thermalParameters": thermal};
 }
 
-RCT_EXPORT_METHOD(disconnect)
+// Detaches the frame tap; the queued frames are still encoded before the completion runs
+- (BOOL)finishVideoRecording:(nullable void (^)(NSDictionary *stats, NSError *_Nullable error))completion
 {
-  dispatch_async(dispatch_get_main_queue(), ^{
-    RCTLogInfo(@"Flir disconnect called (placeholder)");
-    [[FlirEventEmitter shared] sendDeviceEvent:@"FlirDeviceDisconnected" body:@{}];
-  });
+  FlirVideoRecorder *recorder = _videoRecorder;
+  if (recorder == nil) return NO;
+  _videoRecorder = nil;
+  [FlirPreviewView setFrameTap:nil];
+  [recorder finishWithCompletion:^(NSDictionary *stats, NSError *error) {
+    if (completion) completion(stats, error);
+  }];
+  return YES;
 }
 
-RCT_EXPORT_METHOD(getTemperatureAt:(nonnull NSNumber *)x y:(nonnull NSNumber *)y resolver:(RCTPromiseResolveBlock)resolve rejecter:(RCTPromiseRejectBlock)reject)\n{\n  // Return the last sampled temperature from the preview/state singleton\n  dispatch_async(dispatch_get_main_queue(), ^{\n    double t = [FlirState shared].lastTemperature;\n    if (isnan(t)) {\n      resolve([NSNull null]);\n    } else {\n      resolve(@(t));\n    }\n  });\n}\n\nRCT_EXPORT_METHOD(isEmulator:(RCTPromiseResolveBlock)resolve rejecter:(RCTPromiseRejectBlock)reject)\n{\n  dispatch_async(dispatch_get_main_queue(), ^{\n    resolve(@(self.isEmulatorMode));\n  });\n}\n\nRCT_EXPORT_METHOD(isDeviceConnected:(RCTPromiseResolveBlock)resolve rejecter:(RCTPromiseRejectBlock)reject)\n{\n  dispatch_async(dispatch_get_main_queue(), ^{\n    resolve(@(self.isPhysicalDeviceConnected));\n  });\n}\n\nRCT_EXPORT_METHOD(getConnectedDeviceInfo:(RCTPromiseResolveBlock)resolve rejecter:(RCTPromiseRejectBlock)reject)\n{\n  dispatch_async(dispatch_get_main_queue(), ^{\n    if (self.connectedIdentity == nil) {\n      resolve(@\"Not connected\");\n    } else if (self.isEmulatorMode) {\n      resolve([NSString stringWithFormat:@\"Emulator (%@)\", self.connectedIdentity.deviceId]);\n    } else {\n      resolve([NSString stringWithFormat:@\"Physical device (%@)\", self.connectedIdentity.deviceId]);\n    }\n  });\n}\n\nRCT_EXPORT_METHOD(startEmulatorMode:(RCTPromiseResolveBlock)resolve rejecter:(RCTPromiseRejectBlock)reject)\n{\n  dispatch_async(dispatch_get_main_queue(), ^{\n    [self initializeEmulatorMode];\n    resolve(@(YES));\n  });\n}\n\n- (void)initializeEmulatorMode\n{\n  if (!self.discovery) {\n    self.discovery = [[FLIRDiscovery alloc] init];\n    self.discovery.delegate = self;\n  }\n  \n  // Create emulator identity for testing\n  FLIRIdentity *emulatorIdentity = [[FLIRIdentity alloc] initWithEmulatorType:F1_gen3];\n  if (emulatorIdentity) {\n    self.connectedIdentity = emulatorIdentity;\n    self.isEmulatorMode = YES;\n    self.isPhysicalDeviceConnected = NO;\n    \n    // Start discovery for emulator\n    [self.discovery start:FLIRCommunicationInterfaceEmulator cameraType:F1_gen3];\n    \n    // Emit connection event\n    [[FlirEventEmitter shared] sendDeviceEvent:@\"FlirDeviceConnected\" body:@{\n      @\"identity\": @{\n        @\"deviceId\": emulatorIdentity.deviceId ?: @\"Emulator\",\n        @\"isEmulator\": @(YES)\n      },\n      @\"deviceType\": @\"emulator\",\n      @\"isEmulator\": @(YES)\n    }];\n  }\n}
+// Playback queue only; the last opened recording stays mapped until another path is opened
+- (nullable FlirRecording *)openRecording:(NSString *)path error:(NSError **)error
+{
+  if (_playback != nil && [path isEqualToString:_playbackPath]) return _playback;
+  _playback = [FlirRecording recordingWithPath:path error:error];
+  _playbackPath = _playback != nil ? [path copy] : nil;
+  return _playback;
+}
 
-#pragma mark - FLIRDiscoveryEventDelegate
+#pragma mark - Zoom
 
-- (void)cameraDiscovered:(FLIRDiscoveredCamera *)discoveredCamera {
-  FLIRIdentity *identity = discoveredCamera.identity;
-  
-  // Check if this is a real device or emulator
-  BOOL isRealDevice = (identity.communicationInterface != FLIRCommunicationInterfaceEmulator);
-  
-  if (isRealDevice && !self.isPhysicalDeviceConnected) {
-    // Prioritize real device over emulator
-    self.connectedIdentity = identity;
-    self.isEmulatorMode = NO;
-    self.isPhysicalDeviceConnected = YES;
-    
-    // Connect to real device
-    [self connectToDevice:identity];
-  } else if (!isRealDevice && !self.isPhysicalDeviceConnected) {
-    // Use emulator if no real device found
-    self.connectedIdentity = identity;
-    self.isEmulatorMode = YES;
-    self.isPhysicalDeviceConnected = NO;
-    
-    // Connect to emulator
-    [self connectToDevice:identity];
-  }
+// Visible sensor rectangle for a zoom factor and a pan of the visible center from the frame center
+static CGRect FlirZoomCrop(int width, int height, float zoom, int panX, int panY)
+{
+  float cw = width / zoom, ch = height / zoom;
+  float cx = MAX(cw / 2.f, MIN(width - cw / 2.f, width / 2.f + panX));
+  float cy = MAX(ch / 2.f, MIN(height - ch / 2.f, height / 2.f + panY));
+  int w = MAX(1, (int)lroundf(cw)), h = MAX(1, (int)lroundf(ch));
+  int x = MAX(0, MIN(width - w, (int)lroundf(cx - cw / 2.f)));
+  int y = MAX(0, MIN(height - h, (int)lroundf(cy - ch / 2.f)));
+  return CGRectMake(x, y, w, h);
 }
 
-#pragma mark - Helper Methods
+- (void)updateZoomCropWidth:(int)width height:(int)height
+{
+  _sensorWidth = width;
+  _sensorHeight = height;
+  _zoomCrop = (_zoomFactor > 1.f && width > 0 && height > 0)
+    ? FlirZoomCrop(width, height, _zoomFactor, _zoomPanX, _zoomPanY) : CGRectNull;
+  [FlirState shared].visibleRect = _zoomCrop;
+}
 
-- (void)connectToDevice:(FLIRIdentity *)identity {
-  if (!self.camera) {
-    self.camera = [[FLIRCamera alloc] init];
+// The SDK image may be rendered at a different resolution than the plane; crop proportionally
+- (UIImage *)croppedImage:(UIImage *)image
+{
+  if (CGRectIsNull(_zoomCrop) || _sensorWidth <= 0 || image.CGImage == NULL) return image;
+  CGFloat sx = CGImageGetWidth(image.CGImage) / (CGFloat)_sensorWidth;
+  CGFloat sy = CGImageGetHeight(image.CGImage) / (CGFloat)_sensorHeight;
+  CGRect rect = CGRectIntegral(CGRectMake(_zoomCrop.origin.x * sx, _zoomCrop.origin.y * sy,
+                                          _zoomCrop.size.width * sx, _zoomCrop.size.height * sy));
+  CGImageRef cropped = CGImageCreateWithImageInRect(image.CGImage, rect);
+  if (cropped == NULL) return image;
+  UIImage *result = [UIImage imageWithCGImage:cropped scale:image.scale orientation:image.imageOrientation];
+  CGImageRelease(cropped);
+  return result;
+}
+
+- (void)publishZoomTransformFrameWidth:(int)frameWidth height:(int)frameHeight
+{
+  CGRect crop = CGRectIsNull(_zoomCrop) ? CGRectMake(0, 0, _sensorWidth, _sensorHeight) : _zoomCrop;
+  NSDictionary *current = self.zoomTransform;
+  if (current != nil && [current[@"frameWidth"] intValue] == frameWidth && [current[@"frameHeight"] intValue] == frameHeight
+      && CGRectEqualToRect(crop, CGRectMake([current[@"cropX"] intValue], [current[@"cropY"] intValue],
+                                            [current[@"cropWidth"] intValue], [current[@"cropHeight"] intValue]))
+      && [current[@"zoom"] floatValue] == _zoomFactor) {
+    return;
   }
-  
-  NSError *error;
-  BOOL connected = [self.camera connect:identity error:&error];
-  
-  if (connected) {
-    NSString *deviceType = self.isEmulatorMode ? @"emulator" : @"device";
-    [[FlirEventEmitter shared] sendDeviceEvent:@"FlirDeviceConnected" body:@{
-      @"identity": @{
-        @"deviceId": identity.deviceId ?: @"Unknown",
-        @"isEmulator": @(self.isEmulatorMode)
-      },
-      @"deviceType": deviceType,
-      @"isEmulator": @(self.isEmulatorMode)
+  self.zoomTransform = @{
+    @"zoom": @(_zoomFactor),
+    @"panX": @(_zoomPanX),
+    @"panY": @(_zoomPanY),
+    @"sensorWidth": @(_sensorWidth),
+    @"sensorHeight": @(_sensorHeight),
+    @"cropX": @((int)crop.origin.x),
+    @"cropY": @((int)crop.origin.y),
+    @"cropWidth": @((int)crop.size.width),
+    @"cropHeight": @((int)crop.size.height),
+    @"frameWidth": @(frameWidth),
+    @"frameHeight": @(frameHeight),
+    @"scaleX": @(frameWidth > 0 ? crop.size.width / frameWidth : 1.0),
+    @"scaleY": @(frameHeight > 0 ? crop.size.height / frameHeight : 1.0),
+  };
+}
+
+#pragma mark - FLIRStreamDelegate
+
+- (void)onImageReceived
+{
+  atomic_store(&_frameArrivalNanos, clock_gettime_nsec_np(CLOCK_UPTIME_RAW));
+  // Coalesce: a frame already queued will pick up the newest image when it runs
+  if (atomic_exchange(&_framePending, true)) return;
+  dispatch_async(self.streamQueue, ^{
+    [self processFrame];
+  });
+}
+
+- (void)onError:(NSError *)error
+{
+  [[FlirEventEmitter shared] sendDeviceEvent:@"FlirError" body:@{
+    @"error": error.localizedDescription ?: @"Unknown stream error",
+    @"type": @"stream"
+  }];
+}
+
+#pragma mark - FLIRDataReceivedDelegate
+
+- (void)onDisconnected:(FLIRCamera *)camera withError:(NSError *)error
+{
+  dispatch_async(self.streamQueue, ^{
+    [self stopStreaming];
+    [[FlirEventEmitter shared] sendDeviceEvent:@"FlirDeviceDisconnected" body:@{
+      @"error": error.localizedDescription ?: [NSNull null]
     }];
-  } else {
-    RCTLogError(@"Failed to connect to FLIR device: %@", error.localizedDescription);
-  }
+  });
 }
 
 #pragma mark - FLIRDiscoveryEventDelegate
 
 - (void)cameraFound:(FLIRIdentity *)identity
 {
-  // Store the found camera identity
   self.connectedIdentity = identity;
-  
-  // Check if this is an emulator
-  self.isEmulatorMode = (identity.communicationInterface == FLIRCommunicationInterfaceEmulator);
+  self.isEmulatorMode = ([identity communicationInterface] == FLIRCommunicationInterfaceEmulator);
   self.isPhysicalDeviceConnected = !self.isEmulatorMode;
-  
-  // Emit connection event
+
   [[FlirEventEmitter shared] sendDeviceEvent:@"FlirDeviceConnected" body:@{
     @"identity": @{
-      @"deviceId": identity.deviceId ?: @"Unknown",
+      @"deviceId": [identity deviceId] ?: @"Unknown",
       @"isEmulator": @(self.isEmulatorMode)
     },
     @"deviceType": self.isEmulatorMode ? @"emulator" : @"physical",
@@ -353,24 +1120,21 @@ RCT_EXPORT_METHOD(getTemperatureAt:(nonnull NSNumber *)x y:(nonnull NSNumber *)y
 
 - (void)cameraLost:(FLIRIdentity *)identity
 {
-  // Clear connection state
   self.connectedIdentity = nil;
   self.isEmulatorMode = NO;
   self.isPhysicalDeviceConnected = NO;
-  
-  // Emit disconnection event
+
   [[FlirEventEmitter shared] sendDeviceEvent:@"FlirDeviceDisconnected" body:@{
     @"identity": @{
-      @"deviceId": identity.deviceId ?: @"Unknown",
-      @"isEmulator": @(identity.communicationInterface == FLIRCommunicationInterfaceEmulator)
+      @"deviceId": [identity deviceId] ?: @"Unknown",
+      @"isEmulator": @([identity communicationInterface] == FLIRCommunicationInterfaceEmulator)
     },
-    @"wasEmulator": @(identity.communicationInterface == FLIRCommunicationInterfaceEmulator)
+    @"wasEmulator": @([identity communicationInterface] == FLIRCommunicationInterfaceEmulator)
   }];
 }
 
 - (void)discoveryError:(NSString *)error netServiceError:(int)nsnetserviceserror on:(FLIRCommunicationInterface)iface
 {
-  // Emit error event
   [[FlirEventEmitter shared] sendDeviceEvent:@"FlirError" body:@{
     @"error": error ?: @"Unknown discovery error",
     @"type": @"discovery",
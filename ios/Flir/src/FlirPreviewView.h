@@ -1,11 +1,29 @@
 #import <UIKit/UIKit.h>
+#import <CoreVideo/CoreVideo.h>
 
 NS_ASSUME_NONNULL_BEGIN
 
+// Backed by an AVSampleBufferDisplayLayer. Frames are rendered into a pool of IOSurface-backed
+// CVPixelBuffers on the caller's queue and enqueued directly; the main queue is not involved.
 @interface FlirPreviewView : UIView
 
-@property (nonatomic, assign) double lastTemperature;
+// Set on the stream queue with each frame
+@property (atomic, assign) double lastTemperature;
 
+// Hands a frame to every preview currently in a window; call from the stream queue.
++ (void)broadcastFrameImage:(UIImage *)image temperature:(double)temperature;
+
+// Lets the caller write 32BGRA pixels straight into the next pooled buffer, then broadcasts it.
++ (void)broadcastFrameWidth:(int)width
+                     height:(int)height
+                temperature:(double)temperature
+                     render:(void (NS_NOESCAPE ^)(uint8_t *pixels, size_t bytesPerRow))render;
+
+// Called with every rendered 32BGRA buffer before it is broadcast, e.g. to record the preview;
+// set and invoked on the stream queue.
++ (void)setFrameTap:(nullable void (^)(CVPixelBufferRef buffer))tap;
+
+// Same path for a single view; must be called from the stream queue as well.
 - (void)updateWithFrameImage:(UIImage *)image temperature:(double)temperature;
 
 @end
@@ -1,24 +1,206 @@
 #import "FlirPreviewView.h"
-#import "FlirState.h"
+#import <AVFoundation/AVFoundation.h>
+#import <CoreMedia/CoreMedia.h>
+#import <CoreVideo/CoreVideo.h>
+#import <os/lock.h>
+
+// Buffers in flight: one being written, one queued, one on screen and one the layer may still retain
+#define FLIR_PIXEL_BUFFER_COUNT 4
+
+static CFStringRef const FlirContextAttachmentKey = CFSTR("FlirBitmapContext");
+
+// Previews attached to a window, guarded by _viewsLock so the stream queue can enqueue directly
+static NSHashTable<FlirPreviewView *> *_activeViews = nil;
+static os_unfair_lock _viewsLock = OS_UNFAIR_LOCK_INIT;
+
+// Pixel buffer pool and format description for the current frame size; stream queue only
+static CVPixelBufferPoolRef _pool = NULL;
+static CMVideoFormatDescriptionRef _format = NULL;
+static int _poolWidth = 0;
+static int _poolHeight = 0;
+static void (^_frameTap)(CVPixelBufferRef buffer) = nil;
+
+static BOOL FlirEnsurePool(int width, int height)
+{
+  if (_pool != NULL && _poolWidth == width && _poolHeight == height) return YES;
+  if (_pool != NULL) {
+    CVPixelBufferPoolRelease(_pool);
+    _pool = NULL;
+  }
+  if (_format != NULL) {
+    CFRelease(_format);
+    _format = NULL;
+  }
+  NSDictionary *poolAttributes = @{ (id)kCVPixelBufferPoolMinimumBufferCountKey: @(FLIR_PIXEL_BUFFER_COUNT) };
+  NSDictionary *bufferAttributes = @{
+    (id)kCVPixelBufferPixelFormatTypeKey: @(kCVPixelFormatType_32BGRA),
+    (id)kCVPixelBufferWidthKey: @(width),
+    (id)kCVPixelBufferHeightKey: @(height),
+    (id)kCVPixelBufferIOSurfacePropertiesKey: @{},
+    (id)kCVPixelBufferCGBitmapContextCompatibilityKey: @YES,
+  };
+  if (CVPixelBufferPoolCreate(kCFAllocatorDefault, (__bridge CFDictionaryRef)poolAttributes,
+                              (__bridge CFDictionaryRef)bufferAttributes, &_pool) != kCVReturnSuccess) {
+    _pool = NULL;
+    return NO;
+  }
+  _poolWidth = width;
+  _poolHeight = height;
+  return YES;
+}
+
+// The bitmap context wrapping a pooled buffer is created once and kept as a buffer attachment
+static CGContextRef FlirContextForBuffer(CVPixelBufferRef buffer)
+{
+  void *base = CVPixelBufferGetBaseAddress(buffer);
+  CGContextRef context = (CGContextRef)CVBufferGetAttachment(buffer, FlirContextAttachmentKey, NULL);
+  if (context != NULL && CGBitmapContextGetData(context) == base) return context;
+
+  static CGColorSpaceRef colorSpace = NULL;
+  if (colorSpace == NULL) colorSpace = CGColorSpaceCreateDeviceRGB();
+  context = CGBitmapContextCreate(base, CVPixelBufferGetWidth(buffer), CVPixelBufferGetHeight(buffer), 8,
+                                  CVPixelBufferGetBytesPerRow(buffer), colorSpace,
+                                  kCGImageAlphaPremultipliedFirst | kCGBitmapByteOrder32Little);
+  if (context == NULL) return NULL;
+  CVBufferSetAttachment(buffer, FlirContextAttachmentKey, context, kCVAttachmentMode_ShouldNotPropagate);
+  CGContextRelease(context);
+  return context;
+}
+
+// Renders into the next pooled buffer and wraps it for the display layer (+1 retained)
+static CMSampleBufferRef FlirCreateSampleBuffer(int width, int height, BOOL (NS_NOESCAPE ^render)(CVPixelBufferRef buffer))
+{
+  if (width <= 0 || height <= 0 || !FlirEnsurePool(width, height)) return NULL;
+
+  CVPixelBufferRef buffer = NULL;
+  NSDictionary *aux = @{ (id)kCVPixelBufferPoolAllocationThresholdKey: @(FLIR_PIXEL_BUFFER_COUNT) };
+  if (CVPixelBufferPoolCreatePixelBufferWithAuxAttributes(kCFAllocatorDefault, _pool,
+                                                          (__bridge CFDictionaryRef)aux, &buffer) != kCVReturnSuccess) {
+    // Every buffer is still owned by the layer; drop this frame rather than grow the pool
+    return NULL;
+  }
+
+  CVPixelBufferLockBaseAddress(buffer, 0);
+  BOOL rendered = render(buffer);
+  CVPixelBufferUnlockBaseAddress(buffer, 0);
+  if (rendered && _frameTap != nil) _frameTap(buffer);
+
+  if (_format == NULL || !CMVideoFormatDescriptionMatchesImageBuffer(_format, buffer)) {
+    if (_format != NULL) CFRelease(_format);
+    _format = NULL;
+    CMVideoFormatDescriptionCreateForImageBuffer(kCFAllocatorDefault, buffer, &_format);
+  }
+
+  CMSampleBufferRef sample = NULL;
+  CMSampleTimingInfo timing = { kCMTimeInvalid, kCMTimeInvalid, kCMTimeInvalid };
+  if (rendered && _format != NULL) {
+    CMSampleBufferCreateReadyWithImageBuffer(kCFAllocatorDefault, buffer, _format, &timing, &sample);
+  }
+  CVPixelBufferRelease(buffer);
+  if (sample == NULL) return NULL;
+
+  CFArrayRef attachments = CMSampleBufferGetSampleAttachmentsArray(sample, YES);
+  CFMutableDictionaryRef dict = (CFMutableDictionaryRef)CFArrayGetValueAtIndex(attachments, 0);
+  CFDictionarySetValue(dict, kCMSampleAttachmentKey_DisplayImmediately, kCFBooleanTrue);
+  return sample;
+}
+
+static CMSampleBufferRef FlirCreateSampleBufferFromImage(UIImage *image)
+{
+  CGImageRef cgImage = image.CGImage;
+  if (cgImage == NULL) return NULL;
+  int width = (int)CGImageGetWidth(cgImage);
+  int height = (int)CGImageGetHeight(cgImage);
+  return FlirCreateSampleBuffer(width, height, ^BOOL(CVPixelBufferRef buffer) {
+    CGContextRef context = FlirContextForBuffer(buffer);
+    if (context == NULL) return NO;
+    CGContextDrawImage(context, CGRectMake(0, 0, width, height), cgImage);
+    return YES;
+  });
+}
 
 @implementation FlirPreviewView
 
++ (Class)layerClass
+{
+  return [AVSampleBufferDisplayLayer class];
+}
+
++ (void)setFrameTap:(void (^)(CVPixelBufferRef))tap
+{
+  _frameTap = [tap copy];
+}
+
++ (void)broadcastFrameImage:(UIImage *)image temperature:(double)temperature
+{
+  [self broadcastSampleBuffer:FlirCreateSampleBufferFromImage(image) temperature:temperature];
+}
+
++ (void)broadcastFrameWidth:(int)width
+                     height:(int)height
+                temperature:(double)temperature
+                     render:(void (NS_NOESCAPE ^)(uint8_t *pixels, size_t bytesPerRow))render
+{
+  CMSampleBufferRef sample = FlirCreateSampleBuffer(width, height, ^BOOL(CVPixelBufferRef buffer) {
+    render((uint8_t *)CVPixelBufferGetBaseAddress(buffer), CVPixelBufferGetBytesPerRow(buffer));
+    return YES;
+  });
+  [self broadcastSampleBuffer:sample temperature:temperature];
+}
+
+// Consumes the +1 sample buffer
++ (void)broadcastSampleBuffer:(CMSampleBufferRef)sample temperature:(double)temperature
+{
+  if (sample == NULL) return;
+  os_unfair_lock_lock(&_viewsLock);
+  for (FlirPreviewView *view in _activeViews) {
+    [view enqueueSampleBuffer:sample temperature:temperature];
+  }
+  os_unfair_lock_unlock(&_viewsLock);
+  CFRelease(sample);
+}
+
 - (instancetype)initWithFrame:(CGRect)frame
 {
   if (self = [super initWithFrame:frame]) {
     self.backgroundColor = [UIColor blackColor];
+    ((AVSampleBufferDisplayLayer *)self.layer).videoGravity = AVLayerVideoGravityResizeAspect;
     _lastTemperature = NAN;
   }
   return self;
 }
 
+- (void)didMoveToWindow
+{
+  [super didMoveToWindow];
+  os_unfair_lock_lock(&_viewsLock);
+  if (!_activeViews) {
+    _activeViews = [NSHashTable weakObjectsHashTable];
+  }
+  if (self.window) {
+    [_activeViews addObject:self];
+  } else {
+    [_activeViews removeObject:self];
+  }
+  os_unfair_lock_unlock(&_viewsLock);
+}
+
 - (void)updateWithFrameImage:(UIImage *)image temperature:(double)temperature
 {
-  dispatch_async(dispatch_get_main_queue(), ^{
-    self.layer.contents = (id)image.CGImage;
-    self.lastTemperature = temperature;
-    [FlirState shared].lastTemperature = temperature;
-  });
+  CMSampleBufferRef sample = FlirCreateSampleBufferFromImage(image);
+  if (sample == NULL) return;
+  [self enqueueSampleBuffer:sample temperature:temperature];
+  CFRelease(sample);
+}
+
+- (void)enqueueSampleBuffer:(CMSampleBufferRef)sample temperature:(double)temperature
+{
+  AVSampleBufferDisplayLayer *displayLayer = (AVSampleBufferDisplayLayer *)self.layer;
+  if (displayLayer.status == AVQueuedSampleBufferRenderingStatusFailed) {
+    [displayLayer flush];
+  }
+  [displayLayer enqueueSampleBuffer:sample];
+  self.lastTemperature = temperature;
 }
 
 @end
@@ -0,0 +1,89 @@
+#import <Foundation/Foundation.h>
+#import <compression.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+// Frame codec of the .flirrec format, shared by FlirRecorder and FlirFrameHistory: 16-bit
+// quantization, optional delta to the previous frame, byte planes and raw deflate. Not thread-safe.
+@interface FlirPlaneEncoder : NSObject
+
+// Payload of the last encoded frame, valid until the next call
+@property (nonatomic, readonly) const uint8_t *bytes;
+// Pixels of the last frame outside the quantization range, stored at its nearest end
+@property (nonatomic, readonly) NSInteger clippedPixels;
+
+// COMPRESSION_ZLIB (raw deflate, the .flirrec codec) unless benchmarking another algorithm
+- (instancetype)initWithAlgorithm:(compression_algorithm)algorithm;
+
+// Returns the payload length, 0 on failure. A size change resets the delta chain, so the frame
+// must then be a keyframe.
+- (size_t)encodePlane:(const float *)plane width:(int)width height:(int)height keyframe:(BOOL)keyframe;
+
+// Encodes and decodes `frames` frames derived from the plane (sensor-like noise added per frame,
+// a keyframe every 30) with zlib and LZ4; returns [{ codec, encodeMBps, decodeMBps,
+// compressionRatio }], MB/s and ratio measured against float planes as in the recorder stats.
++ (NSArray<NSDictionary *> *)benchmarkCodecsWithPlane:(const float *)plane width:(int)width height:(int)height frames:(int)frames;
+
+@end
+
+// Appends Celsius planes to a .flirrec file: a header with the camera information and thermal
+// parameters as JSON, one raw-deflated 16-bit plane per frame (keyframes hold values, other
+// frames the difference to the previous frame) and a frame index footer. The layout matches the
+// Android RadiometricRecorder, so recordings open on either platform. Temperatures outside the
+// quantization range are stored at its nearest end; the header holds the range.
+@interface FlirRecorder : NSObject
+
+@property (nonatomic, readonly) NSString *path;
+
+- (instancetype)initWithPath:(NSString *)path keyframeInterval:(int)keyframeInterval;
+
+// Copies the plane and encodes it on the recorder's own serial queue, so the caller is not held
+// up by compression or I/O. Returns NO when the frame is dropped because earlier frames are still
+// queued. failure runs on the recorder's queue after the first write error.
+- (BOOL)enqueuePlane:(const float *)plane width:(int)width height:(int)height timestampNanos:(uint64_t)timestampNanos metadata:(NSDictionary *)metadata failure:(void (^)(NSError *error))failure;
+
+// Synchronous append. The header is written with the first frame; frames of another size than
+// the first are skipped and return NO without an error.
+- (BOOL)appendPlane:(const float *)plane width:(int)width height:(int)height timestampNanos:(uint64_t)timestampNanos metadata:(NSDictionary *)metadata error:(NSError **)error;
+
+// Appends a payload encoded by FlirPlaneEncoder. The first payload must be a keyframe.
+- (BOOL)appendPayload:(const void *)payload length:(size_t)length keyframe:(BOOL)keyframe width:(int)width height:(int)height timestampNanos:(uint64_t)timestampNanos metadata:(NSDictionary *)metadata error:(NSError **)error;
+
+// Waits for queued frames, writes the index and closes the file; further appends are ignored.
+// Not from the recorder's queue.
+- (void)close;
+
+// { path, frames, rawBytes, bytesWritten, compressionRatio, throughputMBps, avgAppendMs,
+//   droppedFrames, clippedPixels, clippedFrames }
+- (NSDictionary *)stats;
+
+@end
+
+// Memory-mapped reader for .flirrec files. Frames decode from the nearest keyframe; sequential
+// reads continue from the last decoded frame. Not thread-safe.
+@interface FlirRecording : NSObject
+
+@property (nonatomic, readonly) int width;
+@property (nonatomic, readonly) int height;
+@property (nonatomic, readonly) NSInteger frameCount;
+@property (nonatomic, readonly) int keyframeInterval;
+@property (nonatomic, readonly) NSTimeInterval createdAt;
+@property (nonatomic, readonly) uint64_t durationNanos;
+@property (nonatomic, readonly) NSString *metadata;
+// Range the temperatures were quantized to; values decoded at either end were at or beyond it
+@property (nonatomic, readonly) float clipMin;
+@property (nonatomic, readonly) float clipMax;
+
++ (nullable instancetype)recordingWithPath:(NSString *)path error:(NSError **)error;
+
+- (uint64_t)timestampNanosAtIndex:(NSInteger)index;
+
+// Index of the last frame at or before timestampNanos, clamped to the recording
+- (NSInteger)indexAtTimestampNanos:(uint64_t)timestampNanos;
+
+// Decodes a frame into plane (width * height floats, NaN for dropouts).
+- (BOOL)readFrame:(NSInteger)index into:(float *)plane min:(float *_Nullable)min max:(float *_Nullable)max error:(NSError **)error;
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,615 @@
+#import "FlirRecorder.h"
+#import <os/lock.h>
+
+#define FLIR_REC_VERSION 1
+#define FLIR_REC_CODEC_DEFLATE 1
+#define FLIR_REC_HEADER_SIZE 64
+#define FLIR_REC_FRAME_HEADER_SIZE 24
+#define FLIR_REC_INDEX_ENTRY_SIZE 24
+#define FLIR_REC_TRAILER_SIZE 24
+#define FLIR_REC_FLAG_KEYFRAME 1
+#define FLIR_REC_FRAME_MAGIC 0x454D5246u
+#define FLIR_REC_NAN_CODE 0xFFFF
+#define FLIR_REC_OFFSET -100.f
+#define FLIR_REC_STEP 0.01f
+#define FLIR_REC_CLIP_MIN FLIR_REC_OFFSET
+#define FLIR_REC_CLIP_MAX (FLIR_REC_OFFSET + (FLIR_REC_NAN_CODE - 1) * FLIR_REC_STEP)
+// Frames waiting for the recorder's queue before new ones are dropped
+#define FLIR_REC_MAX_PENDING 3
+
+static const char FlirRecMagic[8] = {'F', 'L', 'I', 'R', 'R', 'E', 'C', '1'};
+static const char FlirRecIndexMagic[8] = {'F', 'L', 'I', 'R', 'I', 'D', 'X', '1'};
+
+static NSString *const FlirRecorderErrorDomain = @"FlirRecorder";
+
+static NSError *FlirRecError(NSString *message)
+{
+  return [NSError errorWithDomain:FlirRecorderErrorDomain code:1 userInfo:@{NSLocalizedDescriptionKey: message}];
+}
+
+// The format is little-endian, like every device this runs on
+static inline void FlirPut16(uint8_t *p, uint16_t v) { memcpy(p, &v, 2); }
+static inline void FlirPut32(uint8_t *p, uint32_t v) { memcpy(p, &v, 4); }
+static inline void FlirPut64(uint8_t *p, uint64_t v) { memcpy(p, &v, 8); }
+static inline uint16_t FlirGet16(const uint8_t *p) { uint16_t v; memcpy(&v, p, 2); return v; }
+static inline uint32_t FlirGet32(const uint8_t *p) { uint32_t v; memcpy(&v, p, 4); return v; }
+static inline uint64_t FlirGet64(const uint8_t *p) { uint64_t v; memcpy(&v, p, 8); return v; }
+
+#pragma mark - Encoder
+
+@implementation FlirPlaneEncoder {
+    compression_algorithm _algorithm;
+    int _width;
+    int _height;
+    NSMutableData *_previous;
+    NSMutableData *_current;
+    NSMutableData *_raw;
+    NSMutableData *_compressed;
+    NSMutableData *_scratch;
+}
+
+- (instancetype)init
+{
+  return [self initWithAlgorithm:COMPRESSION_ZLIB];
+}
+
+- (instancetype)initWithAlgorithm:(compression_algorithm)algorithm
+{
+  if (self = [super init]) {
+    _algorithm = algorithm;
+  }
+  return self;
+}
+
+- (const uint8_t *)bytes
+{
+  return (const uint8_t *)_compressed.bytes;
+}
+
+- (size_t)encodePlane:(const float *)plane width:(int)width height:(int)height keyframe:(BOOL)keyframe
+{
+  if (width != _width || height != _height) [self resizeWidth:width height:height];
+  NSInteger n = (NSInteger)width * height;
+  uint16_t *current = (uint16_t *)_current.mutableBytes;
+  uint16_t *previous = (uint16_t *)_previous.mutableBytes;
+  uint8_t *raw = (uint8_t *)_raw.mutableBytes;
+  const float inverseStep = 1.f / FLIR_REC_STEP;
+  NSInteger clipped = 0;
+  for (NSInteger i = 0; i < n; i++) {
+    float t = plane[i];
+    if (isnan(t)) {
+      current[i] = FLIR_REC_NAN_CODE;
+      continue;
+    }
+    long q = lroundf((t - FLIR_REC_OFFSET) * inverseStep);
+    if (q < 0 || q > FLIR_REC_NAN_CODE - 1) {
+      clipped++;
+      q = MAX(0, MIN(FLIR_REC_NAN_CODE - 1, q));
+    }
+    current[i] = (uint16_t)q;
+  }
+  _clippedPixels = clipped;
+  // Byte planes: low bytes first, then high bytes
+  for (NSInteger i = 0; i < n; i++) {
+    uint16_t v = keyframe ? current[i] : (uint16_t)(current[i] - previous[i]);
+    raw[i] = (uint8_t)v;
+    raw[n + i] = (uint8_t)(v >> 8);
+  }
+  NSMutableData *swap = _previous;
+  _previous = _current;
+  _current = swap;
+  return compression_encode_buffer(_compressed.mutableBytes, _compressed.length, raw, (size_t)(2 * n),
+                                   _scratch.mutableBytes, _algorithm);
+}
+
+- (void)resizeWidth:(int)width height:(int)height
+{
+  _width = width;
+  _height = height;
+  NSUInteger n = (NSUInteger)width * height;
+  _previous = [NSMutableData dataWithLength:n * sizeof(uint16_t)];
+  _current = [NSMutableData dataWithLength:n * sizeof(uint16_t)];
+  _raw = [NSMutableData dataWithLength:n * 2];
+  // Stored deflate blocks add 5 bytes per 64 KB; the rest is headroom
+  _compressed = [NSMutableData dataWithLength:n * 2 + n / 8 + 1024];
+  if (_scratch == nil) _scratch = [NSMutableData dataWithLength:compression_encode_scratch_buffer_size(_algorithm)];
+}
+
++ (NSArray<NSDictionary *> *)benchmarkCodecsWithPlane:(const float *)plane width:(int)width height:(int)height frames:(int)frames
+{
+  NSInteger n = (NSInteger)width * height;
+  if (plane == NULL || n <= 0 || frames <= 0) return @[];
+  NSMutableData *frameData = [NSMutableData dataWithLength:(NSUInteger)n * sizeof(float)];
+  NSMutableData *decoded = [NSMutableData dataWithLength:(NSUInteger)n * 2];
+  float *frame = (float *)frameData.mutableBytes;
+  NSArray *codecs = @[
+    @[@"zlib", @(COMPRESSION_ZLIB)],
+    @[@"lz4", @(COMPRESSION_LZ4)],
+  ];
+  NSMutableArray<NSDictionary *> *results = [NSMutableArray array];
+  for (NSArray *codec in codecs) {
+    compression_algorithm algorithm = (compression_algorithm)[codec[1] intValue];
+    FlirPlaneEncoder *encoder = [[FlirPlaneEncoder alloc] initWithAlgorithm:algorithm];
+    NSMutableData *decodeScratch = [NSMutableData dataWithLength:compression_decode_scratch_buffer_size(algorithm)];
+    // Same noise sequence for every codec
+    uint32_t seed = 12345;
+    uint64_t encodeNanos = 0, decodeNanos = 0, payloadBytes = 0;
+    for (int f = 0; f < frames; f++) {
+      for (NSInteger i = 0; i < n; i++) {
+        seed = seed * 1664525u + 1013904223u;
+        // About +-0.05 C, the frame-to-frame noise of a microbolometer
+        frame[i] = plane[i] + ((int)(seed >> 24) - 128) * (0.05f / 128.f);
+      }
+      uint64_t start = clock_gettime_nsec_np(CLOCK_UPTIME_RAW);
+      size_t length = [encoder encodePlane:frame width:width height:height keyframe:f % 30 == 0];
+      uint64_t encoded = clock_gettime_nsec_np(CLOCK_UPTIME_RAW);
+      compression_decode_buffer(decoded.mutableBytes, decoded.length, encoder.bytes, length,
+                                decodeScratch.mutableBytes, algorithm);
+      decodeNanos += clock_gettime_nsec_np(CLOCK_UPTIME_RAW) - encoded;
+      encodeNanos += encoded - start;
+      payloadBytes += length;
+    }
+    double rawBytes = (double)n * sizeof(float) * frames;
+    [results addObject:@{
+      @"codec": codec[0],
+      @"encodeMBps": @(encodeNanos > 0 ? rawBytes / 1e6 / (encodeNanos / 1e9) : 0),
+      @"decodeMBps": @(decodeNanos > 0 ? rawBytes / 1e6 / (decodeNanos / 1e9) : 0),
+      @"compressionRatio": @(payloadBytes > 0 ? rawBytes / payloadBytes : 0)
+    }];
+  }
+  return results;
+}
+
+@end
+
+#pragma mark - Recorder
+
+@implementation FlirRecorder {
+    FILE *_file;
+    int _keyframeInterval;
+    int _width;
+    int _height;
+    uint64_t _position;
+    BOOL _closed;
+    // Scratch sized once per recording
+    FlirPlaneEncoder *_encoder;
+    // u64 offset, u64 timestamp, u64 flags per frame
+    NSMutableData *_index;
+    NSInteger _frameCount;
+    uint64_t _rawBytes;
+    uint64_t _encodeNanos;
+    uint64_t _clippedPixels;
+    NSInteger _clippedFrames;
+    os_unfair_lock _lock;
+    // Frames are copied on enqueue and encoded here; _pending and _spare are guarded by _lock
+    dispatch_queue_t _queue;
+    NSInteger _pending;
+    NSInteger _droppedFrames;
+    NSMutableArray<NSMutableData *> *_spare;
+    BOOL _failed;
+}
+
+- (instancetype)initWithPath:(NSString *)path keyframeInterval:(int)keyframeInterval
+{
+  if (self = [super init]) {
+    _path = [path copy];
+    _keyframeInterval = MAX(1, keyframeInterval);
+    _index = [NSMutableData data];
+    _lock = OS_UNFAIR_LOCK_INIT;
+    _queue = dispatch_queue_create("flir.recorder", DISPATCH_QUEUE_SERIAL);
+    _spare = [NSMutableArray array];
+  }
+  return self;
+}
+
+- (void)dealloc
+{
+  // Queued blocks retain the recorder, so nothing is pending here
+  [self closeFile];
+}
+
+- (BOOL)enqueuePlane:(const float *)plane width:(int)width height:(int)height timestampNanos:(uint64_t)timestampNanos metadata:(NSDictionary *)metadata failure:(void (^)(NSError *error))failure
+{
+  NSUInteger length = (NSUInteger)width * height * sizeof(float);
+  os_unfair_lock_lock(&_lock);
+  if (_closed || _failed || _pending >= FLIR_REC_MAX_PENDING) {
+    if (!_closed && !_failed) _droppedFrames++;
+    os_unfair_lock_unlock(&_lock);
+    return NO;
+  }
+  _pending++;
+  NSMutableData *copy = _spare.lastObject;
+  if (copy != nil) [_spare removeLastObject];
+  os_unfair_lock_unlock(&_lock);
+
+  if (copy == nil) copy = [NSMutableData dataWithLength:length];
+  copy.length = length;
+  memcpy(copy.mutableBytes, plane, length);
+  dispatch_async(_queue, ^{
+    NSError *error = nil;
+    os_unfair_lock_lock(&self->_lock);
+    BOOL ok = [self lockedAppendPlane:(const float *)copy.bytes width:width height:height timestampNanos:timestampNanos metadata:metadata error:&error];
+    BOOL failed = !ok && error != nil && !self->_failed;
+    if (failed) self->_failed = YES;
+    self->_pending--;
+    [self->_spare addObject:copy];
+    os_unfair_lock_unlock(&self->_lock);
+    if (failed && failure) failure(error);
+  });
+  return YES;
+}
+
+- (BOOL)appendPlane:(const float *)plane width:(int)width height:(int)height timestampNanos:(uint64_t)timestampNanos metadata:(NSDictionary *)metadata error:(NSError **)error
+{
+  os_unfair_lock_lock(&_lock);
+  BOOL ok = [self lockedAppendPlane:plane width:width height:height timestampNanos:timestampNanos metadata:metadata error:error];
+  os_unfair_lock_unlock(&_lock);
+  return ok;
+}
+
+- (BOOL)lockedAppendPlane:(const float *)plane width:(int)width height:(int)height timestampNanos:(uint64_t)timestampNanos metadata:(NSDictionary *)metadata error:(NSError **)error
+{
+  if (_closed) return NO;
+  uint64_t start = clock_gettime_nsec_np(CLOCK_UPTIME_RAW);
+  if (_file == NULL) {
+    if (![self openWidth:width height:height metadata:metadata error:error]) return NO;
+  } else if (width != _width || height != _height) {
+    return NO;
+  }
+
+  NSInteger n = (NSInteger)width * height;
+  BOOL keyframe = _frameCount % _keyframeInterval == 0;
+  size_t length = [_encoder encodePlane:plane width:width height:height keyframe:keyframe];
+  if (length == 0) {
+    if (error) *error = FlirRecError(@"Frame compression failed");
+    return NO;
+  }
+  if (![self writeFramePayload:_encoder.bytes length:length rawLength:(size_t)(2 * n) keyframe:keyframe
+                timestampNanos:timestampNanos error:error]) {
+    return NO;
+  }
+  if (_encoder.clippedPixels > 0) {
+    _clippedPixels += (uint64_t)_encoder.clippedPixels;
+    _clippedFrames++;
+  }
+  _rawBytes += (uint64_t)n * sizeof(float);
+  _encodeNanos += clock_gettime_nsec_np(CLOCK_UPTIME_RAW) - start;
+  return YES;
+}
+
+- (BOOL)appendPayload:(const void *)payload length:(size_t)length keyframe:(BOOL)keyframe width:(int)width height:(int)height timestampNanos:(uint64_t)timestampNanos metadata:(NSDictionary *)metadata error:(NSError **)error
+{
+  os_unfair_lock_lock(&_lock);
+  BOOL ok = [self lockedAppendPayload:payload length:length keyframe:keyframe width:width height:height timestampNanos:timestampNanos metadata:metadata error:error];
+  os_unfair_lock_unlock(&_lock);
+  return ok;
+}
+
+- (BOOL)lockedAppendPayload:(const void *)payload length:(size_t)length keyframe:(BOOL)keyframe width:(int)width height:(int)height timestampNanos:(uint64_t)timestampNanos metadata:(NSDictionary *)metadata error:(NSError **)error
+{
+  if (_closed) return NO;
+  uint64_t start = clock_gettime_nsec_np(CLOCK_UPTIME_RAW);
+  if (_file == NULL) {
+    // A recording has to start with a keyframe
+    if (!keyframe || ![self openWidth:width height:height metadata:metadata error:error]) return NO;
+  } else if (width != _width || height != _height) {
+    return NO;
+  }
+  NSInteger n = (NSInteger)width * height;
+  if (![self writeFramePayload:payload length:length rawLength:(size_t)(2 * n) keyframe:keyframe
+                timestampNanos:timestampNanos error:error]) {
+    return NO;
+  }
+  _rawBytes += (uint64_t)n * sizeof(float);
+  _encodeNanos += clock_gettime_nsec_np(CLOCK_UPTIME_RAW) - start;
+  return YES;
+}
+
+- (BOOL)writeFramePayload:(const void *)payload length:(size_t)length rawLength:(size_t)rawLength keyframe:(BOOL)keyframe timestampNanos:(uint64_t)timestampNanos error:(NSError **)error
+{
+  uint8_t header[FLIR_REC_FRAME_HEADER_SIZE];
+  uint64_t offset = _position;
+  FlirPut32(header, FLIR_REC_FRAME_MAGIC);
+  FlirPut32(header + 4, keyframe ? FLIR_REC_FLAG_KEYFRAME : 0);
+  FlirPut64(header + 8, timestampNanos);
+  FlirPut32(header + 16, (uint32_t)length);
+  FlirPut32(header + 20, (uint32_t)rawLength);
+  if (![self write:header length:sizeof(header) error:error] || ![self write:payload length:length error:error]) {
+    return NO;
+  }
+  uint64_t entry[3] = {offset, timestampNanos, keyframe ? FLIR_REC_FLAG_KEYFRAME : 0};
+  [_index appendBytes:entry length:sizeof(entry)];
+  _frameCount++;
+  return YES;
+}
+
+- (void)close
+{
+  dispatch_sync(_queue, ^{
+    [self closeFile];
+  });
+}
+
+- (void)closeFile
+{
+  os_unfair_lock_lock(&_lock);
+  if (!_closed) {
+    _closed = YES;
+    if (_file != NULL) {
+      uint64_t indexOffset = _position;
+      const uint64_t *entries = (const uint64_t *)_index.bytes;
+      uint8_t entry[FLIR_REC_INDEX_ENTRY_SIZE];
+      for (NSInteger i = 0; i < _frameCount; i++) {
+        memset(entry, 0, sizeof(entry));
+        FlirPut64(entry, entries[3 * i]);
+        FlirPut64(entry + 8, entries[3 * i + 1]);
+        FlirPut32(entry + 16, (uint32_t)entries[3 * i + 2]);
+        [self write:entry length:sizeof(entry) error:nil];
+      }
+      uint8_t trailer[FLIR_REC_TRAILER_SIZE] = {0};
+      FlirPut64(trailer, indexOffset);
+      FlirPut32(trailer + 8, (uint32_t)_frameCount);
+      memcpy(trailer + 16, FlirRecIndexMagic, sizeof(FlirRecIndexMagic));
+      [self write:trailer length:sizeof(trailer) error:nil];
+      fclose(_file);
+      _file = NULL;
+    }
+  }
+  os_unfair_lock_unlock(&_lock);
+}
+
+- (NSDictionary *)stats
+{
+  os_unfair_lock_lock(&_lock);
+  NSDictionary *stats = @{
+    @"path": _path,
+    @"frames": @(_frameCount),
+    @"rawBytes": @(_rawBytes),
+    @"bytesWritten": @(_position),
+    @"compressionRatio": @(_position > 0 ? (double)_rawBytes / _position : 0),
+    @"throughputMBps": @(_encodeNanos > 0 ? _rawBytes / 1e6 / (_encodeNanos / 1e9) : 0),
+    @"avgAppendMs": @(_frameCount > 0 ? _encodeNanos / 1e6 / _frameCount : 0),
+    @"droppedFrames": @(_droppedFrames),
+    @"clippedPixels": @(_clippedPixels),
+    @"clippedFrames": @(_clippedFrames)
+  };
+  os_unfair_lock_unlock(&_lock);
+  return stats;
+}
+
+- (BOOL)openWidth:(int)width height:(int)height metadata:(NSDictionary *)metadata error:(NSError **)error
+{
+  _file = fopen(_path.fileSystemRepresentation, "wb");
+  if (_file == NULL) {
+    if (error) *error = FlirRecError([NSString stringWithFormat:@"Cannot create %@: %s", _path, strerror(errno)]);
+    _closed = YES;
+    return NO;
+  }
+  setvbuf(_file, NULL, _IOFBF, 1 << 16);
+  _width = width;
+  _height = height;
+  _encoder = [[FlirPlaneEncoder alloc] init];
+
+  NSData *json = [NSJSONSerialization dataWithJSONObject:metadata ?: @{} options:0 error:nil] ?: [@"{}" dataUsingEncoding:NSUTF8StringEncoding];
+  uint8_t header[FLIR_REC_HEADER_SIZE] = {0};
+  float offset = FLIR_REC_OFFSET, step = FLIR_REC_STEP;
+  float clipMin = FLIR_REC_CLIP_MIN, clipMax = FLIR_REC_CLIP_MAX;
+  memcpy(header, FlirRecMagic, sizeof(FlirRecMagic));
+  FlirPut16(header + 8, FLIR_REC_VERSION);
+  FlirPut16(header + 10, FLIR_REC_CODEC_DEFLATE);
+  FlirPut32(header + 12, (uint32_t)width);
+  FlirPut32(header + 16, (uint32_t)height);
+  memcpy(header + 20, &offset, 4);
+  memcpy(header + 24, &step, 4);
+  FlirPut32(header + 28, (uint32_t)_keyframeInterval);
+  FlirPut64(header + 32, (uint64_t)([[NSDate date] timeIntervalSince1970] * 1000));
+  FlirPut32(header + 40, (uint32_t)json.length);
+  memcpy(header + 44, &clipMin, 4);
+  memcpy(header + 48, &clipMax, 4);
+  return [self write:header length:sizeof(header) error:error] && [self write:json.bytes length:json.length error:error];
+}
+
+- (BOOL)write:(const void *)bytes length:(size_t)length error:(NSError **)error
+{
+  if (fwrite(bytes, 1, length, _file) != length) {
+    if (error) *error = FlirRecError([NSString stringWithFormat:@"Write failed: %s", strerror(errno)]);
+    return NO;
+  }
+  _position += length;
+  return YES;
+}
+
+@end
+
+#pragma mark - Playback
+
+@implementation FlirRecording {
+    NSData *_map;
+    float _offset;
+    float _step;
+    NSMutableData *_offsets;
+    NSMutableData *_timestamps;
+    NSMutableData *_flags;
+    // Quantized plane of _decodedIndex
+    NSMutableData *_plane;
+    NSMutableData *_raw;
+    NSMutableData *_decodeScratch;
+    NSInteger _decodedIndex;
+}
+
++ (instancetype)recordingWithPath:(NSString *)path error:(NSError **)error
+{
+  NSData *map = [NSData dataWithContentsOfFile:path options:NSDataReadingMappedAlways error:error];
+  if (map == nil) return nil;
+  FlirRecording *recording = [[FlirRecording alloc] initWithMap:map error:error];
+  return recording;
+}
+
+- (instancetype)initWithMap:(NSData *)map error:(NSError **)error
+{
+  if (!(self = [super init])) return nil;
+  const uint8_t *bytes = (const uint8_t *)map.bytes;
+  if (map.length < FLIR_REC_HEADER_SIZE || memcmp(bytes, FlirRecMagic, sizeof(FlirRecMagic)) != 0) {
+    if (error) *error = FlirRecError(@"Not a recording");
+    return nil;
+  }
+  if (FlirGet16(bytes + 8) != FLIR_REC_VERSION || FlirGet16(bytes + 10) != FLIR_REC_CODEC_DEFLATE) {
+    if (error) *error = FlirRecError(@"Unsupported recording version or codec");
+    return nil;
+  }
+  _map = map;
+  _width = (int)FlirGet32(bytes + 12);
+  _height = (int)FlirGet32(bytes + 16);
+  memcpy(&_offset, bytes + 20, 4);
+  memcpy(&_step, bytes + 24, 4);
+  _keyframeInterval = (int)FlirGet32(bytes + 28);
+  _createdAt = FlirGet64(bytes + 32) / 1000.0;
+  uint32_t metadataLength = FlirGet32(bytes + 40);
+  if ((uint64_t)FLIR_REC_HEADER_SIZE + metadataLength > map.length) {
+    if (error) *error = FlirRecError(@"Truncated recording header");
+    return nil;
+  }
+  // Recordings from before the clip range was stored leave it zero; it follows from offset and step
+  float clipMin, clipMax;
+  memcpy(&clipMin, bytes + 44, 4);
+  memcpy(&clipMax, bytes + 48, 4);
+  BOOL stored = clipMin != 0 || clipMax != 0;
+  _clipMin = stored ? clipMin : _offset;
+  _clipMax = stored ? clipMax : _offset + (FLIR_REC_NAN_CODE - 1) * _step;
+  _metadata = [[NSString alloc] initWithBytes:bytes + FLIR_REC_HEADER_SIZE length:metadataLength encoding:NSUTF8StringEncoding] ?: @"{}";
+
+  NSUInteger n = (NSUInteger)_width * _height;
+  _plane = [NSMutableData dataWithLength:n * sizeof(uint16_t)];
+  _raw = [NSMutableData dataWithLength:n * 2];
+  _decodeScratch = [NSMutableData dataWithLength:compression_decode_scratch_buffer_size(COMPRESSION_ZLIB)];
+  _offsets = [NSMutableData data];
+  _timestamps = [NSMutableData data];
+  _flags = [NSMutableData data];
+  _decodedIndex = -1;
+  if (![self readIndex]) [self scanFramesFrom:FLIR_REC_HEADER_SIZE + metadataLength];
+  return self;
+}
+
+- (uint64_t)durationNanos
+{
+  return _frameCount > 1 ? [self timestampNanosAtIndex:_frameCount - 1] - [self timestampNanosAtIndex:0] : 0;
+}
+
+- (uint64_t)timestampNanosAtIndex:(NSInteger)index
+{
+  return ((const uint64_t *)_timestamps.bytes)[index];
+}
+
+- (NSInteger)indexAtTimestampNanos:(uint64_t)timestampNanos
+{
+  const uint64_t *timestamps = (const uint64_t *)_timestamps.bytes;
+  NSInteger lo = 0, hi = _frameCount - 1;
+  while (lo < hi) {
+    NSInteger mid = (lo + hi + 1) / 2;
+    if (timestamps[mid] <= timestampNanos) lo = mid; else hi = mid - 1;
+  }
+  return MAX(0, lo);
+}
+
+- (BOOL)readFrame:(NSInteger)index into:(float *)plane min:(float *)min max:(float *)max error:(NSError **)error
+{
+  if (index < 0 || index >= _frameCount) {
+    if (error) *error = FlirRecError([NSString stringWithFormat:@"Frame %ld of %ld", (long)index, (long)_frameCount]);
+    return NO;
+  }
+  const uint32_t *flags = (const uint32_t *)_flags.bytes;
+  NSInteger start = index;
+  BOOL keyframeBetween = NO;
+  for (NSInteger i = _decodedIndex + 1; _decodedIndex >= 0 && i <= index; i++) {
+    if (flags[i] & FLIR_REC_FLAG_KEYFRAME) { keyframeBetween = YES; break; }
+  }
+  if (_decodedIndex >= 0 && _decodedIndex <= index && !keyframeBetween) {
+    start = _decodedIndex + 1;
+  } else {
+    while (start > 0 && (flags[start] & FLIR_REC_FLAG_KEYFRAME) == 0) start--;
+  }
+  for (NSInteger i = start; i <= index; i++) {
+    if (![self decode:i error:error]) return NO;
+  }
+
+  NSInteger n = (NSInteger)_width * _height;
+  const uint16_t *q = (const uint16_t *)_plane.bytes;
+  float lo = INFINITY, hi = -INFINITY;
+  for (NSInteger i = 0; i < n; i++) {
+    float v = q[i] == FLIR_REC_NAN_CODE ? NAN : _offset + q[i] * _step;
+    plane[i] = v;
+    if (v < lo) lo = v;
+    if (v > hi) hi = v;
+  }
+  if (min) *min = lo <= hi ? lo : NAN;
+  if (max) *max = lo <= hi ? hi : NAN;
+  return YES;
+}
+
+- (BOOL)decode:(NSInteger)index error:(NSError **)error
+{
+  const uint8_t *bytes = (const uint8_t *)_map.bytes;
+  uint64_t position = ((const uint64_t *)_offsets.bytes)[index];
+  uint32_t length = FlirGet32(bytes + position + 16);
+  uint32_t rawLength = FlirGet32(bytes + position + 20);
+  NSInteger n = (NSInteger)_width * _height;
+  if (rawLength != 2 * n) {
+    if (error) *error = FlirRecError([NSString stringWithFormat:@"Frame %ld has unexpected size", (long)index]);
+    return NO;
+  }
+  size_t decoded = compression_decode_buffer(_raw.mutableBytes, rawLength, bytes + position + FLIR_REC_FRAME_HEADER_SIZE,
+                                             length, _decodeScratch.mutableBytes, COMPRESSION_ZLIB);
+  if (decoded != rawLength) {
+    if (error) *error = FlirRecError([NSString stringWithFormat:@"Frame %ld is corrupt", (long)index]);
+    return NO;
+  }
+  BOOL keyframe = (((const uint32_t *)_flags.bytes)[index] & FLIR_REC_FLAG_KEYFRAME) != 0;
+  const uint8_t *raw = (const uint8_t *)_raw.bytes;
+  uint16_t *q = (uint16_t *)_plane.mutableBytes;
+  for (NSInteger i = 0; i < n; i++) {
+    uint16_t v = (uint16_t)(raw[i] | (raw[n + i] << 8));
+    q[i] = keyframe ? v : (uint16_t)(q[i] + v);
+  }
+  _decodedIndex = index;
+  return YES;
+}
+
+- (BOOL)readIndex
+{
+  NSUInteger size = _map.length;
+  if (size < FLIR_REC_TRAILER_SIZE) return NO;
+  const uint8_t *bytes = (const uint8_t *)_map.bytes;
+  const uint8_t *trailer = bytes + size - FLIR_REC_TRAILER_SIZE;
+  if (memcmp(trailer + 16, FlirRecIndexMagic, sizeof(FlirRecIndexMagic)) != 0) return NO;
+  uint64_t indexOffset = FlirGet64(trailer);
+  uint32_t count = FlirGet32(trailer + 8);
+  if (indexOffset + (uint64_t)count * FLIR_REC_INDEX_ENTRY_SIZE != size - FLIR_REC_TRAILER_SIZE) return NO;
+  for (uint32_t i = 0; i < count; i++) {
+    const uint8_t *entry = bytes + indexOffset + (uint64_t)i * FLIR_REC_INDEX_ENTRY_SIZE;
+    [self addFrameAt:FlirGet64(entry) timestamp:FlirGet64(entry + 8) flags:FlirGet32(entry + 16)];
+  }
+  return YES;
+}
+
+// Footer missing: walk the frame headers and stop at the first incomplete frame
+- (void)scanFramesFrom:(uint64_t)position
+{
+  NSUInteger size = _map.length;
+  const uint8_t *bytes = (const uint8_t *)_map.bytes;
+  while (position + FLIR_REC_FRAME_HEADER_SIZE <= size && FlirGet32(bytes + position) == FLIR_REC_FRAME_MAGIC) {
+    uint64_t end = position + FLIR_REC_FRAME_HEADER_SIZE + FlirGet32(bytes + position + 16);
+    if (end > size) break;
+    [self addFrameAt:position timestamp:FlirGet64(bytes + position + 8) flags:FlirGet32(bytes + position + 4)];
+    position = end;
+  }
+}
+
+- (void)addFrameAt:(uint64_t)offset timestamp:(uint64_t)timestamp flags:(uint32_t)flags
+{
+  [_offsets appendBytes:&offset length:sizeof(offset)];
+  [_timestamps appendBytes:&timestamp length:sizeof(timestamp)];
+  [_flags appendBytes:&flags length:sizeof(flags)];
+  _frameCount++;
+}
+
+@end
@@ -0,0 +1,28 @@
+#import <Foundation/Foundation.h>
+
+@class FLIRThermalImage;
+
+NS_ASSUME_NONNULL_BEGIN
+
+// Per-frame min/max/mean/stddev/percentiles/hot- and coldspot over registered regions.
+// Regions are NSDictionaries shaped like the JS API:
+//   { id, type: @"rect", x, y, width, height }   { id, type: @"ellipse", cx, cy, rx, ry }
+//   { id, type: @"polygon", points: [{x, y}, ...] }   { id, type: @"line", x0, y0, x1, y1 }
+@interface FlirRegionStatistics : NSObject
+
+// Set from the JS thread, read on the stream queue
+@property (atomic, copy) NSArray<NSNumber *> *percentiles;
+
++ (instancetype)shared;
+- (void)setRegions:(NSArray<NSDictionary *> *)regions;
+
+// Reduces the plane in one pass per region. The "frame" entry uses FLIRImageStatistics
+// when a thermal image is given, with percentiles from the plane, and the plane otherwise.
+- (NSArray<NSDictionary *> *)computeWithPlane:(const float *)plane
+                                        width:(int)width
+                                       height:(int)height
+                                 thermalImage:(FLIRThermalImage *_Nullable)thermalImage;
+
+@end
+
+NS_ASSUME_NONNULL_END
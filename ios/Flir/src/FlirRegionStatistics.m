@@ -0,0 +1,274 @@
+#import "FlirRegionStatistics.h"
+#import <ThermalSDK/ThermalSDK.h>
+#import <os/lock.h>
+
+#define FLIR_HISTOGRAM_BINS 1024
+
+// Region rasterized into (row, x0, x1) spans for a given frame size
+@interface FlirRegion : NSObject
+@property (nonatomic, copy) NSString *regionId;
+@property (nonatomic, copy) NSString *type;
+@property (nonatomic, strong) NSData *coords;
+@property (nonatomic, strong) NSMutableData *spans;
+@property (nonatomic, assign) int spanWidth;
+@property (nonatomic, assign) int spanHeight;
+@end
+
+@implementation FlirRegion
+@end
+
+static void FlirAddSpan(NSMutableData *spans, int width, int height, int row, int x0, int x1)
+{
+  if (row < 0 || row >= height) return;
+  x0 = MAX(0, x0);
+  x1 = MIN(width, x1);
+  if (x1 <= x0) return;
+  int span[3] = { row, x0, x1 };
+  [spans appendBytes:span length:sizeof(span)];
+}
+
+static void FlirRasterizeRegion(FlirRegion *region, int width, int height)
+{
+  NSMutableData *spans = [NSMutableData data];
+  const float *c = (const float *)region.coords.bytes;
+  NSUInteger n = region.coords.length / sizeof(float);
+
+  if ([region.type isEqualToString:@"rect"] && n >= 4) {
+    for (int y = (int)c[1]; y < (int)(c[1] + c[3]); y++) {
+      FlirAddSpan(spans, width, height, y, (int)c[0], (int)(c[0] + c[2]));
+    }
+  } else if ([region.type isEqualToString:@"ellipse"] && n >= 4 && c[3] > 0) {
+    for (int y = (int)floorf(c[1] - c[3]); y <= (int)ceilf(c[1] + c[3]); y++) {
+      float dy = (y + 0.5f - c[1]) / c[3];
+      if (dy * dy > 1.f) continue;
+      float half = c[2] * sqrtf(1.f - dy * dy);
+      FlirAddSpan(spans, width, height, y, (int)lroundf(c[0] - half), (int)lroundf(c[0] + half));
+    }
+  } else if ([region.type isEqualToString:@"polygon"] && n >= 6) {
+    NSUInteger points = n / 2;
+    float *crossings = malloc(points * sizeof(float));
+    for (int y = 0; y < height; y++) {
+      float sy = y + 0.5f;
+      NSUInteger found = 0;
+      for (NSUInteger i = 0, j = points - 1; i < points; j = i++) {
+        float yi = c[2 * i + 1], yj = c[2 * j + 1];
+        if ((yi > sy) != (yj > sy)) {
+          crossings[found++] = c[2 * i] + (sy - yi) / (yj - yi) * (c[2 * j] - c[2 * i]);
+        }
+      }
+      // Insertion sort; polygons have few edges per row
+      for (NSUInteger a = 1; a < found; a++) {
+        float v = crossings[a];
+        NSUInteger b = a;
+        while (b > 0 && crossings[b - 1] > v) { crossings[b] = crossings[b - 1]; b--; }
+        crossings[b] = v;
+      }
+      for (NSUInteger k = 0; k + 1 < found; k += 2) {
+        FlirAddSpan(spans, width, height, y, (int)ceilf(crossings[k] - 0.5f), (int)ceilf(crossings[k + 1] - 0.5f));
+      }
+    }
+    free(crossings);
+  } else if ([region.type isEqualToString:@"line"] && n >= 4) {
+    int x0 = (int)lroundf(c[0]), y0 = (int)lroundf(c[1]);
+    int x1 = (int)lroundf(c[2]), y1 = (int)lroundf(c[3]);
+    int dx = abs(x1 - x0), dy = -abs(y1 - y0);
+    int sx = x0 < x1 ? 1 : -1, sy = y0 < y1 ? 1 : -1;
+    int err = dx + dy;
+    while (YES) {
+      FlirAddSpan(spans, width, height, y0, x0, x0 + 1);
+      if (x0 == x1 && y0 == y1) break;
+      int e2 = 2 * err;
+      if (e2 >= dy) { err += dy; x0 += sx; }
+      if (e2 <= dx) { err += dx; y0 += sy; }
+    }
+  }
+
+  region.spans = spans;
+  region.spanWidth = width;
+  region.spanHeight = height;
+}
+
+@implementation FlirRegionStatistics {
+    NSArray<FlirRegion *> *_regions;
+    FlirRegion *_wholeFrame;
+    uint32_t _histogram[FLIR_HISTOGRAM_BINS];
+    os_unfair_lock _lock;
+}
+
++ (instancetype)shared
+{
+  static FlirRegionStatistics *shared = nil;
+  static dispatch_once_t onceToken;
+  dispatch_once(&onceToken, ^{
+    shared = [FlirRegionStatistics new];
+  });
+  return shared;
+}
+
+- (instancetype)init
+{
+  if (self = [super init]) {
+    _regions = @[];
+    _percentiles = @[@5, @50, @95];
+    _lock = OS_UNFAIR_LOCK_INIT;
+  }
+  return self;
+}
+
+- (void)setRegions:(NSArray<NSDictionary *> *)regions
+{
+  NSMutableArray<FlirRegion *> *parsed = [NSMutableArray arrayWithCapacity:regions.count];
+  [regions enumerateObjectsUsingBlock:^(NSDictionary *dict, NSUInteger idx, BOOL *stop) {
+    FlirRegion *region = [FlirRegion new];
+    region.regionId = [dict[@"id"] description] ?: [NSString stringWithFormat:@"%lu", (unsigned long)idx];
+    region.type = dict[@"type"] ?: @"rect";
+    region.spanWidth = -1;
+    NSMutableData *coords = [NSMutableData data];
+    NSArray<NSString *> *keys = nil;
+    if ([region.type isEqualToString:@"rect"]) keys = @[@"x", @"y", @"width", @"height"];
+    else if ([region.type isEqualToString:@"ellipse"]) keys = @[@"cx", @"cy", @"rx", @"ry"];
+    else if ([region.type isEqualToString:@"line"]) keys = @[@"x0", @"y0", @"x1", @"y1"];
+    for (NSString *key in keys) {
+      float v = [dict[key] floatValue];
+      [coords appendBytes:&v length:sizeof(v)];
+    }
+    if ([region.type isEqualToString:@"polygon"]) {
+      for (NSDictionary *point in dict[@"points"]) {
+        float xy[2] = { [point[@"x"] floatValue], [point[@"y"] floatValue] };
+        [coords appendBytes:xy length:sizeof(xy)];
+      }
+    }
+    region.coords = coords;
+    [parsed addObject:region];
+  }];
+  os_unfair_lock_lock(&_lock);
+  _regions = parsed;
+  os_unfair_lock_unlock(&_lock);
+}
+
+- (NSArray<NSDictionary *> *)computeWithPlane:(const float *)plane width:(int)width height:(int)height thermalImage:(FLIRThermalImage *)thermalImage
+{
+  os_unfair_lock_lock(&_lock);
+  NSArray<FlirRegion *> *regions = _regions;
+  os_unfair_lock_unlock(&_lock);
+
+  // Frame range for the histogram, one vectorizable pass
+  float lo = INFINITY, hi = -INFINITY;
+  NSInteger count = (NSInteger)width * height;
+  for (NSInteger i = 0; i < count; i++) {
+    float v = plane[i];
+    lo = v < lo ? v : lo;
+    hi = v > hi ? v : hi;
+  }
+
+  NSMutableArray<NSDictionary *> *results = [NSMutableArray arrayWithCapacity:regions.count + 1];
+  if (_wholeFrame == nil || _wholeFrame.spanWidth != width || _wholeFrame.spanHeight != height) {
+    FlirRegion *whole = [FlirRegion new];
+    whole.regionId = @"frame";
+    whole.type = @"rect";
+    float coords[4] = { 0, 0, width, height };
+    whole.coords = [NSData dataWithBytes:coords length:sizeof(coords)];
+    whole.spanWidth = -1;
+    _wholeFrame = whole;
+  }
+  NSDictionary *frameStats = [self reduce:_wholeFrame plane:plane width:width height:height lo:lo hi:hi];
+  NSDictionary *imageStats = thermalImage != nil ? [self imageStatistics:thermalImage] : nil;
+  if (imageStats != nil) {
+    // The SDK has no percentiles; they come from the plane like every other region's
+    NSMutableDictionary *merged = [imageStats mutableCopy];
+    if (frameStats[@"percentiles"] != nil) merged[@"percentiles"] = frameStats[@"percentiles"];
+    frameStats = merged;
+  }
+  [results addObject:frameStats];
+  for (FlirRegion *region in regions) {
+    [results addObject:[self reduce:region plane:plane width:width height:height lo:lo hi:hi]];
+  }
+  return results;
+}
+
+- (NSDictionary *)imageStatistics:(FLIRThermalImage *)thermalImage
+{
+  FLIRImageStatistics *stats = [thermalImage getImageStatistics];
+  if (stats == nil) return nil;
+  CGPoint hot = [stats getHotSpot];
+  CGPoint cold = [stats getColdSpot];
+  return @{
+    @"id": @"frame",
+    @"count": @([thermalImage getWidth] * [thermalImage getHeight]),
+    @"min": @([[stats getMin] asCelsius].value),
+    @"max": @([[stats getMax] asCelsius].value),
+    @"mean": @([[stats getAverage] asCelsius].value),
+    @"stddev": @([stats getStandardDeviation].value),
+    @"hotspot": @{ @"x": @(hot.x), @"y": @(hot.y) },
+    @"coldspot": @{ @"x": @(cold.x), @"y": @(cold.y) },
+  };
+}
+
+- (NSDictionary *)reduce:(FlirRegion *)region plane:(const float *)plane width:(int)width height:(int)height lo:(float)lo hi:(float)hi
+{
+  if (region.spanWidth != width || region.spanHeight != height) {
+    FlirRasterizeRegion(region, width, height);
+  }
+  const int *spans = (const int *)region.spans.bytes;
+  NSUInteger spanInts = region.spans.length / sizeof(int);
+
+  float range = hi - lo;
+  float scale = range > 0 ? (FLIR_HISTOGRAM_BINS - 1) / range : 0.f;
+  memset(_histogram, 0, sizeof(_histogram));
+
+  NSInteger count = 0;
+  double sum = 0, sumSq = 0;
+  float min = INFINITY, max = -INFINITY;
+  NSInteger minIndex = -1, maxIndex = -1;
+  for (NSUInteger s = 0; s < spanInts; s += 3) {
+    NSInteger base = (NSInteger)spans[s] * width;
+    NSInteger end = base + spans[s + 2];
+    for (NSInteger i = base + spans[s + 1]; i < end; i++) {
+      float v = plane[i];
+      if (isnan(v)) continue;
+      count++;
+      sum += v;
+      sumSq += (double)v * v;
+      if (v < min) { min = v; minIndex = i; }
+      if (v > max) { max = v; maxIndex = i; }
+      _histogram[(int)((v - lo) * scale)]++;
+    }
+  }
+
+  if (count == 0) {
+    return @{ @"id": region.regionId, @"count": @0 };
+  }
+
+  double mean = sum / count;
+  NSMutableDictionary *percentiles = [NSMutableDictionary dictionary];
+  for (NSNumber *p in self.percentiles) {
+    float value = min;
+    if (scale > 0) {
+      NSInteger target = (NSInteger)ceil(MAX(0.0, MIN(100.0, p.doubleValue)) / 100.0 * count);
+      NSInteger cumulative = 0;
+      value = max;
+      for (int bin = 0; bin < FLIR_HISTOGRAM_BINS; bin++) {
+        cumulative += _histogram[bin];
+        if (cumulative >= target && cumulative > 0) {
+          value = MAX(min, MIN(max, lo + (bin + 0.5f) / scale));
+          break;
+        }
+      }
+    }
+    percentiles[[NSString stringWithFormat:@"p%@", p]] = @(value);
+  }
+
+  return @{
+    @"id": region.regionId,
+    @"count": @(count),
+    @"min": @(min),
+    @"max": @(max),
+    @"mean": @(mean),
+    @"stddev": @(sqrt(MAX(0.0, sumSq / count - mean * mean))),
+    @"hotspot": @{ @"x": @(maxIndex % width), @"y": @(maxIndex / width) },
+    @"coldspot": @{ @"x": @(minIndex % width), @"y": @(minIndex / width) },
+    @"percentiles": percentiles,
+  };
+}
+
+@end
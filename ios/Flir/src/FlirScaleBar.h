@@ -0,0 +1,25 @@
+#import <Foundation/Foundation.h>
+
+@class FlirColorizer;
+
+NS_ASSUME_NONNULL_BEGIN
+
+// Scale legend for the active palette and span. The palette, span and rendered images are
+// cached and only rebuilt when the colorizer's LUT, span or equalization transfer changes by more
+// than its threshold; FlirScaleChanged is emitted on those changes only.
+@interface FlirScaleBar : NSObject
+
++ (instancetype)shared;
+
+// Call from the stream queue after each frame has been colorized (or tracked from the SDK).
+- (void)updateFromColorizer:(FlirColorizer *)colorizer;
+
+// { palette, min, max, equalized, version, orientation, path } with path a cached PNG of the legend,
+// hot end at the top (vertical) or on the right (horizontal); nil before the first frame.
+- (nullable NSDictionary *)scaleBarWithOrientation:(NSString *)orientation;
+
+- (void)reset;
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,175 @@
+#import "FlirScaleBar.h"
+#import "FlirColorizer.h"
+#import "FlirEventEmitter.h"
+#import <os/lock.h>
+
+// Span changes below this are auto-scale jitter and do not invalidate the legend
+#define FLIR_SCALE_CHANGE_THRESHOLD 0.1f
+#define FLIR_SCALE_LENGTH 256
+#define FLIR_SCALE_THICKNESS 16
+// Equalization moves the legend every frame; it is redrawn once an entry moves this many LUT steps
+#define FLIR_SCALE_TRANSFER_THRESHOLD 8
+
+@implementation FlirScaleBar {
+    // Identity of the LUT the cached legend was built from; stream queue only
+    NSData *_lut;
+    // Span step -> LUT index while equalizing, nil for a linear legend
+    NSData *_transfer;
+    NSString *_palette;
+    float _min;
+    float _max;
+    NSUInteger _version;
+    // orientation -> PNG path for _version
+    NSMutableDictionary<NSString *, NSString *> *_paths;
+    os_unfair_lock _lock;
+}
+
++ (instancetype)shared
+{
+  static FlirScaleBar *shared = nil;
+  static dispatch_once_t onceToken;
+  dispatch_once(&onceToken, ^{
+    shared = [FlirScaleBar new];
+  });
+  return shared;
+}
+
+- (instancetype)init
+{
+  if (self = [super init]) {
+    _min = NAN;
+    _max = NAN;
+    _paths = [NSMutableDictionary dictionary];
+    _lock = OS_UNFAIR_LOCK_INIT;
+  }
+  return self;
+}
+
+static BOOL FlirTransferMoved(NSData *transfer, NSData *previous)
+{
+  if (transfer == nil || previous == nil) return transfer != previous;
+  const uint16_t *a = (const uint16_t *)transfer.bytes, *b = (const uint16_t *)previous.bytes;
+  for (int i = 0; i < FLIR_COLORIZER_LUT_SIZE; i++) {
+    if (abs((int)a[i] - (int)b[i]) >= FLIR_SCALE_TRANSFER_THRESHOLD) return YES;
+  }
+  return NO;
+}
+
+- (void)updateFromColorizer:(FlirColorizer *)colorizer
+{
+  float min = NAN, max = NAN;
+  NSData *lut = [colorizer currentLutWithMin:&min max:&max];
+  if (lut == nil || isnan(min) || isnan(max)) return;
+  NSData *transfer = [colorizer currentTransfer];
+
+  os_unfair_lock_lock(&_lock);
+  BOOL changed = lut != _lut || isnan(_min)
+    || fabsf(min - _min) >= FLIR_SCALE_CHANGE_THRESHOLD || fabsf(max - _max) >= FLIR_SCALE_CHANGE_THRESHOLD
+    || FlirTransferMoved(transfer, _transfer);
+  if (changed) {
+    _lut = lut;
+    _transfer = transfer;
+    _palette = colorizer.paletteName;
+    _min = min;
+    _max = max;
+    _version++;
+    [self removeImages];
+  }
+  NSDictionary *body = changed ? [self describe] : nil;
+  os_unfair_lock_unlock(&_lock);
+
+  if (body != nil) {
+    [[FlirEventEmitter shared] sendDeviceEvent:@"FlirScaleChanged" body:body];
+  }
+}
+
+- (NSDictionary *)scaleBarWithOrientation:(NSString *)orientation
+{
+  BOOL vertical = ![orientation isEqualToString:@"horizontal"];
+  NSString *key = vertical ? @"vertical" : @"horizontal";
+  os_unfair_lock_lock(&_lock);
+  if (_lut == nil) {
+    os_unfair_lock_unlock(&_lock);
+    return nil;
+  }
+  NSString *path = _paths[key];
+  if (path == nil) {
+    path = [self writeImageVertical:vertical version:_version];
+    if (path != nil) _paths[key] = path;
+  }
+  NSMutableDictionary *result = [[self describe] mutableCopy];
+  os_unfair_lock_unlock(&_lock);
+  result[@"orientation"] = key;
+  result[@"path"] = path ?: [NSNull null];
+  return result;
+}
+
+- (void)reset
+{
+  os_unfair_lock_lock(&_lock);
+  _lut = nil;
+  _transfer = nil;
+  _palette = nil;
+  _min = NAN;
+  _max = NAN;
+  [self removeImages];
+  os_unfair_lock_unlock(&_lock);
+}
+
+// Caller holds _lock
+- (void)removeImages
+{
+  for (NSString *path in _paths.allValues) {
+    [[NSFileManager defaultManager] removeItemAtPath:path error:nil];
+  }
+  [_paths removeAllObjects];
+}
+
+// Caller holds _lock
+- (NSDictionary *)describe
+{
+  return @{
+    @"palette": _palette ?: @"",
+    @"min": @(_min),
+    @"max": @(_max),
+    @"equalized": @(_transfer != nil),
+    @"version": @(_version),
+  };
+}
+
+// Caller holds _lock. Draws the LUT's in-span entries at equal temperature steps, through the
+// equalization transfer when there is one; the file is reused until the next change.
+- (NSString *)writeImageVertical:(BOOL)vertical version:(NSUInteger)version
+{
+  int width = vertical ? FLIR_SCALE_THICKNESS : FLIR_SCALE_LENGTH;
+  int height = vertical ? FLIR_SCALE_LENGTH : FLIR_SCALE_THICKNESS;
+  const uint32_t *lut = (const uint32_t *)_lut.bytes;
+  const uint16_t *transfer = (const uint16_t *)_transfer.bytes;
+  NSMutableData *pixels = [NSMutableData dataWithLength:(NSUInteger)width * height * 4];
+  uint32_t *dst = (uint32_t *)pixels.mutableBytes;
+  for (int y = 0; y < height; y++) {
+    for (int x = 0; x < width; x++) {
+      int pos = vertical ? (height - 1 - y) : x;
+      int step = pos * (FLIR_COLORIZER_LUT_SIZE - 1) / (FLIR_SCALE_LENGTH - 1);
+      dst[y * width + x] = lut[transfer != NULL ? transfer[step] : 1 + step];
+    }
+  }
+
+  CGColorSpaceRef colorSpace = CGColorSpaceCreateDeviceRGB();
+  CGContextRef context = CGBitmapContextCreate(dst, width, height, 8, (size_t)width * 4, colorSpace,
+                                               kCGImageAlphaPremultipliedFirst | kCGBitmapByteOrder32Little);
+  CGColorSpaceRelease(colorSpace);
+  if (context == NULL) return nil;
+  CGImageRef image = CGBitmapContextCreateImage(context);
+  CGContextRelease(context);
+  if (image == NULL) return nil;
+  NSData *png = UIImagePNGRepresentation([UIImage imageWithCGImage:image]);
+  CGImageRelease(image);
+
+  NSString *name = [NSString stringWithFormat:@"flir_scale_%@_%lu.png", vertical ? @"v" : @"h", (unsigned long)version];
+  NSString *path = [NSTemporaryDirectory() stringByAppendingPathComponent:name];
+  if (![png writeToFile:path atomically:YES]) return nil;
+  return path;
+}
+
+@end
@@ -1,19 +1,44 @@
 #import <Foundation/Foundation.h>
+#import <UIKit/UIKit.h>
+
+@class FLIRThermalImage;
 
 NS_ASSUME_NONNULL_BEGIN
 
 @interface FlirState : NSObject
 
-@property (nonatomic, assign) double lastTemperature;
+// Written on the stream queue, read from the JS and main threads
+@property (atomic, assign) double lastTemperature;
 @property (nonatomic, copy, nullable) void (^onTemperatureUpdate)(double temperature, int x, int y);
 @property (nonatomic, copy, nullable) void (^onTextureUpdate)(UIImage *_Nonnull image, int textureUnit);
 @property (nonatomic, strong, nullable) UIImage *latestImage;
+// Visible part of the sensor frame while zoomed, CGRectNull for the whole frame; the center
+// sample follows its center
+@property (atomic, assign) CGRect visibleRect;
 
 + (instancetype)shared;
 - (double)getTemperatureAt:(int)x y:(int)y;
 - (void)updateFrame:(UIImage *_Nonnull)image;
-- (void)updateFrame:(UIImage *_Nonnull)image withTemperatureData:(NSArray<NSNumber *> *_Nullable)tempData;
+- (void)updateFrame:(UIImage *_Nonnull)image withThermalImage:(FLIRThermalImage *_Nullable)thermalImage;
 - (double)queryTemperatureAtPoint:(int)x y:(int)y;
+// Bilinear sample at a sub-pixel sensor position; NaN outside the frame or before the first frame
+- (double)sampleTemperatureAtX:(float)x y:(float)y;
+
+// Copies a row-major Celsius plane into the back buffer and publishes it.
+- (void)updateTemperaturePlane:(const float *)values width:(int)width height:(int)height;
+
+// Runs the block against the current plane; the plane cannot be swapped while the block runs.
+// Returns NO when no frame has been published yet.
+- (BOOL)readTemperaturePlane:(void (NS_NOESCAPE ^)(const float *plane, int width, int height))block;
+// Same for the stream queue, which alone fills and swaps the planes: the front plane cannot
+// change under it, so the block runs without the lock and long passes do not stall readers.
+- (BOOL)readPublishedTemperaturePlane:(void (NS_NOESCAPE ^)(const float *plane, int width, int height))block;
+
+// Batch queries against the current plane. Samples outside the frame are NSNull.
+// All return nil when no frame has been published yet.
+- (nullable NSArray *)temperaturesAtPoints:(NSArray *)points;
+- (nullable NSDictionary *)temperaturesInRect:(CGRect)rect;
+- (nullable NSArray *)lineProfileFrom:(CGPoint)start to:(CGPoint)end samples:(NSInteger)samples;
 
 @end
 
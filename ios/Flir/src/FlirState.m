@@ -1,11 +1,19 @@
 #import "FlirState.h"
+#import "FlirEventEmitter.h"
+#import "FlirRegionStatistics.h"
+#import <ThermalSDK/ThermalSDK.h>
+#import <os/lock.h>
 
 static FlirState *_sharedState = nil;
 
 @implementation FlirState {
-    NSArray<NSNumber *> *_temperatureData; // Flattened array of temperature values
+    // Double-buffered row-major Celsius planes; readers only touch the front one under _planeLock
+    NSMutableData *_planes[2];
+    int _frontIndex;
     int _imageWidth;
     int _imageHeight;
+    BOOL _hasPlane;
+    os_unfair_lock _planeLock;
 }
 
 + (instancetype)shared
@@ -15,65 +23,280 @@ static FlirState *_sharedState = nil;
     _sharedState = [FlirState new];
     _sharedState.lastTemperature = NAN;
     _sharedState.latestImage = nil;
-    _sharedState->_temperatureData = nil;
+    _sharedState.visibleRect = CGRectNull;
+    _sharedState->_planes[0] = [NSMutableData data];
+    _sharedState->_planes[1] = [NSMutableData data];
+    _sharedState->_frontIndex = 0;
     _sharedState->_imageWidth = 0;
     _sharedState->_imageHeight = 0;
+    _sharedState->_hasPlane = NO;
+    _sharedState->_planeLock = OS_UNFAIR_LOCK_INIT;
   });
   return _sharedState;
 }
 
 - (double)getTemperatureAt:(int)x y:(int)y
 {
-  // Return cached temperature (will be updated by thermal SDK callbacks)
-  // In production, this would query the actual thermal image data at (x,y)
-  return self.lastTemperature;
+  double t = [self queryTemperatureAtPoint:x y:y];
+  return isnan(t) ? self.lastTemperature : t;
 }
 
 - (void)updateFrame:(UIImage *)image
 {
-  [self updateFrame:image withTemperatureData:nil];
+  [self updateFrame:image withThermalImage:nil];
 }
 
-- (void)updateFrame:(UIImage *)image withTemperatureData:(NSArray<NSNumber *> *)tempData
+- (void)updateFrame:(UIImage *)image withThermalImage:(FLIRThermalImage *)thermalImage
 {
   self.latestImage = image;
-  
-  if (tempData != nil) {
-    _temperatureData = tempData;
-    _imageWidth = (int)image.size.width;
-    _imageHeight = (int)image.size.height;
+
+  if (thermalImage != nil) {
+    [self captureTemperaturePlane:thermalImage];
+    [self emitRegionStatistics:thermalImage];
   }
-  
+
   // Invoke texture callback for native Metal filters (texture unit 7)
   if (self.onTextureUpdate) {
     self.onTextureUpdate(image, 7);
   }
-  
-  // Sample temperature at center point and invoke callback
+
+  // Sample temperature at the center of the visible area of whatever resolution the sensor delivers
+  __block int cx = 80, cy = 60;
+  __block double center = NAN;
+  CGRect visible = self.visibleRect;
+  [self readTemperaturePlane:^(const float *plane, int width, int height) {
+    cx = width / 2;
+    cy = height / 2;
+    if (!CGRectIsNull(visible)) {
+      cx = MIN(width - 1, (int)CGRectGetMidX(visible));
+      cy = MIN(height - 1, (int)CGRectGetMidY(visible));
+    }
+    center = plane[(NSInteger)cy * width + cx];
+  }];
+  if (!isnan(center)) {
+    self.lastTemperature = center;
+  }
   if (self.onTemperatureUpdate) {
-    double temp = [self getTemperatureAt:80 y:60];
-    self.onTemperatureUpdate(temp, 80, 60);
+    self.onTemperatureUpdate(self.lastTemperature, cx, cy);
+  }
+}
+
+- (void)emitRegionStatistics:(FLIRThermalImage *)thermalImage
+{
+  __block NSArray<NSDictionary *> *regions = nil;
+  __block int width = 0, height = 0;
+  // Stream queue: reduced in place, without holding the lock against other readers
+  [self readPublishedTemperaturePlane:^(const float *plane, int w, int h) {
+    regions = [[FlirRegionStatistics shared] computeWithPlane:plane width:w height:h thermalImage:thermalImage];
+    width = w;
+    height = h;
+  }];
+  if (regions == nil) return;
+  [[FlirEventEmitter shared] sendDeviceEvent:@"FlirRegionStats" body:@{
+    @"timestamp": @([[NSDate date] timeIntervalSince1970]),
+    @"width": @(width),
+    @"height": @(height),
+    @"regions": regions
+  }];
+}
+
+- (void)captureTemperaturePlane:(FLIRThermalImage *)thermalImage
+{
+  int width = [thermalImage getWidth];
+  int height = [thermalImage getHeight];
+  if (width <= 0 || height <= 0) return;
+
+  if ([thermalImage getTemperatureUnit] != CELSIUS) {
+    [thermalImage setTemperatureUnit:CELSIUS];
+  }
+
+  // Bulk read of the whole frame; unboxed once into the back plane and then released
+  NSError *error = nil;
+  NSArray<NSNumber *> *values = [thermalImage getValuesFromRectangle:CGRectMake(0, 0, width, height) error:&error];
+  NSUInteger count = (NSUInteger)width * (NSUInteger)height;
+  if (values == nil || values.count < count) return;
+
+  NSMutableData *back = [self backPlaneForCount:count];
+  float *dst = (float *)back.mutableBytes;
+  NSUInteger i = 0;
+  for (NSNumber *value in values) {
+    if (i == count) break;
+    dst[i++] = value.floatValue;
+  }
+  [self publishBackPlaneWidth:width height:height];
+}
+
+- (void)updateTemperaturePlane:(const float *)values width:(int)width height:(int)height
+{
+  if (values == NULL || width <= 0 || height <= 0) return;
+  NSUInteger count = (NSUInteger)width * (NSUInteger)height;
+  NSMutableData *back = [self backPlaneForCount:count];
+  memcpy(back.mutableBytes, values, count * sizeof(float));
+  [self publishBackPlaneWidth:width height:height];
+}
+
+// Only the streaming queue writes, so the back plane is never visible to readers while filled.
+- (NSMutableData *)backPlaneForCount:(NSUInteger)count
+{
+  NSMutableData *back = _planes[1 - _frontIndex];
+  if (back.length != count * sizeof(float)) {
+    back.length = count * sizeof(float);
   }
+  return back;
+}
+
+- (void)publishBackPlaneWidth:(int)width height:(int)height
+{
+  os_unfair_lock_lock(&_planeLock);
+  _frontIndex = 1 - _frontIndex;
+  _imageWidth = width;
+  _imageHeight = height;
+  _hasPlane = YES;
+  os_unfair_lock_unlock(&_planeLock);
+}
+
+- (BOOL)readTemperaturePlane:(void (NS_NOESCAPE ^)(const float *, int, int))block
+{
+  os_unfair_lock_lock(&_planeLock);
+  BOOL hasPlane = _hasPlane;
+  if (hasPlane) {
+    block((const float *)_planes[_frontIndex].bytes, _imageWidth, _imageHeight);
+  }
+  os_unfair_lock_unlock(&_planeLock);
+  return hasPlane;
+}
+
+- (BOOL)readPublishedTemperaturePlane:(void (NS_NOESCAPE ^)(const float *, int, int))block
+{
+  if (!_hasPlane) return NO;
+  block((const float *)_planes[_frontIndex].bytes, _imageWidth, _imageHeight);
+  return YES;
 }
 
 - (double)queryTemperatureAtPoint:(int)x y:(int)y
 {
-  if (_temperatureData == nil || _imageWidth == 0 || _imageHeight == 0) {
-    return NAN;
+  __block double result = NAN;
+  [self readTemperaturePlane:^(const float *plane, int width, int height) {
+    if (x >= 0 && x < width && y >= 0 && y < height) {
+      result = plane[(NSInteger)y * width + x];
+    }
+  }];
+  return result;
+}
+
+#pragma mark - Batch queries
+
+static inline id FlirBoxedTemperature(float value)
+{
+  return isnan(value) ? (id)[NSNull null] : @(value);
+}
+
+static float FlirSamplePlane(const float *plane, int width, int height, float x, float y)
+{
+  if (x < 0 || y < 0 || x > width - 1 || y > height - 1) return NAN;
+  int ix = MIN((int)x, MAX(0, width - 2));
+  int iy = MIN((int)y, MAX(0, height - 2));
+  float fx = x - ix;
+  float fy = y - iy;
+  NSInteger i = (NSInteger)iy * width + ix;
+  NSInteger right = ix + 1 < width ? 1 : 0;
+  NSInteger down = iy + 1 < height ? width : 0;
+  float top = plane[i] + (plane[i + right] - plane[i]) * fx;
+  float bottom = plane[i + down] + (plane[i + down + right] - plane[i + down]) * fx;
+  return top + (bottom - top) * fy;
+}
+
+// Accepts [{x, y}, ...] or a flat [x0, y0, x1, y1, ...]
+- (NSArray *)temperaturesAtPoints:(NSArray *)points
+{
+  BOOL isDictionaries = points.count > 0 && [points.firstObject isKindOfClass:[NSDictionary class]];
+  NSUInteger count = isDictionaries ? points.count : points.count / 2;
+  // Coordinates are unboxed before and values boxed after the lock, as in temperaturesInRect
+  NSMutableData *coordinates = [NSMutableData dataWithLength:count * 2 * sizeof(int)];
+  int *xy = (int *)coordinates.mutableBytes;
+  for (NSUInteger i = 0; i < count; i++) {
+    if (isDictionaries) {
+      NSDictionary *point = points[i];
+      xy[2 * i] = [point[@"x"] intValue];
+      xy[2 * i + 1] = [point[@"y"] intValue];
+    } else {
+      xy[2 * i] = [points[2 * i] intValue];
+      xy[2 * i + 1] = [points[2 * i + 1] intValue];
+    }
   }
-  
-  // Bounds check
-  if (x < 0 || x >= _imageWidth || y < 0 || y >= _imageHeight) {
-    return NAN;
+  NSMutableData *samples = [NSMutableData dataWithLength:count * sizeof(float)];
+  float *values = (float *)samples.mutableBytes;
+  BOOL hasPlane = [self readTemperaturePlane:^(const float *plane, int width, int height) {
+    for (NSUInteger i = 0; i < count; i++) {
+      int x = xy[2 * i], y = xy[2 * i + 1];
+      values[i] = (x >= 0 && x < width && y >= 0 && y < height) ? plane[(NSInteger)y * width + x] : NAN;
+    }
+  }];
+  if (!hasPlane) return nil;
+
+  NSMutableArray *result = [NSMutableArray arrayWithCapacity:count];
+  for (NSUInteger i = 0; i < count; i++) {
+    [result addObject:FlirBoxedTemperature(values[i])];
   }
-  
-  // Access flattened array: index = y * width + x
-  NSInteger index = y * _imageWidth + x;
-  if (index < 0 || index >= (NSInteger)[_temperatureData count]) {
-    return NAN;
+  return result;
+}
+
+- (NSDictionary *)temperaturesInRect:(CGRect)rect
+{
+  // Copy the rows out under the lock and box afterwards, so publishing is never held up
+  __block int x0 = 0, y0 = 0, w = 0, h = 0;
+  NSMutableData *copy = [NSMutableData data];
+  BOOL hasPlane = [self readTemperaturePlane:^(const float *plane, int width, int height) {
+    x0 = MAX(0, (int)CGRectGetMinX(rect));
+    y0 = MAX(0, (int)CGRectGetMinY(rect));
+    w = MAX(0, MIN(width, (int)CGRectGetMaxX(rect)) - x0);
+    h = MAX(0, MIN(height, (int)CGRectGetMaxY(rect)) - y0);
+    copy.length = (NSUInteger)w * h * sizeof(float);
+    float *dst = (float *)copy.mutableBytes;
+    for (int row = 0; row < h; row++) {
+      memcpy(dst + (NSInteger)row * w, plane + (NSInteger)(y0 + row) * width + x0, (size_t)w * sizeof(float));
+    }
+  }];
+  if (!hasPlane) return nil;
+
+  const float *src = (const float *)copy.bytes;
+  NSUInteger count = (NSUInteger)w * h;
+  NSMutableArray *values = [NSMutableArray arrayWithCapacity:count];
+  for (NSUInteger i = 0; i < count; i++) {
+    [values addObject:FlirBoxedTemperature(src[i])];
   }
-  
-  return [_temperatureData[index] doubleValue];
+  return @{ @"x": @(x0), @"y": @(y0), @"width": @(w), @"height": @(h), @"values": values };
+}
+
+- (NSArray *)lineProfileFrom:(CGPoint)start to:(CGPoint)end samples:(NSInteger)samples
+{
+  NSUInteger count = (NSUInteger)MAX(0, samples);
+  NSMutableData *samplesData = [NSMutableData dataWithLength:count * sizeof(float)];
+  float *values = (float *)samplesData.mutableBytes;
+  BOOL hasPlane = [self readTemperaturePlane:^(const float *plane, int width, int height) {
+    for (NSUInteger i = 0; i < count; i++) {
+      float t = count == 1 ? 0.f : (float)i / (float)(count - 1);
+      float x = start.x + (end.x - start.x) * t;
+      float y = start.y + (end.y - start.y) * t;
+      values[i] = FlirSamplePlane(plane, width, height, x, y);
+    }
+  }];
+  if (!hasPlane) return nil;
+
+  NSMutableArray *result = [NSMutableArray arrayWithCapacity:count];
+  for (NSUInteger i = 0; i < count; i++) {
+    [result addObject:FlirBoxedTemperature(values[i])];
+  }
+  return result;
+}
+
+- (double)sampleTemperatureAtX:(float)x y:(float)y
+{
+  __block double result = NAN;
+  [self readTemperaturePlane:^(const float *plane, int width, int height) {
+    result = FlirSamplePlane(plane, width, height, x, y);
+  }];
+  return result;
 }
 
 @end
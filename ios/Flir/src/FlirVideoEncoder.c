@@ -0,0 +1,235 @@
+#include "FlirVideoEncoder.h"
+
+#include <libavcodec/avcodec.h>
+#include <libavformat/avformat.h>
+#include <libavutil/error.h>
+#include <libavutil/opt.h>
+#include <libswscale/swscale.h>
+#include <stdio.h>
+#include <string.h>
+
+// Encoder time base; the muxer rescales to the stream's own
+#define FLIR_VIDEO_TIME_BASE 1000000
+
+struct FlirVideoEncoder {
+  AVFormatContext *format;
+  AVCodecContext *codec;
+  AVStream *stream;
+  AVFrame *frame;
+  AVPacket *packet;
+  struct SwsContext *sws;
+  FlirPixelLayout swsLayout;
+  int swsWidth;
+  int swsHeight;
+  int width;
+  int height;
+  int64_t firstTimestamp;
+  int64_t lastPts;
+  int headerWritten;
+};
+
+static void flir_set_error(char *error, size_t errorSize, const char *message, int code)
+{
+  if (error == NULL || errorSize == 0) return;
+  if (code < 0) {
+    char reason[AV_ERROR_MAX_STRING_SIZE] = {0};
+    av_strerror(code, reason, sizeof(reason));
+    snprintf(error, errorSize, "%s: %s", message, reason);
+  } else {
+    snprintf(error, errorSize, "%s", message);
+  }
+}
+
+static const AVCodec *flir_find_encoder(const char *codec)
+{
+  int hevc = codec != NULL && strcmp(codec, "hevc") == 0;
+  const char *names[] = {
+    hevc ? "hevc_videotoolbox" : "h264_videotoolbox",
+    hevc ? "libx265" : "libx264",
+  };
+  for (size_t i = 0; i < sizeof(names) / sizeof(names[0]); i++) {
+    const AVCodec *found = avcodec_find_encoder_by_name(names[i]);
+    if (found != NULL) return found;
+  }
+  return avcodec_find_encoder(hevc ? AV_CODEC_ID_HEVC : AV_CODEC_ID_H264);
+}
+
+// Sends a frame (NULL to drain) and writes every packet the encoder hands back
+static int flir_encode(FlirVideoEncoder *encoder, AVFrame *frame)
+{
+  int result = avcodec_send_frame(encoder->codec, frame);
+  if (result < 0) return result;
+  for (;;) {
+    result = avcodec_receive_packet(encoder->codec, encoder->packet);
+    if (result == AVERROR(EAGAIN) || result == AVERROR_EOF) return 0;
+    if (result < 0) return result;
+    av_packet_rescale_ts(encoder->packet, encoder->codec->time_base, encoder->stream->time_base);
+    encoder->packet->stream_index = encoder->stream->index;
+    result = av_interleaved_write_frame(encoder->format, encoder->packet);
+    av_packet_unref(encoder->packet);
+    if (result < 0) return result;
+  }
+}
+
+static void flir_free(FlirVideoEncoder *encoder)
+{
+  if (encoder->format != NULL && !(encoder->format->oformat->flags & AVFMT_NOFILE)) {
+    avio_closep(&encoder->format->pb);
+  }
+  avformat_free_context(encoder->format);
+  avcodec_free_context(&encoder->codec);
+  av_frame_free(&encoder->frame);
+  av_packet_free(&encoder->packet);
+  sws_freeContext(encoder->sws);
+  av_free(encoder);
+}
+
+FlirVideoEncoder *flir_video_encoder_open(const char *path, const char *codec, int width, int height,
+                                          int fps, int64_t bitRate, char *error, size_t errorSize)
+{
+  width &= ~1;
+  height &= ~1;
+  if (width <= 0 || height <= 0) {
+    flir_set_error(error, errorSize, "Frame too small to encode", 0);
+    return NULL;
+  }
+  const AVCodec *encoderCodec = flir_find_encoder(codec);
+  if (encoderCodec == NULL) {
+    flir_set_error(error, errorSize, "No encoder available for the codec", 0);
+    return NULL;
+  }
+  if (fps <= 0) fps = 9;
+
+  FlirVideoEncoder *encoder = av_mallocz(sizeof(FlirVideoEncoder));
+  if (encoder == NULL) {
+    flir_set_error(error, errorSize, "Out of memory", 0);
+    return NULL;
+  }
+  encoder->width = width;
+  encoder->height = height;
+  encoder->firstTimestamp = -1;
+  encoder->lastPts = -1;
+
+  int result = avformat_alloc_output_context2(&encoder->format, NULL, "mp4", path);
+  if (result < 0) {
+    flir_set_error(error, errorSize, "Cannot create the MP4 muxer", result);
+    flir_free(encoder);
+    return NULL;
+  }
+  encoder->stream = avformat_new_stream(encoder->format, NULL);
+  encoder->codec = avcodec_alloc_context3(encoderCodec);
+  encoder->frame = av_frame_alloc();
+  encoder->packet = av_packet_alloc();
+  if (encoder->stream == NULL || encoder->codec == NULL || encoder->frame == NULL || encoder->packet == NULL) {
+    flir_set_error(error, errorSize, "Out of memory", 0);
+    flir_free(encoder);
+    return NULL;
+  }
+
+  AVCodecContext *ctx = encoder->codec;
+  ctx->width = width;
+  ctx->height = height;
+  ctx->pix_fmt = AV_PIX_FMT_YUV420P;
+  ctx->time_base = (AVRational){1, FLIR_VIDEO_TIME_BASE};
+  ctx->framerate = (AVRational){fps, 1};
+  ctx->gop_size = fps * 2;
+  // No reordering: packets leave in capture order with pts == dts
+  ctx->max_b_frames = 0;
+  ctx->bit_rate = bitRate > 0 ? bitRate : FFMAX(250000, (int64_t)width * height * fps / 4);
+  if (encoder->format->oformat->flags & AVFMT_GLOBALHEADER) ctx->flags |= AV_CODEC_FLAG_GLOBAL_HEADER;
+  if (strcmp(encoderCodec->name, "libx264") == 0 || strcmp(encoderCodec->name, "libx265") == 0) {
+    av_opt_set(ctx->priv_data, "preset", "veryfast", 0);
+    av_opt_set(ctx->priv_data, "tune", "zerolatency", 0);
+  }
+
+  result = avcodec_open2(ctx, encoderCodec, NULL);
+  if (result < 0) {
+    flir_set_error(error, errorSize, "Cannot open the encoder", result);
+    flir_free(encoder);
+    return NULL;
+  }
+  avcodec_parameters_from_context(encoder->stream->codecpar, ctx);
+  encoder->stream->time_base = ctx->time_base;
+
+  encoder->frame->format = ctx->pix_fmt;
+  encoder->frame->width = width;
+  encoder->frame->height = height;
+  result = av_frame_get_buffer(encoder->frame, 0);
+  if (result >= 0 && !(encoder->format->oformat->flags & AVFMT_NOFILE)) {
+    result = avio_open(&encoder->format->pb, path, AVIO_FLAG_WRITE);
+  }
+  if (result >= 0) result = avformat_write_header(encoder->format, NULL);
+  if (result < 0) {
+    flir_set_error(error, errorSize, "Cannot start the MP4 file", result);
+    flir_free(encoder);
+    return NULL;
+  }
+  encoder->headerWritten = 1;
+  return encoder;
+}
+
+int flir_video_encoder_write(FlirVideoEncoder *encoder, const uint8_t *pixels, int width, int height,
+                             int bytesPerRow, FlirPixelLayout layout, int64_t timestampNanos)
+{
+  // The opened size only differs from the frame by the odd column/row cropped for 4:2:0
+  if ((width & ~1) == encoder->width && (height & ~1) == encoder->height) {
+    width = encoder->width;
+    height = encoder->height;
+  }
+  if (width <= 0 || height <= 0) return AVERROR(EINVAL);
+  if (encoder->sws == NULL || encoder->swsLayout != layout || encoder->swsWidth != width || encoder->swsHeight != height) {
+    enum AVPixelFormat source = layout == FLIR_PIXELS_BGRA ? AV_PIX_FMT_BGRA : AV_PIX_FMT_RGBA;
+    encoder->sws = sws_getCachedContext(encoder->sws, width, height, source,
+                                        encoder->width, encoder->height, AV_PIX_FMT_YUV420P,
+                                        SWS_BILINEAR, NULL, NULL, NULL);
+    if (encoder->sws == NULL) return AVERROR(EINVAL);
+    encoder->swsLayout = layout;
+    encoder->swsWidth = width;
+    encoder->swsHeight = height;
+  }
+  int result = av_frame_make_writable(encoder->frame);
+  if (result < 0) return result;
+  const uint8_t *const source[1] = {pixels};
+  const int sourceStride[1] = {bytesPerRow};
+  sws_scale(encoder->sws, source, sourceStride, 0, height, encoder->frame->data, encoder->frame->linesize);
+
+  if (encoder->firstTimestamp < 0) encoder->firstTimestamp = timestampNanos;
+  int64_t pts = (timestampNanos - encoder->firstTimestamp) / (1000000000 / FLIR_VIDEO_TIME_BASE);
+  // Coalesced or clock-skewed frames still need strictly increasing pts
+  if (pts <= encoder->lastPts) pts = encoder->lastPts + 1;
+  encoder->lastPts = pts;
+  encoder->frame->pts = pts;
+  return flir_encode(encoder, encoder->frame);
+}
+
+int flir_video_encoder_close(FlirVideoEncoder *encoder)
+{
+  if (encoder == NULL) return 0;
+  int result = flir_encode(encoder, NULL);
+  if (encoder->headerWritten) {
+    int trailer = av_write_trailer(encoder->format);
+    if (result >= 0) result = trailer;
+  }
+  flir_free(encoder);
+  return result;
+}
+
+const char *flir_video_encoder_codec_name(const FlirVideoEncoder *encoder)
+{
+  return encoder->codec->codec->name;
+}
+
+int flir_video_encoder_width(const FlirVideoEncoder *encoder)
+{
+  return encoder->width;
+}
+
+int flir_video_encoder_height(const FlirVideoEncoder *encoder)
+{
+  return encoder->height;
+}
+
+int64_t flir_video_encoder_bytes_written(const FlirVideoEncoder *encoder)
+{
+  return encoder->format->pb != NULL ? avio_tell(encoder->format->pb) : 0;
+}
@@ -0,0 +1,44 @@
+#ifndef FLIR_VIDEO_ENCODER_H
+#define FLIR_VIDEO_ENCODER_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Plain C over libavcodec/libavformat/libswscale so the same encoder builds for the pod and on
+// Linux (scripts/bench_video_encoder.sh). Not thread-safe: one thread drives an encoder.
+typedef struct FlirVideoEncoder FlirVideoEncoder;
+
+typedef enum {
+  FLIR_PIXELS_RGBA = 0,
+  FLIR_PIXELS_BGRA = 1,
+} FlirPixelLayout;
+
+// codec is "h264" or "hevc"; the hardware encoder is preferred, then libx264/libx265, then any
+// encoder for the codec id. Odd sizes are cropped to even for 4:2:0. bitRate 0 picks one from
+// the frame size and fps. Returns NULL with a message in error on failure.
+FlirVideoEncoder *flir_video_encoder_open(const char *path, const char *codec, int width, int height,
+                                          int fps, int64_t bitRate, char *error, size_t errorSize);
+
+// Converts one width x height frame to YUV420P at the opened size and encodes it; frames of
+// another size (zoom, a resized preview) are scaled to it. Timestamps are monotonic nanoseconds
+// from the stream and are made relative to the first frame. Returns 0 or a negative AVERROR.
+int flir_video_encoder_write(FlirVideoEncoder *encoder, const uint8_t *pixels, int width, int height,
+                             int bytesPerRow, FlirPixelLayout layout, int64_t timestampNanos);
+
+// Drains the encoder, writes the MP4 trailer and frees the encoder. Returns 0 or a negative AVERROR.
+int flir_video_encoder_close(FlirVideoEncoder *encoder);
+
+const char *flir_video_encoder_codec_name(const FlirVideoEncoder *encoder);
+int flir_video_encoder_width(const FlirVideoEncoder *encoder);
+int flir_video_encoder_height(const FlirVideoEncoder *encoder);
+int64_t flir_video_encoder_bytes_written(const FlirVideoEncoder *encoder);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
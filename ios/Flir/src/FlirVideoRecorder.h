@@ -0,0 +1,29 @@
+#import <Foundation/Foundation.h>
+#import <CoreVideo/CoreVideo.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+// Encodes the colorized preview frames to an MP4 (H.264 or HEVC) on a serial worker queue.
+// Frames are copied into a small pool of buffers; when every buffer is waiting to be encoded
+// the new frame is dropped, so a slow encoder never stalls the stream queue.
+@interface FlirVideoRecorder : NSObject
+
+@property (nonatomic, readonly) NSString *path;
+
+// codec is "h264" or "hevc"; bitRate 0 picks one from the frame size and fps.
+- (instancetype)initWithPath:(NSString *)path codec:(NSString *)codec fps:(int)fps bitRate:(int64_t)bitRate;
+
+// Stream queue only. Copies a 32BGRA buffer and queues it; returns NO when the frame was dropped.
+// The encoder is opened with the size of the first frame; frames of another size are scaled to it.
+- (BOOL)appendPixelBuffer:(CVPixelBufferRef)buffer timestampNanos:(uint64_t)timestampNanos;
+
+// Encodes the queued frames, finalizes the file and calls back with stats on the worker queue.
+- (void)finishWithCompletion:(void (^)(NSDictionary *stats, NSError *_Nullable error))completion;
+
+// { path, codec, width, height, framesEncoded, framesScaled, framesDropped, queueDepth, avgEncodeMs,
+//   bytesWritten }
+- (NSDictionary *)stats;
+
+@end
+
+NS_ASSUME_NONNULL_END
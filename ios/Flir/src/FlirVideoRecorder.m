@@ -0,0 +1,171 @@
+#import "FlirVideoRecorder.h"
+#import "FlirVideoEncoder.h"
+#import <os/lock.h>
+
+// Frames copied and waiting for the encoder; beyond this new frames are dropped
+#define FLIR_VIDEO_QUEUE_DEPTH 3
+#define FLIR_VIDEO_EWMA_WEIGHT 0.1
+
+@implementation FlirVideoRecorder {
+    NSString *_codec;
+    int _fps;
+    int64_t _bitRate;
+    dispatch_queue_t _encodeQueue;
+    os_unfair_lock _lock;
+    // Guarded by _lock
+    NSMutableArray<NSMutableData *> *_freeBuffers;
+    int _width;
+    int _height;
+    int _queueDepth;
+    BOOL _finished;
+    NSError *_error;
+    uint64_t _framesEncoded;
+    uint64_t _framesScaled;
+    uint64_t _framesDropped;
+    double _avgEncodeMs;
+    int64_t _bytesWritten;
+    NSString *_encoderName;
+    // Encode queue only
+    FlirVideoEncoder *_encoder;
+}
+
+- (instancetype)initWithPath:(NSString *)path codec:(NSString *)codec fps:(int)fps bitRate:(int64_t)bitRate
+{
+  if (self = [super init]) {
+    _path = [path copy];
+    _codec = [codec isEqualToString:@"hevc"] ? @"hevc" : @"h264";
+    _fps = fps > 0 ? fps : 9;
+    _bitRate = bitRate;
+    _encodeQueue = dispatch_queue_create("flir.video", DISPATCH_QUEUE_SERIAL);
+    _lock = OS_UNFAIR_LOCK_INIT;
+    _freeBuffers = [NSMutableArray array];
+    _encoderName = @"";
+  }
+  return self;
+}
+
+- (BOOL)appendPixelBuffer:(CVPixelBufferRef)buffer timestampNanos:(uint64_t)timestampNanos
+{
+  int width = (int)CVPixelBufferGetWidth(buffer);
+  int height = (int)CVPixelBufferGetHeight(buffer);
+  os_unfair_lock_lock(&_lock);
+  if (_finished || _error != nil) {
+    os_unfair_lock_unlock(&_lock);
+    return NO;
+  }
+  if (_width == 0) {
+    _width = width;
+    _height = height;
+  }
+  if (_queueDepth >= FLIR_VIDEO_QUEUE_DEPTH) {
+    _framesDropped++;
+    os_unfair_lock_unlock(&_lock);
+    return NO;
+  }
+  NSMutableData *frame = _freeBuffers.lastObject;
+  if (frame != nil) [_freeBuffers removeLastObject];
+  _queueDepth++;
+  os_unfair_lock_unlock(&_lock);
+
+  size_t rowBytes = (size_t)width * 4;
+  if (frame == nil) frame = [NSMutableData data];
+  // Pooled buffers follow the frame size; a zoomed or resized preview is scaled by the encoder
+  if (frame.length < rowBytes * height) frame.length = rowBytes * height;
+  CVPixelBufferLockBaseAddress(buffer, kCVPixelBufferLock_ReadOnly);
+  const uint8_t *src = (const uint8_t *)CVPixelBufferGetBaseAddress(buffer);
+  size_t srcStride = CVPixelBufferGetBytesPerRow(buffer);
+  uint8_t *dst = (uint8_t *)frame.mutableBytes;
+  for (int row = 0; row < height; row++) {
+    memcpy(dst + row * rowBytes, src + row * srcStride, rowBytes);
+  }
+  CVPixelBufferUnlockBaseAddress(buffer, kCVPixelBufferLock_ReadOnly);
+
+  dispatch_async(_encodeQueue, ^{
+    [self encodeFrame:frame width:width height:height timestampNanos:timestampNanos];
+  });
+  return YES;
+}
+
+- (void)encodeFrame:(NSMutableData *)frame width:(int)width height:(int)height timestampNanos:(uint64_t)timestampNanos
+{
+  NSError *error = nil;
+  uint64_t start = clock_gettime_nsec_np(CLOCK_UPTIME_RAW);
+  if (_encoder == NULL) {
+    char message[256] = {0};
+    _encoder = flir_video_encoder_open(_path.fileSystemRepresentation, _codec.UTF8String, _width, _height,
+                                       _fps, _bitRate, message, sizeof(message));
+    if (_encoder == NULL) {
+      error = [NSError errorWithDomain:@"FlirVideoRecorder" code:1
+                              userInfo:@{NSLocalizedDescriptionKey: [NSString stringWithUTF8String:message]}];
+    }
+  }
+  int result = 0;
+  if (_encoder != NULL) {
+    result = flir_video_encoder_write(_encoder, frame.bytes, width, height, width * 4, FLIR_PIXELS_BGRA,
+                                      (int64_t)timestampNanos);
+    if (result < 0) {
+      error = [NSError errorWithDomain:@"FlirVideoRecorder" code:result
+                              userInfo:@{NSLocalizedDescriptionKey: @"Frame encoding failed"}];
+    }
+  }
+  double ms = (clock_gettime_nsec_np(CLOCK_UPTIME_RAW) - start) / 1e6;
+
+  os_unfair_lock_lock(&_lock);
+  [_freeBuffers addObject:frame];
+  _queueDepth--;
+  if (error != nil) {
+    if (_error == nil) _error = error;
+  } else {
+    _avgEncodeMs = _framesEncoded == 0 ? ms : _avgEncodeMs + FLIR_VIDEO_EWMA_WEIGHT * (ms - _avgEncodeMs);
+    _framesEncoded++;
+    if ((width & ~1) != (_width & ~1) || (height & ~1) != (_height & ~1)) _framesScaled++;
+    _bytesWritten = flir_video_encoder_bytes_written(_encoder);
+    _encoderName = [NSString stringWithUTF8String:flir_video_encoder_codec_name(_encoder)];
+  }
+  os_unfair_lock_unlock(&_lock);
+}
+
+- (void)finishWithCompletion:(void (^)(NSDictionary *stats, NSError *error))completion
+{
+  os_unfair_lock_lock(&_lock);
+  _finished = YES;
+  os_unfair_lock_unlock(&_lock);
+  dispatch_async(_encodeQueue, ^{
+    NSError *closeError = nil;
+    if (self->_encoder != NULL) {
+      int result = flir_video_encoder_close(self->_encoder);
+      self->_encoder = NULL;
+      if (result < 0) {
+        closeError = [NSError errorWithDomain:@"FlirVideoRecorder" code:result
+                                     userInfo:@{NSLocalizedDescriptionKey: @"Finalizing the MP4 failed"}];
+      }
+    }
+    NSNumber *size = [[NSFileManager defaultManager] attributesOfItemAtPath:self.path error:nil][NSFileSize];
+    os_unfair_lock_lock(&self->_lock);
+    if (size != nil) self->_bytesWritten = size.longLongValue;
+    NSError *error = self->_error ?: closeError;
+    os_unfair_lock_unlock(&self->_lock);
+    completion([self stats], error);
+  });
+}
+
+- (NSDictionary *)stats
+{
+  os_unfair_lock_lock(&_lock);
+  NSDictionary *stats = @{
+    @"path": _path,
+    @"codec": _encoderName,
+    @"width": @(_width & ~1),
+    @"height": @(_height & ~1),
+    @"framesEncoded": @(_framesEncoded),
+    @"framesScaled": @(_framesScaled),
+    @"framesDropped": @(_framesDropped),
+    @"queueDepth": @(_queueDepth),
+    @"avgEncodeMs": @(_avgEncodeMs),
+    @"bytesWritten": @(_bytesWritten)
+  };
+  os_unfair_lock_unlock(&_lock);
+  return stats;
+}
+
+@end
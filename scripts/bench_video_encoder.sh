@@ -0,0 +1,22 @@
+#!/bin/bash
+set -euo pipefail
+
+# Builds the iOS video encoder core against the system FFmpeg (e.g. libavcodec-dev,
+# libavformat-dev, libswscale-dev with libx264) and encodes synthetic frames with it.
+# Usage: scripts/bench_video_encoder.sh [width] [height] [frames] [h264|hevc]
+
+ROOT="$(cd "$(dirname "$0")/.." && pwd)"
+OUT_DIR="${TMPDIR:-/tmp}/flir_video_bench"
+mkdir -p "$OUT_DIR"
+
+if ! pkg-config --exists libavformat libavcodec libswscale libavutil; then
+  echo "FFmpeg development packages not found (libavformat, libavcodec, libswscale, libavutil built with libx264)" >&2
+  exit 1
+fi
+
+cc -O2 -std=c11 -D_POSIX_C_SOURCE=200809L -I"$ROOT/ios/Flir/src" \
+  "$ROOT/scripts/video_encoder_bench.c" "$ROOT/ios/Flir/src/FlirVideoEncoder.c" \
+  $(pkg-config --cflags --libs libavformat libavcodec libswscale libavutil) \
+  -o "$OUT_DIR/video_encoder_bench"
+
+"$OUT_DIR/video_encoder_bench" "${1:-640}" "${2:-480}" "${3:-300}" "${4:-h264}" "$OUT_DIR/flir_bench.mp4"
@@ -0,0 +1,86 @@
+// Encodes synthetic colorized frames through ios/Flir/src/FlirVideoEncoder.c and reports the
+// per-frame cost. Built and run by scripts/bench_video_encoder.sh against the system FFmpeg.
+
+#include "FlirVideoEncoder.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+static int64_t now_nanos(void)
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (int64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+// A warm spot drifting over a gradient, mapped through a black-red-yellow-white ramp
+static void render_frame(uint8_t *pixels, int width, int height, int index)
+{
+  float cx = width * (0.5f + 0.3f * (float)((index % 90) - 45) / 45.f);
+  float cy = height * 0.5f;
+  for (int y = 0; y < height; y++) {
+    for (int x = 0; x < width; x++) {
+      float dx = (x - cx) / width, dy = (y - cy) / height;
+      float t = 0.35f * y / height + 0.65f / (1.f + 40.f * (dx * dx + dy * dy));
+      int v = (int)(t * 765.f);
+      uint8_t *p = pixels + ((size_t)y * width + x) * 4;
+      p[0] = (uint8_t)(v > 255 ? 255 : v);
+      p[1] = (uint8_t)(v > 510 ? 255 : (v > 255 ? v - 255 : 0));
+      p[2] = (uint8_t)(v > 510 ? v - 510 : 0);
+      p[3] = 255;
+    }
+  }
+}
+
+int main(int argc, char **argv)
+{
+  int width = argc > 1 ? atoi(argv[1]) : 640;
+  int height = argc > 2 ? atoi(argv[2]) : 480;
+  int frames = argc > 3 ? atoi(argv[3]) : 300;
+  const char *codec = argc > 4 ? argv[4] : "h264";
+  const char *path = argc > 5 ? argv[5] : "flir_bench.mp4";
+  const int fps = 9;
+
+  char error[256] = {0};
+  FlirVideoEncoder *encoder = flir_video_encoder_open(path, codec, width, height, fps, 0, error, sizeof(error));
+  if (encoder == NULL) {
+    fprintf(stderr, "open failed: %s\n", error);
+    return 1;
+  }
+  uint8_t *pixels = malloc((size_t)width * height * 4);
+  int64_t encodeNanos = 0;
+  for (int i = 0; i < frames; i++) {
+    render_frame(pixels, width, height, i);
+    int64_t start = now_nanos();
+    int result = flir_video_encoder_write(encoder, pixels, width, height, width * 4, FLIR_PIXELS_RGBA, (int64_t)i * 1000000000 / fps);
+    encodeNanos += now_nanos() - start;
+    if (result < 0) {
+      fprintf(stderr, "encode failed at frame %d: %d\n", i, result);
+      break;
+    }
+  }
+  const char *name = flir_video_encoder_codec_name(encoder);
+  char codecName[64];
+  snprintf(codecName, sizeof(codecName), "%s", name);
+  int64_t start = now_nanos();
+  int result = flir_video_encoder_close(encoder);
+  encodeNanos += now_nanos() - start;
+  free(pixels);
+
+  FILE *file = fopen(path, "rb");
+  long size = 0;
+  if (file != NULL) {
+    fseek(file, 0, SEEK_END);
+    size = ftell(file);
+    fclose(file);
+  }
+  double ms = encodeNanos / 1e6;
+  printf("encoder      %s\n", codecName);
+  printf("frames       %d x %dx%d\n", frames, width & ~1, height & ~1);
+  printf("avg/frame    %.3f ms (%.1f fps)\n", ms / frames, frames / (ms / 1000.0));
+  printf("input rate   %.1f MB/s RGBA\n", (double)width * height * 4 * frames / 1e6 / (ms / 1000.0));
+  printf("output       %s, %ld bytes (%.1f kbit/s at %d fps)\n", path, size, size * 8.0 / 1000.0 / ((double)frames / fps), fps);
+  return result < 0 ? 1 : 0;
+}